@@ -344,6 +344,19 @@ typedef struct INPUT_ONESTREAM_IFO
     uint32_t outputBufferLen;
 }param_oneStream_info;
 
+//!
+//! \brief  This structure is one piece of a scatter-gather output, the output frame is the
+//!         concatenation of all the pieces in order
+//!
+//! \param    pData,                 output,   the piece data, either rewritten headers in pOutputBitstream
+//!                                             or slice data left in the input bitstreams
+//! \param    length,                output,   the piece length
+typedef struct PARAM_OUTPUTSEGMENT
+{
+    const uint8_t *pData;
+    uint32_t       length;
+}param_outputSegment;
+
 //!
 //! \brief  This structure is for the whole frame parameters
 //!
@@ -351,6 +364,7 @@ typedef struct INPUT_ONESTREAM_IFO
 //! \param    VUI_enable,            input,           the flag indicates Video Usability Information enable or not
 //! \param    pTiledBitstream,       input,           this is pointer, which points all of the bistreams
 //! \param    sliceType,             output,          the slice type[I(2), P(1)] of the input bistream
+//! \param    copyThreadNum,         input,           the number of threads copying slice data into the merged bitstream, 0 or 1 copies on the calling thread
 typedef struct PARAM_STREAMSTITCHINFO
 {
     bool                   AUD_enable;
@@ -358,8 +372,24 @@ typedef struct PARAM_STREAMSTITCHINFO
     param_oneStream_info **pTiledBitstream;
     uint32_t               sliceType;
     uint32_t               pts;
+    uint32_t               copyThreadNum;
 }param_streamStitchInfo;
 
+//!
+//! \brief  This structure is for one NAL unit found by I360SCVP_ScanNALs
+//!
+//! \param    startCodeOffset,    output,   the offset of the start code in the scanned bitstream
+//! \param    startCodeSize,      output,   the length of the start code, 3 or 4
+//! \param    naluSize,           output,   the length of the NAL unit up to the next start code, including its start code
+//! \param    emulationBytesNum,  output,   the number of emulation prevention bytes in the NAL unit
+typedef struct PARAM_NALINDEX
+{
+    uint32_t startCodeOffset;
+    uint32_t startCodeSize;
+    uint32_t naluSize;
+    uint32_t emulationBytesNum;
+}param_nalIndex;
+
 //!
 //! \brief  This structure is for the stitch parameters
 //!
@@ -383,6 +413,11 @@ typedef struct PARAM_STREAMSTITCHINFO
 //! \param    pOutputSEI,         output,   the buffer for the output SEI bistream, mainly RWPK, just used in the usedType=E_MERGE_AND_VIEWPORT
 //! \param    outputSEILen,       output,   the length of the output SEI bistream, just used in the usedType=E_MERGE_AND_VIEWPORT
 //! \param    timeStamp,          input,    using timestamp to track frame, especially used in the E_MERGE_AND_VIEWPORT use case
+//! \param    bScatterOutput,     input,    output the merged frame as pOutputSegments instead of copying it to pOutputBitstream,
+//!                                         pOutputBitstream then only holds the rewritten headers, just used in the usedType=E_MERGE_AND_VIEWPORT
+//! \param    pOutputSegments,    output,   the pieces of the merged frame when bScatterOutput is set, owned by the library and valid
+//!                                         until the next process call, the pieces point into the input bitstreams which must be kept
+//! \param    outputSegmentsNum,  output,   the number of pieces in pOutputSegments
 //!
 typedef struct PARAM_360SCVP
 {
@@ -405,6 +440,9 @@ typedef struct PARAM_360SCVP
     unsigned char         *pOutputSEI;
     unsigned int           outputSEILen;
     uint32_t               timeStamp;
+    bool                   bScatterOutput;
+    param_outputSegment   *pOutputSegments;
+    uint32_t               outputSegmentsNum;
 }param_360SCVP;
 
 //!
@@ -488,6 +526,19 @@ int32_t I360SCVP_getFixedNumTiles(TileDef* pOutTile, Param_ViewportOutput* pPara
 //!
 int32_t I360SCVP_ParseNAL(Nalu* pNALU, void* p360SCVPHandle);
 
+//!
+//! \brief    This function finds all the NAL units of a bitstream in one pass, the start codes and the
+//!           emulation prevention bytes are searched with SSE2/AVX2 when the CPU supports them
+//! \param    uint8_t*         pBitstream,  input,  the bitstream, the bytes before the first start code are skipped
+//! \param    uint32_t         length,      input,  the length of the bitstream
+//! \param    param_nalIndex*  pNals,       output, the NAL units in bitstream order, can be NULL to only count them
+//! \param    uint32_t         maxNals,     input,  the number of entries of pNals
+//!
+//! \return   int32_t, the number of NAL units in the bitstream, only the first maxNals ones are filled
+//!           -1,    if the bitstream is NULL
+//!
+int32_t I360SCVP_ScanNALs(uint8_t *pBitstream, uint32_t length, param_nalIndex *pNals, uint32_t maxNals);
+
 //!
 //! \brief    geneate the new SPS bitstream, input include start code, output without startcode
 //!
@@ -34,6 +34,7 @@
 #include "360SCVPCommonDef.h"
 #include "360SCVPHevcEncHdr.h"
 #include "360SCVPImpl.h"
+#include "360SCVPNaluScanner.h"
 
 void* I360SCVP_Init(param_360SCVP* pParam360SCVP)
 {
@@ -152,6 +153,13 @@ int32_t I360SCVP_ParseNAL(Nalu* pNALU, void* p360SCVPHandle)
     return 0;
 }
 
+int32_t I360SCVP_ScanNALs(uint8_t *pBitstream, uint32_t length, param_nalIndex *pNals, uint32_t maxNals)
+{
+    if (!pBitstream)
+        return -1;
+    return (int32_t)gts_nalu_scan(pBitstream, length, pNals, maxNals);
+}
+
 int32_t I360SCVP_GenerateSPS(param_360SCVP* pParam360SCVP, void* p360SCVPHandle)
 {
     int32_t ret = 0;
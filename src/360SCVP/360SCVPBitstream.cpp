@@ -58,6 +58,75 @@ uint64_t gts_fseek(FILE *fp, int64_t offset, int32_t whence)
     return (uint64_t)fseek(fp, (long)offset, whence);
 }
 
+GTS_Err gts_bs_init(GTS_BitStream *bs, const int8_t *buffer, uint64_t BufferSize, uint32_t mode)
+{
+    if (!bs || !buffer || !BufferSize) return GTS_BAD_PARAM;
+    if ((mode != GTS_BITSTREAM_READ) && (mode != GTS_BITSTREAM_WRITE)) return GTS_BAD_PARAM;
+
+    memset(bs, 0, sizeof(GTS_BitStream));
+    bs->original = (int8_t*)buffer;
+    bs->size = BufferSize;
+    bs->bsmode = mode;
+    bs->nbBits = (mode == GTS_BITSTREAM_READ) ? 8 : 0;
+    return GTS_OK;
+}
+
+GTS_Err gts_bs_init_rbsp(GTS_BitStream *bs, const int8_t *nal, uint32_t nalSize, int8_t *scratch, uint32_t scratchSize)
+{
+    if (!bs || !nal || !nalSize || !scratch || !scratchSize) return GTS_BAD_PARAM;
+
+    memset(bs, 0, sizeof(GTS_BitStream));
+    bs->original = scratch;
+    bs->size = 0;
+    bs->bsmode = GTS_BITSTREAM_READ;
+    bs->nbBits = 8;
+    bs->rbsp_src = nal;
+    bs->rbsp_src_size = nalSize;
+    bs->rbsp_capacity = scratchSize;
+    return GTS_OK;
+}
+
+void gts_bs_uninit(GTS_BitStream *bs)
+{
+    if (!bs) return;
+    if (bs->rbsp_heap) gts_free(bs->rbsp_heap);
+    bs->rbsp_heap = NULL;
+}
+
+/*unescape the raw NAL payload until 'size' bytes are available or the payload ends,
+  same rules as gts_media_nalu_remove_emulation_bytes*/
+static void BS_FillRBSP(GTS_BitStream *bs, uint64_t size)
+{
+    const int8_t *src = bs->rbsp_src;
+    uint32_t n = bs->rbsp_src_pos;
+    uint32_t srcSize = bs->rbsp_src_size;
+
+    while ((bs->size < size) && (n < srcSize)) {
+        if (bs->size == bs->rbsp_capacity) {
+            /*the unescaped payload is never larger than the raw one*/
+            int8_t *heap = (int8_t*)gts_malloc(srcSize);
+            if (!heap) break;
+            memcpy(heap, bs->original, (size_t)bs->size);
+            bs->original = heap;
+            bs->rbsp_heap = heap;
+            bs->rbsp_capacity = srcSize;
+        }
+        if (bs->rbsp_zeros == 2 && src[n] == 0x03 && n + 1 < srcSize && src[n + 1] < 0x04) {
+            bs->rbsp_zeros = 0;
+            n++;
+        }
+        bs->rbsp_zeros = src[n] ? 0 : bs->rbsp_zeros + 1;
+        bs->original[bs->size++] = src[n++];
+    }
+    bs->rbsp_src_pos = n;
+}
+
+static inline void BS_Fill(GTS_BitStream *bs, uint64_t size)
+{
+    if (bs->rbsp_src && (bs->size < size) && (bs->rbsp_src_pos < bs->rbsp_src_size))
+        BS_FillRBSP(bs, size);
+}
+
 GTS_BitStream *gts_bs_new(const int8_t *buffer, uint64_t BufferSize, uint32_t mode)
 {
     GTS_BitStream *tmp;
@@ -113,6 +182,7 @@ GTS_BitStream *gts_bs_new(const int8_t *buffer, uint64_t BufferSize, uint32_t mo
 uint64_t gts_bs_get_size(GTS_BitStream *bs)
 {
     if (!bs) return 0;
+    BS_Fill(bs, (uint64_t)-1);
     if (bs->buffer_io)
         return bs->size + bs->buffer_written;
     return bs->size;
@@ -180,6 +250,7 @@ static uint8_t BS_ReadByte(GTS_BitStream *bs)
 {
     if (bs->bsmode == GTS_BITSTREAM_READ) {
         uint8_t res;
+        BS_Fill(bs, bs->position + 1);
         if (bs->position >= bs->size) {
             if (bs->EndOfStream) bs->EndOfStream(bs->par);
             return 0;
@@ -224,9 +295,75 @@ uint8_t gf_bs_read_bit(GTS_BitStream *bs)
 }
 
 
+/*load up to 8 bytes from the memory buffer as a big-endian word, missing bytes read as 0*/
+static inline uint64_t BS_LoadWord(GTS_BitStream *bs)
+{
+    const uint8_t *src = (const uint8_t *)bs->original + bs->position;
+    uint64_t word = 0;
+    if (bs->position + 8 <= bs->size) {
+        memcpy(&word, src, 8);
+#if defined(__GNUC__)
+        return __builtin_bswap64(word);
+#else
+        const uint8_t *b = (const uint8_t *)&word;
+        return ((uint64_t)b[0] << 56) | ((uint64_t)b[1] << 48) | ((uint64_t)b[2] << 40) | ((uint64_t)b[3] << 32)
+             | ((uint64_t)b[4] << 24) | ((uint64_t)b[5] << 16) | ((uint64_t)b[6] << 8) | (uint64_t)b[7];
+#endif
+    }
+    for (uint32_t i = 0; i < 8; i++) {
+        word <<= 8;
+        if (bs->position + i < bs->size)
+            word |= src[i];
+    }
+    return word;
+}
+
+/*next 64 bits of a memory read stream, starting at the current bit; the state is not modified.
+  Only the first (8 - nbBits) + 8 * (size - position) bits are meaningful*/
+static inline uint64_t BS_PeekWord(GTS_BitStream *bs)
+{
+    uint32_t avail = 8 - bs->nbBits;
+    uint64_t word = BS_LoadWord(bs);
+    if (!avail) return word;
+    return ((uint64_t)((bs->current & 0xFF) >> bs->nbBits) << (64 - avail)) | (word >> avail);
+}
+
+/*advance a memory read stream by nBits, the caller guarantees the bits are in the buffer*/
+static inline void BS_SkipBits(GTS_BitStream *bs, uint32_t nBits)
+{
+    uint32_t avail = 8 - bs->nbBits;
+    if (nBits <= avail) {
+        bs->nbBits += nBits;
+        bs->current <<= nBits;
+        return;
+    }
+    nBits -= avail;
+    bs->position += (nBits + 7) >> 3;
+    bs->nbBits = nBits - (((nBits - 1) >> 3) << 3);
+    bs->current = (uint32_t)(uint8_t)bs->original[bs->position - 1] << bs->nbBits;
+}
+
+/*true when nBits can be served from the memory buffer without hitting the end of stream*/
+static inline bool BS_CanReadFast(GTS_BitStream *bs, uint32_t nBits)
+{
+    uint32_t avail;
+    if (bs->bsmode != GTS_BITSTREAM_READ) return false;
+    avail = 8 - bs->nbBits;
+    if (nBits <= avail) return true;
+    /*unescape a whole window ahead so the next reads stay on this path*/
+    if (bs->rbsp_src && (bs->position + 8 > bs->size))
+        BS_Fill(bs, bs->position + 16);
+    return bs->position + ((nBits - avail + 7) >> 3) <= bs->size;
+}
+
 uint32_t gts_bs_read_int(GTS_BitStream *bs, uint32_t nBits)
 {
     uint32_t ret = 0;
+    if (nBits && nBits <= 32 && BS_CanReadFast(bs, nBits)) {
+        ret = (uint32_t)(BS_PeekWord(bs) >> (64 - nBits));
+        BS_SkipBits(bs, nBits);
+        return ret;
+    }
     while (nBits-- > 0) {
         ret <<= 1;
         ret |= gf_bs_read_bit(bs);
@@ -234,6 +371,60 @@ uint32_t gts_bs_read_int(GTS_BitStream *bs, uint32_t nBits)
     return ret;
 }
 
+static uint8_t digits_of_agm[128] = {
+    8, 7, 6, 6, 5, 5, 5, 5,  4, 4, 4, 4, 4, 4, 4, 4,
+    3, 3, 3, 3, 3, 3, 3, 3,  3, 3, 3, 3, 3, 3, 3, 3,
+    2, 2, 2, 2, 2, 2, 2, 2,  2, 2, 2, 2, 2, 2, 2, 2,
+    2, 2, 2, 2, 2, 2, 2, 2,  2, 2, 2, 2, 2, 2, 2, 2,
+    1, 1, 1, 1, 1, 1, 1, 1,  1, 1, 1, 1, 1, 1, 1, 1,
+    1, 1, 1, 1, 1, 1, 1, 1,  1, 1, 1, 1, 1, 1, 1, 1,
+    1, 1, 1, 1, 1, 1, 1, 1,  1, 1, 1, 1, 1, 1, 1, 1,
+    1, 1, 1, 1, 1, 1, 1, 1,  1, 1, 1, 1, 1, 1, 1, 1
+};
+
+uint32_t gts_bs_read_ue(GTS_BitStream *bs)
+{
+    uint8_t flag_c;
+    uint32_t data = 0, flag_r = 0;
+    if (!bs) return 0;
+
+    /*whole code word within the next 64 bits: count the prefix with clz*/
+    if (BS_CanReadFast(bs, 64)) {
+        uint64_t word = BS_PeekWord(bs);
+        if (word >> 32) {
+            uint32_t leadingZeros = (uint32_t)__builtin_clzll(word);
+            uint32_t codeLen = 2 * leadingZeros + 1;
+            BS_SkipBits(bs, codeLen);
+            return (uint32_t)(word >> (64 - codeLen)) - 1;
+        }
+    }
+
+    while (1) {
+        flag_r = gts_bs_peek_bits(bs, 8, 0);
+        if (flag_r) break;
+        //check whether we still have data once the peek is done since we may have less than 8 data available
+        if (!gts_bs_available(bs)) {
+            return 0;
+        }
+        gts_bs_read_int(bs, 8);
+        data += 8;
+    }
+    if (flag_r < 128)
+        flag_c = digits_of_agm[flag_r];
+    else
+        flag_c = 0;
+    gts_bs_read_int(bs, flag_c);
+    data += flag_c;
+    return gts_bs_read_int(bs, data + 1) - 1;
+}
+
+int32_t gts_bs_read_se(GTS_BitStream *bs)
+{
+    uint32_t v = gts_bs_read_ue(bs);
+    if ((v & 0x1) == 0) return (int32_t)(0 - (v >> 1));
+    return (v + 1) >> 1;
+}
+
 uint32_t gts_bs_read_U32(GTS_BitStream *bs)
 {
     uint32_t ret;
@@ -252,6 +443,12 @@ uint32_t gts_bs_read_U32(GTS_BitStream *bs)
 uint64_t gts_bs_read_long_int(GTS_BitStream *bs, uint32_t nBits)
 {
     uint64_t ret = 0;
+    if (nBits > 32 && nBits <= 64 && BS_CanReadFast(bs, nBits)) {
+        ret = gts_bs_read_int(bs, nBits - 32);
+        ret <<= 32;
+        ret |= gts_bs_read_int(bs, 32);
+        return ret;
+    }
     if (nBits>64) {
         gts_bs_read_long_int(bs, nBits-64);
         ret = gts_bs_read_long_int(bs, 64);
@@ -270,6 +467,7 @@ uint32_t gts_bs_read_data(GTS_BitStream *bs, int8_t *data, uint32_t nbBytes)
     uint64_t orig = 0;
 
     if (!bs || !data) return 0;
+    BS_Fill(bs, bs->position + nbBytes);
     if (bs->position + nbBytes > bs->size) return 0;
 
     orig = bs->position;
@@ -350,6 +548,26 @@ static void BS_WriteByte(GTS_BitStream *bs, uint8_t val)
     bs->position += 1;
 }
 
+/*write one byte produced by the bit writer, inserting the emulation prevention byte when needed*/
+static inline void BS_WriteByteEP(GTS_BitStream *bs, uint8_t val)
+{
+    const uint8_t emulation_prevention_three_byte = 0x03;
+
+    if ((bs->zeroCount == 2) && (val < 4)) {
+        BS_WriteByte(bs, emulation_prevention_three_byte);
+        bs->zeroCount = 0;
+    }
+    bs->zeroCount = (val == 0) ? bs->zeroCount + 1 : 0;
+
+    /*plain store while the memory buffer has room, BS_WriteByte handles the rest*/
+    if (((bs->bsmode == GTS_BITSTREAM_WRITE) || (bs->bsmode == GTS_BITSTREAM_WRITE_DYN))
+        && bs->original && (bs->position < bs->size)) {
+        bs->original[bs->position++] = (int8_t)val;
+        return;
+    }
+    BS_WriteByte(bs, val);
+}
+
 static void BS_WriteBit(GTS_BitStream *bs, uint32_t bit)
 {
     const uint8_t emulation_prevention_three_byte = 0x03;
@@ -378,6 +596,22 @@ void gts_bs_write_int(GTS_BitStream *bs, int32_t _value, int32_t nBits)
     uint32_t value, nb_shift;
     if (!nBits) return;
     value = (uint32_t) _value;
+
+    /*append the field to the pending bits and flush all completed bytes at once*/
+    if ((nBits > 0) && (nBits <= 32)
+        && (bs->bsmode != GTS_BITSTREAM_READ) && (bs->bsmode != GTS_BITSTREAM_FILE_READ)) {
+        uint32_t total = bs->nbBits + nBits;
+        uint64_t word = (uint64_t)(bs->current & ((1u << bs->nbBits) - 1)) << nBits;
+        word |= (nBits == 32) ? value : (value & ((1u << nBits) - 1));
+        while (total >= 8) {
+            total -= 8;
+            BS_WriteByteEP(bs, (uint8_t)(word >> total));
+        }
+        bs->current = (uint32_t)(word & ((1u << total) - 1));
+        bs->nbBits = total;
+        return;
+    }
+
     nb_shift = sizeof (int32_t) * 8 - nBits;
     if (nb_shift)
         value <<= nb_shift;
@@ -562,6 +796,7 @@ uint64_t gts_bs_available(GTS_BitStream *bs)
 
     //we are in MEM mode
     if (bs->bsmode == GTS_BITSTREAM_READ) {
+        BS_Fill(bs, (uint64_t)-1);
         if (bs->size < bs->position)
             return 0;
         else
@@ -628,6 +863,7 @@ static GTS_Err BS_SeekIntern(GTS_BitStream *bs, uint64_t offset)
 GTS_Err gts_bs_seek(GTS_BitStream *bs, uint64_t offset)
 {
     if (!bs) return GTS_BAD_PARAM;
+    BS_Fill(bs, offset + 1);
     if (offset > bs->size) return GTS_BAD_PARAM;
 
     gts_bs_align(bs);
@@ -642,8 +878,13 @@ uint32_t gts_bs_peek_bits(GTS_BitStream *bs, uint32_t numBits, uint64_t byte_off
     if (!bs) return 0;
 
     if ( (bs->bsmode != GTS_BITSTREAM_READ) && (bs->bsmode != GTS_BITSTREAM_FILE_READ)) return 0;
+    BS_Fill(bs, bs->position + byte_offset + 1);
     if (!numBits || (bs->size < bs->position + byte_offset)) return 0;
 
+    /*in-place peek on memory streams, same result as the read/seek back below*/
+    if (!byte_offset && numBits <= 32 && BS_CanReadFast(bs, numBits))
+        return (uint32_t)(BS_PeekWord(bs) >> (64 - numBits));
+
     /*store our state*/
     curPos = bs->position;
     curBits = bs->nbBits;
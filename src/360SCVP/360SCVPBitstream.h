@@ -115,6 +115,15 @@ struct __tag_bitstream
     int8_t *buffer_io;
     uint32_t buffer_io_size;
     uint32_t buffer_written;
+
+    //raw NAL payload when emulation prevention bytes are removed on demand (read mode)
+    const int8_t *rbsp_src;
+    uint32_t rbsp_src_size;
+    uint32_t rbsp_src_pos;
+    uint8_t rbsp_zeros;
+    //capacity of the buffer behind original, and its heap replacement once it is exceeded
+    uint64_t rbsp_capacity;
+    int8_t *rbsp_heap;
 };
 
 typedef struct __tag_bitstream GTS_BitStream;
@@ -133,6 +142,44 @@ typedef struct __tag_bitstream GTS_BitStream;
  */
 GTS_BitStream *gts_bs_new(const int8_t *buffer, uint64_t size, uint32_t mode);
 
+/*!
+ *    \brief Initializes a caller-owned bitstream object on a caller-provided buffer (read or write mode), nothing is allocated.
+ *
+ *    \param GTS_BitStream * bs      input  the bitstream object to initialize, typically on the stack
+ *    \param const int8_t *  buffer  input  buffer to read or write, must not be NULL
+ *    \param uint64_t        size    input  size of the buffer given
+ *    \param uint32_t        mode    input  GTS_BITSTREAM_READ or GTS_BITSTREAM_WRITE
+ *
+ *    \return GTS_Err GTS_OK on success, GTS_BAD_PARAM otherwise
+ *
+ *    \note the object must not be released with gts_bs_del. Same overflow behavior as gts_bs_new in write mode.
+ */
+GTS_Err gts_bs_init(GTS_BitStream *bs, const int8_t *buffer, uint64_t size, uint32_t mode);
+
+/*!
+ *    \brief Initializes a caller-owned read bitstream over a NAL unit payload which still contains emulation prevention bytes.
+ *
+ *    The bytes are unescaped into the scratch buffer only as far as they are read, so parsing a slice header does not
+ *    touch the slice data. Positions and sizes are those of the unescaped payload. If the reader goes beyond the scratch
+ *    capacity, the rest is unescaped into a heap buffer released by gts_bs_uninit.
+ *
+ *    \param GTS_BitStream * bs           input  the bitstream object to initialize
+ *    \param const int8_t *  nal          input  the NAL unit payload, starting at the NAL unit header
+ *    \param uint32_t        nalSize      input  size of the payload
+ *    \param int8_t *        scratch      input  buffer receiving the unescaped bytes
+ *    \param uint32_t        scratchSize  input  size of the scratch buffer
+ *
+ *    \return GTS_Err GTS_OK on success, GTS_BAD_PARAM otherwise
+ */
+GTS_Err gts_bs_init_rbsp(GTS_BitStream *bs, const int8_t *nal, uint32_t nalSize, int8_t *scratch, uint32_t scratchSize);
+
+/*!
+ *    \brief Releases what a bitstream initialized by gts_bs_init or gts_bs_init_rbsp may have allocated.
+ *
+ *    \param GTS_BitStream *bs  input  the bitstream object, not freed itself
+ */
+void gts_bs_uninit(GTS_BitStream *bs);
+
 /*!
  *    \brief Deletes the bitstream object, bitstream destructor from file handle
  *    \param GTS_BitStream *bs  input which is created by gts_bs_new
@@ -177,6 +224,24 @@ uint64_t gts_bs_available(GTS_BitStream *bs);
  */
 uint32_t gts_bs_read_int(GTS_BitStream *bs, uint32_t nBits);
 
+/*!
+ *    \brief Reads an unsigned Exp-Golomb coded integer (ue(v)).
+ *
+ *    \param GTS_BitStream *bs   input  the target bitstream
+ *
+ *    \return uint32_t the decoded value, 0 if the stream ends inside the leading zeros.
+ */
+uint32_t gts_bs_read_ue(GTS_BitStream *bs);
+
+/*!
+ *    \brief Reads a signed Exp-Golomb coded integer (se(v)).
+ *
+ *    \param GTS_BitStream *bs   input  the target bitstream
+ *
+ *    \return int32_t the decoded value.
+ */
+int32_t gts_bs_read_se(GTS_BitStream *bs);
+
 /*!
  *    \brief Reads a large integer coded on a number of bit bigger than 32.
  *
@@ -26,6 +26,9 @@
 #include <assert.h>
 #include <math.h>
 #include "360SCVPCubeMap.h"
+#ifdef SCVP_X86_SIMD
+#include <immintrin.h>
+#endif
 
 /*************************************
 Cubemap geometry related functions;
@@ -151,3 +154,87 @@ void CubeMap::map3DTo2D(SPos *pSPosIn, SPos *pSPosOut)
     pSPosOut->x = (POSType)((pu+1.0)*(m_sVideoInfo.iFaceWidth>>1) + (-0.5));
     pSPosOut->y = (POSType)((pv+1.0)*(m_sVideoInfo.iFaceHeight>>1)+ (-0.5));
 }
+
+void CubeMap::map2DTo3DBatch(SPosArray& sPosIn, SPosArray& sPosOut, int32_t num)
+{
+    for (int32_t k = 0; k < num; k++)
+    {
+        SPos in(sPosIn.faceIdx[k], sPosIn.x[k], sPosIn.y[k], sPosIn.z[k]), out;
+        CubeMap::map2DTo3D(in, &out);
+        sPosOut.faceIdx[k] = out.faceIdx;
+        sPosOut.x[k] = out.x;
+        sPosOut.y[k] = out.y;
+        sPosOut.z[k] = out.z;
+    }
+}
+
+#ifdef SCVP_X86_SIMD
+// same operations as map3DTo2D, 4 positions per iteration, returns the number of mapped positions
+__attribute__((target("avx2")))
+static int32_t map3DTo2DAVX2(int32_t iFaceWidth, int32_t iFaceHeight, SPosArray& sPosIn, SPosArray& sPosOut, int32_t num)
+{
+    const __m256d signMask = _mm256_set1_pd(-0.0);
+    const __m256d zero = _mm256_setzero_pd();
+    const __m256d one = _mm256_set1_pd(1.0);
+    const __m256d halfWidth = _mm256_set1_pd((POSType)(iFaceWidth>>1));
+    const __m256d halfHeight = _mm256_set1_pd((POSType)(iFaceHeight>>1));
+    const __m256d offset = _mm256_set1_pd(-0.5);
+    int32_t k = 0;
+    for (; k + 4 <= num; k += 4)
+    {
+        __m256d x = _mm256_loadu_pd(sPosIn.x + k);
+        __m256d y = _mm256_loadu_pd(sPosIn.y + k);
+        __m256d z = _mm256_loadu_pd(sPosIn.z + k);
+        __m256d aX = _mm256_andnot_pd(signMask, x);
+        __m256d aY = _mm256_andnot_pd(signMask, y);
+        __m256d aZ = _mm256_andnot_pd(signMask, z);
+        __m256d nX = _mm256_xor_pd(signMask, x);
+        __m256d nY = _mm256_xor_pd(signMask, y);
+        __m256d nZ = _mm256_xor_pd(signMask, z);
+
+        // the major axis, x first, then y, then z
+        __m256d isX = _mm256_and_pd(_mm256_cmp_pd(aX, aY, _CMP_GE_OQ), _mm256_cmp_pd(aX, aZ, _CMP_GE_OQ));
+        __m256d isY = _mm256_andnot_pd(isX, _mm256_and_pd(_mm256_cmp_pd(aY, aX, _CMP_GE_OQ), _mm256_cmp_pd(aY, aZ, _CMP_GE_OQ)));
+        __m256d isPos = _mm256_blendv_pd(_mm256_blendv_pd(_mm256_cmp_pd(z, zero, _CMP_GT_OQ), _mm256_cmp_pd(y, zero, _CMP_GT_OQ), isY),
+                                         _mm256_cmp_pd(x, zero, _CMP_GT_OQ), isX);
+
+        // face 0: (-z, -y)/aX, face 1: (z, -y)/aX
+        // face 2: (x, z)/aY,   face 3: (x, -z)/aY
+        // face 4: (x, -y)/aZ,  face 5: (-x, -y)/aZ
+        __m256d uX = _mm256_blendv_pd(z, nZ, isPos);
+        __m256d uZ = _mm256_blendv_pd(nX, x, isPos);
+        __m256d vY = _mm256_blendv_pd(nZ, z, isPos);
+        __m256d pu = _mm256_blendv_pd(_mm256_blendv_pd(_mm256_div_pd(uZ, aZ), _mm256_div_pd(x, aY), isY), _mm256_div_pd(uX, aX), isX);
+        __m256d pv = _mm256_blendv_pd(_mm256_blendv_pd(_mm256_div_pd(nY, aZ), _mm256_div_pd(vY, aY), isY), _mm256_div_pd(nY, aX), isX);
+
+        __m256d face = _mm256_blendv_pd(_mm256_blendv_pd(_mm256_set1_pd(4), _mm256_set1_pd(2), isY), zero, isX);
+        face = _mm256_add_pd(face, _mm256_andnot_pd(isPos, one));
+
+        //convert pu, pv to [0, width], [0, height];
+        _mm256_storeu_pd(sPosOut.x + k, _mm256_add_pd(_mm256_mul_pd(_mm256_add_pd(pu, one), halfWidth), offset));
+        _mm256_storeu_pd(sPosOut.y + k, _mm256_add_pd(_mm256_mul_pd(_mm256_add_pd(pv, one), halfHeight), offset));
+        _mm256_storeu_pd(sPosOut.z + k, zero);
+        _mm_storeu_si128((__m128i*)(sPosOut.faceIdx + k), _mm256_cvtpd_epi32(face));
+    }
+    return k;
+}
+#endif
+
+void CubeMap::map3DTo2DBatch(SPosArray& sPosIn, SPosArray& sPosOut, int32_t num)
+{
+    int32_t k = 0;
+#ifdef SCVP_X86_SIMD
+    if (getSIMDLevel() >= SIMD_AVX2)
+        k = map3DTo2DAVX2(m_sVideoInfo.iFaceWidth, m_sVideoInfo.iFaceHeight, sPosIn, sPosOut, num);
+#endif
+    // the remaining positions
+    for (; k < num; k++)
+    {
+        SPos in(sPosIn.faceIdx[k], sPosIn.x[k], sPosIn.y[k], sPosIn.z[k]), out;
+        CubeMap::map3DTo2D(&in, &out);
+        sPosOut.faceIdx[k] = out.faceIdx;
+        sPosOut.x[k] = out.x;
+        sPosOut.y[k] = out.y;
+        sPosOut.z[k] = out.z;
+    }
+}
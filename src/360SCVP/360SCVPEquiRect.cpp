@@ -100,3 +100,37 @@ void EquiRect::map3DTo2D(SPos *pSPosIn, SPos *pSPosOut)
     pSPosOut->y = (POSType)((len < S_EPS? 0.5 : sacos(y/len)/S_PI)*m_sVideoInfo.iFaceHeight);
     pSPosOut->y -= 0.5;
 }
+
+void EquiRect::map2DTo3DBatch(SPosArray& sPosIn, SPosArray& sPosOut, int32_t num)
+{
+    for (int32_t k = 0; k < num; k++)
+    {
+        SPos in(sPosIn.faceIdx[k], sPosIn.x[k], sPosIn.y[k], sPosIn.z[k]), out;
+        EquiRect::map2DTo3D(in, &out);
+        sPosOut.faceIdx[k] = out.faceIdx;
+        sPosOut.x[k] = out.x;
+        sPosOut.y[k] = out.y;
+        sPosOut.z[k] = out.z;
+    }
+}
+
+//same as map3DTo2D without the virtual call, the positions are kept identical;
+void EquiRect::map3DTo2DBatch(SPosArray& sPosIn, SPosArray& sPosOut, int32_t num)
+{
+    POSType iWidth = m_sVideoInfo.iFaceWidth;
+    POSType iHeight = m_sVideoInfo.iFaceHeight;
+    for (int32_t k = 0; k < num; k++)
+    {
+        POSType x = sPosIn.x[k];
+        POSType y = sPosIn.y[k];
+        POSType z = sPosIn.z[k];
+        POSType len = ssqrt(x*x + y*y + z*z);
+
+        sPosOut.faceIdx[k] = 0;
+        sPosOut.z[k] = 0;
+        //yaw;
+        sPosOut.x[k] = (POSType)((S_PI-satan2(z, x))*iWidth/(2*S_PI)) - 0.5;
+        //pitch;
+        sPosOut.y[k] = (POSType)((len < S_EPS? 0.5 : sacos(y/len)/S_PI)*iHeight) - 0.5;
+    }
+}
@@ -45,6 +45,8 @@ public:
 
     virtual void map2DTo3D(SPos& IPosIn, SPos *pSPosOut);
     virtual void map3DTo2D(SPos *pSPosIn, SPos *pSPosOut);
+    virtual void map2DTo3DBatch(SPosArray& sPosIn, SPosArray& sPosOut, int32_t num);
+    virtual void map3DTo2DBatch(SPosArray& sPosIn, SPosArray& sPosOut, int32_t num);
 };
 
 #endif // __360SCVP_EQUIRECT__
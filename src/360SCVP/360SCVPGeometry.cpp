@@ -44,6 +44,7 @@ Geometry::Geometry()
     m_bPadded = false;
     m_bGeometryMapping = false;
     m_bConvOutputPaddingNeeded = false;
+    m_bSparseMapping = false;
     m_numFaces = 0;
     m_upLeft = nullptr;
     m_downRight = nullptr;
@@ -109,57 +110,59 @@ void Geometry::geometryMapping(Geometry *pGeoSrc)
       ((ViewPort*)this)->setRotMat();
       ((ViewPort*)this)->setInvK();
     }
-    //generate the map;
+
+    // the viewport range only depends on a few samples of each row, see sparseGeometryMapping
+    if (m_sVideoInfo.geoType == SVIDEO_VIEWPORT && m_bSparseMapping
+        && !m_bConvOutputPaddingNeeded && !pRot[0] && !pRot[1] && !pRot[2]
+        && (pGeoSrc->getType() == SVIDEO_EQUIRECT || pGeoSrc->getType() == SVIDEO_CUBEMAP))
+    {
+        sparseGeometryMapping(pGeoSrc);
+        m_bGeometryMapping = true;
+        return;
+    }
+
+    //generate the map row by row;
+    int32_t iWidth = m_sVideoInfo.iFaceWidth;
+    int32_t iHeight = m_sVideoInfo.iFaceHeight;
+    int32_t nMarginX = m_iMarginX;
+    int32_t nMarginY = m_iMarginY;
+    int32_t iRowStart = m_bConvOutputPaddingNeeded ? -nMarginX : 0;
+    int32_t iRowEnd = m_bConvOutputPaddingNeeded ? iWidth + nMarginX : iWidth;
+    int32_t jStart = m_bConvOutputPaddingNeeded ? -nMarginY : 0;
+    int32_t jEnd = m_bConvOutputPaddingNeeded ? iHeight + nMarginY : iHeight;
+    SPosArray sPos2D, sPos3D;
+    if (!allocPosArray(sPos2D, iRowEnd - iRowStart) || !allocPosArray(sPos3D, iRowEnd - iRowStart))
+    {
+        freePosArray(sPos2D);
+        freePosArray(sPos3D);
+        return;
+    }
+
     for(int32_t fIdx=0; fIdx<m_sVideoInfo.iNumFaces; fIdx++)
     {
       for(int32_t ch=0; ch<1; ch++)//iNumMaps
       {
-          int32_t iWidth = m_sVideoInfo.iFaceWidth;
-          int32_t iHeight = m_sVideoInfo.iFaceHeight;
-          int32_t nMarginX = m_iMarginX;
-          int32_t nMarginY = m_iMarginY;
           int32_t nNextAreaX = iWidth + nMarginX;
-          for (int32_t j = -nMarginY; j < iHeight + nMarginY; j++)
+          for (int32_t j = jStart; j < jEnd; j++)
           {
-              for (int32_t i = -nMarginX; i < iWidth + nMarginX; i++)
+              mapRow(pGeoSrc, fIdx, j, iRowStart, iRowEnd - iRowStart, sPos2D, sPos3D);
+              for (int32_t i = iRowStart; i < iRowEnd; i++)
               {
                   if (!m_bConvOutputPaddingNeeded && !insideFace((i), (j)))
                       continue;
 
                   int32_t xOrg = (i + nMarginX);
-                  int32_t ic = i;
-                  int32_t jc = j;
+                  int32_t k = i - iRowStart;
+                  SPos pos3D(sPos3D.faceIdx[k], sPos3D.x[k], sPos3D.y[k], sPos3D.z[k]);
+                  if (m_sVideoInfo.geoType == SVIDEO_VIEWPORT)
                   {
-                      POSType x = (ic);
-                      POSType y = (jc);
-                      SPos in(fIdx, x, y, 0), pos3D;
-                      map2DTo3D(in, &pos3D);
-
-                      rotate3D(pos3D, pRot[0], pRot[1], pRot[2]);
-                      pGeoSrc->map3DTo2D(&pos3D, &pos3D);
-                      if (m_sVideoInfo.geoType == SVIDEO_VIEWPORT)
+                      //if the input is the erp, should consider the boundary case
+                      if ((int32_t)pos3D.x == 0 && xOrg != 16 && pGeoSrc->getType() == SVIDEO_EQUIRECT)
                       {
-                          SPos *pUpLeftTmp = m_upLeft + pos3D.faceIdx;
-                          SPos *pDownRightTmp = m_downRight + pos3D.faceIdx;
-                          int32_t yTmp = (int32_t)pos3D.y;//(int32_t)(pos / stride);
-                          int32_t xTmp = (int32_t)pos3D.x;//(int32_t)(pos % stride);
-                                                          //if the input is the erp, should consider the boundary case
-                          if (xTmp == 0 && xOrg != 16 && pGeoSrc->getType() == SVIDEO_EQUIRECT)
-                          {
-                              nNextAreaX = i;
-                              break;
-                          }
-                          if (pUpLeftTmp->x > xTmp)
-                              pUpLeftTmp->x = xTmp;
-                          if (pUpLeftTmp->y > yTmp)
-                              pUpLeftTmp->y = yTmp;
-                          if (pDownRightTmp->x < xTmp)
-                              pDownRightTmp->x = xTmp;
-                          if (pDownRightTmp->y < yTmp)
-                              pDownRightTmp->y = yTmp;
-                          pUpLeftTmp->faceIdx = pos3D.faceIdx;
-                          pDownRightTmp->faceIdx = pos3D.faceIdx;
+                          nNextAreaX = i;
+                          break;
                       }
+                      updateRange(m_upLeft + pos3D.faceIdx, m_downRight + pos3D.faceIdx, pos3D);
                   }
               }
           }
@@ -167,45 +170,24 @@ void Geometry::geometryMapping(Geometry *pGeoSrc)
           // judge if exiting boundary when the source is erp format
           if (nNextAreaX != (iWidth + nMarginX) && (pGeoSrc->getType() == SVIDEO_EQUIRECT))
           {
-              for (int32_t j = -nMarginY; j < iHeight + nMarginY; j++)
+              for (int32_t j = jStart; j < jEnd; j++)
               {
-                  for (int32_t i = nNextAreaX; i < iWidth + nMarginX; i++)
+                  mapRow(pGeoSrc, fIdx, j, nNextAreaX, iRowEnd - nNextAreaX, sPos2D, sPos3D);
+                  for (int32_t i = nNextAreaX; i < iRowEnd; i++)
                   {
                       if (!m_bConvOutputPaddingNeeded && !insideFace((i), (j)))
                           continue;
-                      int32_t ic = i;
-                      int32_t jc = j;
-                      {
-                          POSType x = (ic);
-                          POSType y = (jc);
-                          SPos in(fIdx, x, y, 0), pos3D;
-
-                          map2DTo3D(in, &pos3D);
-                          rotate3D(pos3D, pRot[0], pRot[1], pRot[2]);
-                          pGeoSrc->map3DTo2D(&pos3D, &pos3D);
-                          if (m_sVideoInfo.geoType == SVIDEO_VIEWPORT)
-                          {
-                              SPos *pUpLeftTmp = m_upLeft + 1;
-                              SPos *pDownRightTmp = m_downRight + 1;
-                              int32_t yTmp = (int32_t)pos3D.y;//(int32_t)(pos / stride);
-                              int32_t xTmp = (int32_t)pos3D.x;//(int32_t)(pos % stride);
-                              if (pUpLeftTmp->x > xTmp)
-                                  pUpLeftTmp->x = xTmp;
-                              if (pUpLeftTmp->y > yTmp)
-                                  pUpLeftTmp->y = yTmp;
-                              if (pDownRightTmp->x < xTmp)
-                                  pDownRightTmp->x = xTmp;
-                              if (pDownRightTmp->y < yTmp)
-                                  pDownRightTmp->y = yTmp;
-                              pUpLeftTmp->faceIdx = pos3D.faceIdx;
-                              pDownRightTmp->faceIdx = pos3D.faceIdx;
-                          }
-                      }
+                      int32_t k = i - nNextAreaX;
+                      SPos pos3D(sPos3D.faceIdx[k], sPos3D.x[k], sPos3D.y[k], sPos3D.z[k]);
+                      if (m_sVideoInfo.geoType == SVIDEO_VIEWPORT)
+                          updateRange(m_upLeft + 1, m_downRight + 1, pos3D);
                   }
               }
           }
       }
     }
+    freePosArray(sPos2D);
+    freePosArray(sPos3D);
 
     if (m_sVideoInfo.geoType == SVIDEO_VIEWPORT)
     {
@@ -220,6 +202,281 @@ void Geometry::geometryMapping(Geometry *pGeoSrc)
     m_bGeometryMapping = true;
 }
 
+void Geometry::mapPixel(Geometry *pGeoSrc, int32_t faceIdx, int32_t i, int32_t j, SPos *pSPosOut)
+{
+    int32_t *pRot = m_sVideoInfo.sVideoRotation.degree;
+    SPos in(faceIdx, (POSType)i, (POSType)j, 0);
+    map2DTo3D(in, pSPosOut);
+    rotate3D(*pSPosOut, pRot[0], pRot[1], pRot[2]);
+    pGeoSrc->map3DTo2D(pSPosOut, pSPosOut);
+}
+
+bool Geometry::allocPosArray(SPosArray& sPos, int32_t num)
+{
+    sPos.faceIdx = new int32_t[num > 0 ? num : 1];
+    sPos.x = new POSType[3 * (num > 0 ? num : 1)];
+    sPos.y = sPos.x + num;
+    sPos.z = sPos.y + num;
+    return sPos.faceIdx && sPos.x;
+}
+
+void Geometry::freePosArray(SPosArray& sPos)
+{
+    delete[] sPos.faceIdx;
+    delete[] sPos.x;
+    sPos.faceIdx = NULL;
+    sPos.x = sPos.y = sPos.z = NULL;
+}
+
+// map the pixels [iStart, iStart + num) of row j into the source geometry
+void Geometry::mapRow(Geometry *pGeoSrc, int32_t faceIdx, int32_t j, int32_t iStart, int32_t num, SPosArray& sPos2D, SPosArray& sPos3D)
+{
+    int32_t *pRot = m_sVideoInfo.sVideoRotation.degree;
+    for (int32_t k = 0; k < num; k++)
+    {
+        sPos2D.faceIdx[k] = faceIdx;
+        sPos2D.x[k] = (POSType)(iStart + k);
+        sPos2D.y[k] = (POSType)j;
+        sPos2D.z[k] = 0;
+    }
+    map2DTo3DBatch(sPos2D, sPos3D, num);
+    rotate3DBatch(sPos3D, num, pRot[0], pRot[1], pRot[2]);
+    pGeoSrc->map3DTo2DBatch(sPos3D, sPos3D, num);
+}
+
+void Geometry::updateRange(SPos *pUpLeft, SPos *pDownRight, SPos& sPos)
+{
+    int32_t yTmp = (int32_t)sPos.y;
+    int32_t xTmp = (int32_t)sPos.x;
+    if (pUpLeft->x > xTmp)
+        pUpLeft->x = xTmp;
+    if (pUpLeft->y > yTmp)
+        pUpLeft->y = yTmp;
+    if (pDownRight->x < xTmp)
+        pDownRight->x = xTmp;
+    if (pDownRight->y < yTmp)
+        pDownRight->y = yTmp;
+    pUpLeft->faceIdx = sPos.faceIdx;
+    pDownRight->faceIdx = sPos.faceIdx;
+}
+
+/***************************************************
+// sparse version of geometryMapping for the viewport, the output range is the
+// same as the one of the full mapping.
+// one row of the viewport is a great circle arc shorter than 180 degree, so
+// - for cube map, every face covers one interval of the row, and x/y are
+//   monotonic inside the interval, only the interval ends are needed;
+// - for erp, the longitude is monotonic along the row except one wrap at the
+//   seam, and the latitude is symmetric to the centre column, so only the row
+//   ends, the centre and the pixels around the seam are needed. The rows close
+//   to the poles are mapped pixel by pixel.
+****************************************************/
+void Geometry::sparseGeometryMapping(Geometry *pGeoSrc)
+{
+    int32_t iWidth = m_sVideoInfo.iFaceWidth;
+    int32_t iHeight = m_sVideoInfo.iFaceHeight;
+    if (iWidth <= 0 || iHeight <= 0)
+        return;
+
+    if (pGeoSrc->getType() == SVIDEO_CUBEMAP)
+    {
+        for (int32_t j = 0; j < iHeight; j++)
+        {
+            SPos sPosA, sPosB;
+            mapPixel(pGeoSrc, 0, 0, j, &sPosA);
+            mapPixel(pGeoSrc, 0, iWidth - 1, j, &sPosB);
+            sparseMapRowSegment(pGeoSrc, j, 0, sPosA, iWidth - 1, sPosB);
+        }
+    }
+    else
+    {
+        // rows around the poles, where the longitude changes too fast
+        int32_t poleRowStart[2] = { 1, 1 };
+        int32_t poleRowEnd[2] = { 0, 0 };
+        for (int32_t k = 0; k < 2; k++)
+        {
+            SPos pole(0, 0, k ? -1 : 1, 0), polePos;
+            map3DTo2D(&pole, &polePos);
+            if (polePos.faceIdx < 0)
+                continue;
+            poleRowStart[k] = (int32_t)sfloor(polePos.y) - 2;
+            poleRowEnd[k] = (int32_t)sfloor(polePos.y) + 3;
+        }
+
+        int32_t *pBreakX = new int32_t[iHeight];
+        int32_t *pWrapX = new int32_t[iHeight];
+        SPosArray sPos2D, sPos3D;
+        allocPosArray(sPos2D, iWidth);
+        allocPosArray(sPos3D, iWidth);
+        int32_t lastBreakX = -1;
+        for (int32_t j = 0; j < iHeight; j++)
+        {
+            bool bPoleRow = (j >= poleRowStart[0] && j <= poleRowEnd[0]) || (j >= poleRowStart[1] && j <= poleRowEnd[1]);
+            if (bPoleRow)
+            {
+                pBreakX[j] = -1;
+                mapRow(pGeoSrc, 0, j, 0, iWidth, sPos2D, sPos3D);
+                for (int32_t i = 0; i < iWidth; i++)
+                {
+                    SPos sPos(sPos3D.faceIdx[i], sPos3D.x[i], sPos3D.y[i], sPos3D.z[i]);
+                    if ((int32_t)sPos.x == 0 && i != 0)
+                    {
+                        pBreakX[j] = i;
+                        break;
+                    }
+                    updateRange(m_upLeft + sPos.faceIdx, m_downRight + sPos.faceIdx, sPos);
+                }
+                // marks the row to be mapped pixel by pixel in the second area as well
+                pWrapX[j] = -2;
+            }
+            else
+            {
+                sparseMapERPRow(pGeoSrc, j, pBreakX + j, pWrapX + j);
+            }
+            if (pBreakX[j] > 0)
+                lastBreakX = pBreakX[j];
+        }
+
+        // the area after the seam, from the last break position on each row
+        if (lastBreakX > 0)
+        {
+            SPos *pUpLeftTmp = m_upLeft + 1;
+            SPos *pDownRightTmp = m_downRight + 1;
+            for (int32_t j = 0; j < iHeight; j++)
+            {
+                if (pWrapX[j] == -2)
+                {
+                    mapRow(pGeoSrc, 0, j, lastBreakX, iWidth - lastBreakX, sPos2D, sPos3D);
+                    for (int32_t k = 0; k < iWidth - lastBreakX; k++)
+                    {
+                        SPos sPos(sPos3D.faceIdx[k], sPos3D.x[k], sPos3D.y[k], sPos3D.z[k]);
+                        updateRange(pUpLeftTmp, pDownRightTmp, sPos);
+                    }
+                    continue;
+                }
+                int32_t candidates[6] = { lastBreakX, iWidth - 1, (iWidth - 1) / 2, iWidth / 2, pWrapX[j] - 1, pWrapX[j] };
+                for (int32_t k = 0; k < 6; k++)
+                {
+                    if (candidates[k] < lastBreakX || candidates[k] >= iWidth)
+                        continue;
+                    if (k >= 4 && pWrapX[j] < 0)
+                        continue;
+                    SPos sPos;
+                    mapPixel(pGeoSrc, 0, candidates[k], j, &sPos);
+                    updateRange(pUpLeftTmp, pDownRightTmp, sPos);
+                }
+            }
+        }
+        delete[] pBreakX;
+        delete[] pWrapX;
+        freePosArray(sPos2D);
+        freePosArray(sPos3D);
+    }
+
+    SPos *pUpLeftTmp = m_upLeft;
+    for (int32_t i = 0; i < FACE_NUMBER; i++)
+    {
+        if (pUpLeftTmp->faceIdx >= 0)
+            m_numFaces++;
+        pUpLeftTmp++;
+    }
+}
+
+/***************************************************
+// map one row of the viewport onto erp, the range before the break position
+// is updated into the first face, the break position(the first pixel mapped to
+// x = 0 except the first one of the row) and the wrap position(the first pixel
+// after the seam) are output, -1 if not found.
+****************************************************/
+void Geometry::sparseMapERPRow(Geometry *pGeoSrc, int32_t j, int32_t *pBreakX, int32_t *pWrapX)
+{
+    int32_t iWidth = m_sVideoInfo.iFaceWidth;
+    int32_t iSrcWidth = pGeoSrc->m_sVideoInfo.iFaceWidth;
+    SPos sPos0, sPosEnd, sPos;
+    mapPixel(pGeoSrc, 0, 0, j, &sPos0);
+    mapPixel(pGeoSrc, 0, iWidth - 1, j, &sPosEnd);
+
+    // the longitude range of the row is less than half of the width
+    POSType delta = sPosEnd.x - sPos0.x;
+    bool bWrap = (iWidth > 1) && (sfabs(delta) > iSrcWidth / 2.0);
+    bool bIncrease = (delta > 0) != bWrap;
+
+    // first pixel in [lo, hi) whose x is less(or greater) than the threshold
+    auto findFirst = [&](int32_t lo, int32_t hi, POSType threshold, bool bLess) {
+        while (lo < hi)
+        {
+            int32_t mid = lo + ((hi - lo) >> 1);
+            mapPixel(pGeoSrc, 0, mid, j, &sPos);
+            if (bLess ? (sPos.x < threshold) : (sPos.x > threshold))
+                hi = mid;
+            else
+                lo = mid + 1;
+        }
+        return lo;
+    };
+
+    int32_t wrapX = -1;
+    if (bWrap)
+        wrapX = findFirst(1, iWidth, sPos0.x, bIncrease);
+
+    // pixels mapped to x = 0 are next to the seam, on the side of x = 0
+    int32_t breakX = -1;
+    if (iWidth > 1)
+    {
+        if (bIncrease)
+        {
+            int32_t firstX = bWrap ? wrapX : 1;
+            mapPixel(pGeoSrc, 0, firstX, j, &sPos);
+            if ((int32_t)sPos.x == 0)
+                breakX = firstX;
+        }
+        else
+        {
+            int32_t endX = bWrap ? wrapX : iWidth;
+            mapPixel(pGeoSrc, 0, endX - 1, j, &sPos);
+            if ((int32_t)sPos.x == 0)
+            {
+                breakX = findFirst(0, endX, 1, true);
+                if (breakX == 0)
+                    breakX = (endX > 1) ? 1 : -1;
+            }
+        }
+    }
+
+    int32_t endX = breakX > 0 ? breakX : iWidth;
+    int32_t candidates[6] = { 0, endX - 1, (iWidth - 1) / 2, iWidth / 2, wrapX - 1, wrapX };
+    for (int32_t k = 0; k < 6; k++)
+    {
+        if (candidates[k] < 0 || candidates[k] >= endX)
+            continue;
+        if (k >= 4 && wrapX < 0)
+            continue;
+        mapPixel(pGeoSrc, 0, candidates[k], j, &sPos);
+        updateRange(m_upLeft + sPos.faceIdx, m_downRight + sPos.faceIdx, sPos);
+    }
+    *pBreakX = breakX;
+    *pWrapX = wrapX;
+}
+
+/***************************************************
+// map the pixels [a, b] of one viewport row onto cube map, the segment is
+// split until both ends are on the same face.
+****************************************************/
+void Geometry::sparseMapRowSegment(Geometry *pGeoSrc, int32_t j, int32_t a, SPos& sPosA, int32_t b, SPos& sPosB)
+{
+    if (sPosA.faceIdx == sPosB.faceIdx || b - a <= 1)
+    {
+        updateRange(m_upLeft + sPosA.faceIdx, m_downRight + sPosA.faceIdx, sPosA);
+        updateRange(m_upLeft + sPosB.faceIdx, m_downRight + sPosB.faceIdx, sPosB);
+        return;
+    }
+    int32_t mid = a + ((b - a) >> 1);
+    SPos sPosMid;
+    mapPixel(pGeoSrc, 0, mid, j, &sPosMid);
+    sparseMapRowSegment(pGeoSrc, j, a, sPosA, mid, sPosMid);
+    sparseMapRowSegment(pGeoSrc, j, mid, sPosMid, b, sPosB);
+}
+
 /***************************************************
 //convert source geometry to destination geometry;
 ****************************************************/
@@ -230,6 +487,91 @@ void Geometry::geoConvert(Geometry *pGeoDst)
     return;
 }
 
+static SIMDLevel detectSIMDLevel()
+{
+#ifdef SCVP_X86_SIMD
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f"))
+        return SIMD_AVX512;
+    if (__builtin_cpu_supports("avx2"))
+        return SIMD_AVX2;
+#endif
+    return SIMD_NONE;
+}
+
+SIMDLevel Geometry::getSIMDLevel()
+{
+    static SIMDLevel level = detectSIMDLevel();
+    return level;
+}
+
+// the default batch functions, map the positions one by one
+void Geometry::map2DTo3DBatch(SPosArray& sPosIn, SPosArray& sPosOut, int32_t num)
+{
+    for (int32_t k = 0; k < num; k++)
+    {
+        SPos in(sPosIn.faceIdx[k], sPosIn.x[k], sPosIn.y[k], sPosIn.z[k]), out;
+        map2DTo3D(in, &out);
+        sPosOut.faceIdx[k] = out.faceIdx;
+        sPosOut.x[k] = out.x;
+        sPosOut.y[k] = out.y;
+        sPosOut.z[k] = out.z;
+    }
+}
+
+void Geometry::map3DTo2DBatch(SPosArray& sPosIn, SPosArray& sPosOut, int32_t num)
+{
+    for (int32_t k = 0; k < num; k++)
+    {
+        SPos in(sPosIn.faceIdx[k], sPosIn.x[k], sPosIn.y[k], sPosIn.z[k]), out;
+        map3DTo2D(&in, &out);
+        sPosOut.faceIdx[k] = out.faceIdx;
+        sPosOut.x[k] = out.x;
+        sPosOut.y[k] = out.y;
+        sPosOut.z[k] = out.z;
+    }
+}
+
+void Geometry::rotate3DBatch(SPosArray& sPos, int32_t num, int32_t rx, int32_t ry, int32_t rz)
+{
+    if(rx)
+    {
+        POSType rcos = scos((POSType)(rx*S_PI/180.0));
+        POSType rsin = ssin((POSType)(rx*S_PI/180.0));
+        for (int32_t k = 0; k < num; k++)
+        {
+            POSType t1 = rcos*sPos.y[k] - rsin*sPos.z[k];
+            POSType t2 = rsin*sPos.y[k] + rcos*sPos.z[k];
+            sPos.y[k] = t1;
+            sPos.z[k] = t2;
+        }
+    }
+    if(ry)
+    {
+        POSType rcos = scos((POSType)(ry*S_PI/180.0));
+        POSType rsin = ssin((POSType)(ry*S_PI/180.0));
+        for (int32_t k = 0; k < num; k++)
+        {
+            POSType t1 = rcos*sPos.x[k] + rsin*sPos.z[k];
+            POSType t2 = -rsin*sPos.x[k] + rcos*sPos.z[k];
+            sPos.x[k] = t1;
+            sPos.z[k] = t2;
+        }
+    }
+    if(rz)
+    {
+        POSType rcos = scos((POSType)(rz*S_PI/180.0));
+        POSType rsin = ssin((POSType)(rz*S_PI/180.0));
+        for (int32_t k = 0; k < num; k++)
+        {
+            POSType t1 = rcos*sPos.x[k] - rsin*sPos.y[k];
+            POSType t2 = rsin*sPos.x[k] + rcos*sPos.y[k];
+            sPos.x[k] = t1;
+            sPos.y[k] = t2;
+        }
+    }
+}
+
 void Geometry::rotate3D(SPos& sPos, int32_t rx, int32_t ry, int32_t rz)
 {
     POSType x = sPos.x;
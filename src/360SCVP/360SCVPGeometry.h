@@ -66,6 +66,27 @@ struct SPos
     SPos(int32_t f, POSType xIn, POSType yIn, POSType zIn ) : faceIdx(f), x(xIn), y(yIn), z(zIn) {};
 };
 
+//positions in the structure of arrays layout, used by the batch mapping functions;
+struct SPosArray
+{
+    int32_t *faceIdx;
+    POSType *x;
+    POSType *y;
+    POSType *z;
+};
+
+//the instruction set used by the batch mapping functions, detected at runtime;
+enum SIMDLevel
+{
+    SIMD_NONE = 0,
+    SIMD_AVX2,
+    SIMD_AVX512,
+};
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define SCVP_X86_SIMD 1
+#endif
+
 struct GeometryRotation
 {
     int32_t degree[3];  //[x/y/z];
@@ -99,8 +120,18 @@ protected:
     bool m_bPadded;
     bool m_bGeometryMapping;
     bool m_bConvOutputPaddingNeeded;
+    bool m_bSparseMapping;
     inline int32_t round(POSType t) { return (int32_t)(t+ (t>=0? 0.5 :-0.5)); }; 
     void rotate3D(SPos& sPos, int32_t rx, int32_t ry, int32_t rz);
+    void rotate3DBatch(SPosArray& sPos, int32_t num, int32_t rx, int32_t ry, int32_t rz);
+    void mapPixel(Geometry *pGeoSrc, int32_t faceIdx, int32_t i, int32_t j, SPos *pSPosOut);
+    void mapRow(Geometry *pGeoSrc, int32_t faceIdx, int32_t j, int32_t iStart, int32_t num, SPosArray& sPos2D, SPosArray& sPos3D);
+    bool allocPosArray(SPosArray& sPos, int32_t num);
+    void freePosArray(SPosArray& sPos);
+    void updateRange(SPos *pUpLeft, SPos *pDownRight, SPos& sPos);
+    void sparseGeometryMapping(Geometry *pGeoSrc);
+    void sparseMapERPRow(Geometry *pGeoSrc, int32_t j, int32_t *pBreakX, int32_t *pWrapX);
+    void sparseMapRowSegment(Geometry *pGeoSrc, int32_t j, int32_t a, SPos& sPosA, int32_t b, SPos& sPosB);
 public:
     int32_t m_numFaces;
     SPos* m_upLeft;
@@ -111,12 +142,16 @@ public:
     void geoUnInit(); // just use in the viewport
     GeometryType getType() { return (GeometryType)m_sVideoInfo.geoType; };
     void setPaddingFlag(bool bFlag) { m_bPadded = bFlag; }
+    void setSparseMappingFlag(bool bFlag) { m_bSparseMapping = bFlag; }
     virtual void map2DTo3D(SPos& IPosIn, SPos *pSPosOut) = 0;
     virtual void map3DTo2D(SPos *pSPosIn, SPos *pSPosOut) = 0;
+    virtual void map2DTo3DBatch(SPosArray& sPosIn, SPosArray& sPosOut, int32_t num);
+    virtual void map3DTo2DBatch(SPosArray& sPosIn, SPosArray& sPosOut, int32_t num);
     virtual void geoConvert(Geometry *pGeoDst);
     virtual bool insideFace(int32_t x, int32_t y) { return ( x>=0 && x<(m_sVideoInfo.iFaceWidth) && y>=0 && y<(m_sVideoInfo.iFaceHeight) ); }
     virtual void geometryMapping(Geometry *pGeoSrc);
     static Geometry* create(SVideoInfo& sVideoInfo);
+    static SIMDLevel getSIMDLevel();
  };
 
 #endif // __360SCVP_TGEOMETRY__
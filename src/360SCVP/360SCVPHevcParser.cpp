@@ -26,6 +26,10 @@
 #include "assert.h"
 #include "360SCVPHevcParser.h"
 #include "360SCVPHevcTilestream.h"
+#include "360SCVPNaluScanner.h"
+
+/*unescaped bytes kept on the stack while parsing one NAL unit, enough for parameter sets and slice headers*/
+#define HEVC_RBSP_SCRATCH_SIZE 1024
 
 uint32_t gts_get_bit_size(uint32_t MaxVal)
 {
@@ -36,25 +40,7 @@ uint32_t gts_get_bit_size(uint32_t MaxVal)
 
 uint32_t gts_media_nalu_emulation_bytes_remove_count(const int8_t *buffer, uint32_t size_nal)
 {
-    uint32_t n = 0, emulation_bytes_count = 0;
-    uint8_t zero_counter = 0;
-
-    while (n < size_nal)
-    {
-        if (zero_counter == 2 && buffer[n] == 0x03 && n + 1 < size_nal && buffer[n + 1] < 0x04)
-        {
-            zero_counter = 0;
-            emulation_bytes_count++;
-            n++;
-        }
-        if (!buffer[n])
-            zero_counter++;
-        else
-            zero_counter = 0;
-        n++;
-    }
-
-    return emulation_bytes_count;
+    return gts_nalu_emulation_bytes_count((const uint8_t *)buffer, size_nal);
 }
 
 uint32_t gts_media_nalu_remove_emulation_bytes(const int8_t *src_buffer, int8_t *dst_buffer, uint32_t size_nal)
@@ -82,46 +68,14 @@ uint32_t gts_media_nalu_remove_emulation_bytes(const int8_t *src_buffer, int8_t
 }
 
 
-static uint8_t digits_of_agm[128] = {
-    8, 7, 6, 6, 5, 5, 5, 5,  4, 4, 4, 4, 4, 4, 4, 4,
-    3, 3, 3, 3, 3, 3, 3, 3,  3, 3, 3, 3, 3, 3, 3, 3,
-    2, 2, 2, 2, 2, 2, 2, 2,  2, 2, 2, 2, 2, 2, 2, 2,
-    2, 2, 2, 2, 2, 2, 2, 2,  2, 2, 2, 2, 2, 2, 2, 2,
-    1, 1, 1, 1, 1, 1, 1, 1,  1, 1, 1, 1, 1, 1, 1, 1,
-    1, 1, 1, 1, 1, 1, 1, 1,  1, 1, 1, 1, 1, 1, 1, 1,
-    1, 1, 1, 1, 1, 1, 1, 1,  1, 1, 1, 1, 1, 1, 1, 1,
-    1, 1, 1, 1, 1, 1, 1, 1,  1, 1, 1, 1, 1, 1, 1, 1
-};
-
 static uint32_t bs_get_ue(GTS_BitStream *gts_bitstream)
 {
-    uint8_t flag_c;
-    uint32_t data = 0, flag_r = 0;
-    while (1) {
-        flag_r = gts_bs_peek_bits(gts_bitstream, 8, 0);
-        if (flag_r) break;
-        //check whether we still have data once the peek is done since we may have less than 8 data available
-        if (!gts_bs_available(gts_bitstream)) {
-            //GF_LOG(GF_LOG_ERROR, GF_LOG_CODING, ("[AVC/HEVC] Not enough data in bitstream !!\n"));
-            return 0;
-        }
-        gts_bs_read_int(gts_bitstream, 8);
-        data += 8;
-    }
-    if (flag_r < 128)
-        flag_c = digits_of_agm[flag_r];
-    else
-        flag_c = 0;
-    gts_bs_read_int(gts_bitstream, flag_c);
-    data += flag_c;
-    return gts_bs_read_int(gts_bitstream, data + 1) - 1;
+    return gts_bs_read_ue(gts_bitstream);
 }
 
 static int32_t bs_get_se(GTS_BitStream *bs)
 {
-    uint32_t v = bs_get_ue(bs);
-    if ((v & 0x1) == 0) return (int32_t)(0 - (v >> 1));
-    return (v + 1) >> 1;
+    return gts_bs_read_se(bs);
 }
 
 uint32_t gts_media_nalu_is_start_code(GTS_BitStream *bs)
@@ -613,6 +567,22 @@ static uint32_t gts_media_nalu_locate_start_code_bs(GTS_BitStream *bs, bool loca
     uint64_t start = gts_bs_get_position(bs);
     if (start<3) return 0;
 
+    if (bs->bsmode == GTS_BITSTREAM_READ && !bs->rbsp_src && bs->size - start <= 0xFFFFFFFF)
+    {
+        // the whole buffer is in memory, search it directly
+        const uint8_t *data = (const uint8_t *)bs->original + start;
+        uint32_t size = (uint32_t)(bs->size - start);
+        uint32_t startCode = gts_nalu_find_start_code(data, size);
+        gts_bs_seek(bs, start);
+        if (locate_trailing && startCode == size) {
+            while (nb_cons_zeros < size && !data[size - 1 - nb_cons_zeros])
+                nb_cons_zeros++;
+            if (nb_cons_zeros >= 3)
+                return size - nb_cons_zeros;
+        }
+        return startCode;
+    }
+
     load_size = 0;
     bpos = 0;
     cache_start = 0;
@@ -1666,8 +1636,8 @@ static int32_t gts_media_hevc_read_pps_bs(GTS_BitStream *gts_bitstream, HEVCStat
 int32_t gts_media_hevc_parse_nalu(hevc_specialInfo* pSpecialInfo, int8_t *data, uint32_t size, HEVCState *hevc)
 {
     GTS_BitStream *bs=NULL;
-    int8_t *data_without_emulation_bytes = NULL;
-    uint32_t data_without_emulation_bytes_size = 0;
+    GTS_BitStream rbsp;
+    int8_t rbspScratch[HEVC_RBSP_SCRATCH_SIZE];
     bool is_slice = false;
     int32_t ret = -1;
     HEVCSliceInfo SliceInfo;
@@ -1683,18 +1653,9 @@ int32_t gts_media_hevc_parse_nalu(hevc_specialInfo* pSpecialInfo, int8_t *data,
     hevc->s_info.entry_point_start_bits = -1;
     hevc->s_info.payload_start_offset = -1;
 
-    data_without_emulation_bytes_size = gts_media_nalu_emulation_bytes_remove_count(data, size);
-    if (!data_without_emulation_bytes_size) {
-        bs = gts_bs_new(data, size, GTS_BITSTREAM_READ);
-    } else {
-        /*still contains emulation bytes*/
-        data_without_emulation_bytes = (int8_t*) gts_malloc(size*sizeof(int8_t));
-        if(data_without_emulation_bytes){
-            data_without_emulation_bytes_size = gts_media_nalu_remove_emulation_bytes(data, data_without_emulation_bytes, size);
-        }
-        bs = gts_bs_new(data_without_emulation_bytes, data_without_emulation_bytes_size, GTS_BITSTREAM_READ);
-    }
-    if (!bs) goto exit;
+    /*emulation bytes are removed while reading, only up to where the header parsing stops*/
+    if (gts_bs_init_rbsp(&rbsp, data, size, rbspScratch, HEVC_RBSP_SCRATCH_SIZE) != GTS_OK) goto exit;
+    bs = &rbsp;
 
     if (! hevc_parse_nal_header(bs, nal_unit_type, temporal_id, layer_id, payloadType)) goto exit;
     SliceInfo.nal_unit_type = *nal_unit_type;
@@ -1779,8 +1740,7 @@ int32_t gts_media_hevc_parse_nalu(hevc_specialInfo* pSpecialInfo, int8_t *data,
     memcpy(&hevc->s_info, &SliceInfo, sizeof(HEVCSliceInfo));
 
 exit:
-    if (bs) gts_bs_del(bs);
-    if (data_without_emulation_bytes) gts_free(data_without_emulation_bytes);
+    if (bs) gts_bs_uninit(bs);
     return ret;
 }
 
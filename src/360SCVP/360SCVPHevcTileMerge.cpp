@@ -142,7 +142,81 @@ int32_t modify_slice_header(HEVCState *hevc, hevc_mergeStream *mergeStream, uint
     return 0;
 }
 
-int32_t merge_header(GTS_BitStream *bs, oneStream_info* pSlice, uint8_t **pBitstream, bool isHR, hevc_mergeStream *mergeStream, HEVCState *orgHevc)
+static uint64_t hash_header_nals(const uint8_t *data, uint32_t len)
+{
+    // FNV-1a
+    uint64_t hash = 14695981039346656037ULL;
+    for (uint32_t i = 0; i < len; i++)
+    {
+        hash ^= data[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+// Bring the per frame state of one resolution up to date with its header stream.
+// The full state is copied only when the header NAL units change; otherwise just the
+// parts rewritten by header parsing or modified by the previous frame are refreshed.
+static void refresh_frame_state(one_res *res, HEVCState *hevc, const uint8_t *headers, uint32_t headersLen)
+{
+    HEVCState *state = res->pFrameState;
+    uint64_t hash = hash_header_nals(headers, headersLen);
+    if (!res->bFrameStateValid || hash != res->headerHash)
+    {
+        memcpy(state, hevc, sizeof(HEVCState));
+        res->headerHash = hash;
+        res->bFrameStateValid = true;
+        return;
+    }
+
+    state->full_slice_header_parse = hevc->full_slice_header_parse;
+    state->sps_active_idx = hevc->sps_active_idx;
+    state->last_parsed_vps_id = hevc->last_parsed_vps_id;
+    state->last_parsed_sps_id = hevc->last_parsed_sps_id;
+    state->last_parsed_pps_id = hevc->last_parsed_pps_id;
+    state->first_nal = hevc->first_nal;
+    state->tile_slice_count = hevc->tile_slice_count;
+    memcpy(&state->s_info, &hevc->s_info, sizeof(HEVCSliceInfo));
+    memcpy(&state->sei, &hevc->sei, sizeof(HEVC_SEI));
+    memcpy(&state->sps[0], &hevc->sps[0], sizeof(HEVC_SPS));
+    if (hevc->last_parsed_sps_id > 0 && hevc->last_parsed_sps_id < 16)
+        memcpy(&state->sps[hevc->last_parsed_sps_id], &hevc->sps[hevc->last_parsed_sps_id], sizeof(HEVC_SPS));
+    if (hevc->last_parsed_pps_id >= 0 && hevc->last_parsed_pps_id < 64)
+        memcpy(&state->pps[hevc->last_parsed_pps_id], &hevc->pps[hevc->last_parsed_pps_id], sizeof(HEVC_PPS));
+    if (hevc->last_parsed_vps_id >= 0 && hevc->last_parsed_vps_id < 16)
+        memcpy(&state->vps[hevc->last_parsed_vps_id], &hevc->vps[hevc->last_parsed_vps_id], sizeof(HEVC_VPS));
+}
+
+// append one piece to the scatter-gather output, pieces following each other in memory are joined
+static int32_t add_output_segment(hevc_mergeStream *mergeStream, const uint8_t *pData, uint32_t length)
+{
+    if (!length)
+        return 0;
+    if (mergeStream->segmentsNum)
+    {
+        param_outputSegment *pLast = &mergeStream->pSegments[mergeStream->segmentsNum - 1];
+        if (pLast->pData + pLast->length == pData)
+        {
+            pLast->length += length;
+            return 0;
+        }
+    }
+    if (mergeStream->segmentsNum == mergeStream->segmentsSize)
+    {
+        uint32_t newSize = mergeStream->segmentsSize ? 2 * mergeStream->segmentsSize : 64;
+        param_outputSegment *pSegments = (param_outputSegment *)realloc(mergeStream->pSegments, newSize * sizeof(param_outputSegment));
+        if (!pSegments)
+            return -1;
+        mergeStream->pSegments = pSegments;
+        mergeStream->segmentsSize = newSize;
+    }
+    mergeStream->pSegments[mergeStream->segmentsNum].pData = pData;
+    mergeStream->pSegments[mergeStream->segmentsNum].length = length;
+    mergeStream->segmentsNum++;
+    return 0;
+}
+
+int32_t merge_header(GTS_BitStream *bs, oneStream_info* pSlice, uint8_t **pBitstream, bool isHR, hevc_mergeStream *mergeStream, bool isHeader)
 {
     if (!bs || !pSlice || !pBitstream || !mergeStream)
         return -1;
@@ -170,11 +244,18 @@ int32_t merge_header(GTS_BitStream *bs, oneStream_info* pSlice, uint8_t **pBitst
     framesize = specialLen + nalsize[SLICE_DATA];
     lenSlice -= framesize;
 
+    one_res *res = isHR ? &mergeStream->highRes : &mergeStream->lowRes;
+    if (!isHeader && (nalsize[SEQ_PARAM_SET] || nalsize[PIC_PARAM_SET] || nalsize[VID_PARAM_SET]))
+    {
+        // tile stream carrying parameter sets changed the shared state, rebuild it next frame
+        res->bFrameStateValid = false;
+    }
+
     if (nalsize[SEQ_PARAM_SET])
     {
-        if (orgHevc)
+        if (isHeader && res->pFrameState)
         {
-            memcpy(orgHevc, hevc, sizeof(HEVCState));
+            refresh_frame_state(res, hevc, pBufferSliceCur, specialLen - nalsize[SLICE_HEADER]);
         }
 
         // Choose LR header if HR and LR exist
@@ -192,6 +273,19 @@ int32_t merge_header(GTS_BitStream *bs, oneStream_info* pSlice, uint8_t **pBitst
         hevc_write_slice_header(bs, hevc);
     }
 
+    if (mergeStream->bScatterOutput)
+    {
+        // headers stay packed in the output bitstream, slice data is referenced where it is
+        if (add_output_segment(mergeStream, pBitstreamCur, (uint32_t)(bs->position - bs_position))
+            || add_output_segment(mergeStream, pBufferSliceCur + specialLen, nalsize[SLICE_DATA]))
+            return -1;
+        pBitstreamCur += bs->position - bs_position;
+        pSlice->outputBufferLen += (uint32_t)(bs->position - bs_position) + nalsize[SLICE_DATA];
+        pBufferSliceCur += specialLen + nalsize[SLICE_DATA];
+        *pBitstream = pBitstreamCur;
+        return 0;
+    }
+
     //move to current address
     pBitstreamCur += bs->position - bs_position;
     pSlice->outputBufferLen += (uint32_t)(bs->position - bs_position);
@@ -412,6 +506,15 @@ void* tile_merge_Init(param_mergeStream *mergeStreamParams)
     {
         init_one_bitstream(&mergeStream->lowRes.pTiledBitstreams[i]);
     }
+    mergeStream->highRes.pFrameState = (HEVCState*)malloc(sizeof(HEVCState));
+    mergeStream->lowRes.pFrameState = (HEVCState*)malloc(sizeof(HEVCState));
+    if (!mergeStream->highRes.pFrameState || !mergeStream->lowRes.pFrameState)
+    {
+        tile_merge_Close(mergeStream);
+        return NULL;
+    }
+    memset(mergeStream->highRes.pFrameState, 0, sizeof(HEVCState));
+    memset(mergeStream->lowRes.pFrameState, 0, sizeof(HEVCState));
     return mergeStream;
 }
 
@@ -426,6 +529,17 @@ int32_t tile_merge_Close(void* handle)
     destory_one_bitstream(&mergeStream->highRes.pHeader);
     destory_one_bitstream(&mergeStream->lowRes.pHeader);
 
+    if (mergeStream->highRes.pFrameState)
+    {
+        free(mergeStream->highRes.pFrameState);
+        mergeStream->highRes.pFrameState = NULL;
+    }
+    if (mergeStream->lowRes.pFrameState)
+    {
+        free(mergeStream->lowRes.pFrameState);
+        mergeStream->lowRes.pFrameState = NULL;
+    }
+
     for(int32_t i = 0 ; i < HR_ntile ; i++)
     {
         destory_one_bitstream(&mergeStream->highRes.pTiledBitstreams[i]);
@@ -441,6 +555,12 @@ int32_t tile_merge_Close(void* handle)
         mergeStream->slice_segment_address = NULL;
     }
 
+    if(mergeStream->pSegments)
+    {
+        free(mergeStream->pSegments);
+        mergeStream->pSegments = NULL;
+    }
+
     if(mergeStream->highRes.pTiledBitstreams)
     {
         free(mergeStream->highRes.pTiledBitstreams);
@@ -513,43 +633,53 @@ int32_t tile_merge_Process(param_mergeStream *mergeStreamParams, void* handle)
     }
 
     mergeStream->pOutputBitstream = mergeStreamParams->pOutputBitstream;
+    mergeStream->bScatterOutput = mergeStreamParams->bScatterOutput;
+    mergeStream->segmentsNum = 0;
 
     // Get tiles merge solution
     int32_t err = get_merge_solution(mergeStream);
     if(err)
         return err;
 
-    // Merge
-    GTS_BitStream *bs = gts_bs_new((const int8_t *)mergeStream->pOutputBitstream, 2*mergeStream->inputBistreamsLen, GTS_BITSTREAM_WRITE);
+    // Merge, the output bitstream object and the per frame states are owned by the handle
+    GTS_BitStream *bs = &mergeStream->outputBs;
+    if (gts_bs_init(bs, (const int8_t *)mergeStream->pOutputBitstream, 2*mergeStream->inputBistreamsLen, GTS_BITSTREAM_WRITE) != GTS_OK)
+        return -1;
     uint8_t *pOutBitstream = mergeStream->pOutputBitstream;
 
-    HEVCState *HRhevcSlice = (HEVCState*)malloc(sizeof(HEVCState));
-    HEVCState *LRhevcSlice = (HEVCState*)malloc(sizeof(HEVCState));
+    HEVCState *HRhevcSlice = mergeStream->highRes.pFrameState;
+    HEVCState *LRhevcSlice = mergeStream->lowRes.pFrameState;
     HEVCState *tmpHevcSlice = NULL;
 
+    int32_t mergeErr = 0;
     if(HR_ntile)
     {
-        merge_header(bs, mergeStream->highRes.pHeader, &pOutBitstream, 1, mergeStream, HRhevcSlice);
+        mergeErr |= merge_header(bs, mergeStream->highRes.pHeader, &pOutBitstream, 1, mergeStream, true);
     }
     if(LR_ntile)
     {
-        merge_header(bs, mergeStream->lowRes.pHeader, &pOutBitstream, 0, mergeStream, LRhevcSlice);
+        mergeErr |= merge_header(bs, mergeStream->lowRes.pHeader, &pOutBitstream, 0, mergeStream, true);
     }
     // Just merge one frame
     for(int32_t i = 0 ; i < HR_ntile; i++)
     {
         tmpHevcSlice = mergeStream->highRes.pTiledBitstreams[i]->hevcSlice;
         mergeStream->highRes.pTiledBitstreams[i]->hevcSlice = HRhevcSlice;
-        merge_header(bs, mergeStream->highRes.pTiledBitstreams[i], &pOutBitstream, 1, mergeStream,NULL);
+        mergeErr |= merge_header(bs, mergeStream->highRes.pTiledBitstreams[i], &pOutBitstream, 1, mergeStream, false);
         mergeStream->highRes.pTiledBitstreams[i]->hevcSlice = tmpHevcSlice;
     }
     for(int32_t i = 0 ; i < LR_ntile; i++)
     {
         tmpHevcSlice = mergeStream->lowRes.pTiledBitstreams[i]->hevcSlice;
         mergeStream->lowRes.pTiledBitstreams[i]->hevcSlice = LRhevcSlice;
-        merge_header(bs, mergeStream->lowRes.pTiledBitstreams[i], &pOutBitstream, 0, mergeStream,NULL);
+        mergeErr |= merge_header(bs, mergeStream->lowRes.pTiledBitstreams[i], &pOutBitstream, 0, mergeStream, false);
         mergeStream->lowRes.pTiledBitstreams[i]->hevcSlice = tmpHevcSlice;
     }
+    if (mergeErr)
+    {
+        gts_bs_uninit(bs);
+        return -1;
+    }
 
     // Calculate output length
     int32_t outputBufferLen = 0;
@@ -571,19 +701,10 @@ int32_t tile_merge_Process(param_mergeStream *mergeStreamParams, void* handle)
     }
     mergeStream->outputiledbistreamlen = outputBufferLen;
     mergeStreamParams->outputiledbistreamlen = mergeStream->outputiledbistreamlen;
+    mergeStreamParams->pOutputSegments = mergeStream->bScatterOutput ? mergeStream->pSegments : NULL;
+    mergeStreamParams->outputSegmentsNum = mergeStream->bScatterOutput ? mergeStream->segmentsNum : 0;
 
-    if (bs) gts_bs_del(bs);
-
-    if(HRhevcSlice)
-    {
-        free(HRhevcSlice);
-        HRhevcSlice = NULL;
-    }
-    if(LRhevcSlice)
-    {
-        free(LRhevcSlice);
-        LRhevcSlice = NULL;
-    }
+    gts_bs_uninit(bs);
     return 0;
 }
 
@@ -598,6 +719,8 @@ int32_t tile_merge_reset(void* handle)
     if (0 == HR_ntile && 0 == LR_ntile)
         return -1;
 
+    // frame states are kept, since the reset is done for every frame and
+    // changed headers are found by their hash
     mergeStream->bWroteHeader = 0;
 
     mergeStream->inputBistreamsLen = 0;
@@ -41,6 +41,9 @@ typedef struct ONE_RES
     int32_t                num_tile_columns;
     int32_t                num_tile_rows;
     bool                   bOrdered;
+    HEVCState             *pFrameState;       // state shared by the tiles of one frame, kept across frames
+    uint64_t               headerHash;        // hash of the header NAL units pFrameState was built from
+    bool                   bFrameStateValid;
 }one_res;
 
 typedef struct HEVC_MERGEBITSTREAM
@@ -55,6 +58,11 @@ typedef struct HEVC_MERGEBITSTREAM
     int32_t        pic_height;
     int32_t       *slice_segment_address;
     bool           bWroteHeader;
+    GTS_BitStream  outputBs;
+    bool           bScatterOutput;
+    param_outputSegment *pSegments;       // scatter-gather output of the current frame
+    uint32_t       segmentsNum;
+    uint32_t       segmentsSize;
 }hevc_mergeStream;
 
 //modify resolution and tile segmentation
@@ -62,7 +70,7 @@ int32_t modify_parameter_sets(HEVCState *hevc, hevc_mergeStream *mergeStream);
 int32_t init_one_bitstream(oneStream_info **pBs);
 int32_t destory_one_bitstream(oneStream_info **pBs);
 int32_t modify_slice_header(HEVCState *hevc, hevc_mergeStream *mergeStream, uint32_t tile_index);
-int32_t merge_header(GTS_BitStream *bs, oneStream_info* pSlice, uint8_t **pBitstream, bool isHR, hevc_mergeStream *mergeStream, HEVCState *orgHevc);
+int32_t merge_header(GTS_BitStream *bs, oneStream_info* pSlice, uint8_t **pBitstream, bool isHR, hevc_mergeStream *mergeStream, bool isHeader);
 // Put all LR tiles at the right of HR tiles
 int32_t get_merge_solution(hevc_mergeStream *mergeStream);
 
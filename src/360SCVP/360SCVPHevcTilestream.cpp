@@ -30,6 +30,7 @@
 #include "360SCVPHevcParser.h"
 #include "360SCVPHevcEncHdr.h"
 #include "360SCVPTiledstreamAPI.h"
+#include "360SCVPNaluScanner.h"
 
 int32_t hevc_import_ffextradata(hevc_specialInfo* pSpecialInfo, HEVCState* hevc, uint32_t *pSize, int32_t *spsCnt, int32_t bParse)
 {
@@ -187,22 +188,13 @@ int32_t  parse_hevc_specialinfo(hevc_specialInfo* pSpecialInfo, HEVCState* hevc,
     int32_t calnalbits = 0;
 
     //remove the useless byte in the input bitstream
-    uint8_t *ptr = pSpecialInfo->ptr;
     uint32_t ptr_size = pSpecialInfo->ptr_size;
-    int32_t  byteCnt = 0;
-    while (ptr_size > 0)
-    {
-        if ((*ptr == 0 && *(ptr + 1) == 0 && *(ptr + 2) == 0 && *(ptr + 3) == 1)
-            || (*ptr == 0 && *(ptr + 1) == 0 && *(ptr + 2) == 1))
-            break;
-        ptr++;
-        ptr_size--;
-        byteCnt++;
-    }
+    uint32_t byteCnt = gts_nalu_find_start_code(pSpecialInfo->ptr, ptr_size);
+    ptr_size -= byteCnt;
 
     if (byteCnt > 0)
     {
-        memcpy(pSpecialInfo->ptr, pSpecialInfo->ptr + byteCnt, ptr_size);
+        memmove(pSpecialInfo->ptr, pSpecialInfo->ptr + byteCnt, ptr_size);
         pSpecialInfo->ptr_size = ptr_size;
     }
     int32_t nalCnt = hevc_import_ffextradata(pSpecialInfo, hevc, nalsize, spsCnt, bParse);
@@ -94,6 +94,10 @@ TstitchStream::TstitchStream()
     m_xTopLeftNet = 0;
     m_yTopLeftNet = 0;
     m_dstRwpk = RegionWisePacking();
+    m_pSliceCopier = NULL;
+    m_pCopyJobs = NULL;
+    m_copyJobsNum = 0;
+    m_copyJobsSize = 0;
 }
 
 TstitchStream::TstitchStream(TstitchStream& other)
@@ -168,6 +172,10 @@ TstitchStream::TstitchStream(TstitchStream& other)
     m_yTopLeftNet = other.m_yTopLeftNet;
     m_dstRwpk = RegionWisePacking();
     m_dstRwpk = other.m_dstRwpk;
+    m_pSliceCopier = NULL;
+    m_pCopyJobs = NULL;
+    m_copyJobsNum = 0;
+    m_copyJobsSize = 0;
 }
 
 TstitchStream::~TstitchStream()
@@ -204,6 +212,14 @@ TstitchStream::~TstitchStream()
         delete []m_specialInfo[1];
         m_specialInfo[1] = nullptr;
     }
+    if (m_pSliceCopier) {
+        delete m_pSliceCopier;
+        m_pSliceCopier = nullptr;
+    }
+    if (m_pCopyJobs) {
+        free(m_pCopyJobs);
+        m_pCopyJobs = nullptr;
+    }
 }
 
 int32_t TstitchStream::initViewport(Param_ViewPortInfo* pViewPortInfo, int32_t tilecolCount, int32_t tilerowCount)
@@ -338,6 +354,17 @@ int32_t TstitchStream::init(param_360SCVP* pParamStitchStream)
         m_pSteamStitch = genTiledStream_Init(&m_streamStitch);
         if (!m_pSteamStitch)
             return -1;
+        if (pParamStitchStream->paramStitchInfo.copyThreadNum > 1)
+        {
+            m_pSliceCopier = new TsliceCopier;
+            if (!m_pSliceCopier || m_pSliceCopier->init(pParamStitchStream->paramStitchInfo.copyThreadNum))
+            {
+                printf("failed to start the slice copy threads, copy serially!\n");
+                if (m_pSliceCopier)
+                    delete m_pSliceCopier;
+                m_pSliceCopier = NULL;
+            }
+        }
         return ret;
     }
     if (parseNals(pParamStitchStream, pParamStitchStream->usedType, NULL, 0) < 0)
@@ -652,6 +679,7 @@ int32_t TstitchStream::doMerge(param_360SCVP* pParamStitchStream)
     int32_t ret = 0;
     if (pParamStitchStream == NULL)
         return -1;
+    m_mergeStreamParam.bScatterOutput = pParamStitchStream->bScatterOutput;
     ret = tile_merge_Process(&m_mergeStreamParam, m_pMergeStream);
     if (ret < 0)
         return -1;
@@ -679,7 +707,10 @@ int32_t TstitchStream::doMerge(param_360SCVP* pParamStitchStream)
         ret = EncRWPKSEI(&m_dstRwpk, pParamStitchStream->pOutputSEI, &pParamStitchStream->outputSEILen);
 
     pParamStitchStream->outputBitstreamLen = m_mergeStreamParam.outputiledbistreamlen;
-    memcpy(pParamStitchStream->pOutputBitstream, m_mergeStreamParam.pOutputBitstream, m_mergeStreamParam.outputiledbistreamlen);
+    pParamStitchStream->pOutputSegments = m_mergeStreamParam.pOutputSegments;
+    pParamStitchStream->outputSegmentsNum = m_mergeStreamParam.outputSegmentsNum;
+    if (!m_mergeStreamParam.bScatterOutput && pParamStitchStream->pOutputBitstream != m_mergeStreamParam.pOutputBitstream)
+        memcpy(pParamStitchStream->pOutputBitstream, m_mergeStreamParam.pOutputBitstream, m_mergeStreamParam.outputiledbistreamlen);
 
     return ret;
 }
@@ -977,8 +1008,9 @@ int32_t TstitchStream::merge_one_tile(uint8_t **pBitstream, oneStream_info* pSli
     pBitstreamCur += bs->position - bs_position;
     bs_position = bs->position;
 
-    //copy slice data
-    memcpy(pBitstreamCur, pBufferSliceCur + specialLen, nalsize[SLICE_DATA]);
+    //reserve the slice data, copied once all slice headers are written
+    if (addCopyJob(pBitstreamCur, pBufferSliceCur + specialLen, nalsize[SLICE_DATA]))
+        return GTS_OUT_OF_MEM;
     pBitstreamCur += nalsize[SLICE_DATA];
     bs->position += nalsize[SLICE_DATA];
     pBufferSliceCur += specialLen + nalsize[SLICE_DATA];
@@ -989,6 +1021,34 @@ int32_t TstitchStream::merge_one_tile(uint8_t **pBitstream, oneStream_info* pSli
     return framesize;
 }
 
+// split in pieces so that a few large tiles still spread over the copy threads
+#define SLICE_COPY_JOB_MAX_SIZE (256 * 1024)
+
+int32_t TstitchStream::addCopyJob(uint8_t *pDst, const uint8_t *pSrc, uint32_t size)
+{
+    while (size)
+    {
+        uint32_t jobSize = size > SLICE_COPY_JOB_MAX_SIZE ? SLICE_COPY_JOB_MAX_SIZE : size;
+        if (m_copyJobsNum == m_copyJobsSize)
+        {
+            uint32_t newSize = m_copyJobsSize ? 2 * m_copyJobsSize : 64;
+            SliceCopyJob *pJobs = (SliceCopyJob*)realloc(m_pCopyJobs, newSize * sizeof(SliceCopyJob));
+            if (!pJobs)
+                return -1;
+            m_pCopyJobs = pJobs;
+            m_copyJobsSize = newSize;
+        }
+        m_pCopyJobs[m_copyJobsNum].pDst = pDst;
+        m_pCopyJobs[m_copyJobsNum].pSrc = pSrc;
+        m_pCopyJobs[m_copyJobsNum].size = jobSize;
+        m_copyJobsNum++;
+        pDst += jobSize;
+        pSrc += jobSize;
+        size -= jobSize;
+    }
+    return 0;
+}
+
 int32_t TstitchStream::merge_partstream_into1bitstream(int32_t totalInputLen)
 {
     hevc_gen_tiledstream* pGenTilesStream = (hevc_gen_tiledstream*)m_pSteamStitch;
@@ -1013,6 +1073,9 @@ int32_t TstitchStream::merge_partstream_into1bitstream(int32_t totalInputLen)
 
     parse_tiles_info(pGenTilesStream);
 
+    // first pass: parse and rewrite every slice header in order, which gives the
+    // output offset of each slice data; second pass: copy all slice data
+    m_copyJobsNum = 0;
     for (int32_t i = 0; i < pGenTilesStream->outTilesHeightCount; i++)
     {
         for (int32_t j = 0; j < pGenTilesStream->outTilesWidthCount; j++)
@@ -1037,11 +1100,28 @@ int32_t TstitchStream::merge_partstream_into1bitstream(int32_t totalInputLen)
             if (bs) bspos = bs->position;
             bool bFirstTile = (bool)((i == 0 && j == 0) == 1 ? 1 : 0);
             int32_t curframesize = merge_one_tile(&pBitstreamCur, pSliceCur, bs, bFirstTile);
+            if (curframesize < 0)
+            {
+                m_copyJobsNum = 0;
+                if (bs) gts_bs_del(bs);
+                return curframesize;
+            }
             pSliceCur->curBufferLen += curframesize;
             pSliceCur->outputBufferLen += (uint32_t)(bs->position - bspos);
         }
     }
 
+    if (m_pSliceCopier)
+    {
+        m_pSliceCopier->copy(m_pCopyJobs, m_copyJobsNum);
+    }
+    else
+    {
+        for (uint32_t i = 0; i < m_copyJobsNum; i++)
+            memcpy(m_pCopyJobs[i].pDst, m_pCopyJobs[i].pSrc, m_pCopyJobs[i].size);
+    }
+    m_copyJobsNum = 0;
+
     if (bs) gts_bs_del(bs);
     return 0;
 }
@@ -1344,15 +1424,13 @@ int32_t  TstitchStream::GenerateSPS(param_360SCVP* pParamStitchStream)
 int32_t  TstitchStream::GenerateSliceHdr(param_360SCVP* pParam360SCVP, int32_t newSliceAddr)
 {
     int32_t ret = -1;
-    GTS_BitStream *bsWrite = NULL;
+    GTS_BitStream bsWrite;
     HEVCState hevcTmp;
     if (!pParam360SCVP)
         return -1;
 
-    // new bs
-    bsWrite = gts_bs_new((const int8_t *)pParam360SCVP->pOutputBitstream, 2 * pParam360SCVP->inputBitstreamLen, GTS_BITSTREAM_WRITE);
-
-    if (bsWrite)
+    // write straight into the output buffer, no bitstream object allocation per slice header
+    if (gts_bs_init(&bsWrite, (const int8_t *)pParam360SCVP->pOutputBitstream, 2 * pParam360SCVP->inputBitstreamLen, GTS_BITSTREAM_WRITE) == GTS_OK)
     {
         // parse the old slice header
         uint32_t nalsize[20];
@@ -1364,13 +1442,7 @@ int32_t  TstitchStream::GenerateSliceHdr(param_360SCVP* pParam360SCVP, int32_t n
         memset(nalsize, 0, sizeof(nalsize));
         ret = hevc_import_ffextradata(&specialInfo, m_hevcState, nalsize, &spsCnt, 0);
         if (ret < 0)
-        {
-            if(bsWrite)
-            {
-                gts_bs_del(bsWrite);
-            }
             return ret;
-        }
         // modify the sliceheader
         memcpy(&hevcTmp, m_hevcState, sizeof(HEVCState));
 
@@ -1387,9 +1459,8 @@ int32_t  TstitchStream::GenerateSliceHdr(param_360SCVP* pParam360SCVP, int32_t n
         si->slice_segment_address = newSliceAddr;
 
         // write the new sliceheader
-        hevc_write_slice_header(bsWrite, &hevcTmp);
-        pParam360SCVP->outputBitstreamLen = gts_bs_get_position(bsWrite);
-        gts_bs_del(bsWrite);
+        hevc_write_slice_header(&bsWrite, &hevcTmp);
+        pParam360SCVP->outputBitstreamLen = gts_bs_get_position(&bsWrite);
         ret = 0;
     }
 
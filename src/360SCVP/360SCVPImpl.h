@@ -26,6 +26,7 @@
 #ifndef _360SCVP_IMPL_H_
 #define _360SCVP_IMPL_H_
 #include "360SCVPHevcTilestream.h"
+#include "360SCVPSliceCopier.h"
 
 class TstitchStream
 {
@@ -75,6 +76,10 @@ protected:
     int32_t         m_hrTilesInRow;
     int32_t         m_hrTilesInCol;
     RegionWisePacking m_dstRwpk;
+    TsliceCopier   *m_pSliceCopier;   //workers copying slice data when stitching, NULL copies serially
+    SliceCopyJob   *m_pCopyJobs;      //slice data copies of the frame being stitched
+    uint32_t        m_copyJobsNum;
+    uint32_t        m_copyJobsSize;
 
 public:
     uint16_t        m_nalType;
@@ -127,6 +132,7 @@ protected:
     int32_t initMerge(param_360SCVP* pParamStitchStream, int32_t sliceSize);
     int32_t initViewport(Param_ViewPortInfo* pViewPortInfo, int32_t tilecolCount, int32_t tilerowCount);
     int32_t merge_partstream_into1bitstream(int32_t totalInputLen);
+    int32_t addCopyJob(uint8_t *pDst, const uint8_t *pSrc, uint32_t size);
 };// END CLASS DEFINITION
 
 #endif // _360SCVP_IMPL_H_
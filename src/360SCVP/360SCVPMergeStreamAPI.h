@@ -57,6 +57,9 @@ typedef struct PARAM_MERGEBITSTREAM
     uint8_t               *pOutputBitstream;       //!< pointer to output bitstream
     uint32_t               outputiledbistreamlen;  //!< length of output bitstream
     bool                   bWroteHeader;           //!< flag for whether Headers need to be wrote
+    bool                   bScatterOutput;         //!< flag for whether slice data is referenced instead of copied to output bitstream
+    param_outputSegment   *pOutputSegments;        //!< pieces of the merged stream in order when bScatterOutput is set
+    uint32_t               outputSegmentsNum;      //!< number of pieces in pOutputSegments
 }param_mergeStream;
 
 //!
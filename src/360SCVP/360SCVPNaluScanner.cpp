@@ -0,0 +1,195 @@
+/*
+ * Copyright (c) 2020, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "360SCVPNaluScanner.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define SCVP_NALU_SCAN_SIMD 1
+#include <immintrin.h>
+#endif
+
+// every start code (00 00 01) and emulation prevention byte (00 00 03) follows two zero
+// bytes, so the scanners only look for zero pairs and check the third byte afterwards.
+// they return the first p in [from, size - 1) with data[p] == data[p + 1] == 0, else size
+typedef uint32_t (*FindZeroPairFunc)(const uint8_t *data, uint32_t from, uint32_t size);
+
+static uint32_t find_zero_pair_c(const uint8_t *data, uint32_t from, uint32_t size)
+{
+    for (uint32_t p = from; p + 1 < size; p++)
+    {
+        if (!data[p] && !data[p + 1])
+            return p;
+    }
+    return size;
+}
+
+#ifdef SCVP_NALU_SCAN_SIMD
+__attribute__((target("sse2")))
+static uint32_t find_zero_pair_sse2(const uint8_t *data, uint32_t from, uint32_t size)
+{
+    const __m128i zero = _mm_setzero_si128();
+    uint32_t p = from;
+    for (; p + 17 <= size; p += 16)
+    {
+        __m128i z0 = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(data + p)), zero);
+        __m128i z1 = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(data + p + 1)), zero);
+        uint32_t mask = (uint32_t)_mm_movemask_epi8(_mm_and_si128(z0, z1));
+        if (mask)
+            return p + __builtin_ctz(mask);
+    }
+    return find_zero_pair_c(data, p, size);
+}
+
+__attribute__((target("avx2")))
+static uint32_t find_zero_pair_avx2(const uint8_t *data, uint32_t from, uint32_t size)
+{
+    const __m256i zero = _mm256_setzero_si256();
+    uint32_t p = from;
+    for (; p + 33 <= size; p += 32)
+    {
+        __m256i z0 = _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*)(data + p)), zero);
+        __m256i z1 = _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*)(data + p + 1)), zero);
+        uint32_t mask = (uint32_t)_mm256_movemask_epi8(_mm256_and_si256(z0, z1));
+        if (mask)
+            return p + __builtin_ctz(mask);
+    }
+    return find_zero_pair_sse2(data, p, size);
+}
+#endif
+
+static FindZeroPairFunc detect_find_zero_pair()
+{
+#ifdef SCVP_NALU_SCAN_SIMD
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+        return find_zero_pair_avx2;
+    if (__builtin_cpu_supports("sse2"))
+        return find_zero_pair_sse2;
+#endif
+    return find_zero_pair_c;
+}
+
+static inline uint32_t find_zero_pair(const uint8_t *data, uint32_t from, uint32_t size)
+{
+    static FindZeroPairFunc findZeroPair = detect_find_zero_pair();
+    return findZeroPair(data, from, size);
+}
+
+// the zero pair at p is followed by an emulation prevention byte: the pair is exactly two
+// zeros long, and the 03 is followed by a byte below 04 inside the buffer
+static inline bool is_emulation_byte(const uint8_t *data, uint32_t p, uint32_t size)
+{
+    return p + 3 < size && data[p + 2] == 0x03 && (int8_t)data[p + 3] < 0x04
+        && (p == 0 || data[p - 1]);
+}
+
+uint32_t gts_nalu_find_start_code(const uint8_t *data, uint32_t size)
+{
+    if (!data)
+        return size;
+    uint32_t p = 0;
+    while ((p = find_zero_pair(data, p, size)) < size)
+    {
+        if (p + 2 < size && data[p + 2] == 0x01)
+            return (p > 0 && !data[p - 1]) ? p - 1 : p;
+        p++;
+    }
+    return size;
+}
+
+uint32_t gts_nalu_emulation_bytes_count(const uint8_t *data, uint32_t size)
+{
+    if (!data)
+        return 0;
+    uint32_t count = 0;
+    uint32_t p = 0;
+    while ((p = find_zero_pair(data, p, size)) < size)
+    {
+        if (is_emulation_byte(data, p, size))
+        {
+            count++;
+            p += 3;
+        }
+        else
+        {
+            p++;
+        }
+    }
+    return count;
+}
+
+uint32_t gts_nalu_scan(const uint8_t *data, uint32_t size, param_nalIndex *pNals, uint32_t maxNals)
+{
+    if (!data)
+        return 0;
+    uint32_t nalsNum = 0;
+    uint32_t naluStart = 0;
+    uint32_t emulationBytes = 0;
+    uint32_t lastEmulationPos = 0;
+    uint32_t p = 0;
+    while ((p = find_zero_pair(data, p, size)) < size)
+    {
+        if (p + 2 < size && data[p + 2] == 0x01)
+        {
+            uint32_t startCode = (p > 0 && !data[p - 1]) ? p - 1 : p;
+            if (nalsNum)
+            {
+                // a trailing 00 00 03 is only an emulation prevention byte if something follows it in the NAL unit
+                if (emulationBytes && lastEmulationPos + 1 == startCode)
+                    emulationBytes--;
+                if (nalsNum <= maxNals && pNals)
+                {
+                    pNals[nalsNum - 1].naluSize = startCode - naluStart;
+                    pNals[nalsNum - 1].emulationBytesNum = emulationBytes;
+                }
+            }
+            if (nalsNum < maxNals && pNals)
+            {
+                pNals[nalsNum].startCodeOffset = startCode;
+                pNals[nalsNum].startCodeSize = p + 3 - startCode;
+            }
+            nalsNum++;
+            naluStart = startCode;
+            emulationBytes = 0;
+            p += 3;
+        }
+        else if (nalsNum && is_emulation_byte(data, p, size))
+        {
+            emulationBytes++;
+            lastEmulationPos = p + 2;
+            p += 3;
+        }
+        else
+        {
+            p++;
+        }
+    }
+    if (nalsNum && nalsNum <= maxNals && pNals)
+    {
+        pNals[nalsNum - 1].naluSize = size - naluStart;
+        pNals[nalsNum - 1].emulationBytesNum = emulationBytes;
+    }
+    return nalsNum;
+}
@@ -0,0 +1,66 @@
+/*
+ * Copyright (c) 2020, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef _360SCVP_NALUSCANNER_H_
+#define _360SCVP_NALUSCANNER_H_
+
+#include "stdint.h"
+#include "360SCVPAPI.h"
+
+//!
+//! \brief  find the first start code of the buffer
+//!
+//! \param  data, input, the buffer
+//! \param  size, input, the buffer length
+//!
+//! \return uint32_t, the offset of the start code, which begins one byte earlier for
+//!         a four bytes start code, or size if the buffer has no start code
+//!
+uint32_t gts_nalu_find_start_code(const uint8_t *data, uint32_t size);
+
+//!
+//! \brief  count the emulation prevention bytes of one NAL unit, with the same rules
+//!         as gts_media_nalu_remove_emulation_bytes
+//!
+//! \param  data, input, the NAL unit
+//! \param  size, input, the NAL unit length
+//!
+//! \return uint32_t, the number of emulation prevention bytes
+//!
+uint32_t gts_nalu_emulation_bytes_count(const uint8_t *data, uint32_t size);
+
+//!
+//! \brief  find the start codes and the emulation prevention bytes of the buffer in one pass
+//!
+//! \param  data,    input,  the buffer
+//! \param  size,    input,  the buffer length
+//! \param  pNals,   output, the NAL units in order, can be NULL
+//! \param  maxNals, input,  the number of entries in pNals
+//!
+//! \return uint32_t, the number of NAL units in the buffer, only the first maxNals are filled
+//!
+uint32_t gts_nalu_scan(const uint8_t *data, uint32_t size, param_nalIndex *pNals, uint32_t maxNals);
+
+#endif // _360SCVP_NALUSCANNER_H_
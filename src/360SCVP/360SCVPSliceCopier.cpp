@@ -0,0 +1,137 @@
+/*
+ * Copyright (c) 2020, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "string.h"
+#include "360SCVPSliceCopier.h"
+
+TsliceCopier::TsliceCopier()
+{
+    m_pThreads = NULL;
+    m_threadNum = 0;
+    m_pJobs = NULL;
+    m_jobsNum = 0;
+    m_nextJob = 0;
+    m_generation = 0;
+    m_busyWorkers = 0;
+    m_bExit = false;
+    pthread_mutex_init(&m_mutex, NULL);
+    pthread_cond_init(&m_startCond, NULL);
+    pthread_cond_init(&m_doneCond, NULL);
+}
+
+TsliceCopier::~TsliceCopier()
+{
+    pthread_mutex_lock(&m_mutex);
+    m_bExit = true;
+    pthread_cond_broadcast(&m_startCond);
+    pthread_mutex_unlock(&m_mutex);
+    for (uint32_t i = 0; i < m_threadNum; i++)
+    {
+        pthread_join(m_pThreads[i], NULL);
+    }
+    if (m_pThreads)
+    {
+        delete []m_pThreads;
+        m_pThreads = NULL;
+    }
+    pthread_cond_destroy(&m_doneCond);
+    pthread_cond_destroy(&m_startCond);
+    pthread_mutex_destroy(&m_mutex);
+}
+
+int32_t TsliceCopier::init(uint32_t threadNum)
+{
+    if (m_pThreads || threadNum < 2)
+        return -1;
+
+    m_pThreads = new pthread_t[threadNum - 1];
+    if (!m_pThreads)
+        return -1;
+    for (uint32_t i = 0; i < threadNum - 1; i++)
+    {
+        if (pthread_create(&m_pThreads[i], NULL, workerThread, this))
+            return -1;
+        m_threadNum++;
+    }
+    return 0;
+}
+
+void* TsliceCopier::workerThread(void *pCopier)
+{
+    TsliceCopier *copier = (TsliceCopier*)pCopier;
+    uint32_t generation = 0;
+
+    pthread_mutex_lock(&copier->m_mutex);
+    while (1)
+    {
+        while (!copier->m_bExit && generation == copier->m_generation)
+            pthread_cond_wait(&copier->m_startCond, &copier->m_mutex);
+        if (copier->m_bExit)
+            break;
+        generation = copier->m_generation;
+        pthread_mutex_unlock(&copier->m_mutex);
+
+        copier->runJobs();
+
+        pthread_mutex_lock(&copier->m_mutex);
+        if (--copier->m_busyWorkers == 0)
+            pthread_cond_signal(&copier->m_doneCond);
+    }
+    pthread_mutex_unlock(&copier->m_mutex);
+    return NULL;
+}
+
+void TsliceCopier::runJobs()
+{
+    uint32_t idx;
+    while ((idx = __sync_fetch_and_add(&m_nextJob, 1)) < m_jobsNum)
+    {
+        memcpy(m_pJobs[idx].pDst, m_pJobs[idx].pSrc, m_pJobs[idx].size);
+    }
+}
+
+void TsliceCopier::copy(SliceCopyJob *pJobs, uint32_t jobsNum)
+{
+    if (!pJobs || !jobsNum)
+        return;
+
+    pthread_mutex_lock(&m_mutex);
+    m_pJobs = pJobs;
+    m_jobsNum = jobsNum;
+    m_nextJob = 0;
+    m_busyWorkers = m_threadNum;
+    m_generation++;
+    pthread_cond_broadcast(&m_startCond);
+    pthread_mutex_unlock(&m_mutex);
+
+    runJobs();
+
+    pthread_mutex_lock(&m_mutex);
+    while (m_busyWorkers)
+        pthread_cond_wait(&m_doneCond, &m_mutex);
+    m_pJobs = NULL;
+    m_jobsNum = 0;
+    pthread_mutex_unlock(&m_mutex);
+}
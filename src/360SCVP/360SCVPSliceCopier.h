@@ -0,0 +1,87 @@
+/*
+ * Copyright (c) 2020, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef _360SCVP_SLICECOPIER_H_
+#define _360SCVP_SLICECOPIER_H_
+
+#include "stdint.h"
+#include <pthread.h>
+
+//!
+//! \brief  one memory copy of a slice payload into the merged bitstream
+//!
+typedef struct SLICECOPYJOB
+{
+    uint8_t       *pDst;
+    const uint8_t *pSrc;
+    uint32_t       size;
+}SliceCopyJob;
+
+//!
+//! \class  TsliceCopier
+//! \brief  worker pool copying the slice payloads of one merged frame in parallel,
+//!         the calling thread takes part in the copy
+//!
+class TsliceCopier
+{
+public:
+    TsliceCopier();
+    virtual ~TsliceCopier();
+
+    //!
+    //! \brief  start the workers
+    //!
+    //! \param  threadNum, input, total number of threads copying, including the caller
+    //!
+    //! \return int32_t, 0 if success, else -1
+    //!
+    int32_t init(uint32_t threadNum);
+
+    //!
+    //! \brief  copy all the jobs and return once they are done
+    //!
+    //! \param  pJobs,   input, the copy jobs, destinations must not overlap
+    //! \param  jobsNum, input, the number of jobs
+    //!
+    void copy(SliceCopyJob *pJobs, uint32_t jobsNum);
+
+private:
+    static void* workerThread(void *pCopier);
+    void runJobs();
+
+    pthread_t          *m_pThreads;
+    uint32_t            m_threadNum;
+    pthread_mutex_t     m_mutex;
+    pthread_cond_t      m_startCond;
+    pthread_cond_t      m_doneCond;
+    SliceCopyJob       *m_pJobs;
+    uint32_t            m_jobsNum;
+    uint32_t            m_nextJob;
+    uint32_t            m_generation;
+    uint32_t            m_busyWorkers;
+    bool                m_bExit;
+};
+
+#endif // _360SCVP_SLICECOPIER_H_
@@ -31,6 +31,9 @@
 #include <assert.h>
 #include <math.h>
 #include "360SCVPViewPort.h"
+#ifdef SCVP_X86_SIMD
+#include <immintrin.h>
+#endif
 
 
 ViewPort::ViewPort(SVideoInfo& sVideoInfo) : Geometry()
@@ -64,6 +67,96 @@ void ViewPort::map2DTo3D(SPos& IPosIn, SPos *pSPosOut)
 
 }
 
+#ifdef SCVP_X86_SIMD
+// same operations as map2DTo3D, 8 positions per iteration, returns the number of mapped positions
+__attribute__((target("avx512f")))
+static int32_t map2DTo3DAVX512(POSType matInvK[3][3], POSType matRot[3][3], SPosArray& sPosIn, SPosArray& sPosOut, int32_t num)
+{
+    const __m512d half = _mm512_set1_pd(0.5);
+    const __m512d one = _mm512_set1_pd(1.0);
+    int32_t k = 0;
+    for (; k + 8 <= num; k += 8)
+    {
+        __m512d u = _mm512_add_pd(_mm512_loadu_pd(sPosIn.x + k), half);
+        __m512d v = _mm512_add_pd(_mm512_loadu_pd(sPosIn.y + k), half);
+        __m512d x2 = _mm512_add_pd(_mm512_add_pd(_mm512_mul_pd(_mm512_set1_pd(matInvK[0][0]), u), _mm512_mul_pd(_mm512_set1_pd(matInvK[0][1]), v)), _mm512_set1_pd(matInvK[0][2]));
+        __m512d y2 = _mm512_add_pd(_mm512_add_pd(_mm512_mul_pd(_mm512_set1_pd(matInvK[1][0]), u), _mm512_mul_pd(_mm512_set1_pd(matInvK[1][1]), v)), _mm512_set1_pd(matInvK[1][2]));
+
+        // undo perspective division
+        __m512d z1 = _mm512_div_pd(one, _mm512_maskz_sqrt_pd(0xFF, _mm512_add_pd(_mm512_add_pd(_mm512_mul_pd(x2, x2), _mm512_mul_pd(y2, y2)), one)));
+        __m512d x1 = _mm512_mul_pd(z1, x2);
+        __m512d y1 = _mm512_mul_pd(z1, y2);
+
+        // rotate: p = R * p1
+        __m512d p[3];
+        for (int32_t r = 0; r < 3; r++)
+        {
+            p[r] = _mm512_add_pd(_mm512_add_pd(_mm512_mul_pd(_mm512_set1_pd(matRot[r][0]), x1), _mm512_mul_pd(_mm512_set1_pd(matRot[r][1]), y1)), _mm512_mul_pd(_mm512_set1_pd(matRot[r][2]), z1));
+        }
+        _mm512_storeu_pd(sPosOut.x + k, p[0]);
+        _mm512_storeu_pd(sPosOut.y + k, p[1]);
+        _mm512_storeu_pd(sPosOut.z + k, p[2]);
+        _mm256_storeu_si256((__m256i*)(sPosOut.faceIdx + k), _mm256_loadu_si256((__m256i*)(sPosIn.faceIdx + k)));
+    }
+    return k;
+}
+
+// same operations as map2DTo3D, 4 positions per iteration, returns the number of mapped positions
+__attribute__((target("avx2")))
+static int32_t map2DTo3DAVX2(POSType matInvK[3][3], POSType matRot[3][3], SPosArray& sPosIn, SPosArray& sPosOut, int32_t num)
+{
+    const __m256d half = _mm256_set1_pd(0.5);
+    const __m256d one = _mm256_set1_pd(1.0);
+    int32_t k = 0;
+    for (; k + 4 <= num; k += 4)
+    {
+        __m256d u = _mm256_add_pd(_mm256_loadu_pd(sPosIn.x + k), half);
+        __m256d v = _mm256_add_pd(_mm256_loadu_pd(sPosIn.y + k), half);
+        __m256d x2 = _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(_mm256_set1_pd(matInvK[0][0]), u), _mm256_mul_pd(_mm256_set1_pd(matInvK[0][1]), v)), _mm256_set1_pd(matInvK[0][2]));
+        __m256d y2 = _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(_mm256_set1_pd(matInvK[1][0]), u), _mm256_mul_pd(_mm256_set1_pd(matInvK[1][1]), v)), _mm256_set1_pd(matInvK[1][2]));
+
+        // undo perspective division
+        __m256d z1 = _mm256_div_pd(one, _mm256_sqrt_pd(_mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(x2, x2), _mm256_mul_pd(y2, y2)), one)));
+        __m256d x1 = _mm256_mul_pd(z1, x2);
+        __m256d y1 = _mm256_mul_pd(z1, y2);
+
+        // rotate: p = R * p1
+        __m256d p[3];
+        for (int32_t r = 0; r < 3; r++)
+        {
+            p[r] = _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(_mm256_set1_pd(matRot[r][0]), x1), _mm256_mul_pd(_mm256_set1_pd(matRot[r][1]), y1)), _mm256_mul_pd(_mm256_set1_pd(matRot[r][2]), z1));
+        }
+        _mm256_storeu_pd(sPosOut.x + k, p[0]);
+        _mm256_storeu_pd(sPosOut.y + k, p[1]);
+        _mm256_storeu_pd(sPosOut.z + k, p[2]);
+        _mm_storeu_si128((__m128i*)(sPosOut.faceIdx + k), _mm_loadu_si128((__m128i*)(sPosIn.faceIdx + k)));
+    }
+    return k;
+}
+#endif
+
+void ViewPort::map2DTo3DBatch(SPosArray& sPosIn, SPosArray& sPosOut, int32_t num)
+{
+    int32_t k = 0;
+#ifdef SCVP_X86_SIMD
+    SIMDLevel level = getSIMDLevel();
+    if (level == SIMD_AVX512)
+        k = map2DTo3DAVX512(m_matInvK, m_matRotMatx, sPosIn, sPosOut, num);
+    else if (level == SIMD_AVX2)
+        k = map2DTo3DAVX2(m_matInvK, m_matRotMatx, sPosIn, sPosOut, num);
+#endif
+    // the remaining positions
+    for (; k < num; k++)
+    {
+        SPos in(sPosIn.faceIdx[k], sPosIn.x[k], sPosIn.y[k], sPosIn.z[k]), out;
+        ViewPort::map2DTo3D(in, &out);
+        sPosOut.faceIdx[k] = sPosIn.faceIdx[k];
+        sPosOut.x[k] = out.x;
+        sPosOut.y[k] = out.y;
+        sPosOut.z[k] = out.z;
+    }
+}
+
 void ViewPort::setViewPort(float fovx,float fovy,float yaw,float pitch)
 {
    m_sVideoInfo.viewPort.hFOV= fovx;
@@ -110,8 +203,28 @@ void ViewPort::matInv(POSType K[3][3])
   m_matInvK[2][1] = (K[2][0] * K[0][1] - K[0][0] * K[2][1]) /det;
   m_matInvK[2][2] = (K[0][0] * K[1][1] - K[1][0] * K[0][1]) /det;
 }
-void ViewPort::map3DTo2D(SPos *,SPos *)
+//The output is the position in the viewport sampling grid, faceIdx is -1 if the point is behind the viewport;
+void ViewPort::map3DTo2D(SPos *pSPosIn, SPos *pSPosOut)
 {
-    assert(0 && "Viewport 3D to 2D is not supported ");
+    // rotate back: p1 = R' * p
+    POSType x1 = m_matRotMatx[0][0]*pSPosIn->x + m_matRotMatx[1][0]*pSPosIn->y + m_matRotMatx[2][0]*pSPosIn->z;
+    POSType y1 = m_matRotMatx[0][1]*pSPosIn->x + m_matRotMatx[1][1]*pSPosIn->y + m_matRotMatx[2][1]*pSPosIn->z;
+    POSType z1 = m_matRotMatx[0][2]*pSPosIn->x + m_matRotMatx[1][2]*pSPosIn->y + m_matRotMatx[2][2]*pSPosIn->z;
+
+    pSPosOut->z = 0;
+    if (z1 < S_EPS)
+    {
+        pSPosOut->faceIdx = -1;
+        pSPosOut->x = 0;
+        pSPosOut->y = 0;
+        return;
+    }
+
+    // perspective division, then undo the inverse K matrix
+    POSType x2 = x1 / z1;
+    POSType y2 = y1 / z1;
+    pSPosOut->faceIdx = 0;
+    pSPosOut->x = (x2 - m_matInvK[0][2]) / m_matInvK[0][0] - (POSType)(0.5);
+    pSPosOut->y = (y2 - m_matInvK[1][2]) / m_matInvK[1][1] - (POSType)(0.5);
 }
 
@@ -44,8 +44,9 @@ public:
     ViewPort(SVideoInfo& sVideoInfo);
     virtual ~ViewPort();
     virtual void map2DTo3D(SPos& IPosIn, SPos *pSPosOut);
-    //own methods;
     virtual void map3DTo2D(SPos *pSPosIn, SPos *pSPosOut);
+    virtual void map2DTo3DBatch(SPosArray& sPosIn, SPosArray& sPosOut, int32_t num);
+    //own methods;
     void setViewPort(float, float, float, float);
     void setRotMat();
     void setInvK();
@@ -120,6 +120,46 @@ int32_t   genViewport_process(generateViewPortParam* pParamGenViewport, void* pG
 //!
 int32_t genViewport_setViewPort(void* pGenHandle, float yaw, float pitch);
 
+//!
+//! \brief    This function selects how the viewport range is calculated. In the sparse mode(default) only the viewport
+//!           pixels which can decide the range are mapped, otherwise all the pixels of the viewport are mapped.
+//!           Both modes output the same range.
+//!
+//! \param    void*  pGenHandle,        input, which is created by the genTiledStream_Init function
+//! \param    bool   bSparse,           input, true for the sparse mode, false for the full mapping
+//!
+//! \return   s32, the status of the function.
+//!           0,     if succeed
+//!           not 0, if fail
+//!
+int32_t genViewport_setSparseMapping(void* pGenHandle, bool bSparse);
+
+//!
+//! \brief    This function enables the viewport lookup table. The viewport range is calculated only once for each cell
+//!           of the quantized yaw/pitch grid, and genViewport_process then outputs the range of the nearest cell.
+//!           The cells of one pitch row are allocated when the row is visited first.
+//!
+//! \param    void*  pGenHandle,        input, which is created by the genTiledStream_Init function
+//! \param    float  quantStep,         input, the quantization step of yaw and pitch in degree, 0 to disable the table
+//!
+//! \return   s32, the status of the function.
+//!           0,     if succeed
+//!           not 0, if fail
+//!
+int32_t genViewport_setLUTStep(void* pGenHandle, float quantStep);
+
+//!
+//! \brief    This function fills all the cells of the viewport lookup table enabled by genViewport_setLUTStep,
+//!           so that no genViewport_process call needs to do the geometry mapping afterwards.
+//!
+//! \param    void*  pGenHandle,        input, which is created by the genTiledStream_Init function
+//!
+//! \return   s32, the status of the function.
+//!           0,     if succeed
+//!           not 0, if fail
+//!
+int32_t genViewport_precomputeLUT(void* pGenHandle);
+
 //!
 //! \brief    This function sets the maxmimum selected tile number for the viewPort.
 //!
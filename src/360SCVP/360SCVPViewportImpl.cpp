@@ -213,6 +213,31 @@ int32_t genViewport_setViewPort(void* pGenHandle, float yaw, float pitch)
     return 0;
 }
 
+int32_t genViewport_setSparseMapping(void* pGenHandle, bool bSparse)
+{
+    TgenViewport* cTAppConvCfg = (TgenViewport*)(pGenHandle);
+    if (!cTAppConvCfg)
+        return -1;
+    cTAppConvCfg->m_bSparseMapping = bSparse;
+    return 0;
+}
+
+int32_t genViewport_setLUTStep(void* pGenHandle, float quantStep)
+{
+    TgenViewport* cTAppConvCfg = (TgenViewport*)(pGenHandle);
+    if (!cTAppConvCfg)
+        return -1;
+    return cTAppConvCfg->setLUTStep(quantStep);
+}
+
+int32_t genViewport_precomputeLUT(void* pGenHandle)
+{
+    TgenViewport* cTAppConvCfg = (TgenViewport*)(pGenHandle);
+    if (!cTAppConvCfg)
+        return -1;
+    return cTAppConvCfg->precomputeLUT();
+}
+
 bool genViewport_isInside(void* pGenHandle, int32_t x, int32_t y, int32_t width, int32_t height, int32_t faceId)
 {
     bool ret = 0;
@@ -440,7 +465,14 @@ TgenViewport::TgenViewport()
     m_iInputHeight = 0;
     m_maxTileNum = 0;
     m_numFaces = 0;
+    m_bSparseMapping = true;
     m_srd = new ITileInfo;
+    m_lutStep = 0;
+    m_lutYawNum = 0;
+    m_lutPitchNum = 0;
+    m_lutHFOV = 0;
+    m_lutVFOV = 0;
+    m_ppLUTRows = NULL;
 }
 
 TgenViewport::~TgenViewport()
@@ -460,6 +492,12 @@ TgenViewport::~TgenViewport()
         delete m_srd;
         m_srd = NULL;
     }
+    if(m_ppLUTRows)
+    {
+        releaseLUTRows();
+        delete[] m_ppLUTRows;
+        m_ppLUTRows = NULL;
+    }
 }
 
 TgenViewport& TgenViewport::operator=(const TgenViewport& src)
@@ -501,6 +539,12 @@ void TgenViewport::destroy()
     if(m_srd)
         delete[] m_srd;
     m_srd = NULL;
+    if(m_ppLUTRows)
+    {
+        releaseLUTRows();
+        delete[] m_ppLUTRows;
+    }
+    m_ppLUTRows = NULL;
 }
 
 
@@ -570,6 +614,20 @@ int32_t TgenViewport::parseCfg(  )
 
 int32_t  TgenViewport::convert()
 {
+    SVideoInfo codingSVideoInfo = m_codingSVideoInfo;
+    ViewportLUTEntry *pLUTEntry = NULL;
+
+    // the viewport range of a quantized pose is calculated only once when the lookup table is enabled
+    if (m_ppLUTRows && codingSVideoInfo.geoType == SVIDEO_VIEWPORT)
+    {
+        pLUTEntry = getLUTEntry(codingSVideoInfo.viewPort);
+        if (pLUTEntry && pLUTEntry->bValid)
+        {
+            loadLUTEntry(pLUTEntry);
+            return 0;
+        }
+    }
+
     Geometry  *pcInputGeomtry = NULL;
     Geometry  *pcCodingGeomtry = NULL;
     pcInputGeomtry = Geometry::create(m_sourceSVideoInfo);
@@ -577,17 +635,14 @@ int32_t  TgenViewport::convert()
     {
         return -1;
     }
-    pcCodingGeomtry = Geometry::create(m_codingSVideoInfo);
+    pcCodingGeomtry = Geometry::create(codingSVideoInfo);
     if (!pcCodingGeomtry)
     {
         delete pcInputGeomtry;
         pcInputGeomtry = NULL;
         return -1;
     }
-
-    // starting time
-    double dResult;
-    clock_t lBefore = clock();
+    pcCodingGeomtry->setSparseMappingFlag(m_bSparseMapping);
 
     pcInputGeomtry->geoConvert(pcCodingGeomtry);
 
@@ -613,10 +668,10 @@ int32_t  TgenViewport::convert()
             pDownRightSrc++;
         }
         pcCodingGeomtry->geoUnInit();
-    }
 
-    dResult = (double)(clock() - lBefore) / CLOCKS_PER_SEC;
-    printf("\n Total Time: %12.3f sec.\n", dResult);
+        if (pLUTEntry)
+            storeLUTEntry(pLUTEntry);
+    }
 
     if(pcInputGeomtry)
     {
@@ -630,6 +685,147 @@ int32_t  TgenViewport::convert()
     }
     return 0;
 }
+
+int32_t TgenViewport::setLUTStep(float quantStep)
+{
+    if (quantStep < 0 || quantStep > 90)
+        return -1;
+
+    if (m_ppLUTRows)
+    {
+        releaseLUTRows();
+        delete[] m_ppLUTRows;
+    }
+    m_ppLUTRows = NULL;
+    m_lutStep = quantStep;
+    m_lutYawNum = 0;
+    m_lutPitchNum = 0;
+    if (quantStep == 0)
+        return 0;
+
+    // yaw wraps around at +/-180, while both -90 and 90 are valid pitch cells
+    m_lutYawNum = (int32_t)(360 / quantStep + 0.5);
+    m_lutPitchNum = (int32_t)(180 / quantStep + 0.5) + 1;
+    m_ppLUTRows = new ViewportLUTEntry*[m_lutPitchNum];
+    if (!m_ppLUTRows)
+        return -1;
+    memset(m_ppLUTRows, 0, m_lutPitchNum * sizeof(ViewportLUTEntry*));
+    m_lutHFOV = m_codingSVideoInfo.viewPort.hFOV;
+    m_lutVFOV = m_codingSVideoInfo.viewPort.vFOV;
+    return 0;
+}
+
+int32_t TgenViewport::precomputeLUT()
+{
+    if (!m_ppLUTRows)
+        return -1;
+    if (parseCfg() < 0)
+        return -1;
+
+    POSType yawStep = 360.0 / m_lutYawNum;
+    POSType pitchStep = 180.0 / (m_lutPitchNum - 1);
+    float yaw = m_codingSVideoInfo.viewPort.fYaw;
+    float pitch = m_codingSVideoInfo.viewPort.fPitch;
+    int32_t ret = 0;
+    for (int32_t j = 0; j < m_lutPitchNum && ret == 0; j++)
+    {
+        for (int32_t i = 0; i < m_lutYawNum && ret == 0; i++)
+        {
+            m_codingSVideoInfo.viewPort.fYaw = (float)(i * yawStep - 180);
+            m_codingSVideoInfo.viewPort.fPitch = (float)(j * pitchStep - 90);
+            ret = convert();
+        }
+    }
+
+    // restore the output of the current pose
+    m_codingSVideoInfo.viewPort.fYaw = yaw;
+    m_codingSVideoInfo.viewPort.fPitch = pitch;
+    if (ret == 0)
+        ret = convert();
+    return ret;
+}
+
+ViewportLUTEntry* TgenViewport::getLUTEntry(ViewPortSettings& viewPort)
+{
+    // the table only holds the FOV it is built for
+    if (viewPort.hFOV != m_lutHFOV || viewPort.vFOV != m_lutVFOV)
+    {
+        releaseLUTRows();
+        m_lutHFOV = viewPort.hFOV;
+        m_lutVFOV = viewPort.vFOV;
+    }
+
+    POSType yawStep = 360.0 / m_lutYawNum;
+    POSType pitchStep = 180.0 / (m_lutPitchNum - 1);
+
+    POSType yaw = fmod((POSType)viewPort.fYaw + 180, 360);
+    if (yaw < 0)
+        yaw += 360;
+    int32_t yawIdx = (int32_t)sfloor(yaw / yawStep + 0.5) % m_lutYawNum;
+
+    POSType pitch = (POSType)viewPort.fPitch + 90;
+    if (pitch < 0)
+        pitch = 0;
+    if (pitch > 180)
+        pitch = 180;
+    int32_t pitchIdx = (int32_t)sfloor(pitch / pitchStep + 0.5);
+    if (pitchIdx >= m_lutPitchNum)
+        pitchIdx = m_lutPitchNum - 1;
+
+    // snap the pose to the cell, so the cell content does not depend on the pose filling it
+    viewPort.fYaw = (float)(yawIdx * yawStep - 180);
+    viewPort.fPitch = (float)(pitchIdx * pitchStep - 90);
+
+    if (!m_ppLUTRows[pitchIdx])
+    {
+        m_ppLUTRows[pitchIdx] = new ViewportLUTEntry[m_lutYawNum];
+        if (!m_ppLUTRows[pitchIdx])
+            return NULL;
+        memset(m_ppLUTRows[pitchIdx], 0, m_lutYawNum * sizeof(ViewportLUTEntry));
+    }
+    return &m_ppLUTRows[pitchIdx][yawIdx];
+}
+
+void TgenViewport::releaseLUTRows()
+{
+    for (int32_t i = 0; i < m_lutPitchNum; i++)
+    {
+        if (m_ppLUTRows[i])
+        {
+            delete[] m_ppLUTRows[i];
+            m_ppLUTRows[i] = NULL;
+        }
+    }
+}
+
+void TgenViewport::loadLUTEntry(ViewportLUTEntry* pEntry)
+{
+    m_numFaces = pEntry->numFaces;
+    for (int32_t i = 0; i < FACE_NUMBER; i++)
+    {
+        m_pUpLeft[i].faceIdx = pEntry->faceIdx[i];
+        m_pUpLeft[i].x = pEntry->upLeft[i][0];
+        m_pUpLeft[i].y = pEntry->upLeft[i][1];
+        m_pDownRight[i].faceIdx = pEntry->faceIdx[i];
+        m_pDownRight[i].x = pEntry->downRight[i][0];
+        m_pDownRight[i].y = pEntry->downRight[i][1];
+    }
+}
+
+void TgenViewport::storeLUTEntry(ViewportLUTEntry* pEntry)
+{
+    pEntry->numFaces = m_numFaces;
+    for (int32_t i = 0; i < FACE_NUMBER; i++)
+    {
+        pEntry->faceIdx[i] = m_pUpLeft[i].faceIdx;
+        pEntry->upLeft[i][0] = (int32_t)m_pUpLeft[i].x;
+        pEntry->upLeft[i][1] = (int32_t)m_pUpLeft[i].y;
+        pEntry->downRight[i][0] = (int32_t)m_pDownRight[i].x;
+        pEntry->downRight[i][1] = (int32_t)m_pDownRight[i].y;
+    }
+    pEntry->bValid = 1;
+}
+
 bool TgenViewport::isInside(int32_t x, int32_t y, int32_t width, int32_t height, int32_t faceId)
 {
     bool ret = 0;
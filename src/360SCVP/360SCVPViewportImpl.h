@@ -27,6 +27,7 @@
 #define __360SCVP_VIEWPORTIMPL__
 
 #include "360SCVPGeometry.h"
+#include "360SCVPViewPort.h"
 
 #include <sstream>
 #include <vector>
@@ -69,6 +70,16 @@ struct ITileInfo
     int32_t   faceId;
     uint32_t  isOccupy;
 };
+///< one cell of the viewport lookup table, keeps the viewport range on each face for one quantized pose
+struct ViewportLUTEntry
+{
+    int32_t   bValid;
+    int32_t   numFaces;
+    int32_t   faceIdx[FACE_NUMBER];
+    int32_t   upLeft[FACE_NUMBER][2];
+    int32_t   downRight[FACE_NUMBER][2];
+};
+
 /// generate viewport class
 class TgenViewport
 {
@@ -93,6 +104,14 @@ public:
     int32_t       m_aiPad[2];                                       ///< number of padded pixels for width and height
     int32_t   m_faceSizeAlignment;
     int32_t       m_maxTileNum;
+    bool          m_bSparseMapping;                                 ///< map only the samples which decide the viewport range
+    // viewport lookup table
+    float     m_lutStep;                                        ///< quantization step of yaw/pitch in degree, 0 if the table is disabled
+    int32_t   m_lutYawNum;                                      ///< cell number in the yaw direction
+    int32_t   m_lutPitchNum;                                    ///< cell number in the pitch direction
+    float     m_lutHFOV;                                        ///< the horizontal FOV the table is built for
+    float     m_lutVFOV;                                        ///< the vertical FOV the table is built for
+    ViewportLUTEntry **m_ppLUTRows;                           ///< the cells of each pitch row, allocated when the row is visited
     inline int32_t round(POSType t) { return (int32_t)(t+ (t>=0? 0.5 :-0.5)); };
 public:
     TgenViewport();
@@ -104,9 +123,17 @@ public:
     void     destroy();    ///< destroy option handling class
     int32_t  parseCfg(  );  ///< parse configuration file to fill member variables
     int32_t  convert();
+    //viewport lookup table;
+    int32_t  setLUTStep(float quantStep);
+    int32_t  precomputeLUT();
     //analysis;
     bool     isInside(int32_t x, int32_t y, int32_t width, int32_t height, int32_t faceId);
     int32_t  calcTilesInViewport(ITileInfo* pTileInfo, int32_t tileCol, int32_t tileRow);
+private:
+    ViewportLUTEntry* getLUTEntry(ViewPortSettings& viewPort);
+    void     releaseLUTRows();
+    void     loadLUTEntry(ViewportLUTEntry* pEntry);
+    void     storeLUTEntry(ViewportLUTEntry* pEntry);
 
 };// END CLASS DEFINITION
 
@@ -0,0 +1,35 @@
+#!/bin/bash -e
+
+# Read throughput benchmark of GTS_BitStream, kept out of the unit
+# test run since timings depend on the machine.
+#
+# Usage: ./bench.sh [baseline revision]
+#
+# 360SCVP of the working tree is measured, and of the baseline
+# revision too if given, e.g. the commit before a reader change.
+
+BENCH_DIR=$(mktemp -d)
+trap "rm -rf ${BENCH_DIR}" EXIT
+
+STREAMS="test.h265 test.265 test_low.265"
+
+run_bench()
+{
+    local src_dir=$1
+    local build_dir=$2
+
+    cmake -S ${src_dir} -B ${build_dir} > /dev/null
+    cmake --build ${build_dir} -j$(nproc) > /dev/null
+    g++ -std=c++11 -O2 -I${src_dir} benchBitstream.cpp -o ${build_dir}/benchBitstream -L${build_dir} -l360SCVP -lpthread
+    LD_LIBRARY_PATH=${build_dir} ${build_dir}/benchBitstream ${STREAMS}
+}
+
+if [ -n "$1" ]; then
+    echo "== baseline $1"
+    mkdir -p ${BENCH_DIR}/baseline_src
+    git -C .. archive "$1" . | tar -x -C ${BENCH_DIR}/baseline_src
+    run_bench ${BENCH_DIR}/baseline_src ${BENCH_DIR}/baseline
+fi
+
+echo "== working tree"
+run_bench .. ${BENCH_DIR}/current
@@ -0,0 +1,118 @@
+/*
+ * Copyright (c) 2019, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+//!
+//! \file:   benchBitstream.cpp
+//! \brief:  read throughput of GTS_BitStream, run by bench.sh against
+//!          360SCVP libraries built from different revisions, not
+//!          part of the unit test run
+//!
+
+#include <chrono>
+#include <fstream>
+#include <iterator>
+#include <stdio.h>
+#include <string>
+#include "360SCVPBitstream.h"
+
+#define BENCH_ROUNDS_NUM 7
+
+namespace {
+
+//!
+//! \brief  field widths read repeatedly, mixing flags, short fields
+//!         and wider ones like slice header parsing does
+//!
+const uint32_t fieldBits[] = {1, 6, 3, 1, 8, 2, 16, 5, 1, 24};
+
+//!
+//! \brief  read the whole buffer field by field
+//!
+//! \return uint64_t
+//!         sum of all fields read, which is the same for any
+//!         correct reader
+//!
+uint64_t ReadFields(const uint8_t *data, uint64_t size)
+{
+    GTS_BitStream *bs = gts_bs_new((const int8_t*)data, size, GTS_BITSTREAM_READ);
+    if (!bs)
+        return 0;
+
+    uint32_t fieldsNum = sizeof(fieldBits) / sizeof(fieldBits[0]);
+    uint64_t sum = 0;
+    while (gts_bs_get_position(bs) + 16 < size)
+    {
+        for (uint32_t i = 0; i < fieldsNum; i++)
+            sum += gts_bs_read_int(bs, fieldBits[i]);
+    }
+    gts_bs_del(bs);
+
+    return sum;
+}
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 2)
+    {
+        printf("Usage: %s <bitstream file> ...\n", argv[0]);
+        return 1;
+    }
+
+    int ret = 0;
+    for (int fileIdx = 1; fileIdx < argc; fileIdx++)
+    {
+        std::ifstream input(argv[fileIdx], std::ios::binary);
+        std::string content((std::istreambuf_iterator<char>(input)), std::istreambuf_iterator<char>());
+        if (content.size() <= 16)
+        {
+            printf("%s: failed to read enough data\n", argv[fileIdx]);
+            ret = 1;
+            continue;
+        }
+
+        const uint8_t *data = (const uint8_t*)content.data();
+        uint64_t size = content.size();
+        uint64_t sum = 0;
+        double bestTime = 0;
+        for (uint32_t round = 0; round < BENCH_ROUNDS_NUM; round++)
+        {
+            std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            sum = ReadFields(data, size);
+            std::chrono::duration<double, std::milli> time = std::chrono::steady_clock::now() - start;
+            if (!round || time.count() < bestTime)
+                bestTime = time.count();
+        }
+
+        // checksum tells whether libraries read the same fields
+        double sizeMB = (double)size / (1024 * 1024);
+        printf("%s: %llu bytes in %.2f ms, %.1f MB/s, checksum %llu\n",
+            argv[fileIdx], (unsigned long long)size, bestTime,
+            sizeMB * 1000 / bestTime, (unsigned long long)sum);
+    }
+
+    return ret;
+}
@@ -27,7 +27,11 @@
 #include "gtest/gtest.h"
 #include <string>
 #include <fstream>
+#include <vector>
 #include "../360SCVPAPI.h"
+#include "../360SCVPBitstream.h"
+#include "../360SCVPViewportAPI.h"
+#include "../360SCVPMergeStreamAPI.h"
 
 namespace{
 class I360SCVPTest : public testing::Test {
@@ -1004,4 +1008,686 @@ TEST_F(I360SCVPTest, parseRWPK)
     EXPECT_TRUE(ret == 0);
 }
 
+TEST_F(I360SCVPTest, ViewportLUT)
+{
+    generateViewPortParam paramViewport;
+    point upLeft[6], downRight[6];
+    point upLeftLUT[6], downRightLUT[6];
+    memset(&paramViewport, 0, sizeof(generateViewPortParam));
+    paramViewport.m_iViewportWidth = 960;
+    paramViewport.m_iViewportHeight = 960;
+    paramViewport.m_viewPort_hFOV = 80;
+    paramViewport.m_viewPort_vFOV = 80;
+    paramViewport.m_output_geoType = E_SVIDEO_VIEWPORT;
+    paramViewport.m_input_geoType = E_SVIDEO_EQUIRECT;
+    paramViewport.m_iInputWidth = 3840;
+    paramViewport.m_iInputHeight = 2048;
+    paramViewport.m_tileNumRow = 4;
+    paramViewport.m_tileNumCol = 8;
+    paramViewport.m_pUpLeft = upLeft;
+    paramViewport.m_pDownRight = downRight;
+    void* pViewport = genViewport_Init(&paramViewport);
+    EXPECT_TRUE(pViewport != NULL);
+    if (!pViewport)
+        return;
+
+    generateViewPortParam paramViewportLUT = paramViewport;
+    paramViewportLUT.m_pUpLeft = upLeftLUT;
+    paramViewportLUT.m_pDownRight = downRightLUT;
+    void* pViewportLUT = genViewport_Init(&paramViewportLUT);
+    EXPECT_TRUE(pViewportLUT != NULL);
+    if (!pViewportLUT)
+    {
+        genViewport_unInit(pViewport);
+        return;
+    }
+    int ret = genViewport_setLUTStep(pViewportLUT, 5);
+    EXPECT_TRUE(ret == 0);
+
+    // on the grid, the table should output the same range as the geometry mapping
+    for (int pitch = -90; pitch <= 90; pitch += 45)
+    {
+        for (int yaw = -180; yaw < 180; yaw += 90)
+        {
+            for (int repeat = 0; repeat < 2; repeat++)
+            {
+                ret = genViewport_setViewPort(pViewport, yaw, pitch);
+                ret |= genViewport_process(&paramViewport, pViewport);
+                ret |= genViewport_setViewPort(pViewportLUT, yaw, pitch);
+                ret |= genViewport_process(&paramViewportLUT, pViewportLUT);
+                EXPECT_TRUE(ret == 0);
+                EXPECT_TRUE(paramViewport.m_numFaces == paramViewportLUT.m_numFaces);
+                for (int i = 0; i < paramViewport.m_numFaces; i++)
+                {
+                    EXPECT_TRUE(upLeft[i].faceId == upLeftLUT[i].faceId);
+                    EXPECT_TRUE(upLeft[i].x == upLeftLUT[i].x);
+                    EXPECT_TRUE(upLeft[i].y == upLeftLUT[i].y);
+                    EXPECT_TRUE(downRight[i].x == downRightLUT[i].x);
+                    EXPECT_TRUE(downRight[i].y == downRightLUT[i].y);
+                }
+            }
+        }
+    }
+
+    // off the grid, the pose is snapped to the nearest cell
+    ret = genViewport_setViewPort(pViewport, 45, 30);
+    ret |= genViewport_process(&paramViewport, pViewport);
+    ret |= genViewport_setViewPort(pViewportLUT, 46.2, 28.1);
+    ret |= genViewport_process(&paramViewportLUT, pViewportLUT);
+    EXPECT_TRUE(ret == 0);
+    EXPECT_TRUE(upLeft[0].x == upLeftLUT[0].x);
+    EXPECT_TRUE(upLeft[0].y == upLeftLUT[0].y);
+    EXPECT_TRUE(downRight[0].x == downRightLUT[0].x);
+    EXPECT_TRUE(downRight[0].y == downRightLUT[0].y);
+
+    genViewport_unInit(pViewport);
+    genViewport_unInit(pViewportLUT);
+}
+
+TEST_F(I360SCVPTest, ViewportSparseMapping)
+{
+    // erp and cube map input
+    int inputGeoType[2] = { E_SVIDEO_EQUIRECT, E_SVIDEO_CUBEMAP };
+    int inputWidth[2] = { 3840, 960 };
+    int inputHeight[2] = { 2048, 960 };
+    for (int t = 0; t < 2; t++)
+    {
+        generateViewPortParam paramViewport;
+        point upLeft[6], downRight[6];
+        point upLeftSparse[6], downRightSparse[6];
+        memset(&paramViewport, 0, sizeof(generateViewPortParam));
+        paramViewport.m_iViewportWidth = 960;
+        paramViewport.m_iViewportHeight = 720;
+        paramViewport.m_viewPort_hFOV = 90;
+        paramViewport.m_viewPort_vFOV = 70;
+        paramViewport.m_output_geoType = E_SVIDEO_VIEWPORT;
+        paramViewport.m_input_geoType = inputGeoType[t];
+        paramViewport.m_iInputWidth = inputWidth[t];
+        paramViewport.m_iInputHeight = inputHeight[t];
+        paramViewport.m_tileNumRow = 4;
+        paramViewport.m_tileNumCol = 8;
+        paramViewport.m_pUpLeft = upLeft;
+        paramViewport.m_pDownRight = downRight;
+        void* pViewport = genViewport_Init(&paramViewport);
+        EXPECT_TRUE(pViewport != NULL);
+        if (!pViewport)
+            return;
+
+        generateViewPortParam paramViewportSparse = paramViewport;
+        paramViewportSparse.m_pUpLeft = upLeftSparse;
+        paramViewportSparse.m_pDownRight = downRightSparse;
+        void* pViewportSparse = genViewport_Init(&paramViewportSparse);
+        EXPECT_TRUE(pViewportSparse != NULL);
+        if (!pViewportSparse)
+        {
+            genViewport_unInit(pViewport);
+            return;
+        }
+        int ret = genViewport_setSparseMapping(pViewport, false);
+        ret |= genViewport_setSparseMapping(pViewportSparse, true);
+        EXPECT_TRUE(ret == 0);
+
+        // sweep the poses, including the poles and the erp boundary
+        for (float pitch = -90; pitch <= 90; pitch += 30)
+        {
+            for (float yaw = -180; yaw <= 180; yaw += 55)
+            {
+                ret = genViewport_setViewPort(pViewport, yaw, pitch);
+                ret |= genViewport_process(&paramViewport, pViewport);
+                ret |= genViewport_setViewPort(pViewportSparse, yaw, pitch);
+                ret |= genViewport_process(&paramViewportSparse, pViewportSparse);
+                EXPECT_TRUE(ret == 0);
+                EXPECT_TRUE(paramViewport.m_numFaces == paramViewportSparse.m_numFaces);
+                for (int i = 0; i < paramViewport.m_numFaces; i++)
+                {
+                    EXPECT_TRUE(upLeft[i].faceId == upLeftSparse[i].faceId);
+                    EXPECT_TRUE(upLeft[i].x == upLeftSparse[i].x);
+                    EXPECT_TRUE(upLeft[i].y == upLeftSparse[i].y);
+                    EXPECT_TRUE(downRight[i].faceId == downRightSparse[i].faceId);
+                    EXPECT_TRUE(downRight[i].x == downRightSparse[i].x);
+                    EXPECT_TRUE(downRight[i].y == downRightSparse[i].y);
+                }
+            }
+        }
+        genViewport_unInit(pViewport);
+        genViewport_unInit(pViewportSparse);
+    }
+}
+
+// bit-by-bit reference reader, the behavior GTS_BitStream must keep
+struct RefBitReader
+{
+    const uint8_t* data;
+    uint64_t       size;
+    uint64_t       bitPos;
+
+    uint32_t readBit()
+    {
+        uint64_t byte = bitPos >> 3;
+        uint32_t bit = byte < size ? (data[byte] >> (7 - (bitPos & 7))) & 1 : 0;
+        bitPos++;
+        return bit;
+    }
+    uint32_t readInt(uint32_t nBits)
+    {
+        uint32_t ret = 0;
+        while (nBits--)
+            ret = (ret << 1) | readBit();
+        return ret;
+    }
+    // returns false when the prefix is too long for a 32 bits code
+    bool readUE(uint32_t& value)
+    {
+        uint32_t leadingZeros = 0;
+        while (!readBit())
+        {
+            if (++leadingZeros > 31)
+                return false;
+        }
+        value = ((1u << leadingZeros) | readInt(leadingZeros)) - 1;
+        return true;
+    }
+};
+
+TEST_F(I360SCVPTest, BitstreamReader)
+{
+    const char* files[3] = { "./test.265", "./test.h265", "./test_low.265" };
+    for (int f = 0; f < 3; f++)
+    {
+        std::ifstream in(files[f], std::ios::binary);
+        std::string content((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        if (content.empty())
+            continue;
+        const uint8_t* data = (const uint8_t*)content.data();
+        uint64_t size = content.size();
+
+        // mixed fixed-length / exp-golomb / peek pattern checked against the reference
+        GTS_BitStream* bs = gts_bs_new((const int8_t*)data, size, GTS_BITSTREAM_READ);
+        EXPECT_TRUE(bs != NULL);
+        if (!bs)
+            return;
+        RefBitReader ref = { data, size, 0 };
+        uint32_t seed = 12345;
+        bool match = true;
+        while (match && ref.bitPos + 128 < size * 8)
+        {
+            seed = seed * 1103515245 + 12345;
+            uint32_t op = (seed >> 16) % 4;
+            uint32_t nBits = ((seed >> 8) & 31) + 1;
+            if (op == 0)
+            {
+                match = gts_bs_read_int(bs, nBits) == ref.readInt(nBits);
+            }
+            else if (op == 1)
+            {
+                uint32_t value = 0;
+                if (!ref.readUE(value))
+                    break;
+                match = gts_bs_read_ue(bs) == value;
+            }
+            else if (op == 2)
+            {
+                RefBitReader peek = ref;
+                match = gts_bs_peek_bits(bs, nBits, 0) == peek.readInt(nBits);
+            }
+            else
+            {
+                uint64_t high = ref.readInt(nBits);
+                uint64_t value = (high << 32) | ref.readInt(32);
+                match = gts_bs_read_long_int(bs, nBits + 32) == value;
+            }
+            match = match && (gts_bs_get_bit_offset(bs) == ref.bitPos);
+        }
+        EXPECT_TRUE(match);
+        gts_bs_del(bs);
+    }
+}
+
+
+TEST_F(I360SCVPTest, BitstreamWriter)
+{
+    // fields biased towards zero so that emulation prevention bytes are inserted
+    const uint32_t bufSize = 1 << 16;
+    int8_t* buffer = new int8_t[bufSize];
+    std::vector<uint8_t> ref;
+    GTS_BitStream bs;
+    EXPECT_TRUE(gts_bs_init(&bs, buffer, bufSize, GTS_BITSTREAM_WRITE) == GTS_OK);
+
+    uint32_t seed = 6789, current = 0, nbBits = 0, zeroCount = 0;
+    for (int i = 0; i < 20000; i++)
+    {
+        seed = seed * 1103515245 + 12345;
+        int32_t nBits = ((seed >> 8) & 31) + 1;
+        uint32_t value = ((seed >> 16) & 7) ? 0 : seed;
+        if ((seed & 0xF000) == 0)
+            value = 1;
+        gts_bs_write_int(&bs, (int32_t)value, nBits);
+        for (int32_t b = nBits - 1; b >= 0; b--)
+        {
+            current = (current << 1) | ((value >> b) & 1);
+            if (++nbBits == 8)
+            {
+                if (zeroCount == 2 && (uint8_t)current < 4)
+                {
+                    ref.push_back(0x03);
+                    zeroCount = 0;
+                }
+                zeroCount = (uint8_t)current == 0 ? zeroCount + 1 : 0;
+                ref.push_back((uint8_t)current);
+                current = 0;
+                nbBits = 0;
+            }
+        }
+        if (ref.size() + 8 > bufSize)
+            break;
+    }
+    EXPECT_TRUE(gts_bs_get_position(&bs) == ref.size());
+    EXPECT_TRUE(bs.nbBits == nbBits);
+    EXPECT_TRUE(memcmp(buffer, ref.data(), ref.size()) == 0);
+    delete[] buffer;
+}
+
+TEST_F(I360SCVPTest, BitstreamRBSP)
+{
+    std::ifstream in("./test.265", std::ios::binary);
+    std::string content((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    const int8_t* data = (const int8_t*)content.data();
+    uint32_t size = (uint32_t)content.size();
+
+    // split on 3 bytes start codes
+    std::vector<uint32_t> starts;
+    for (uint32_t i = 0; i + 3 < size; i++)
+    {
+        if (!data[i] && !data[i + 1] && data[i + 2] == 1)
+            starts.push_back(i + 3);
+    }
+    starts.push_back(size + 3);
+    EXPECT_TRUE(starts.size() > 1);
+
+    int emulatedNals = 0;
+    for (size_t k = 0; k + 1 < starts.size(); k++)
+    {
+        uint32_t nalSize = starts[k + 1] - 3 - starts[k];
+        const int8_t* nal = data + starts[k];
+        std::vector<int8_t> ref;
+        uint32_t zeros = 0;
+        for (uint32_t n = 0; n < nalSize; n++)
+        {
+            if (zeros == 2 && nal[n] == 0x03 && n + 1 < nalSize && nal[n + 1] < 0x04)
+            {
+                zeros = 0;
+                n++;
+            }
+            zeros = nal[n] ? 0 : zeros + 1;
+            ref.push_back(nal[n]);
+        }
+        if (ref.size() != nalSize)
+            emulatedNals++;
+
+        // small scratch so that large NAL units also exercise the heap fallback
+        int8_t scratch[64];
+        GTS_BitStream bs;
+        EXPECT_TRUE(gts_bs_init_rbsp(&bs, nal, nalSize, scratch, sizeof(scratch)) == GTS_OK);
+        RefBitReader refBits = { (const uint8_t*)ref.data(), ref.size(), 0 };
+        bool match = true;
+        for (int i = 0; i < 100 && refBits.bitPos + 32 <= ref.size() * 8; i++)
+        {
+            uint32_t nBits = (i * 7) % 32 + 1;
+            match = match && gts_bs_read_int(&bs, nBits) == refBits.readInt(nBits);
+        }
+        EXPECT_TRUE(match);
+        EXPECT_TRUE(gts_bs_get_position(&bs) == (refBits.bitPos + 7) / 8);
+        EXPECT_TRUE(gts_bs_get_size(&bs) == ref.size());
+        EXPECT_TRUE(memcmp(bs.original, ref.data(), ref.size()) == 0);
+        gts_bs_uninit(&bs);
+    }
+    EXPECT_TRUE(emulatedNals > 0);
+}
+
+TEST_F(I360SCVPTest, StitchParallelCopy)
+{
+    // stitch the same 2x2 tiles with serial and threaded slice copy, the output must be identical
+    const int tilesNum = 4;
+    std::vector<unsigned char> outputs[2];
+    for (int k = 0; k < 2; k++)
+    {
+        param.usedType = E_STREAM_STITCH_ONLY;
+        param.paramPicInfo.tileHeightNum = 2;
+        param.paramPicInfo.tileWidthNum = 2;
+        param.paramPicInfo.picWidth = frameWidth * 2;
+        param.paramPicInfo.picHeight = frameHeight * 2;
+        param.paramStitchInfo.copyThreadNum = k ? 4 : 0;
+        void* pI360SCVP = I360SCVP_Init(&param);
+        EXPECT_TRUE(pI360SCVP != NULL);
+        if (!pI360SCVP)
+            return;
+
+        param_oneStream_info tiles[tilesNum];
+        param_oneStream_info *pTiles[tilesNum];
+        memset(tiles, 0, sizeof(tiles));
+        for (int i = 0; i < tilesNum; i++)
+        {
+            tiles[i].pTiledBitstreamBuffer = pInputBuffer;
+            tiles[i].inputBufferLen = bufferlen;
+            tiles[i].tilesHeightCount = 1;
+            tiles[i].tilesWidthCount = 1;
+            pTiles[i] = &tiles[i];
+        }
+        param.paramStitchInfo.pTiledBitstream = pTiles;
+
+        unsigned char *pOutput = new unsigned char[bufferlen * tilesNum];
+        param.pOutputBitstream = pOutput;
+        for (int frame = 0; frame < 3; frame++)
+        {
+            int ret = I360SCVP_process(&param, pI360SCVP);
+            EXPECT_TRUE(ret == 0);
+            EXPECT_TRUE(param.outputBitstreamLen > 0);
+            outputs[k].insert(outputs[k].end(), pOutput, pOutput + param.outputBitstreamLen);
+            for (int i = 0; i < tilesNum; i++)
+            {
+                tiles[i].pTiledBitstreamBuffer += tiles[i].curBufferLen;
+                tiles[i].inputBufferLen -= tiles[i].curBufferLen;
+            }
+        }
+        param.pOutputBitstream = pOutputBuffer;
+        delete[] pOutput;
+        I360SCVP_unInit(pI360SCVP);
+    }
+    EXPECT_TRUE(outputs[0] == outputs[1]);
+}
+
+TEST_F(I360SCVPTest, MergeScatterOutput)
+{
+    // the concatenated pieces of the scatter output must be the copied merged frame
+    std::vector<unsigned char> outputs[2];
+    for (int k = 0; k < 2; k++)
+    {
+        param.usedType = E_MERGE_AND_VIEWPORT;
+        param.paramViewPort.faceWidth = frameWidth;
+        param.paramViewPort.faceHeight = frameHeight;
+        param.paramViewPort.geoTypeInput = EGeometryType(E_SVIDEO_EQUIRECT);
+        param.paramViewPort.viewportHeight = 960;
+        param.paramViewPort.viewportWidth = 960;
+        param.paramViewPort.geoTypeOutput = E_SVIDEO_VIEWPORT;
+        param.paramViewPort.viewPortYaw = -90;
+        param.paramViewPort.viewPortPitch = 0;
+        param.paramViewPort.viewPortFOVH = 80;
+        param.paramViewPort.viewPortFOVV = 80;
+        param.bScatterOutput = (k == 1);
+        void* pI360SCVP = I360SCVP_Init(&param);
+        EXPECT_TRUE(pI360SCVP != NULL);
+        if (!pI360SCVP)
+            return;
+
+        int ret = I360SCVP_process(&param, pI360SCVP);
+        EXPECT_TRUE(ret == 0);
+        if (param.bScatterOutput)
+        {
+            EXPECT_TRUE(param.pOutputSegments != NULL);
+            EXPECT_TRUE(param.outputSegmentsNum > 1);
+            for (uint32_t i = 0; i < param.outputSegmentsNum; i++)
+                outputs[k].insert(outputs[k].end(), param.pOutputSegments[i].pData,
+                    param.pOutputSegments[i].pData + param.pOutputSegments[i].length);
+        }
+        else
+        {
+            EXPECT_TRUE(param.pOutputSegments == NULL);
+            outputs[k].insert(outputs[k].end(), pOutputBuffer, pOutputBuffer + param.outputBitstreamLen);
+        }
+        EXPECT_TRUE(outputs[k].size() == param.outputBitstreamLen);
+        I360SCVP_unInit(pI360SCVP);
+    }
+    EXPECT_TRUE(outputs[0].size() > 0);
+    EXPECT_TRUE(outputs[0] == outputs[1]);
+}
+
+// byte by byte NAL split with the start code and emulation prevention rules of the parsers
+static std::vector<param_nalIndex> RefScanNALs(const uint8_t *data, uint32_t size)
+{
+    std::vector<param_nalIndex> nals;
+    for (uint32_t i = 0; i + 2 < size; i++)
+    {
+        if (data[i] || data[i + 1] || data[i + 2] != 1)
+            continue;
+        param_nalIndex nal;
+        nal.startCodeOffset = (i > 0 && !data[i - 1]) ? i - 1 : i;
+        nal.startCodeSize = i + 3 - nal.startCodeOffset;
+        nal.naluSize = 0;
+        nal.emulationBytesNum = 0;
+        if (!nals.empty())
+            nals.back().naluSize = nal.startCodeOffset - nals.back().startCodeOffset;
+        nals.push_back(nal);
+        i += 2;
+    }
+    if (!nals.empty())
+        nals.back().naluSize = size - nals.back().startCodeOffset;
+    for (size_t k = 0; k < nals.size(); k++)
+    {
+        const int8_t *nal = (const int8_t*)data + nals[k].startCodeOffset;
+        uint32_t zeros = 0;
+        for (uint32_t n = 0; n < nals[k].naluSize; n++)
+        {
+            if (zeros == 2 && nal[n] == 0x03 && n + 1 < nals[k].naluSize && nal[n + 1] < 0x04)
+            {
+                zeros = 0;
+                nals[k].emulationBytesNum++;
+                n++;
+            }
+            zeros = nal[n] ? 0 : zeros + 1;
+        }
+    }
+    return nals;
+}
+
+static bool SameNALs(const std::vector<param_nalIndex>& ref, const param_nalIndex *pNals, int32_t nalsNum)
+{
+    if (nalsNum != (int32_t)ref.size())
+        return false;
+    for (int32_t i = 0; i < nalsNum; i++)
+    {
+        if (ref[i].startCodeOffset != pNals[i].startCodeOffset || ref[i].startCodeSize != pNals[i].startCodeSize
+            || ref[i].naluSize != pNals[i].naluSize || ref[i].emulationBytesNum != pNals[i].emulationBytesNum)
+            return false;
+    }
+    return true;
+}
+
+TEST_F(I360SCVPTest, ScanNALs)
+{
+    std::vector<param_nalIndex> ref = RefScanNALs(pInputBuffer, bufferlen);
+    EXPECT_TRUE(ref.size() > 10);
+    EXPECT_TRUE(I360SCVP_ScanNALs(pInputBuffer, bufferlen, NULL, 0) == (int32_t)ref.size());
+    std::vector<param_nalIndex> nals(ref.size());
+    int32_t nalsNum = I360SCVP_ScanNALs(pInputBuffer, bufferlen, nals.data(), nals.size());
+    EXPECT_TRUE(SameNALs(ref, nals.data(), nalsNum));
+    uint32_t emulationBytes = 0;
+    for (size_t i = 0; i < ref.size(); i++)
+        emulationBytes += ref[i].emulationBytesNum;
+    EXPECT_TRUE(emulationBytes > 0);
+
+    // dense zeros, start codes and emulation patterns at every alignment of the vector loads
+    const uint8_t patterns[][4] = { {0, 0, 1, 0x40}, {0, 0, 0, 1}, {0, 0, 3, 1}, {0, 0, 3, 0}, {0, 0, 3, 0x80}, {0, 0, 0, 3} };
+    std::vector<uint8_t> buffer(4096);
+    uint32_t seed = 12345;
+    bool match = true;
+    for (int round = 0; round < 200; round++)
+    {
+        for (size_t i = 0; i < buffer.size(); i++)
+        {
+            seed = seed * 1103515245 + 12345;
+            buffer[i] = ((seed >> 16) & 3) ? (uint8_t)(seed >> 24) : 0;
+        }
+        for (int k = 0; k < 40; k++)
+        {
+            seed = seed * 1103515245 + 12345;
+            uint32_t pos = (seed >> 8) % (buffer.size() - 4);
+            memcpy(&buffer[pos], patterns[(seed >> 4) % 6], 4);
+        }
+        uint32_t size = buffer.size() - round;
+        ref = RefScanNALs(buffer.data(), size);
+        nals.resize(ref.size() + 1);
+        nalsNum = I360SCVP_ScanNALs(buffer.data(), size, nals.data(), nals.size());
+        match = match && SameNALs(ref, nals.data(), nalsNum);
+    }
+    EXPECT_TRUE(match);
+}
+
+// parameter sets and the first slices of one frame of one resolution
+struct MergeInput
+{
+    std::vector<uint8_t>              header;
+    std::vector<std::vector<uint8_t>> tiles;
+};
+
+static MergeInput GetMergeInput(const uint8_t *data, const std::vector<param_nalIndex>& nals,
+    int frame, int tilesPerFrame, int selectedNum)
+{
+    // parameter sets ahead of the first slice are the header, parameter sets repeated
+    // later are skipped, so are SEIs
+    MergeInput input;
+    std::vector<size_t> slices;
+    for (size_t i = 0; i < nals.size(); i++)
+    {
+        int32_t nalType = (data[nals[i].startCodeOffset + nals[i].startCodeSize] >> 1) & 0x3f;
+        if (nalType < 32)
+            slices.push_back(i);
+        else if (slices.empty() && nalType <= 34)
+            input.header.insert(input.header.end(), data + nals[i].startCodeOffset,
+                data + nals[i].startCodeOffset + nals[i].naluSize);
+    }
+    for (int i = 0; i < selectedNum && (size_t)(frame * tilesPerFrame + i) < slices.size(); i++)
+    {
+        const param_nalIndex& nal = nals[slices[frame * tilesPerFrame + i]];
+        input.tiles.push_back(std::vector<uint8_t>(data + nal.startCodeOffset, data + nal.startCodeOffset + nal.naluSize));
+    }
+    return input;
+}
+
+// merge 2x2 high resolution tiles and 2 low resolution tiles of one frame, by a fresh
+// handle if handle is NULL, inputs are copied since parsing may move data in place
+static int MergeFrame(void *handle, MergeInput hr, MergeInput lr, std::vector<uint8_t>& output)
+{
+    if (hr.tiles.size() != 4 || lr.tiles.size() != 2)
+        return -1;
+
+    param_oneStream_info headers[2];
+    param_oneStream_info tiles[6];
+    param_oneStream_info *pHrTiles[4];
+    param_oneStream_info *pLrTiles[2];
+    memset(headers, 0, sizeof(headers));
+    memset(tiles, 0, sizeof(tiles));
+    headers[0].pTiledBitstreamBuffer = hr.header.data();
+    headers[0].inputBufferLen = hr.header.size();
+    headers[1].pTiledBitstreamBuffer = lr.header.data();
+    headers[1].inputBufferLen = lr.header.size();
+    uint32_t inputLen = hr.header.size() + lr.header.size();
+    for (int i = 0; i < 6; i++)
+    {
+        std::vector<uint8_t>& tile = (i < 4) ? hr.tiles[i] : lr.tiles[i - 4];
+        tiles[i].pTiledBitstreamBuffer = tile.data();
+        tiles[i].inputBufferLen = tile.size();
+        inputLen += tile.size();
+        if (i < 4)
+            pHrTiles[i] = &tiles[i];
+        else
+            pLrTiles[i - 4] = &tiles[i];
+    }
+
+    param_mergeStream mergeParam;
+    memset(&mergeParam, 0, sizeof(mergeParam));
+    mergeParam.highRes.width = 3840;
+    mergeParam.highRes.height = 2048;
+    mergeParam.highRes.selectedTilesCount = 4;
+    mergeParam.highRes.tile_width = 384;
+    mergeParam.highRes.tile_height = 256;
+    mergeParam.highRes.num_tile_columns = 2;
+    mergeParam.highRes.num_tile_rows = 2;
+    mergeParam.highRes.bOrdered = true;
+    mergeParam.highRes.pHeader = &headers[0];
+    mergeParam.highRes.pTiledBitstreams = pHrTiles;
+    mergeParam.lowRes.width = 1280;
+    mergeParam.lowRes.height = 768;
+    mergeParam.lowRes.selectedTilesCount = 2;
+    mergeParam.lowRes.tile_width = 256;
+    mergeParam.lowRes.tile_height = 256;
+    mergeParam.lowRes.pHeader = &headers[1];
+    mergeParam.lowRes.pTiledBitstreams = pLrTiles;
+    mergeParam.bWroteHeader = true;
+
+    std::vector<uint8_t> buffer(inputLen * 2);
+    mergeParam.pOutputBitstream = buffer.data();
+
+    bool isFresh = !handle;
+    if (isFresh)
+        handle = tile_merge_Init(&mergeParam);
+    if (!handle)
+        return -1;
+
+    int ret = tile_merge_reset(handle);
+    if (!ret)
+        ret = tile_merge_Process(&mergeParam, handle);
+    if (!ret)
+        output.assign(buffer.data(), buffer.data() + mergeParam.outputiledbistreamlen);
+
+    if (isFresh)
+        tile_merge_Close(handle);
+    return ret;
+}
+
+TEST_F(I360SCVPTest, MergeFramesKeptState)
+{
+    // frames merged through one handle must be the same as merged by a fresh handle
+    // each, also when high resolution input switches to another stream of the same
+    // size with different VPS, SPS and PPS, and back
+    FILE *pOtherFile = fopen("./test.h265", "rb");
+    EXPECT_TRUE(pOtherFile != NULL);
+    if (!pOtherFile)
+        return;
+    std::vector<uint8_t> other(bufferlen);
+    other.resize(fread(other.data(), 1, other.size(), pOtherFile));
+    fclose(pOtherFile);
+
+    std::vector<param_nalIndex> hrNals = RefScanNALs(pInputBuffer, bufferlen);
+    std::vector<param_nalIndex> otherNals = RefScanNALs(other.data(), other.size());
+    std::vector<param_nalIndex> lrNals = RefScanNALs(pInputBufferlow, bufferlenlow);
+
+    // test.265 has 80 tiles and test.h265 has 16 tiles in each frame
+    const int framesNum = 6;
+    const bool isOther[framesNum] = { false, false, true, true, false, false };
+    std::vector<MergeInput> hrInputs;
+    std::vector<MergeInput> lrInputs;
+    for (int frame = 0; frame < framesNum; frame++)
+    {
+        if (isOther[frame])
+            hrInputs.push_back(GetMergeInput(other.data(), otherNals, frame, 16, 4));
+        else
+            hrInputs.push_back(GetMergeInput(pInputBuffer, hrNals, frame, 80, 4));
+        lrInputs.push_back(GetMergeInput(pInputBufferlow, lrNals, frame, 15, 2));
+    }
+    EXPECT_TRUE(hrInputs[0].header != hrInputs[2].header);
+
+    param_mergeStream initParam;
+    memset(&initParam, 0, sizeof(initParam));
+    initParam.highRes.selectedTilesCount = 4;
+    initParam.highRes.tile_width = 384;
+    initParam.highRes.tile_height = 256;
+    initParam.lowRes.selectedTilesCount = 2;
+    initParam.lowRes.tile_width = 256;
+    initParam.lowRes.tile_height = 256;
+    void *pMerge = tile_merge_Init(&initParam);
+    EXPECT_TRUE(pMerge != NULL);
+    if (!pMerge)
+        return;
+
+    for (int frame = 0; frame < framesNum; frame++)
+    {
+        std::vector<uint8_t> kept;
+        std::vector<uint8_t> fresh;
+        EXPECT_TRUE(MergeFrame(pMerge, hrInputs[frame], lrInputs[frame], kept) == 0);
+        EXPECT_TRUE(MergeFrame(NULL, hrInputs[frame], lrInputs[frame], fresh) == 0);
+        EXPECT_TRUE(kept.size() > 0);
+        EXPECT_TRUE(kept == fresh);
+    }
+    tile_merge_Close(pMerge);
+}
 }
@@ -42,6 +42,8 @@
 #include <stdlib.h>
 #include <unistd.h>
 #include <map>
+#include <math.h>
+#include <chrono>
 
 #define MAX_PATH_COUNT 1024
 
@@ -65,6 +67,19 @@ DownloadManager::DownloadManager()
     // same random file name, so ignore 0
     m_count = 1;
     mUseCache = false;
+    mActiveTransfers = 0;
+    mSampleStartTime = 0;
+    mSampleBytes     = 0;
+    mLastDataTime    = 0;
+    mLastSample      = 0;
+    mFastAverage     = 0;
+    mSlowAverage     = 0;
+    mTotalSampleTime = 0;
+}
+
+static uint64_t GetTimeMs()
+{
+    return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
 }
 
 DownloadManager::~DownloadManager()
@@ -105,15 +120,150 @@ std::string DownloadManager::AssignCacheFileName()
     return file_name;
 }
 
+void DownloadManager::TransferStarted()
+{
+    std::lock_guard<std::mutex> lock(mStatMtx);
+
+    // a new sample begins when the link becomes busy
+    if (!mActiveTransfers)
+    {
+        mSampleStartTime = GetTimeMs();
+        mSampleBytes     = 0;
+        mLastDataTime    = mSampleStartTime;
+    }
+    mActiveTransfers++;
+}
+
+void DownloadManager::AddDownloadedBytes(uint64_t bytes)
+{
+    std::lock_guard<std::mutex> lock(mStatMtx);
+
+    mDownloadedBytes += bytes;
+    if (!mActiveTransfers)
+        return;
+
+    uint64_t now = GetTimeMs();
+
+    // nothing received for a long time, e.g. a transfer isn't reported
+    // as finished, so the idle time isn't counted into the sample
+    if (now - mLastDataTime > BANDWIDTH_SAMPLE_MAX_TIME)
+    {
+        CloseBandwidthSample(mLastDataTime);
+        mSampleStartTime = now;
+        mSampleBytes     = 0;
+    }
+
+    mSampleBytes += bytes;
+    mLastDataTime = now;
+
+    if (now - mSampleStartTime >= BANDWIDTH_SAMPLE_MAX_TIME)
+    {
+        CloseBandwidthSample(now);
+        mSampleStartTime = now;
+        mSampleBytes     = 0;
+    }
+}
+
+void DownloadManager::TransferFinished()
+{
+    std::lock_guard<std::mutex> lock(mStatMtx);
+
+    if (mActiveTransfers <= 0)
+        return;
+
+    mDownloadedFiles++;
+    mActiveTransfers--;
+    if (!mActiveTransfers)
+    {
+        CloseBandwidthSample(GetTimeMs());
+        mSampleBytes = 0;
+    }
+}
+
+void DownloadManager::CloseBandwidthSample(uint64_t endTime)
+{
+    uint64_t duration = endTime > mSampleStartTime ? endTime - mSampleStartTime : 0;
+    if (duration < BANDWIDTH_SAMPLE_MIN_TIME || mSampleBytes < BANDWIDTH_SAMPLE_MIN_BYTES)
+        return;
+
+    double seconds = duration / 1000.0;
+    double sample  = mSampleBytes * 8 / seconds;
+
+    // moving averages weighted by sample duration
+    double fastAlpha = pow(0.5, seconds / BANDWIDTH_FAST_HALF_LIFE);
+    double slowAlpha = pow(0.5, seconds / BANDWIDTH_SLOW_HALF_LIFE);
+    mFastAverage = fastAlpha * mFastAverage + (1 - fastAlpha) * sample;
+    mSlowAverage = slowAlpha * mSlowAverage + (1 - slowAlpha) * sample;
+    mTotalSampleTime += seconds;
+
+    mRecentSamples.push_back(sample);
+    while (mRecentSamples.size() > BANDWIDTH_HARMONIC_SAMPLES)
+        mRecentSamples.pop_front();
+
+    mLastSample = sample;
+
+    LOG(INFO) << "Bandwidth sample " << (uint64_t)sample << " bps of " << mSampleBytes << " bytes in " << duration << " ms" << endl;
+}
+
 /// get download bit rate
 int DownloadManager::GetImmediateBitrate()
 {
-    return 0;
+    std::lock_guard<std::mutex> lock(mStatMtx);
+    return (int)mLastSample;
 }
 
 int DownloadManager::GetAverageBitrate()
 {
-    return 0;
+    std::lock_guard<std::mutex> lock(mStatMtx);
+    if (mRecentSamples.empty())
+        return 0;
+
+    double reciprocalSum = 0;
+    for (auto sample : mRecentSamples)
+        reciprocalSum += 1 / sample;
+
+    return (int)(mRecentSamples.size() / reciprocalSum);
+}
+
+uint64_t DownloadManager::GetBandwidthEstimate()
+{
+    double harmonic = GetAverageBitrate();
+
+    std::lock_guard<std::mutex> lock(mStatMtx);
+    if (mTotalSampleTime <= 0)
+        return 0;
+
+    // averages start from 0, so correct them with total weight of samples
+    double fast = mFastAverage / (1 - pow(0.5, mTotalSampleTime / BANDWIDTH_FAST_HALF_LIFE));
+    double slow = mSlowAverage / (1 - pow(0.5, mTotalSampleTime / BANDWIDTH_SLOW_HALF_LIFE));
+
+    double estimate = fast < slow ? fast : slow;
+    if (harmonic > 0 && harmonic < estimate)
+        estimate = harmonic;
+
+    return (uint64_t)estimate;
+}
+
+void DownloadManager::AddDownloadingSegment(int adaptationSetID, OmafSegment* segment)
+{
+    std::lock_guard<std::mutex> lock(mSegmentMtx);
+    mDownloadingSegments[segment] = adaptationSetID;
+}
+
+void DownloadManager::RemoveDownloadingSegment(OmafSegment* segment)
+{
+    std::lock_guard<std::mutex> lock(mSegmentMtx);
+    mDownloadingSegments.erase(segment);
+}
+
+void DownloadManager::VisitDownloadingSegments(int adaptationSetID, std::function<void(OmafSegment*)> func)
+{
+    std::lock_guard<std::mutex> lock(mSegmentMtx);
+    for (auto& it : mDownloadingSegments)
+    {
+        if (it.second == adaptationSetID)
+            func(it.first);
+    }
 }
 
 void DownloadManager::CleanCache()
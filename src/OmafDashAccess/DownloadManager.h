@@ -39,11 +39,23 @@
 
 #include "general.h"
 #include <mutex>
+#include <list>
+#include <map>
+#include <functional>
 
 typedef bool (*enum_dir_item)(void *cbck, std::string item_name, std::string item_path);
 
 VCD_OMAF_BEGIN
 
+#define BANDWIDTH_SAMPLE_MIN_TIME      50      //<! ms, shorter samples are dominated by request latency
+#define BANDWIDTH_SAMPLE_MAX_TIME      1000    //<! ms, samples are closed periodically while downloading continuously
+#define BANDWIDTH_SAMPLE_MIN_BYTES     16384   //<! smaller samples are dominated by request latency
+#define BANDWIDTH_FAST_HALF_LIFE       2.0     //<! second, half life of fast moving average
+#define BANDWIDTH_SLOW_HALF_LIFE       8.0     //<! second, half life of slow moving average
+#define BANDWIDTH_HARMONIC_SAMPLES     5       //<! samples number for harmonic mean
+
+class OmafSegment;
+
 class DownloadManager {
 public:
     DownloadManager();
@@ -78,15 +90,57 @@ public:
     std::string AssignCacheFileName();
 
     //!
-    //! \brief  Get a downloading bit rate
+    //! \brief  Note that one segment transfer starts, the link is
+    //!         regarded as busy while there is transfer ongoing
+    //!
+    void TransferStarted();
+
+    //!
+    //! \brief  Add bytes received by ongoing transfers
+    //!
+    void AddDownloadedBytes(uint64_t bytes);
+
+    //!
+    //! \brief  Note that one segment transfer finishes or is stopped
+    //!
+    void TransferFinished();
+
+    //!
+    //! \brief  Get a downloading bit rate, of the latest bandwidth sample
     //!
     int GetImmediateBitrate();
 
     //!
-    //! \brief  Get an average downloading bit rate
+    //! \brief  Get an average downloading bit rate, harmonic mean of
+    //!         the latest bandwidth samples
     //!
     int GetAverageBitrate();
 
+    //!
+    //! \brief  Get the bandwidth estimation used for rate adaption in
+    //!         bits per second, the lowest one of the fast and slow
+    //!         moving averages and the harmonic mean, 0 if no sample yet
+    //!
+    uint64_t GetBandwidthEstimate();
+
+    //!
+    //! \brief  Record media segment of the adaptation set whose download
+    //!         is being started, it is kept until the segment is
+    //!         downloaded, stopped or destroyed
+    //!
+    void AddDownloadingSegment(int adaptationSetID, OmafSegment* segment);
+
+    //!
+    //! \brief  Remove segment which isn't downloading any more
+    //!
+    void RemoveDownloadingSegment(OmafSegment* segment);
+
+    //!
+    //! \brief  Call func for each downloading segment of the adaptation
+    //!         set, the segments are not destroyed before func returns
+    //!
+    void VisitDownloadingSegments(int adaptationSetID, std::function<void(OmafSegment*)> func);
+
     //!
     //! \brief  Get/Set methods for properties
     //!
@@ -142,8 +196,14 @@ private:
     //!
     std::string GetRandomString(int size);
 
+    //!
+    //! \brief  finish current bandwidth sample at endTime and update
+    //!         the estimations with it, called with mStatMtx locked
+    //!
+    void CloseBandwidthSample(uint64_t endTime);
+
 private:
-    int                            mDownloadedBytes;    //<! the total downloaded bytes
+    uint64_t                       mDownloadedBytes;    //<! the total downloaded bytes
     int                            mDownloadedFiles;    //<! the total downloaded files
     std::string                    mCacheDir;           //<! the directory of the cache file
     std::string                    mFilePrefix;         //<! the prefix for each cached file
@@ -153,6 +213,18 @@ private:
     bool                           mUseCache;           //<! the flag to indicate whether using file caching
     int32_t                        m_count;             //<! count for random file name
     std::mutex                     mCacheMtx;                //<! mutex for cache clear
+    std::mutex                     mStatMtx;            //<! mutex for bandwidth statistics
+    int32_t                        mActiveTransfers;    //<! transfers number ongoing
+    uint64_t                       mSampleStartTime;    //<! ms, start time of current bandwidth sample
+    uint64_t                       mSampleBytes;        //<! bytes received in current bandwidth sample
+    uint64_t                       mLastDataTime;       //<! ms, the time data is received last time
+    double                         mLastSample;         //<! bits per second of the latest sample
+    double                         mFastAverage;        //<! fast moving average, not corrected by total weight
+    double                         mSlowAverage;        //<! slow moving average, not corrected by total weight
+    double                         mTotalSampleTime;    //<! second, total duration of all samples
+    std::list<double>              mRecentSamples;      //<! latest samples for harmonic mean
+    std::mutex                     mSegmentMtx;         //<! mutex for downloading segments
+    std::map<OmafSegment*, int>    mDownloadingSegments;//<! <segment, adaptation set ID> of downloading segments
 };
 
 typedef VCD::VRVideo::Singleton<DownloadManager> DOWNLOADMANAGER;    //<! singleton of DownloadManager
@@ -40,6 +40,8 @@
 #include "general.h"
 #include "OmafMediaStream.h"
 
+#include <memory>
+
 VCD_OMAF_BEGIN
 
 class MediaPacket {
@@ -53,7 +55,6 @@ public:
         m_type = -1;
         mPts = 0;
         m_nRealSize = 0;
-        m_rwpk = NULL;
     };
 
     //!
@@ -64,7 +65,6 @@ public:
         memcpy(m_pPayload, buf, size);
         m_type = -1;
         mPts = 0;
-        m_rwpk = NULL;
     };
 
     //!
@@ -79,8 +79,6 @@ public:
             mPts = 0;
             m_nRealSize = 0;
         }
-        if (m_rwpk != NULL)
-            deleteRwpk();
     };
 
     //!
@@ -156,6 +154,58 @@ public:
         return 0;
     };
 
+    //!
+    //! \brief  make sure the payload buffer can hold size bytes, the
+    //!         buffer is neither shrunk nor filled, and the data in
+    //!         it isn't kept
+    //!
+    //! \param  [in] size
+    //!         the needed buffer size
+    //!
+    //! \return
+    //!         allocated size of the packet, -1 if failed
+    //!
+    int ReservePacket(int size){
+        m_nRealSize = 0;
+        if( NULL != m_pPayload && size <= m_nAllocSize )
+            return m_nAllocSize;
+
+        if( NULL != m_pPayload ){
+            free(m_pPayload);
+            m_pPayload = NULL;
+            m_nAllocSize = 0;
+        }
+
+        m_pPayload = (char*)malloc( size );
+
+        if(NULL == m_pPayload) return -1;
+
+        m_nAllocSize = size;
+        return size;
+    };
+
+    //!
+    //! \brief  get the allocated size of the payload buffer
+    //!
+    //! \return
+    //!         allocated size of the packet
+    //!
+    int AllocatedSize(){ return m_nAllocSize; };
+
+    //!
+    //! \brief  clear the packet information so that the packet and
+    //!         its buffer can be reused for another sample
+    //!
+    //! \return
+    //!
+    //!
+    void Reset(){
+        m_type = -1;
+        mPts = 0;
+        m_nRealSize = 0;
+        m_rwpk.reset();
+    };
+
     //!
     //! \brief  Set the type for packet
     //!
@@ -178,30 +228,43 @@ public:
     void SetRealSize(uint64_t realSize) { m_nRealSize = realSize; };
     uint64_t GetRealSize() { return m_nRealSize; };
 
-    void SetRwpk(RegionWisePacking *rwpk) { m_rwpk = rwpk; };
-    RegionWisePacking* GetRwpk() { return m_rwpk; };
+    //!
+    //! \brief  Set region wise packing owned by this packet only
+    //!
+    void SetRwpk(RegionWisePacking *rwpk) { m_rwpk.reset(rwpk, DeleteRwpk); };
 
-private:
-    char* m_pPayload;                    //!<the payload buffer of the packet
-    int   m_nAllocSize;                  //!<the allocated size of packet
-    uint64_t m_nRealSize;                //!< real size of packet
-    int   m_type;                        //!<the type of the payload
-    uint64_t mPts;
-    RegionWisePacking *m_rwpk;
+    //!
+    //! \brief  Set region wise packing shared with other packets, e.g.
+    //!         packets of samples with the same sample entry
+    //!
+    void SetRwpk(std::shared_ptr<RegionWisePacking> rwpk) { m_rwpk = rwpk; };
 
-    void deleteRwpk()
+    RegionWisePacking* GetRwpk() { return m_rwpk.get(); };
+    std::shared_ptr<RegionWisePacking> GetSharedRwpk() { return m_rwpk; };
+
+    //!
+    //! \brief  delete region wise packing and its regions
+    //!
+    static void DeleteRwpk(RegionWisePacking *rwpk)
     {
-        if (m_rwpk != NULL)
+        if (rwpk != NULL)
         {
-            if (m_rwpk->rectRegionPacking != NULL)
+            if (rwpk->rectRegionPacking != NULL)
             {
-                delete []m_rwpk->rectRegionPacking;
-                m_rwpk->rectRegionPacking = NULL;
+                delete []rwpk->rectRegionPacking;
+                rwpk->rectRegionPacking = NULL;
             }
-            delete m_rwpk;
-            m_rwpk = NULL;
+            delete rwpk;
         }
     }
+
+private:
+    char* m_pPayload;                    //!<the payload buffer of the packet
+    int   m_nAllocSize;                  //!<the allocated size of packet
+    uint64_t m_nRealSize;                //!< real size of packet
+    int   m_type;                        //!<the type of the payload
+    uint64_t mPts;
+    std::shared_ptr<RegionWisePacking> m_rwpk; //!< region wise packing of the packet, may be shared by packets
 };
 
 VCD_OMAF_END;
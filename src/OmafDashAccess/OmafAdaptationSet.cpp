@@ -34,6 +34,7 @@
  */
 
 #include "OmafAdaptationSet.h"
+#include "DownloadManager.h"
 #include <sys/time.h>
 #include <sys/timeb.h>
 
@@ -58,12 +59,14 @@ OmafAdaptationSet::OmafAdaptationSet()
     mReEnable          = false;
     mPF                = PF_UNKNOWN;
     mSegmentDuration   = 0;
+    mAvailabilityTimeOffset = 0;
     mTrackNumber       = 0;
     mStartNumber       = 0;
     mID                = 0;
     mType              = MediaType_NONE;
     mFpt               = FP_UNKNOWN;
     mRwpkType          = RWPK_UNKNOWN;
+    mDownloadPriority  = 0;
     memset(&mVideoInfo, 0, sizeof(VideoInfo));
     memset(&mAudioInfo, 0, sizeof(AudioInfo));
     pthread_mutex_init(&mMutex, NULL);
@@ -120,6 +123,7 @@ int OmafAdaptationSet::Initialize(AdaptationSetElement* pAdaptationSet)
     if(NULL != segment){
         mStartNumber       = segment->GetStartNumber();
         mSegmentDuration = segment->GetDuration() / segment->GetTimescale();
+        mAvailabilityTimeOffset = (uint64_t)(segment->GetAvailabilityTimeOffset() * 1000);
     }
 
     // mAudioInfo.sample_rate = parse_int( mRepresentation->GetAudioSamplingRate().c_str() );
@@ -150,7 +154,8 @@ int  OmafAdaptationSet::SelectRepresentation( )
 {
     std::vector<RepresentationElement*> pRep = mAdaptationSet->GetRepresentations();
 
-    ///FIX; so far choose the first rep in the Representation list
+    // start from the first rep in the Representation list, the following
+    // segments are switched by RepresentationSelector with bandwidth
     this->mRepresentation = pRep[0];
 
     return ERROR_NONE;
@@ -382,6 +387,11 @@ int OmafAdaptationSet::DownloadSegment( )
     }
 
     pSegment->SetInitSegID(this->mInitSegment->GetInitSegID());
+    pSegment->SetDownloadPriority(mDownloadPriority);
+
+    // record it before download starts, since it may be finished and
+    // handed to reader manager at any time after Open
+    DOWNLOADMANAGER::GetInstance()->AddDownloadingSegment(mID, pSegment);
 
     ret = pSegment->Open();
 
@@ -405,6 +415,17 @@ int OmafAdaptationSet::DownloadSegment( )
     return ret;
 }
 
+void OmafAdaptationSet::SetDownloadPriority(int32_t priority)
+{
+    if (mDownloadPriority == priority)
+        return;
+
+    mDownloadPriority = priority;
+
+    DOWNLOADMANAGER::GetInstance()->VisitDownloadingSegments(mID,
+        [priority](OmafSegment* segment) { segment->SetDownloadPriority(priority); });
+}
+
 /////read relative methods
 int OmafAdaptationSet::UpdateStartNumberByTime(uint64_t nAvailableStartTime)
 {
@@ -429,7 +450,8 @@ int OmafAdaptationSet::UpdateStartNumberByTime(uint64_t nAvailableStartTime)
 
         return -1;
     }
-    mActiveSegNum = (current - nAvailableStartTime) / (mSegmentDuration * 1000) + mStartNumber;
+    // segments published in chunks can be requested before they are complete
+    mActiveSegNum = (current - nAvailableStartTime + mAvailabilityTimeOffset) / (mSegmentDuration * 1000) + mStartNumber;
 
     LOG(INFO) << "current " << current << " and available time " << nAvailableStartTime << " Start segment index " << mActiveSegNum << endl;
     return mActiveSegNum;
@@ -92,6 +92,12 @@ public:
     //!
     int DownloadSegment( );
 
+    //!
+    //! \brief  Set download priority of the segments, and reorder the
+    //!         segment downloads which are not started yet
+    //!
+    void SetDownloadPriority(int32_t priority);
+
     //!
     //! \brief  Select representation from
     //!
@@ -165,6 +171,7 @@ public:
         return 0;
     };
     bool                      IsEnabled()                                  { return mEnable;              };
+    int32_t                   GetDownloadPriority()                        { return mDownloadPriority;    };
 
     virtual OmafAdaptationSet* GetClassType(){
         return this;
@@ -199,6 +206,7 @@ protected:
     int                                   mID;               //<! the ID of this adaption Set. ?trackID
     std::vector<int>                      mDependIDs;         //<! the ID this adaption Set depends on
     uint64_t                              mSegmentDuration;  //<! Segment duration as advertised in the MPD
+    uint64_t                              mAvailabilityTimeOffset; //<! time in ms by which segments are available earlier as advertised in the MPD
     int                                   mStartNumber;      //<! the first number of segment after getting
                                                              //<! mpd which is used to get first segment for downloading
     int                                   mActiveSegNum;     //<! the segment are being processed
@@ -219,6 +227,7 @@ protected:
     bool                                  mEnable;           //<! is Adaptation Set enabled
     bool                                  mReEnable;         //<! flag for Adaption Set is re-enabled
     std::list<bool>                       mEnableRecord;     //<! record the last 3 enable changes
+    int32_t                               mDownloadPriority; //<! download priority of the segments
 };
 
 VCD_OMAF_END;
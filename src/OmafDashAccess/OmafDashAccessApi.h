@@ -60,11 +60,15 @@ typedef enum{
  * source_type : the structure of videos in the mpd to be processed
  * cache_path : the directory to store cached downloaded files; a default path
  *              will be used if it is ""
+ * viewport_lut_step : the quantization step in degree of yaw/pitch for the
+ *              viewport lookup table; the default step will be used if it is 0,
+ *              and the table is disabled if it is negative
  */
 typedef struct DASHSTREAMINGCLIENT{
     const char*        media_url;
     SourceType         source_type;
     const char*        cache_path;
+    float              viewport_lut_step;
 } DashStreamingClient;
 
 /*
@@ -38,6 +38,7 @@
 #include "general.h"
 #include "OmafMediaSource.h"
 #include "OmafDashSource.h"
+#include "OmafReaderManager.h"
 #include "../utils/GlogWrapper.h"
 
 using namespace std;
@@ -56,6 +57,7 @@ int OmafAccess_OpenMedia( Handler hdl, DashStreamingClient* pCtx, bool enablePre
 {
     OmafMediaSource* pSource = (OmafMediaSource*)hdl;
     pSource->SetLoop(false);
+    pSource->SetViewportLUTStep(pCtx->viewport_lut_step);
     return pSource->OpenMedia(pCtx->media_url, pCtx->cache_path, enablePredictor);
 }
 
@@ -123,7 +125,8 @@ int OmafAccess_GetPacket(
         packet[i].size = outSize;
         i++;
 
-        delete pPkt;
+        // data has been copied out, packet is reused by reader
+        READERMANAGER::GetInstance()->ReleasePacket(pPkt);
         pPkt = NULL;
     }
 
@@ -41,6 +41,8 @@ OmafCurlDownloader::OmafCurlDownloader()
     m_endTime      = 0;
     m_startTime    = 0;
     m_curlHandler  = NULL;
+    m_downloadedSize = 0;
+    m_priority     = 0;
 }
 
 OmafCurlDownloader::OmafCurlDownloader(string url):OmafCurlDownloader()
@@ -60,16 +62,14 @@ OmafCurlDownloader::~OmafCurlDownloader()
 
 ODStatus OmafCurlDownloader::InitCurl()
 {
-    curl_global_init(CURL_GLOBAL_ALL);
-
-    m_curlHandler = curl_easy_init();
+    m_curlHandler = CURLMULTIENGINE::GetInstance()->AcquireHandle();
     CheckNullPtr_PrintLog_ReturnStatus(m_curlHandler, "failed to init curl library.", ERROR, OD_STATUS_OPERATION_FAILED);
 
     curl_easy_setopt(m_curlHandler, CURLOPT_URL, m_url.c_str());
-    curl_easy_setopt(m_curlHandler, CURLOPT_SSL_VERIFYPEER, 0L);
-    curl_easy_setopt(m_curlHandler, CURLOPT_SSL_VERIFYHOST, 0L);
     curl_easy_setopt(m_curlHandler, CURLOPT_WRITEFUNCTION, CallBackForCurl);
     curl_easy_setopt(m_curlHandler, CURLOPT_WRITEDATA, (void*)this);
+    curl_easy_setopt(m_curlHandler, CURLOPT_HEADERFUNCTION, HeaderCallBackForCurl);
+    curl_easy_setopt(m_curlHandler, CURLOPT_HEADERDATA, (void*)this);
     return OD_STATUS_SUCCESS;
 }
 
@@ -84,19 +84,58 @@ ODStatus OmafCurlDownloader::Start()
     st = InitCurl();
     CheckAndReturn(st);
 
-    StartThread(true);
-
     m_startTime = chrono::duration_cast<std::chrono::milliseconds>(m_clock.now().time_since_epoch()).count();
 
+    // status must be set before the request may be finished by engine
     SetStatus(DOWNLOADING);
 
+    LOG(INFO)<<"now download "<<m_url<<endl;
+
+    CURL *handle = m_curlHandler;
+    m_curlHandler = NULL;
+    st = CURLMULTIENGINE::GetInstance()->AddRequest(this, handle, m_priority);
+    if (st != OD_STATUS_SUCCESS)
+    {
+        CURLMULTIENGINE::GetInstance()->ReleaseHandle(handle);
+        SetStatus(STOPPED);
+        m_stream.ReachedEOS();
+    }
+
     return st;
 }
 
 ODStatus OmafCurlDownloader::Stop()
 {
+    DownloaderStatus status = GetStatus();
+    if (status == NOT_START || status == STOPPED)
+    {
+        SetStatus(STOPPED);
+        return OD_STATUS_SUCCESS;
+    }
+
     this->SetStatus(STOPPING);
-    this->Join();
+
+    // the request is cancelled if it isn't finished yet, else engine
+    // has finished notifying this downloader when RemoveRequest returns
+    if (CURLMULTIENGINE::GetInstance()->RemoveRequest(this) == OD_STATUS_SUCCESS)
+    {
+        m_stream.ReachedEOS();
+    }
+
+    if (GetStatus() != STOPPED)
+        SetStatus(STOPPED);
+
+    return OD_STATUS_SUCCESS;
+}
+
+ODStatus OmafCurlDownloader::SetPriority(int32_t priority)
+{
+    m_priority = priority;
+
+    // reorder the request if it is still waiting to be started
+    if (GetStatus() == DOWNLOADING)
+        CURLMULTIENGINE::GetInstance()->UpdatePriority(this, priority);
+
     return OD_STATUS_SUCCESS;
 }
 
@@ -105,6 +144,11 @@ ODStatus OmafCurlDownloader::Read(uint8_t* data, size_t size)
     return m_stream.GetStream((char*)data, size);
 }
 
+ODStatus OmafCurlDownloader::Read(std::ostream& output, size_t size)
+{
+    return m_stream.GetStream(output, size);
+}
+
 ODStatus OmafCurlDownloader::Peek(uint8_t* data, size_t size)
 {
     return m_stream.PeekStream((char*)data, size);
@@ -115,29 +159,23 @@ ODStatus OmafCurlDownloader::Peek(uint8_t* data, size_t size, size_t offset)
     return m_stream.PeekStream((char*)data, size, offset);
 }
 
-void* OmafCurlDownloader::Download(void* downloader)
+void OmafCurlDownloader::TransferDone(CURLcode result)
 {
-    OmafCurlDownloader* curlDownloader = static_cast<OmafCurlDownloader*>(downloader);
-    LOG(INFO)<<"now download "<<curlDownloader->m_url<<endl;
-    curl_easy_perform(curlDownloader->m_curlHandler);
-    curl_easy_cleanup(curlDownloader->m_curlHandler);
-    curl_global_cleanup();
-
-    if(curlDownloader->GetStatus() == STOPPING)
-        curlDownloader->SetStatus(STOPPED);
+    if (result != CURLE_OK && GetStatus() != STOPPING)
+    {
+        LOG(WARNING)<<"download "<<m_url<<" failed, "<<curl_easy_strerror(result)<<endl;
+    }
+
+    // failed transfer is reported as stopped so that the partial data
+    // or error page isn't taken as segment data
+    if(GetStatus() == STOPPING || result != CURLE_OK)
+        SetStatus(STOPPED);
     else
     {
-        curlDownloader->SetStatus(DOWNLOADED);
+        SetStatus(DOWNLOADED);
     }
 
     m_stream.ReachedEOS();
-
-    return nullptr;
-}
-
-void OmafCurlDownloader::Run()
-{
-    Download(this);
 }
 
 ODStatus OmafCurlDownloader::ObserverAttach(OmafDownloaderObserver *observer)
@@ -186,7 +224,7 @@ ODStatus OmafCurlDownloader::NotifyDownloadedData()
     m_observerLock.lock();
     for(auto observer: m_observers)
     {
-        observer->DownloadDataNotify(this->m_stream.GetTotalStreamLength());
+        observer->DownloadDataNotify(this->m_downloadedSize);
     }
     m_observerLock.unlock();
 
@@ -195,6 +233,12 @@ ODStatus OmafCurlDownloader::NotifyDownloadedData()
 
 ODStatus OmafCurlDownloader::CleanUp()
 {
+    if (m_curlHandler)
+    {
+        CURLMULTIENGINE::GetInstance()->ReleaseHandle(m_curlHandler);
+        m_curlHandler = NULL;
+    }
+
     // make sure downloader is stopped or wait time is more than 10 mins
     int64_t waitTime = 0;
     while(m_status != STOPPED && waitTime < 6000000)
@@ -206,6 +250,26 @@ ODStatus OmafCurlDownloader::CleanUp()
     return OD_STATUS_SUCCESS;
 }
 
+size_t OmafCurlDownloader::HeaderCallBackForCurl(char* header, size_t dataSize, size_t typeSize, void* handle)
+{
+    OmafCurlDownloader* curlDownloder = (OmafCurlDownloader*) handle;
+    size_t size = dataSize * typeSize;
+
+    // reserve the whole segment in stream buffer once its length is known,
+    // header names are in lower case with HTTP/2
+    const char lengthField[] = "content-length:";
+    const size_t fieldSize = sizeof(lengthField) - 1;
+    if(size > fieldSize && !strncasecmp(header, lengthField, fieldSize))
+    {
+        string value(header + fieldSize, size - fieldSize);
+        uint64_t contentLength = strtoull(value.c_str(), NULL, 10);
+        if(contentLength)
+            curlDownloder->m_stream.Reserve(contentLength);
+    }
+
+    return size;
+}
+
 size_t OmafCurlDownloader::CallBackForCurl(void* downloadedData, size_t dataSize, size_t typeSize, void* handle)
 {
     OmafCurlDownloader* curlDownloder = (OmafCurlDownloader*) handle;
@@ -214,9 +278,9 @@ size_t OmafCurlDownloader::CallBackForCurl(void* downloadedData, size_t dataSize
         return 0;
 
     size_t size = dataSize * typeSize;
-    char* data = new char[size];
-    memcpy(data, downloadedData, size);
-    curlDownloder->m_stream.AddSubStream(data, size);
+    if(curlDownloder->m_stream.AddSubStream((char*)downloadedData, size) != OD_STATUS_SUCCESS)
+        return 0;
+    curlDownloder->m_downloadedSize += size;
 
     // notify all the observers that more data is downloaded
     curlDownloder->NotifyDownloadedData();
@@ -224,8 +288,11 @@ size_t OmafCurlDownloader::CallBackForCurl(void* downloadedData, size_t dataSize
     //calculate the download rate
     uint64_t endTime = chrono::duration_cast<std::chrono::milliseconds>(curlDownloder->m_clock.now().time_since_epoch()).count();
 
-    double downloadRate = curlDownloder->m_stream.GetTotalStreamLength() / ((endTime - curlDownloder->m_startTime) * 1000.0);
-    curlDownloder->SetDownloadRate(downloadRate);
+    if(endTime > curlDownloder->m_startTime)
+    {
+        double downloadRate = curlDownloder->m_downloadedSize * 1000.0 / (endTime - curlDownloder->m_startTime);
+        curlDownloder->SetDownloadRate(downloadRate);
+    }
 
     return size;
 }
@@ -35,6 +35,7 @@
 
 #include <curl/curl.h>
 #include "OmafDownloader.h"
+#include "OmafCurlMultiEngine.h"
 #include "Stream.h"
 #include "../OmafDashParser/SegmentElement.h"
 
@@ -44,9 +45,11 @@ VCD_OMAF_BEGIN
 
 //!
 //! \class:  OmafCurlDownloader
-//! \brief:  downloader with libcurl
+//! \brief:  downloader with libcurl, the transfer is driven by the
+//!          shared download engine instead of one thread for each
+//!          downloader
 //!
-class OmafCurlDownloader: public OmafDownloader, ThreadLock, Threadable
+class OmafCurlDownloader: public OmafDownloader, ThreadLock, CurlTransfer
 {
 public:
 
@@ -94,6 +97,19 @@ public:
     //!
     virtual ODStatus Read(uint8_t* data, size_t size);
 
+    //!
+    //! \brief    Read given size stream to output stream
+    //!
+    //! \param    [in] output
+    //!           output stream the read stream is written to
+    //! \param    [in] size
+    //!           size of stream that should read
+    //!
+    //! \return   ODStatus
+    //!           OD_STATUS_SUCCESS if success, else fail reason
+    //!
+    virtual ODStatus Read(std::ostream& output, size_t size);
+
     //!
     //! \brief    Peek given size stream to data pointer
     //!
@@ -153,9 +169,20 @@ public:
     virtual double GetDownloadRate();
 
     //!
-    //! \brief Interface implementation from base class: Threadable
+    //! \brief    Set download priority
+    //!
+    //! \param    [in] priority
+    //!           download priority
+    //!
+    //! \return   ODStatus
+    //!           OD_STATUS_SUCCESS if success, else fail reason
+    //!
+    virtual ODStatus SetPriority(int32_t priority);
+
+    //!
+    //! \brief Interface implementation from base class: CurlTransfer
     //!
-    virtual void Run();
+    virtual void TransferDone(CURLcode result);
 
 private:
 
@@ -176,7 +203,7 @@ private:
     ODStatus NotifyDownloadedData();
 
     //!
-    //! \brief    Initialize curl library
+    //! \brief    Get easy handle from download engine and set options
     //!
     //! \return   ODStatus
     //!           OD_STATUS_SUCCESS if success, else fail reason
@@ -209,14 +236,21 @@ private:
     static size_t CallBackForCurl(void* downloadedData, size_t dataSize, size_t typeSize, void* handle);
 
     //!
-    //! \brief    Download run in thread
+    //! \brief    Header callback function for curl
     //!
-    //! \param    [in] downloader
-    //!           the downloader handle
+    //! \param    [in] header
+    //!           pointer to one header line
+    //! \param    [in] dataSize
+    //!           size of data
+    //! \param    [in] typeSize
+    //!           size of data type
+    //! \param    [in] handle
+    //!           handle for this class
     //!
-    //! \return   void
+    //! \return   size_t
+    //!           the handled size
     //!
-    void* Download(void* downloader);
+    static size_t HeaderCallBackForCurl(char* header, size_t dataSize, size_t typeSize, void* handle);
 
     //!
     //! \brief    Set download status
@@ -254,10 +288,12 @@ private:
     Stream                                  m_stream;       //!< download stream
     CURL*                                   m_curlHandler;  //!< curl handle
     string                                  m_url;          //!< download url
+    int32_t                                 m_priority;     //!< download priority in download engine
 
     chrono::high_resolution_clock           m_clock;        //!< clock for calculating rate
     uint64_t                                m_startTime;    //!< download start time
     uint64_t                                m_endTime;      //!< download end time
+    uint64_t                                m_downloadedSize; //!< total size of downloaded data, including data already read from the stream
     double                                  m_downloadRate; //!< real-time download rate (bytes/s)
     ThreadLock                              m_rateLock;     //!< lock for download rate
 };
@@ -0,0 +1,393 @@
+/*
+ * Copyright (c) 2019, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+
+ */
+
+//!
+//! \file:   OmafCurlMultiEngine.cpp
+//! \brief:  download engine shared by all downloaders
+//!
+
+#include "OmafCurlMultiEngine.h"
+
+VCD_OMAF_BEGIN
+
+OmafCurlMultiEngine::OmafCurlMultiEngine()
+{
+    m_notifyingTransfer = NULL;
+    m_engineThread      = 0;
+    m_isStopped         = false;
+    pthread_mutex_init(&m_mutex, NULL);
+    pthread_cond_init(&m_requestCond, NULL);
+    pthread_cond_init(&m_removedCond, NULL);
+
+    // global initialization is done only once for all downloads
+    curl_global_init(CURL_GLOBAL_ALL);
+
+    m_multiHandle = curl_multi_init();
+    if (!m_multiHandle)
+    {
+        LOG(ERROR)<<"Failed to init curl multi handle!"<<endl;
+        return;
+    }
+
+    curl_multi_setopt(m_multiHandle, CURLMOPT_PIPELINING, CURLPIPE_MULTIPLEX);
+    curl_multi_setopt(m_multiHandle, CURLMOPT_MAX_HOST_CONNECTIONS, (long)DEFAULT_MAX_HOST_CONNECTIONS);
+
+    StartThread();
+}
+
+OmafCurlMultiEngine::~OmafCurlMultiEngine()
+{
+    if (m_multiHandle)
+    {
+        pthread_mutex_lock(&m_mutex);
+        m_isStopped = true;
+        pthread_cond_signal(&m_requestCond);
+        pthread_mutex_unlock(&m_mutex);
+
+        WakeUp();
+        Join();
+
+        for (auto request: m_activeRequests)
+        {
+            curl_multi_remove_handle(m_multiHandle, request.second);
+            curl_easy_cleanup(request.second);
+        }
+        m_activeRequests.clear();
+
+        curl_multi_cleanup(m_multiHandle);
+        m_multiHandle = NULL;
+    }
+
+    for (auto request: m_pendingRequests)
+    {
+        curl_easy_cleanup(request.second.handle);
+    }
+    m_pendingRequests.clear();
+
+    for (auto handle: m_idleHandles)
+    {
+        curl_easy_cleanup(handle);
+    }
+    m_idleHandles.clear();
+
+    curl_global_cleanup();
+
+    pthread_cond_destroy(&m_removedCond);
+    pthread_cond_destroy(&m_requestCond);
+    pthread_mutex_destroy(&m_mutex);
+}
+
+CURL* OmafCurlMultiEngine::AcquireHandle()
+{
+    CURL *handle = NULL;
+
+    pthread_mutex_lock(&m_mutex);
+    if (m_idleHandles.size())
+    {
+        handle = m_idleHandles.front();
+        m_idleHandles.pop_front();
+    }
+    pthread_mutex_unlock(&m_mutex);
+
+    if (!handle)
+    {
+        handle = curl_easy_init();
+        CheckNullPtr_PrintLog_ReturnStatus(handle, "failed to init curl library.", ERROR, NULL);
+    }
+
+    curl_easy_setopt(handle, CURLOPT_SSL_VERIFYPEER, 0L);
+    curl_easy_setopt(handle, CURLOPT_SSL_VERIFYHOST, 0L);
+    // segments being produced arrive in small chunks, don't delay them
+    curl_easy_setopt(handle, CURLOPT_TCP_NODELAY, 1L);
+    curl_easy_setopt(handle, CURLOPT_TCP_KEEPALIVE, 1L);
+    curl_easy_setopt(handle, CURLOPT_NOSIGNAL, 1L);
+    // HTTP error responses fail the transfer instead of delivering the body
+    curl_easy_setopt(handle, CURLOPT_FAILONERROR, 1L);
+    // prefer multiplexing on one HTTP/2 connection to opening new ones
+    curl_easy_setopt(handle, CURLOPT_HTTP_VERSION, (long)CURL_HTTP_VERSION_2TLS);
+    curl_easy_setopt(handle, CURLOPT_PIPEWAIT, 1L);
+
+    return handle;
+}
+
+void OmafCurlMultiEngine::ReleaseHandle(CURL* handle)
+{
+    if (!handle)
+        return;
+
+    pthread_mutex_lock(&m_mutex);
+    RecycleHandle(handle);
+    pthread_mutex_unlock(&m_mutex);
+}
+
+void OmafCurlMultiEngine::RecycleHandle(CURL* handle)
+{
+    if (m_idleHandles.size() >= MAX_IDLE_EASY_HANDLES)
+    {
+        curl_easy_cleanup(handle);
+        return;
+    }
+
+    curl_easy_reset(handle);
+    m_idleHandles.push_back(handle);
+}
+
+ODStatus OmafCurlMultiEngine::AddRequest(CurlTransfer* transfer, CURL* handle, int32_t priority)
+{
+    if (!transfer || !handle)
+        return OD_STATUS_INVALID;
+
+    CheckNullPtr_PrintLog_ReturnStatus(m_multiHandle, "The download engine is not initialized!", ERROR, OD_STATUS_OPERATION_FAILED);
+
+    SetStreamWeight(handle, priority);
+    curl_easy_setopt(handle, CURLOPT_PRIVATE, (void*)transfer);
+
+    CurlRequest request;
+    request.transfer = transfer;
+    request.handle   = handle;
+
+    pthread_mutex_lock(&m_mutex);
+    m_pendingRequests.insert(std::make_pair(priority, request));
+    pthread_cond_signal(&m_requestCond);
+    pthread_mutex_unlock(&m_mutex);
+
+    WakeUp();
+
+    return OD_STATUS_SUCCESS;
+}
+
+ODStatus OmafCurlMultiEngine::RemoveRequest(CurlTransfer* transfer)
+{
+    ODStatus ret = OD_STATUS_INVALID;
+
+    pthread_mutex_lock(&m_mutex);
+
+    for (auto it = m_pendingRequests.begin(); it != m_pendingRequests.end(); it++)
+    {
+        if (it->second.transfer == transfer)
+        {
+            RecycleHandle(it->second.handle);
+            m_pendingRequests.erase(it);
+            pthread_mutex_unlock(&m_mutex);
+            return OD_STATUS_SUCCESS;
+        }
+    }
+
+    if (m_activeRequests.find(transfer) != m_activeRequests.end())
+    {
+        m_cancelledRequests.push_back(transfer);
+        WakeUp();
+
+        while (m_activeRequests.find(transfer) != m_activeRequests.end())
+        {
+            pthread_cond_wait(&m_removedCond, &m_mutex);
+        }
+        ret = OD_STATUS_SUCCESS;
+    }
+
+    // the request may have just finished, wait until the transfer is
+    // notified unless it is removed in its own notification
+    while (m_notifyingTransfer == transfer && !pthread_equal(m_engineThread, pthread_self()))
+    {
+        pthread_cond_wait(&m_removedCond, &m_mutex);
+    }
+
+    pthread_mutex_unlock(&m_mutex);
+
+    return ret;
+}
+
+ODStatus OmafCurlMultiEngine::UpdatePriority(CurlTransfer* transfer, int32_t priority)
+{
+    pthread_mutex_lock(&m_mutex);
+
+    for (auto it = m_pendingRequests.begin(); it != m_pendingRequests.end(); it++)
+    {
+        if (it->second.transfer == transfer)
+        {
+            CurlRequest request = it->second;
+            if (it->first != priority)
+            {
+                m_pendingRequests.erase(it);
+                SetStreamWeight(request.handle, priority);
+                m_pendingRequests.insert(std::make_pair(priority, request));
+            }
+            pthread_mutex_unlock(&m_mutex);
+            return OD_STATUS_SUCCESS;
+        }
+    }
+
+    pthread_mutex_unlock(&m_mutex);
+
+    return OD_STATUS_INVALID;
+}
+
+void OmafCurlMultiEngine::SetStreamWeight(CURL* handle, int32_t priority)
+{
+    long weight = DEFAULT_STREAM_WEIGHT + priority;
+    if (weight < 1)
+        weight = 1;
+    if (weight > 256)
+        weight = 256;
+    curl_easy_setopt(handle, CURLOPT_STREAM_WEIGHT, weight);
+}
+
+void OmafCurlMultiEngine::UpdateActiveRequests()
+{
+    bool removed = false;
+    for (auto transfer: m_cancelledRequests)
+    {
+        auto it = m_activeRequests.find(transfer);
+        if (it == m_activeRequests.end())
+            continue;
+
+        curl_multi_remove_handle(m_multiHandle, it->second);
+        RecycleHandle(it->second);
+        m_activeRequests.erase(it);
+        removed = true;
+    }
+    m_cancelledRequests.clear();
+
+    if (removed)
+        pthread_cond_broadcast(&m_removedCond);
+
+    while (m_pendingRequests.size() && m_activeRequests.size() < DEFAULT_MAX_ACTIVE_TRANSFERS)
+    {
+        CurlRequest request = m_pendingRequests.begin()->second;
+        m_pendingRequests.erase(m_pendingRequests.begin());
+
+        CURLMcode mRet = curl_multi_add_handle(m_multiHandle, request.handle);
+        if (mRet != CURLM_OK)
+        {
+            LOG(ERROR)<<"Failed to add request to curl multi handle, "<<curl_multi_strerror(mRet)<<endl;
+            m_failedRequests.push_back(request);
+            continue;
+        }
+
+        m_activeRequests[request.transfer] = request.handle;
+    }
+}
+
+void OmafCurlMultiEngine::NotifyTransferDone(CurlTransfer* transfer, CURL* handle, CURLcode result)
+{
+    // called with m_mutex locked, the request is already removed from
+    // the engine so that it won't be waited by RemoveRequest any more
+    m_notifyingTransfer = transfer;
+    pthread_mutex_unlock(&m_mutex);
+
+    transfer->TransferDone(result);
+
+    pthread_mutex_lock(&m_mutex);
+    m_notifyingTransfer = NULL;
+    RecycleHandle(handle);
+    pthread_cond_broadcast(&m_removedCond);
+}
+
+void OmafCurlMultiEngine::ProcessFinishedRequests()
+{
+    pthread_mutex_lock(&m_mutex);
+
+    while (m_failedRequests.size())
+    {
+        CurlRequest request = m_failedRequests.back();
+        m_failedRequests.pop_back();
+
+        NotifyTransferDone(request.transfer, request.handle, CURLE_FAILED_INIT);
+    }
+
+    CURLMsg *msg = NULL;
+    int msgsLeft = 0;
+    while ((msg = curl_multi_info_read(m_multiHandle, &msgsLeft)))
+    {
+        if (msg->msg != CURLMSG_DONE)
+            continue;
+
+        // msg is invalid once the handle is removed
+        CURL *handle = msg->easy_handle;
+        CURLcode result = msg->data.result;
+
+        char *priv = NULL;
+        curl_easy_getinfo(handle, CURLINFO_PRIVATE, &priv);
+        CurlTransfer *transfer = (CurlTransfer*)priv;
+
+        curl_multi_remove_handle(m_multiHandle, handle);
+        m_activeRequests.erase(transfer);
+
+        NotifyTransferDone(transfer, handle, result);
+    }
+
+    pthread_mutex_unlock(&m_mutex);
+}
+
+void OmafCurlMultiEngine::WakeUp()
+{
+#if LIBCURL_VERSION_NUM >= 0x074400
+    curl_multi_wakeup(m_multiHandle);
+#endif
+}
+
+void OmafCurlMultiEngine::Run()
+{
+    m_engineThread = pthread_self();
+
+    while (1)
+    {
+        pthread_mutex_lock(&m_mutex);
+        UpdateActiveRequests();
+        while (!m_isStopped && !m_activeRequests.size() && !m_failedRequests.size())
+        {
+            pthread_cond_wait(&m_requestCond, &m_mutex);
+            UpdateActiveRequests();
+        }
+        bool isStopped = m_isStopped;
+        pthread_mutex_unlock(&m_mutex);
+
+        if (isStopped)
+            break;
+
+        int runningNum = 0;
+        CURLMcode mRet = curl_multi_perform(m_multiHandle, &runningNum);
+        if (mRet != CURLM_OK)
+        {
+            LOG(ERROR)<<"Failed to perform curl multi transfers, "<<curl_multi_strerror(mRet)<<endl;
+        }
+
+        ProcessFinishedRequests();
+
+        if (!runningNum)
+            continue;
+
+#if LIBCURL_VERSION_NUM >= 0x074400
+        // waked up by curl_multi_wakeup when requests are added or removed
+        curl_multi_poll(m_multiHandle, NULL, 0, 1000, NULL);
+#else
+        curl_multi_wait(m_multiHandle, NULL, 0, 10, NULL);
+#endif
+    }
+}
+
+VCD_OMAF_END
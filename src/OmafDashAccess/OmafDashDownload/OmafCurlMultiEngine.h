@@ -0,0 +1,261 @@
+/*
+ * Copyright (c) 2019, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+
+ */
+
+//!
+//! \file:   OmafCurlMultiEngine.h
+//! \brief:  download engine shared by all downloaders, driving all
+//!          transfers with one libcurl multi handle
+//!
+
+#ifndef OMAFCURLMULTIENGINE_H
+#define OMAFCURLMULTIENGINE_H
+
+#include <curl/curl.h>
+#include <functional>
+#include "../OmafDashParser/Common.h"
+
+VCD_USE_VRVIDEO;
+
+VCD_OMAF_BEGIN
+
+#define DEFAULT_MAX_ACTIVE_TRANSFERS  16   //!< transfers number driven by the multi handle at the same time, the others
+                                           //!< are kept pending so that they can still be reordered by priority
+#define DEFAULT_MAX_HOST_CONNECTIONS  8    //!< connections number kept open to one host
+#define MAX_IDLE_EASY_HANDLES         64   //!< easy handles number kept for reuse
+#define DEFAULT_STREAM_WEIGHT         16   //!< HTTP/2 stream weight for requests with priority 0
+
+//!
+//! \class:  CurlTransfer
+//! \brief:  transfer which can be driven by OmafCurlMultiEngine
+//!
+class CurlTransfer
+{
+public:
+
+    //!
+    //! \brief Constructor
+    //!
+    CurlTransfer(){};
+
+    //!
+    //! \brief Destructor
+    //!
+    virtual ~CurlTransfer(){};
+
+    //!
+    //! \brief    Called in engine thread when the transfer finishes
+    //!
+    //! \param    [in] result
+    //!           result of the transfer
+    //!
+    //! \return   void
+    //!
+    virtual void TransferDone(CURLcode result) = 0;
+};
+
+//!
+//! \class:  OmafCurlMultiEngine
+//! \brief:  one thread drives all transfers with one multi handle, so
+//!          connections, DNS cache and TLS sessions are reused between
+//!          segments, and requests to the same host are multiplexed
+//!          over HTTP/2 when the server supports it
+//!
+class OmafCurlMultiEngine: public Threadable
+{
+public:
+
+    //!
+    //! \brief Constructor
+    //!
+    OmafCurlMultiEngine();
+
+    //!
+    //! \brief Destructor
+    //!
+    virtual ~OmafCurlMultiEngine();
+
+    //!
+    //! \brief    Get one easy handle with default options set,
+    //!           reused from finished transfers if there is one
+    //!
+    //! \return   CURL*
+    //!           easy handle, NULL if failed
+    //!
+    CURL* AcquireHandle();
+
+    //!
+    //! \brief    Give back easy handle which isn't added to the engine
+    //!
+    //! \param    [in] handle
+    //!           easy handle got from AcquireHandle
+    //!
+    //! \return   void
+    //!
+    void ReleaseHandle(CURL* handle);
+
+    //!
+    //! \brief    Queue one transfer, requests with larger priority
+    //!           are started first, requests with same priority are
+    //!           started in the queued order
+    //!
+    //! \param    [in] transfer
+    //!           transfer to be notified when the request finishes
+    //! \param    [in] handle
+    //!           easy handle of the request got from AcquireHandle,
+    //!           owned by the engine from now on
+    //! \param    [in] priority
+    //!           priority of the request
+    //!
+    //! \return   ODStatus
+    //!           OD_STATUS_SUCCESS if success, else fail reason
+    //!
+    ODStatus AddRequest(CurlTransfer* transfer, CURL* handle, int32_t priority);
+
+    //!
+    //! \brief    Remove transfer from the engine, wait until it isn't
+    //!           driven by engine thread any more
+    //!
+    //! \param    [in] transfer
+    //!           transfer to be removed
+    //!
+    //! \return   ODStatus
+    //!           OD_STATUS_SUCCESS if the transfer is removed before
+    //!           finished, OD_STATUS_INVALID if it isn't in the engine
+    //!
+    ODStatus RemoveRequest(CurlTransfer* transfer);
+
+    //!
+    //! \brief    Change priority of transfer which isn't started yet,
+    //!           it is moved behind the pending requests of the same
+    //!           priority
+    //!
+    //! \param    [in] transfer
+    //!           transfer to be updated
+    //! \param    [in] priority
+    //!           new priority of the request
+    //!
+    //! \return   ODStatus
+    //!           OD_STATUS_SUCCESS if the request is pending, else
+    //!           OD_STATUS_INVALID
+    //!
+    ODStatus UpdatePriority(CurlTransfer* transfer, int32_t priority);
+
+    //!
+    //! \brief Interface implementation from base class: Threadable
+    //!
+    virtual void Run();
+
+private:
+
+    //!
+    //! \struct: CurlRequest
+    //! \brief:  request queued or driven by the engine
+    //!
+    struct CurlRequest
+    {
+        CurlTransfer *transfer;
+        CURL         *handle;
+    };
+
+    //!
+    //! \brief    Add pending requests to multi handle by priority and
+    //!           remove the cancelled ones, called with m_mutex locked
+    //!
+    //! \return   void
+    //!
+    void UpdateActiveRequests();
+
+    //!
+    //! \brief    Notify transfers of finished requests
+    //!
+    //! \return   void
+    //!
+    void ProcessFinishedRequests();
+
+    //!
+    //! \brief    Reset easy handle and keep it for reuse, called with
+    //!           m_mutex locked
+    //!
+    //! \param    [in] handle
+    //!           easy handle not driven by the multi handle
+    //!
+    //! \return   void
+    //!
+    void RecycleHandle(CURL* handle);
+
+    //!
+    //! \brief    Notify transfer that its request finishes
+    //!
+    //! \param    [in] transfer
+    //!           transfer of the finished request
+    //! \param    [in] handle
+    //!           easy handle of the finished request
+    //! \param    [in] result
+    //!           result of the request
+    //!
+    //! \return   void
+    //!
+    void NotifyTransferDone(CurlTransfer* transfer, CURL* handle, CURLcode result);
+
+    //!
+    //! \brief    Set HTTP/2 stream weight of the request by priority
+    //!
+    //! \param    [in] handle
+    //!           easy handle of the request
+    //! \param    [in] priority
+    //!           priority of the request
+    //!
+    //! \return   void
+    //!
+    void SetStreamWeight(CURL* handle, int32_t priority);
+
+    //!
+    //! \brief    Wake up engine thread blocked in polling
+    //!
+    //! \return   void
+    //!
+    void WakeUp();
+
+    CURLM                                            *m_multiHandle;  //!< multi handle driving all transfers
+    std::multimap<int32_t, CurlRequest, std::greater<int32_t>> m_pendingRequests; //!< requests waiting to be started, sorted by priority
+    std::map<CurlTransfer*, CURL*>                   m_activeRequests;   //!< requests added to the multi handle
+    std::vector<CurlTransfer*>                       m_cancelledRequests;//!< active requests to be removed by engine thread
+    std::list<CURL*>                                 m_idleHandles;      //!< easy handles of finished requests for reuse
+    std::vector<CurlRequest>                         m_failedRequests;   //!< requests failed to be added to the multi handle
+    CurlTransfer                                     *m_notifyingTransfer; //!< transfer being notified by engine thread
+    pthread_t                                        m_engineThread;     //!< thread ID of engine thread
+    pthread_mutex_t                                  m_mutex;            //!< mutex for requests
+    pthread_cond_t                                   m_requestCond;      //!< signalled when new requests are queued
+    pthread_cond_t                                   m_removedCond;      //!< signalled when requests are removed
+    bool                                             m_isStopped;        //!< whether engine thread should exit
+};
+
+typedef VCD::VRVideo::Singleton<OmafCurlMultiEngine> CURLMULTIENGINE;    //<! singleton of OmafCurlMultiEngine
+
+VCD_OMAF_END;
+
+#endif //OMAFCURLMULTIENGINE_H
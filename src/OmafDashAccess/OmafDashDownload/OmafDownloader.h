@@ -85,6 +85,19 @@ public:
     //!
     virtual ODStatus Read(uint8_t* data, size_t size) = 0;
 
+    //!
+    //! \brief    Read given size stream to output stream
+    //!
+    //! \param    [in] output
+    //!           output stream the read stream is written to
+    //! \param    [in] size
+    //!           size of stream that should read
+    //!
+    //! \return   ODStatus
+    //!           OD_STATUS_SUCCESS if success, else fail reason
+    //!
+    virtual ODStatus Read(std::ostream& output, size_t size) = 0;
+
     //!
     //! \brief    Peek given size stream to data pointer
     //!
@@ -142,6 +155,19 @@ public:
     //!           download rate
     //!
     virtual double GetDownloadRate() = 0;
+
+    //!
+    //! \brief    Set download priority, downloads with larger priority
+    //!           are started first, it can be changed until the
+    //!           download is really started
+    //!
+    //! \param    [in] priority
+    //!           download priority
+    //!
+    //! \return   ODStatus
+    //!           OD_STATUS_SUCCESS if success, else fail reason
+    //!
+    virtual ODStatus SetPriority(int32_t priority) = 0;
 };
 
 VCD_OMAF_END;
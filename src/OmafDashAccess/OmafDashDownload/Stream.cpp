@@ -34,188 +34,155 @@
 
 VCD_OMAF_BEGIN
 
+#define STREAM_MIN_BUFFER_SIZE (64 * 1024)
+
 Stream::Stream()
 {
-    m_eos = false;
-    m_totalLength = 0;
+    m_data     = NULL;
+    m_capacity = 0;
+    m_dataSize = 0;
+    m_readPos  = 0;
+    m_eos      = false;
 }
 
 Stream::~Stream()
 {
-    if(m_listDownloadedStreams.size())
-    {
-        for(std::list<StreamInfo*>::iterator it = m_listDownloadedStreams.begin() ; it != m_listDownloadedStreams.end(); it++)
-        {
-            StreamInfo * ds = *it;
-            SAFE_DELETE(ds);
-        }
-        m_listDownloadedStreams.clear();
-    }
+    SAFE_FREE(m_data);
 }
 
-ODStatus Stream::AddSubStream(char* streamData, uint64_t streamLen)
+ODStatus Stream::Reserve(uint64_t streamLen)
 {
-    StreamInfo *sInfo = new StreamInfo();
-    sInfo->data = streamData;
-    sInfo->length = streamLen;
+    lock_guard<mutex> lck(m_mutex);
 
-    m_lock.lock();
-    m_totalLength += streamLen;
-    m_listDownloadedStreams.push_back(sInfo);
-    m_lock.unlock();
+    if (streamLen <= m_capacity)
+        return OD_STATUS_SUCCESS;
+
+    char *newData = (char*)realloc(m_data, streamLen);
+    CheckNullPtr_PrintLog_ReturnStatus(newData, "Failed to allocate stream buffer!", ERROR, OD_STATUS_OPERATION_FAILED);
+
+    m_data     = newData;
+    m_capacity = streamLen;
 
-    // notify other threads
-    m_cv.notify_all();
     return OD_STATUS_SUCCESS;
 }
 
-ODStatus Stream::GetStream(char* streamData, uint64_t streamDataLen)
+ODStatus Stream::AddSubStream(const char* streamData, uint64_t streamLen)
 {
-    CheckNullPtr_PrintLog_ReturnStatus(streamData, "the data pointer for getting output stream is null!", ERROR, OD_STATUS_INVALID);
+    CheckNullPtr_PrintLog_ReturnStatus(streamData, "The sub-stream data is null!", ERROR, OD_STATUS_INVALID);
 
-    while(!GetDownloadedListSize() && !IsEOS())
     {
-        mutex mtx;
-        unique_lock<mutex> lck(mtx);
-
-        // wait for time out or is notified
-        m_cv.wait_for(lck, chrono::milliseconds(2));
-    }
+        lock_guard<mutex> lck(m_mutex);
 
-    m_lock.lock();
+        if (m_dataSize + streamLen > m_capacity)
+        {
+            // length of the stream is unknown, grow the buffer exponentially
+            uint64_t newCapacity = m_capacity ? m_capacity : STREAM_MIN_BUFFER_SIZE;
+            while (newCapacity < m_dataSize + streamLen)
+                newCapacity *= 2;
 
-    uint64_t gotSize = 0, gotCnt = 0;
-    for(auto stream: m_listDownloadedStreams)
-    {
-        if(gotSize >= streamDataLen)
-            break;
+            char *newData = (char*)realloc(m_data, newCapacity);
+            CheckNullPtr_PrintLog_ReturnStatus(newData, "Failed to allocate stream buffer!", ERROR, OD_STATUS_OPERATION_FAILED);
 
-        uint64_t copysize = 0;
-        if((streamDataLen - gotSize) >= stream->length)
-        {
-            copysize = stream->length;
-            memcpy(streamData + gotSize, stream->data, copysize);
-            gotCnt++;
-        }
-        else
-        {
-            copysize = (streamDataLen - gotSize);
-            memcpy(streamData + gotSize, stream->data, copysize);
-
-            // remove the copied part of list element
-            auto leftSize = stream->length - copysize;
-            char* newData = new char(leftSize);
-            memcpy(newData, stream->data, leftSize);
-            SAFE_DELETE(stream->data);
-            stream->data = newData;
-            stream->length = leftSize;
+            m_data     = newData;
+            m_capacity = newCapacity;
         }
 
-        gotSize += copysize;
+        memcpy(m_data + m_dataSize, streamData, streamLen);
+        m_dataSize += streamLen;
     }
 
-    while(gotCnt)
+    // notify other threads
+    m_cv.notify_all();
+    return OD_STATUS_SUCCESS;
+}
+
+uint64_t Stream::WaitForData(unique_lock<mutex>& lck, uint64_t size, uint64_t offset)
+{
+    while ((m_dataSize - m_readPos) < (offset + size) && !m_eos)
     {
-        auto downStream = m_listDownloadedStreams.front();
-        m_listDownloadedStreams.pop_front();
-        SAFE_DELETE(downStream);
-        gotCnt--;
+        m_cv.wait(lck);
     }
 
-    m_totalLength -= streamDataLen;
+    uint64_t leftSize = m_dataSize - m_readPos;
+    if (leftSize <= offset)
+        return 0;
 
-    m_lock.unlock();
-
-    return OD_STATUS_SUCCESS;
+    return (leftSize - offset) < size ? (leftSize - offset) : size;
 }
 
-ODStatus Stream::PeekStream(char* streamData, uint64_t streamDataLen)
+void Stream::Consume(uint64_t size)
 {
-    CheckNullPtr_PrintLog_ReturnStatus(streamData, "The data pointer for getting output stream is null!", ERROR, OD_STATUS_INVALID);
+    m_readPos += size;
 
-    while(!GetDownloadedListSize() && !IsEOS())
+    // nothing will be added or got any more
+    if (m_eos && m_readPos == m_dataSize)
     {
-        mutex mtx;
-        unique_lock<mutex> lck(mtx);
-
-        // wait for time out or is notified
-        m_cv.wait_for(lck, chrono::milliseconds(2));
+        SAFE_FREE(m_data);
+        m_capacity = 0;
     }
+}
 
-    m_lock.lock();
-
-    uint64_t gotSize = 0;
-    for(auto stream: m_listDownloadedStreams)
-    {
-        if(gotSize >= streamDataLen)
-            break;
+ODStatus Stream::GetStream(char* streamData, uint64_t streamDataLen)
+{
+    CheckNullPtr_PrintLog_ReturnStatus(streamData, "the data pointer for getting output stream is null!", ERROR, OD_STATUS_INVALID);
 
-        uint64_t copysize = (streamDataLen - gotSize) >= stream->length ? stream->length : (streamDataLen - gotSize);
+    unique_lock<mutex> lck(m_mutex);
 
-        memcpy(streamData + gotSize, stream->data, copysize);
-        gotSize += copysize;
+    uint64_t gotSize = WaitForData(lck, streamDataLen, 0);
+    if (gotSize)
+    {
+        memcpy(streamData, m_data + m_readPos, gotSize);
+        Consume(gotSize);
     }
 
-    m_lock.unlock();
-
     return OD_STATUS_SUCCESS;
 }
 
-ODStatus Stream::PeekStream(char* streamData, uint64_t streamDataLen, size_t offset)
+ODStatus Stream::GetStream(std::ostream& output, uint64_t streamDataLen)
 {
-    CheckNullPtr_PrintLog_ReturnStatus(streamData, "The data pointer for getting output stream is null!", ERROR, OD_STATUS_INVALID);
+    unique_lock<mutex> lck(m_mutex);
 
-    while(!GetDownloadedListSize() && !IsEOS())
+    uint64_t gotSize = WaitForData(lck, streamDataLen, 0);
+    if (gotSize)
     {
-        mutex mtx;
-        unique_lock<mutex> lck(mtx);
-
-        // wait for time out or is notified
-        m_cv.wait_for(lck, chrono::milliseconds(2));
+        output.write(m_data + m_readPos, gotSize);
+        Consume(gotSize);
     }
 
-    m_lock.lock();
-
-    // find the block that offset refers
-    auto it = m_listDownloadedStreams.begin();
-    while(it != m_listDownloadedStreams.end())
-    {
-        if(offset - (*it)->length <= 0) break;
-        offset -= (*it)->length;
-
-        it++;
-    }
+    return output.good() ? OD_STATUS_SUCCESS : OD_STATUS_OPERATION_FAILED;
+}
 
-    uint64_t gotSize = 0;
-    if (it == m_listDownloadedStreams.end())
-    {
-        return OD_STATUS_OPERATION_FAILED;
-    }
-    // copy the left data in offset block
-    memcpy(streamData, (*it)->data + offset, (*it)->length - offset);
-    gotSize += (*it)->length - offset;
-    it++;
+ODStatus Stream::PeekStream(char* streamData, uint64_t streamDataLen)
+{
+    return PeekStream(streamData, streamDataLen, 0);
+}
 
-    for(; it!= m_listDownloadedStreams.end(); it++)
-    {
-        auto stream = (*it);
-        if(gotSize >= streamDataLen)
-            break;
+ODStatus Stream::PeekStream(char* streamData, uint64_t streamDataLen, size_t offset)
+{
+    CheckNullPtr_PrintLog_ReturnStatus(streamData, "The data pointer for getting output stream is null!", ERROR, OD_STATUS_INVALID);
 
-        uint64_t copysize = (streamDataLen - gotSize) >= stream->length ? stream->length : (streamDataLen - gotSize);
+    unique_lock<mutex> lck(m_mutex);
 
-        memcpy(streamData + gotSize, stream->data, copysize);
-        gotSize += copysize;
-    }
+    uint64_t gotSize = WaitForData(lck, streamDataLen, offset);
+    if (!gotSize && streamDataLen)
+        return OD_STATUS_OPERATION_FAILED;
 
-    m_lock.unlock();
+    memcpy(streamData, m_data + m_readPos + offset, gotSize);
 
     return OD_STATUS_SUCCESS;
 }
 
 ODStatus Stream::ReachedEOS()
 {
-    m_eos = true;
+    {
+        lock_guard<mutex> lck(m_mutex);
+        m_eos = true;
+        if (m_readPos == m_dataSize)
+        {
+            SAFE_FREE(m_data);
+            m_capacity = 0;
+        }
+    }
 
     m_cv.notify_all();
 
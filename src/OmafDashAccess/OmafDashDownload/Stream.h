@@ -40,65 +40,40 @@ VCD_USE_VRVIDEO;
 VCD_OMAF_BEGIN
 
 //!
-//! \class  StreamInfo
-//! \brief  Stream Information, including data and data size
+//! \class  Stream
+//! \brief  Stream class, which stores downloaded sub-streams in one
+//!         contiguous buffer, so that any part of the stream can be
+//!         got directly by its offset
 //!
-class StreamInfo
+class Stream
 {
 public:
 
     //!
     //! \brief Constructor
     //!
-    StreamInfo()
-    {
-        data   = NULL;
-        length = 0;
-    }
-
-    //!
-    //! \brief Constructor with parameter
-    //!
-    StreamInfo(char* d, uint64_t l):StreamInfo()
-    {
-        data = d;
-        length = l;
-    }
+    Stream();
 
     //!
     //! \brief Destructor
     //!
-    ~StreamInfo()
-    {
-        SAFE_DELETE(data);
-        length = 0;
-    }
-
-    char*            data;   //<! stream data
-    uint64_t         length; //<! length of data
-};
-
-
-//!
-//! \class  Stream
-//! \brief  Stream class, which will store sub-streams
-//!
-class Stream: public ThreadLock
-{
-public:
+    ~Stream();
 
     //!
-    //! \brief Constructor
+    //! \brief    Reserve buffer for the whole stream, so that the
+    //!           buffer needn't grow while sub-streams are added
     //!
-    Stream();
-
+    //! \param    [in] streamLen
+    //!           expected total length of the stream
     //!
-    //! \brief Destructor
+    //! \return   ODStatus
+    //!           OD_STATUS_SUCCESS if success, else fail reason
     //!
-    ~Stream();
+    ODStatus Reserve(uint64_t streamLen);
 
     //!
-    //! \brief    Add sub-stream
+    //! \brief    Add sub-stream, the data is copied to the end of
+    //!           stream buffer
     //!
     //! \param    [in] streamData
     //!           sub-stream data
@@ -108,10 +83,11 @@ public:
     //! \return   ODStatus
     //!           OD_STATUS_SUCCESS if success, else fail reason
     //!
-    ODStatus AddSubStream(char* streamData, uint64_t streamLen);
+    ODStatus AddSubStream(const char* streamData, uint64_t streamLen);
 
     //!
-    //! \brief    Get given size sub-stream
+    //! \brief    Get given size sub-stream, wait until the data is
+    //!           downloaded or the stream reaches EOS
     //!
     //! \param    [in] streamData
     //!           sub-stream data
@@ -123,6 +99,20 @@ public:
     //!
     ODStatus GetStream(char* streamData, uint64_t streamDataLen);
 
+    //!
+    //! \brief    Get given size sub-stream and write it to output
+    //!           stream directly from stream buffer
+    //!
+    //! \param    [in] output
+    //!           output stream the sub-stream is written to
+    //! \param    [in] streamDataLen
+    //!           sub-stream length
+    //!
+    //! \return   ODStatus
+    //!           OD_STATUS_SUCCESS if success, else fail reason
+    //!
+    ODStatus GetStream(std::ostream& output, uint64_t streamDataLen);
+
     //!
     //! \brief    Peek given size sub-stream
     //!
@@ -144,7 +134,7 @@ public:
     //! \param    [in] streamDataLen
     //!           sub-stream length
     //! \param    [in] offset
-    //!           stream offset that read should start
+    //!           offset to the data not got yet that read should start
     //!
     //! \return   ODStatus
     //!           OD_STATUS_SUCCESS if success, else fail reason
@@ -165,40 +155,63 @@ public:
     //! \return   bool
     //!           true if EOS reached, else false
     //!
-    bool IsEOS(){return m_eos;}
+    bool IsEOS()
+    {
+        lock_guard<mutex> lck(m_mutex);
+        return m_eos;
+    }
 
     //!
-    //! \brief    Get total stream length
+    //! \brief    Get length of the stream not got yet
     //!
     //! \return   uint64_t
-    //!           total stream length
+    //!           length of the stream not got yet
     //!
-    uint64_t GetTotalStreamLength(){return m_totalLength;}
+    uint64_t GetTotalStreamLength()
+    {
+        lock_guard<mutex> lck(m_mutex);
+        return m_dataSize - m_readPos;
+    }
 
 private:
 
     //!
-    //! \brief    get number of sub-streams
+    //! \brief    Wait until given size data from offset is downloaded
+    //!           or the stream reaches EOS, called with m_mutex locked
     //!
-    //! \return   size_t
-    //!           number of sub-streams
+    //! \param    [in] lck
+    //!           lock of m_mutex
+    //! \param    [in] size
+    //!           size of data needed
+    //! \param    [in] offset
+    //!           offset to the data not got yet
     //!
-    size_t GetDownloadedListSize()
-    {
-        m_lock.lock();
-        auto listSize = m_listDownloadedStreams.size();
-        m_lock.unlock();
+    //! \return   uint64_t
+    //!           size of data could be got
+    //!
+    uint64_t WaitForData(unique_lock<mutex>& lck, uint64_t size, uint64_t offset);
 
-        return listSize;
-    }
+    //!
+    //! \brief    Move read position forward and free the buffer once
+    //!           the whole stream has been got, called with m_mutex
+    //!           locked
+    //!
+    //! \param    [in] size
+    //!           size of data got
+    //!
+    //! \return   void
+    //!
+    void Consume(uint64_t size);
 
-    list<StreamInfo*>       m_listDownloadedStreams;    //!< list stores all downloaded sub-streams
-    ThreadLock              m_lock;                     //!< for downloaded streams synchronize
+    char                    *m_data;                    //!< buffer storing all downloaded sub-streams
+    uint64_t                m_capacity;                 //!< allocated size of m_data
+    uint64_t                m_dataSize;                 //!< size of downloaded data in m_data
+    uint64_t                m_readPos;                  //!< offset of the data not got yet in m_data
+    mutex                   m_mutex;                    //!< for downloaded streams synchronize
     bool                    m_eos;                      //!< flag for end of stream
-    condition_variable      m_cv;                       //!< condition variable for streams
-    uint64_t                m_totalLength;              //!< the total length of stream
+    condition_variable      m_cv;                       //!< signalled when new data is added or EOS is reached
 };
 
 VCD_OMAF_END;
 
-#endif //STREAM_H
\ No newline at end of file
+#endif //STREAM_H
@@ -382,6 +382,9 @@ SegmentElement* OmafMPDReader::BuildSegment(OmafXMLElement* xmlSegment)
     segment->SetDuration(StringToInt(xmlSegment->GetAttributeVal(DURATION)));
     segment->SetStartNumber(StringToInt(xmlSegment->GetAttributeVal(STARTNUMBER)));
     segment->SetTimescale(StringToInt(xmlSegment->GetAttributeVal(TIMESCALE)));
+    segment->SetAvailabilityTimeOffset(atof(xmlSegment->GetAttributeVal(AVAILABILITYTIMEOFFSET).c_str()));
+    // segments are only available after they are complete unless it is set to false
+    segment->SetAvailabilityTimeComplete(xmlSegment->GetAttributeVal(AVAILABILITYTIMECOMPLETE) != "false");
 
     map<string, string> attributes = xmlSegment->GetAttributes();
     segment->AddOriginalAttributes(attributes);
@@ -42,6 +42,8 @@ SegmentElement::SegmentElement()
     m_duration = 0;
     m_startNumber = 0;
     m_timescale = 0;
+    m_availabilityTimeOffset = 0;
+    m_availabilityTimeComplete = true;
 }
 
 SegmentElement::~SegmentElement()
@@ -90,18 +92,26 @@ ODStatus SegmentElement::ResetDownload()
     return OD_STATUS_SUCCESS;
 }
 
-ODStatus SegmentElement::StartDownloadSegment(OmafDownloaderObserver* observer)
+ODStatus SegmentElement::StartDownloadSegment(OmafDownloaderObserver* observer, int32_t priority)
 {
     CheckNullPtr_PrintLog_ReturnStatus(m_downloader, "The downloader is not created yet!", ERROR, OD_STATUS_INVALID);
 
     //attach the observers to downloader
     CheckAndReturn(m_downloader->ObserverAttach(observer));
 
+    m_downloader->SetPriority(priority);
     m_downloader->Start();
 
     return OD_STATUS_SUCCESS;
 }
 
+ODStatus SegmentElement::SetDownloadPriority(int32_t priority)
+{
+    CheckNullPtr_PrintLog_ReturnStatus(m_downloader, "The downloader is not created yet!", ERROR, OD_STATUS_INVALID);
+
+    return m_downloader->SetPriority(priority);
+}
+
 ODStatus SegmentElement::StopDownloadSegment(OmafDownloaderObserver* observer)
 {
     if(!m_downloader)
@@ -120,6 +130,13 @@ ODStatus SegmentElement::Read(uint8_t* data, size_t size)
     return m_downloader->Read(data, size);
 }
 
+ODStatus SegmentElement::Read(std::ostream& output, size_t size)
+{
+    CheckNullPtr_PrintLog_ReturnStatus(m_downloader, "The downloader is not created yet!", ERROR, OD_STATUS_INVALID);
+
+    return m_downloader->Read(output, size);
+}
+
 ODStatus SegmentElement::Peek(uint8_t* data, size_t size)
 {
     CheckNullPtr_PrintLog_ReturnStatus(m_downloader, "The downloader is not created yet!", ERROR, OD_STATUS_INVALID);
@@ -123,6 +123,34 @@ public:
     //!
     MEMBER_SET_AND_GET_FUNC(int32_t, m_timescale, Timescale);
 
+    //!
+    //! \brief    Set function for m_availabilityTimeOffset member
+    //!
+    //! \param    [in] double
+    //!           value to set
+    //! \param    [in] m_availabilityTimeOffset
+    //!           m_availabilityTimeOffset member in class
+    //! \param    [in] AvailabilityTimeOffset
+    //!           m_availabilityTimeOffset name in class
+    //!
+    //! \return   void
+    //!
+    MEMBER_SET_AND_GET_FUNC(double, m_availabilityTimeOffset, AvailabilityTimeOffset);
+
+    //!
+    //! \brief    Set function for m_availabilityTimeComplete member
+    //!
+    //! \param    [in] bool
+    //!           value to set
+    //! \param    [in] m_availabilityTimeComplete
+    //!           m_availabilityTimeComplete member in class
+    //! \param    [in] AvailabilityTimeComplete
+    //!           m_availabilityTimeComplete name in class
+    //!
+    //! \return   void
+    //!
+    MEMBER_SET_AND_GET_FUNC(bool, m_availabilityTimeComplete, AvailabilityTimeComplete);
+
     //!
     //! \brief    Set function for m_url member
     //!
@@ -169,11 +197,25 @@ public:
     //!
     //! \param    [in] observer
     //!           A pointer of OmafDownloaderObserver class
+    //! \param    [in] priority
+    //!           download priority, larger one is downloaded first
+    //!
+    //! \return   ODStatus
+    //!           OD_STATUS_SUCCESS if success, else fail reason
+    //!
+    ODStatus StartDownloadSegment(OmafDownloaderObserver* observer, int32_t priority = 0);
+
+    //!
+    //! \brief    Change priority of the segment being downloaded, it
+    //!           takes effect if the download isn't really started
+    //!
+    //! \param    [in] priority
+    //!           download priority, larger one is downloaded first
     //!
     //! \return   ODStatus
     //!           OD_STATUS_SUCCESS if success, else fail reason
     //!
-    ODStatus StartDownloadSegment(OmafDownloaderObserver* observer);
+    ODStatus SetDownloadPriority(int32_t priority);
 
     //!
     //! \brief    Read given size stream to data pointer
@@ -188,6 +230,19 @@ public:
     //!
     ODStatus Read(uint8_t* data, size_t size);
 
+    //!
+    //! \brief    Read given size stream to output stream
+    //!
+    //! \param    [in] output
+    //!           output stream the read stream is written to
+    //! \param    [in] size
+    //!           size of stream that should read
+    //!
+    //! \return   ODStatus
+    //!           OD_STATUS_SUCCESS if success, else fail reason
+    //!
+    ODStatus Read(std::ostream& output, size_t size);
+
     //!
     //! \brief    Peek given size stream to data pointer
     //!
@@ -253,6 +308,8 @@ private:
     int32_t m_duration;           //!< the duration attribute
     int32_t m_startNumber;        //!< the startNumber attribute
     int32_t m_timescale;          //!< the timescale attribute
+    double  m_availabilityTimeOffset;   //!< the availabilityTimeOffset attribute, in the unit of second
+    bool    m_availabilityTimeComplete; //!< the availabilityTimeComplete attribute
 
     // download part
     string m_url;                 //!< the string to save URL
@@ -190,6 +190,10 @@ int OmafDashSource::OpenMedia(std::string url, std::string cacheDir, bool enable
     ret = mSelector->SetInitialViewport(mViewPorts, &mHeadSetInfo, (it->second));
     if(ret != ERROR_NONE) return ret;
 
+    for(auto iter=mMapStream.begin(); iter!=mMapStream.end(); iter++){
+        iter->second->UpdateViewport(mHeadSetInfo.pose);
+    }
+
     // set status
     this->SetStatus( STATUS_READY );
 
@@ -306,9 +310,24 @@ int OmafDashSource::ChangeViewport(HeadPose* pose)
 {
     int ret = mSelector->UpdateViewport( pose );
 
+    // reorder tile downloads at once, not to wait for next selection
+    for(auto it=mMapStream.begin(); it!=mMapStream.end(); it++){
+        it->second->UpdateViewport(pose);
+    }
+
     return ret;
 }
 
+int OmafDashSource::SetViewportLUTStep(float step)
+{
+    if (step > 0)
+        mSelector->SetViewportLUTStep(step);
+    else if (step < 0)
+        mSelector->SetViewportLUTStep(0);
+
+    return ERROR_NONE;
+}
+
 int OmafDashSource::GetMediaInfo( DashMediaInfo* media_info )
 {
     MPDInfo *mInfo  = this->GetMPDInfo();
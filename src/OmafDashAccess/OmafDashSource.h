@@ -83,6 +83,7 @@ public:
     virtual int GetStatistic(DashStatisticInfo* dsInfo);
     virtual int SetupHeadSetInfo(HeadSetInfo* clientInfo);
     virtual int ChangeViewport(HeadPose* pose);
+    virtual int SetViewportLUTStep(float step);
     virtual int GetMediaInfo( DashMediaInfo* media_info );
     virtual int GetTrackCount();
     virtual int SelectSpecialSegments(int extractorTrackIdx);
@@ -52,6 +52,7 @@ OmafExtractorSelector::OmafExtractorSelector( int size )
     mCurrentExtractor = nullptr;
     mPose = nullptr;
     mUsePrediction = false;
+    mLUTStep = VIEWPORT_LUT_STEP;
 }
 
 OmafExtractorSelector::~OmafExtractorSelector()
@@ -176,6 +177,10 @@ int OmafExtractorSelector::SetInitialViewport( std::vector<Viewport*>& pView, He
     if(!m360ViewPortHandle)
         return ERROR_NULL_PTR;
 
+    // pose is updated at sensor rate, reuse the viewport range of the quantized pose
+    if(mLUTStep > 0 && genViewport_setLUTStep(m360ViewPortHandle, mLUTStep))
+        LOG(WARNING)<<"Failed to enable the viewport lookup table!"<<endl;
+
     //set current Pose;
     mPose = new HeadPose;
     memcpy(mPose, headSetInfo->pose, sizeof(HeadPose));
@@ -301,6 +306,7 @@ ListExtractor OmafExtractorSelector::GetExtractorByPosePrediction( OmafMediaStre
     if(mPoseHistory.size() <= 1)
     {
         pthread_mutex_unlock(&mMutex);
+        pStream->UpdatePredictedViewport(NULL);
         return extractors;
     }
 
@@ -322,6 +328,8 @@ ListExtractor OmafExtractorSelector::GetExtractorByPosePrediction( OmafMediaStre
     OmafExtractor *selectedExtractor = SelectExtractor(pStream, pose);
     if(selectedExtractor)
         extractors.push_back(selectedExtractor);
+    // tiles of predicted viewport are fetched early too
+    pStream->UpdatePredictedViewport(pose);
     SAFE_DELETE(pose);
     return extractors;
 }
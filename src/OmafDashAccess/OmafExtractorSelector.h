@@ -45,6 +45,7 @@ using namespace VCD::OMAF;
 VCD_OMAF_BEGIN
 
 #define POSE_SIZE 20
+#define VIEWPORT_LUT_STEP 1.0f  // default quantization step in degree of the viewport lookup table
 
 typedef std::list<OmafExtractor*> ListExtractor;
 
@@ -88,6 +89,12 @@ public:
 
     void EnablePosePrediction(){mUsePrediction = true;};
 
+    //!
+    //! \brief  Set the quantization step in degree of the viewport lookup
+    //!         table used from SetInitialViewport, 0 to disable the table
+    //!
+    void SetViewportLUTStep(float step){mLUTStep = step;};
+
 private:
     //!
     //! \brief  Get Extractor based on latest Pose
@@ -114,6 +121,7 @@ private:
     void                              *m360ViewPortHandle;
     generateViewPortParam             *mParamViewport;
     bool                              mUsePrediction;
+    float                             mLUTStep;                   //<! quantization step of the viewport lookup table
 };
 
 VCD_OMAF_END;
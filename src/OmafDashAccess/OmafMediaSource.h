@@ -158,6 +158,19 @@ public:
     //!
     virtual int ChangeViewport(HeadPose* pose) = 0;
 
+    //!
+    //! \brief  Set the quantization step of the viewport lookup table, it
+    //!         must be set before the media is opened. it's pure interface
+    //!
+    //! \param  [in] step
+    //!         the step in degree, 0 for the default step and negative
+    //!         value to disable the table
+    //!
+    //! \return
+    //!         ERROR_NONE if success, else fail reason
+    //!
+    virtual int SetViewportLUTStep(float step) = 0;
+
 
     //!
     //! \brief  Get statistic information relative to the media. it's pure interface
@@ -26,6 +26,9 @@
  */
 
 #include "OmafMediaStream.h"
+#include "OmafReaderManager.h"
+#include "DownloadManager.h"
+#include <algorithm>
 
 VCD_OMAF_BEGIN
 
@@ -37,6 +40,8 @@ OmafMediaStream::OmafMediaStream()
     m_pStreamInfo          = NULL;
     m_bEOS                 = false;
     mStreamID              = 0;
+    mRepSelector           = new RepresentationSelector();
+    mTileScheduler         = new TileDownloadScheduler();
     pthread_mutex_init(&mMutex, NULL);
     pthread_mutex_init(&mCurrentMutex, NULL);
 }
@@ -45,6 +50,8 @@ OmafMediaStream::~OmafMediaStream()
 {
     SAFE_FREE(m_pStreamInfo);
     SAFE_FREE(mMainAdaptationSet);
+    SAFE_DELETE(mRepSelector);
+    SAFE_DELETE(mTileScheduler);
     if(mMediaAdaptationSet.size())
     {
         for(auto &it: mMediaAdaptationSet)
@@ -284,11 +291,13 @@ int OmafMediaStream::DownloadSegments()
 {
     int ret = ERROR_NONE;
     pthread_mutex_lock(&mMutex);
-    for(auto it = mMediaAdaptationSet.begin();
-             it != mMediaAdaptationSet.end();
-             it++ ){
-        OmafAdaptationSet* pAS = (OmafAdaptationSet*)(it->second);
-        pAS->DownloadSegment();
+
+    if (mRepSelector)
+    {
+        std::list<OmafExtractor*> extractors = GetEnabledExtractor();
+        mRepSelector->SelectRepresentations(mMediaAdaptationSet, extractors,
+                                            DOWNLOADMANAGER::GetInstance()->GetBandwidthEstimate(),
+                                            GetBufferedTime(), GetSegmentDuration() * 1000);
     }
 
     // NOTE: this function should be in the same thread with UpdateEnabledExtractors
@@ -298,13 +307,67 @@ int OmafMediaStream::DownloadSegments()
              extrator_it != mExtractors.end();
              extrator_it++ ){
         OmafExtractor* extractor = (OmafExtractor*)(extrator_it->second);
+        extractor->SetDownloadPriority(EXTRACTOR_SEGMENT_PRIORITY);
         extractor->DownloadSegment();
     }
     //pthread_mutex_unlock(&mCurrentMutex);
+
+    // start tiles in viewport first, so they are not queued behind the
+    // others when transfers number is limited
+    UpdateDownloadPriorities();
+
+    std::vector<OmafAdaptationSet*> adaptationSets;
+    for(auto it = mMediaAdaptationSet.begin();
+             it != mMediaAdaptationSet.end();
+             it++ ){
+        adaptationSets.push_back(it->second);
+    }
+    std::stable_sort(adaptationSets.begin(), adaptationSets.end(),
+        [](OmafAdaptationSet* a, OmafAdaptationSet* b) { return a->GetDownloadPriority() > b->GetDownloadPriority(); });
+
+    for(auto pAS : adaptationSets){
+        pAS->DownloadSegment();
+    }
+
     pthread_mutex_unlock(&mMutex);
     return ret;
 }
 
+void OmafMediaStream::UpdateViewport(HeadPose* pose)
+{
+    if(!pose || !mTileScheduler) return;
+
+    pthread_mutex_lock(&mMutex);
+    mTileScheduler->SetCurrentPose(pose);
+    UpdateDownloadPriorities();
+    pthread_mutex_unlock(&mMutex);
+}
+
+void OmafMediaStream::UpdatePredictedViewport(HeadPose* pose)
+{
+    if(!mTileScheduler) return;
+
+    pthread_mutex_lock(&mMutex);
+    mTileScheduler->SetPredictedPose(pose);
+    UpdateDownloadPriorities();
+    pthread_mutex_unlock(&mMutex);
+}
+
+void OmafMediaStream::UpdateDownloadPriorities()
+{
+    if(!mTileScheduler || mMediaAdaptationSet.empty()) return;
+
+    ProjectionFormat projFormat = m_pStreamInfo ? (ProjectionFormat)m_pStreamInfo->mProjFormat : PF_UNKNOWN;
+    std::map<int, int32_t> priorities;
+    if(ERROR_NONE != mTileScheduler->GetPriorities(mMediaAdaptationSet, projFormat, priorities))
+        return;
+
+    for(auto &it: mMediaAdaptationSet){
+        OmafAdaptationSet* pAS = it.second;
+        pAS->SetDownloadPriority(priorities[pAS->GetID()]);
+    }
+}
+
 int OmafMediaStream::SeekTo( int seg_num)
 {
     int ret = ERROR_NONE;
@@ -363,6 +426,33 @@ int OmafMediaStream::UpdateEnabledExtractors(std::list<OmafExtractor*> extractor
     return ret;
 }
 
+uint64_t OmafMediaStream::GetBufferedTime()
+{
+    if (!m_pStreamInfo || m_pStreamInfo->framerate_num <= 0 || m_pStreamInfo->framerate_den <= 0)
+        return 0;
+
+    // packets are read from the enabled extractor track, or from each
+    // tile track if there is no extractor
+    int trackNumber = -1;
+    std::list<OmafExtractor*> extractors = GetEnabledExtractor();
+    if (extractors.size())
+    {
+        trackNumber = extractors.front()->GetTrackNumber();
+    }
+    else if (mMediaAdaptationSet.size())
+    {
+        trackNumber = mMediaAdaptationSet.begin()->second->GetTrackNumber();
+    }
+
+    if (trackNumber < 0)
+        return 0;
+
+    int frames = 0;
+    READERMANAGER::GetInstance()->GetPacketQueueSize(trackNumber, frames);
+
+    return (uint64_t)frames * 1000 * m_pStreamInfo->framerate_den / m_pStreamInfo->framerate_num;
+}
+
 int OmafMediaStream::GetTrackCount()
 {
     return this->mMediaAdaptationSet.size() + this->mExtractors.size();
@@ -40,6 +40,8 @@
 #include "OmafReader.h"
 #include "OmafAdaptationSet.h"
 #include "OmafExtractor.h"
+#include "RepresentationSelector.h"
+#include "TileDownloadScheduler.h"
 #include "MediaPacket.h"
 
 VCD_OMAF_BEGIN
@@ -133,6 +135,18 @@ public:
     //!
     int UpdateEnabledExtractors(std::list<OmafExtractor*> extractors);
 
+    //!
+    //! \brief  Update viewport used to prioritise tile downloads, the
+    //!         downloads not started yet are reordered
+    //!
+    void UpdateViewport(HeadPose* pose);
+
+    //!
+    //! \brief  Update predicted viewport used to prioritise tile
+    //!         downloads, NULL if there is no prediction
+    //!
+    void UpdatePredictedViewport(HeadPose* pose);
+
     //!
     //! \brief  Get count of tracks
     //!
@@ -215,6 +229,17 @@ private:
     //!
     void SetupExtratorDependency();
 
+    //!
+    //! \brief  Get the time in ms of media read but not consumed yet
+    //!
+    uint64_t GetBufferedTime();
+
+    //!
+    //! \brief  Set download priorities of tiles by the distance to
+    //!         viewport, called with mMutex locked
+    //!
+    void UpdateDownloadPriorities();
+
 private:
     std::map<int, OmafAdaptationSet*> mMediaAdaptationSet;            //<! Adaptation Set list for tiles
     std::map<int, OmafExtractor*>     mExtractors;                  //<! Adaptation Set list for extractor
@@ -226,6 +251,8 @@ private:
     pthread_mutex_t                   mMutex;                       //<! for synchronization
     pthread_mutex_t                   mCurrentMutex;                //<! for synchronization of mCurrentExtractors
     bool                              m_bEOS;                       //<! flag for end of stream
+    RepresentationSelector           *mRepSelector;                 //<! the selector for representations of next segments
+    TileDownloadScheduler            *mTileScheduler;               //<! the scheduler for download priorities of tiles
 
 };
 
@@ -100,6 +100,8 @@ int OmafReaderManager::Close()
     SAFE_DELETE(mReader);
     releaseAllSegments();
     releasePacketQueue();
+    releasePacketPool();
+    mPacketSizeHints.clear();
 
     for(auto &it:m_readSegMap)
     {
@@ -114,6 +116,13 @@ int OmafReaderManager::Close()
     }
     m_readSegMap.clear();
 
+    for (auto& itRelSeg : mReleasedSegs)
+    {
+        delete itRelSeg;
+    }
+    mReleasedSegs.clear();
+    mMapChunkSegID.clear();
+
     return ERROR_NONE;
 }
 
@@ -221,10 +230,34 @@ int OmafReaderManager::AddSegment( OmafSegment* pSeg, uint32_t nInitSegID, uint3
         else
             LOG(WARNING)<<"viewport changed but size of m_readSegMap is 0, failed to update segment count!!"<<endl;
 
+        // chunks are read as segments, so the IDs are counted in chunks and
+        // follow the ID of the same chunk in other tracks
+        if(pSeg->IsChunk() && segCnt != -1)
+        {
+            auto itChunk = mMapChunkSegID.find(segCnt);
+            if (itChunk != mMapChunkSegID.end())
+            {
+                segCnt = itChunk->second;
+            }
+            else
+            {
+                segCnt = 1;
+                for (auto& itCnt : mMapSegCnt)
+                    segCnt = itCnt.second >= segCnt ? itCnt.second + 1 : segCnt;
+            }
+        }
+
         mMapSegCnt[nInitSegID] = segCnt - 1;
     }
 
     nSegID = ++(mMapSegCnt[nInitSegID]);
+
+    if (pSeg->IsChunk() && !pSeg->GetChunkIndex() && !mMapChunkSegID.count(pSeg->GetSegCount()))
+    {
+        mMapChunkSegID[pSeg->GetSegCount()] = nSegID;
+        if (mMapChunkSegID.size() > 10)
+            mMapChunkSegID.erase(mMapChunkSegID.begin());
+    }
     //LOG(INFO)<<"now nSegID = "<<nSegID<<", pSeg->IsReEnabled() = "<<pSeg->IsReEnabled()<<", segCnt = "<<segCnt<<endl;
 
     auto it = m_readSegMap.begin();
@@ -257,6 +290,13 @@ int OmafReaderManager::AddSegment( OmafSegment* pSeg, uint32_t nInitSegID, uint3
     return ERROR_NONE;
 }
 
+void OmafReaderManager::ReleaseSegment( OmafSegment* pSeg )
+{
+    mLock.lock();
+    mReleasedSegs.push_back(pSeg);
+    mLock.unlock();
+}
+
 int OmafReaderManager::ParseSegment(uint32_t nSegID, uint32_t nInitSegID)
 {
     if(NULL == mReader) return ERROR_NULL_PTR;
@@ -386,15 +426,60 @@ void OmafReaderManager::RemoveTrackFromPacketQueue(list<int>& trackIDs)
         PacketQueue pPackQ = mPacketQueues[it];
         for (std::list<MediaPacket*>::iterator iter = pPackQ.begin() ; iter != pPackQ.end(); iter++)
         {
-            MediaPacket *mediaPacket = *iter;
-            delete mediaPacket;
-            mediaPacket = NULL;
+            ReleasePacket(*iter);
         }
         mPacketQueues.erase(it);
     }
     mPacketLock.unlock();
 }
 
+MediaPacket* OmafReaderManager::AcquirePacket(uint32_t size)
+{
+    MediaPacket *packet = NULL;
+
+    mPoolLock.lock();
+    if (!mPacketPool.empty())
+    {
+        packet = mPacketPool.front();
+        mPacketPool.pop_front();
+    }
+    mPoolLock.unlock();
+
+    if (!packet)
+    {
+        packet = new MediaPacket();
+        if (!packet)
+            return NULL;
+    }
+
+    if (packet->ReservePacket(size) < 0)
+    {
+        LOG(ERROR) << "Failed to allocate packet of size " << size << " !" << endl;
+        delete packet;
+        return NULL;
+    }
+
+    return packet;
+}
+
+void OmafReaderManager::ReleasePacket(MediaPacket* pPacket)
+{
+    if (!pPacket)
+        return;
+
+    pPacket->Reset();
+
+    mPoolLock.lock();
+    if (mPacketPool.size() < MAX_POOLED_PACKETS)
+    {
+        mPacketPool.push_back(pPacket);
+        pPacket = NULL;
+    }
+    mPoolLock.unlock();
+
+    SAFE_DELETE(pPacket);
+}
+
 int OmafReaderManager::GetNextFrame( int trackID, MediaPacket*& pPacket, bool needParams )
 {
     mPacketLock.lock();
@@ -421,16 +506,19 @@ int OmafReaderManager::GetNextFrame( int trackID, MediaPacket*& pPacket, bool ne
             return OMAF_ERROR_INVALID_DATA;
         }
 
-        MediaPacket *newPacket = new MediaPacket();
         uint32_t newSize = mVPSLen + mSPSLen + mPPSLen + pPacket->Size();
-        newPacket->ReAllocatePacket(newSize);
+        MediaPacket *newPacket = AcquirePacket(newSize);
+        if (!newPacket)
+        {
+            return OMAF_ERROR_NULL_PTR;
+        }
         newPacket->SetRealSize(newSize);
 
         char *origData = pPacket->Payload();
         char *newData  = newPacket->Payload();
         if(!origData || !newData)
         {
-            SAFE_DELETE(newPacket);
+            ReleasePacket(newPacket);
             return OMAF_ERROR_NULL_PTR;
         }
         memcpy(newData, mVPS, mVPSLen);
@@ -438,19 +526,14 @@ int OmafReaderManager::GetNextFrame( int trackID, MediaPacket*& pPacket, bool ne
         memcpy(newData + mVPSLen + mSPSLen, mPPS, mPPSLen);
         memcpy(newData + mVPSLen + mSPSLen + mPPSLen, origData, pPacket->Size());
 
-        RegionWisePacking *newRwpk = new RegionWisePacking;
-        RegionWisePacking *pRwpk = pPacket->GetRwpk();
-        if(!newRwpk || !pRwpk)
+        if(!pPacket->GetRwpk())
         {
-            SAFE_DELETE(newPacket);
-            SAFE_DELETE(newRwpk);
+            ReleasePacket(newPacket);
             return OMAF_ERROR_NULL_PTR;
         }
-        *newRwpk = *pRwpk;
-        newRwpk->rectRegionPacking = new RectangularRegionWisePacking[newRwpk->numRegions];
-        memcpy(newRwpk->rectRegionPacking, pRwpk->rectRegionPacking, pRwpk->numRegions * sizeof(RectangularRegionWisePacking));
-        newPacket->SetRwpk(newRwpk);
-        delete pPacket;
+        // region wise packing isn't changed by the parameter sets, share it
+        newPacket->SetRwpk(pPacket->GetSharedRwpk());
+        ReleasePacket(pPacket);
         pPacket = newPacket;
     }
     return ERROR_NONE;
@@ -499,6 +582,7 @@ int OmafReaderManager::ReadNextSegment(
     }
 
     std::map<uint32_t, uint32_t> segSizeMap;
+    std::map<int32_t, uint32_t>  sampleDescIdxMap; //<! sample id & its sample description index in read segment
 
     for (auto& itSample : trackInfo->samplePropertyArrays)
     {
@@ -508,14 +592,29 @@ int OmafReaderManager::ReadNextSegment(
     for (auto& itSample : trackInfo->samplePropertyArrays)
     {
         segSizeMap[itSample->segmentId]++;
-        if (beginSampleId == -1 && itSample->segmentId == sampleIdx->mCurrentReadSegment)
+        if (itSample->segmentId == sampleIdx->mCurrentReadSegment)
         {
-            beginSampleId = itSample->id;
+            if (beginSampleId == -1)
+                beginSampleId = itSample->id;
+            sampleDescIdxMap[itSample->id] = itSample->descriptionIndex;
         }
     }
 
     if(beginSampleId == -1) return OMAF_ERROR_INVALID_DATA;
 
+    // payload size is from the largest sample read so far, grown when
+    // one sample doesn't fit, so no frame size based buffer is needed
+    uint32_t& sizeHint = mPacketSizeHints[trackID];
+    if (!sizeHint)
+    {
+        sizeHint = (trackInfo->maxSampleSize > MIN_PACKET_SIZE) ? trackInfo->maxSampleSize : MIN_PACKET_SIZE;
+    }
+
+    // region wise packing is from the sample entry, so samples with the
+    // same sample description share one
+    std::shared_ptr<RegionWisePacking> segRwpk;
+    uint32_t segRwpkDescIdx = 0;
+
     for ( ; beginSampleId < (int32_t)(segSizeMap[sampleIdx->mCurrentReadSegment]); beginSampleId++)
     {
         int sample = beginSampleId;
@@ -553,10 +652,6 @@ int OmafReaderManager::ReadNextSegment(
             LOG(INFO) << "Get sample width " << mWidth << " and sample height " << mHeight << " !" << endl;
         }
 
-        MediaPacket* packet = new MediaPacket();
-        uint32_t packetSize = ((mWidth * mHeight * 3) / 2 ) / 2;
-        packet->ReAllocatePacket(packetSize);
-
         if (!mVPSLen || !mSPSLen || !mPPSLen)
         {
             memset(mVPS, 0, 256);
@@ -606,31 +701,75 @@ int OmafReaderManager::ReadNextSegment(
             }
         }
 
-        if (isExtractor)
+        MediaPacket* packet = AcquirePacket(sizeHint);
+        if (!packet)
         {
-            ret = mReader->getExtractorTrackSampleData(combinedTrackId, sample, (char *)(packet->Payload()), packetSize );
-        }
-        else
-        {
-            ret =  mReader->getTrackSampleData(combinedTrackId, sample, (char *)(packet->Payload()), packetSize );
+            return OMAF_ERROR_NULL_PTR;
         }
 
-        RegionWisePacking *pRwpk = new RegionWisePacking;
+        uint32_t packetSize = 0;
+        for (int tries = 0; tries < 4; tries++)
+        {
+            packetSize = packet->AllocatedSize();
+            if (isExtractor)
+            {
+                ret = mReader->getExtractorTrackSampleData(combinedTrackId, sample, (char *)(packet->Payload()), packetSize );
+            }
+            else
+            {
+                ret =  mReader->getTrackSampleData(combinedTrackId, sample, (char *)(packet->Payload()), packetSize );
+            }
 
-        ret = mReader->getPropertyRegionWisePacking(combinedTrackId, sample, pRwpk);
+            if (ret != OMAF_MEMORY_TOO_SMALL_BUFFER)
+                break;
 
-        packet->SetRwpk(pRwpk);
+            // reader reports the needed size when it knows it
+            uint32_t allocSize = (uint32_t)(packet->AllocatedSize());
+            uint32_t newSize   = (packetSize > allocSize) ? packetSize : allocSize * 2;
+            if (packet->ReservePacket(newSize) < 0)
+            {
+                ReleasePacket(packet);
+                return OMAF_ERROR_NULL_PTR;
+            }
+            sizeHint = (newSize > sizeHint) ? newSize : sizeHint;
+        }
 
         if (ret == OMAF_MEMORY_TOO_SMALL_BUFFER )
         {
             LOG(ERROR) << "The frame size has exceeded the maximum packet size" << endl;
+            ReleasePacket(packet);
             return ret;
         }
         else if (ret)
         {
             LOG(ERROR) << "Failed to get packet " << (sampleIdx->mGlobalSampleIndex + beginSampleId) << " for track " << trackID << " and error is " << ret << endl;
+            ReleasePacket(packet);
             return ret;
         }
+
+        if (!segRwpk || sampleDescIdxMap[sample] != segRwpkDescIdx)
+        {
+            RegionWisePacking *pRwpk = new RegionWisePacking;
+            if (!pRwpk)
+            {
+                ReleasePacket(packet);
+                return OMAF_ERROR_NULL_PTR;
+            }
+            memset(pRwpk, 0, sizeof(RegionWisePacking));
+
+            ret = mReader->getPropertyRegionWisePacking(combinedTrackId, sample, pRwpk);
+            if (ret)
+            {
+                LOG(ERROR) << "Failed to get region wise packing for sample " << sample << " of track " << trackID << " !" << endl;
+                MediaPacket::DeleteRwpk(pRwpk);
+                ReleasePacket(packet);
+                return ret;
+            }
+            segRwpk.reset(pRwpk, MediaPacket::DeleteRwpk);
+            segRwpkDescIdx = sampleDescIdxMap[sample];
+        }
+        packet->SetRwpk(segRwpk);
+
         packet->SetRealSize(packetSize);
         mPacketLock.lock();
         mPacketQueues[trackID].push_back(packet);
@@ -876,6 +1015,14 @@ void OmafReaderManager::Run()
 // Keep more than 1 element in m_readSegMap for segment count update if viewport changed
 void OmafReaderManager::RemoveReadSegmentFromMap()
 {
+    mLock.lock();
+    for (auto& itRelSeg : mReleasedSegs)
+    {
+        delete itRelSeg;
+    }
+    mReleasedSegs.clear();
+    mLock.unlock();
+
     if(m_readSegMap.size() < 10) return;
 
     for(auto &it:m_readSegMap)
@@ -975,14 +1122,24 @@ void OmafReaderManager::releasePacketQueue()
 {
     ScopeLock packetLock(mPacketLock);
     for(auto it=mPacketQueues.begin(); it!=mPacketQueues.end(); it++){
-        PacketQueue queue = (*it).second;
+        PacketQueue& queue = (*it).second;
         for(auto qu_it=queue.begin(); qu_it!=queue.end(); qu_it++){
             MediaPacket* pkt = (MediaPacket*)(*qu_it);
-            delete pkt;
-            pkt = NULL;
+            ReleasePacket(pkt);
         }
         queue.clear();
     }
 }
 
+void OmafReaderManager::releasePacketPool()
+{
+    ScopeLock poolLock(mPoolLock);
+    for(auto it=mPacketPool.begin(); it!=mPacketPool.end(); it++){
+        MediaPacket* pkt = (MediaPacket*)(*it);
+        delete pkt;
+        pkt = NULL;
+    }
+    mPacketPool.clear();
+}
+
 VCD_OMAF_END
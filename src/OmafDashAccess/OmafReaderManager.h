@@ -46,6 +46,9 @@ VCD_OMAF_BEGIN
 
 typedef std::list<MediaPacket*> PacketQueue;
 
+#define MAX_POOLED_PACKETS    64          //<! packets number kept in the pool for reuse
+#define MIN_PACKET_SIZE       (64 * 1024) //<! minimum payload size of packets read from segments
+
 struct SampleIndex
 {
     SampleIndex()
@@ -94,6 +97,11 @@ public:
 
     int ParseSegment(uint32_t nSegID, uint32_t nInitSegID);
 
+    //!  \brief release Segment whose data has all been added in chunks, it is
+    //!         deleted later on reader thread rather than in download callback
+    //!
+    void ReleaseSegment( OmafSegment* pSeg );
+
     //!  \brief Get Next packet from packet queue. each track has a packet queue
     //!
     int GetNextFrame( int trackID, MediaPacket*& pPacket, bool needParams );
@@ -120,6 +128,12 @@ public:
 
     void RemoveTrackFromPacketQueue(list<int>& trackIDs);
 
+    //!
+    //! \brief  give back packet got from GetNextFrame, the packet and its
+    //!         buffer are reused for the following samples
+    //!
+    void ReleasePacket(MediaPacket* pPacket);
+
 public:
     //!  \brief the thread routine to read packet for each active track
     //!
@@ -160,6 +174,17 @@ private:
     //!
     void releasePacketQueue();
 
+    //!
+    //! \brief  get one packet which can hold size bytes, reused from
+    //!         the pool if there is one
+    //!
+    MediaPacket* AcquirePacket(uint32_t size);
+
+    //!
+    //! \brief  release all packets kept in the pool
+    //!
+    void releasePacketPool();
+
     //!  \brief release all use Segment
     //!
     void setNextSampleId(int trackID, uint32_t id, bool& segmentChanged);
@@ -174,11 +199,16 @@ private:
     int                             mCurTrkCnt;       //<! ID base for Init Segment
     OmafMediaSource*                mSource;          //<! reference to the source
     std::map<int, int>              mMapSegCnt;       //<! ID base for segment based on each InitSeg
+    std::map<int, int>              mMapChunkSegID;   //<! segment count & ID given to its first chunk
+    std::list<OmafSegment*>         mReleasedSegs;    //<! segments read in chunks, waiting to be deleted
     std::map<int, SegStatus>        mMapSegStatus;    //<! Segment status for each track
     std::map<int, int>              mMapInitTrk;      //<! ID pair for InitSegID to TrackID;
     ThreadLock                      mLock;            //<! for synchronization
     ThreadLock                      mReaderLock;      //<! lock for reader synchronization
     ThreadLock                      mPacketLock;      //<! lock for packet queue synchronization
+    ThreadLock                      mPoolLock;        //<! lock for packet pool synchronization
+    PacketQueue                     mPacketPool;      //<! released packets for reuse
+    std::map<int, uint32_t>         mPacketSizeHints; //<! <trackID, payload size enough for samples read so far>
     bool                            mEOS;             //<! flag for end of stream
     int                             mStatus;          //<! thread status: 0: runing; 1: stopping, 2. stopped;
     bool                            mReadSync;        //<! need to read  the frame at the bound of I frame (GOP boundary)
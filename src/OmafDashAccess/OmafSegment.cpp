@@ -50,21 +50,29 @@ OmafSegment::OmafSegment()
     mCacheFile   = "";
     mStatus      = SegUnknown;
     mSegSize     = 0;
+    mCachedSize  = 0;
+    mChunked     = false;
+    mChunkCnt    = 0;
+    mChunkIdx    = -1;
     mInitSegment = false;
-    mData        = NULL;
     mReEnabled   = false;
     mSegCnt      = 0;
     mInitSegID   = 0;
     mSegID       = 0;
+    mTransferActive = false;
+    mPriority    = 0;
 }
 
 OmafSegment::~OmafSegment()
 {
+    DOWNLOADMANAGER::GetInstance()->RemoveDownloadingSegment(this);
+
     pthread_mutex_destroy( &mMutex );
     pthread_cond_destroy( &mCond );
 
     //SAFE_DELETE(mSeg);
-    mSeg->StopDownloadSegment((OmafDownloaderObserver*) this);
+    // chunks of a segment have no SegmentElement of their own
+    if (mSeg) mSeg->StopDownloadSegment((OmafDownloaderObserver*) this);
 
     DOWNLOADMANAGER::GetInstance()->DeleteCacheFile(mCacheFile);
 }
@@ -78,11 +86,17 @@ OmafSegment::OmafSegment(SegmentElement* pSeg, int segCnt, bool bInitSegment, bo
     mCacheFile   = "";
     mStatus      = SegUnknown;
     mSegSize     = 0;
+    mCachedSize  = 0;
+    mChunked     = false;
+    mChunkCnt    = 0;
+    mChunkIdx    = -1;
     mInitSegment = bInitSegment;
     mReEnabled   = reEnabled;
     mSegCnt      = segCnt;
     mInitSegID   = 0;
     mSegID       = 0;
+    mTransferActive = false;
+    mPriority    = 0;
 }
 
 int OmafSegment::StartDownload()
@@ -92,14 +106,30 @@ int OmafSegment::StartDownload()
     mStoreFile = DOWNLOADMANAGER::GetInstance()->UseCache();
 
     mSegSize     = 0;
+    mCachedSize  = 0;
+    mChunkCnt    = 0;
+    mChunkIdx    = -1;
+
+    // segments still being produced arrive chunk by chunk, so they
+    // are read chunk by chunk while they are downloading
+    mChunked = mStoreFile && !mInitSegment && !mSeg->GetAvailabilityTimeComplete();
 
     mStatus = SegReady;
 
-    mSeg->StartDownloadSegment((OmafDownloaderObserver*) this);
+    int32_t priority = mInitSegment ? INIT_SEGMENT_DOWNLOAD_PRIORITY : mPriority;
+    mSeg->StartDownloadSegment((OmafDownloaderObserver*) this, priority);
 
     return ERROR_NONE;
 }
 
+void OmafSegment::SetDownloadPriority(int32_t priority)
+{
+    mPriority = priority;
+
+    if (mSeg && !mInitSegment && mStatus == SegDownloading)
+        mSeg->SetDownloadPriority(priority);
+}
+
 int OmafSegment::WaitComplete()
 {
     if( mStatus == SegDownloaded ) return ERROR_NONE;
@@ -174,21 +204,92 @@ int OmafSegment::SaveToFile()
 {
     mCacheFile = DOWNLOADMANAGER::GetInstance()->GetCacheFolder() + "/" + DOWNLOADMANAGER::GetInstance()->AssignCacheFileName();
     mFileStream.open(mCacheFile, ios::out|ios::binary);
+    if (!mFileStream.is_open())
+    {
+        LOG(ERROR)<<"Failed to open cache file "<<mCacheFile<<std::endl;
+        return ERROR_INVALID;
+    }
 
-    mData = (uint8_t*)malloc(mSegSize);
-    Read( mData, mSegSize );
-
-    mFileStream.write( (char *)mData, mSegSize);
+    // only the data not read as chunks is left in the stream, and it
+    // is written to cache file directly from download buffer
+    uint64_t leftSize = mSegSize - mCachedSize;
+    mSeg->Read(mFileStream, leftSize);
+    mCachedSize += leftSize;
 
     mFileStream.close();
 
-    if (mData)
+    LOG(INFO)<<"close saved cache "<<mCacheFile<<", size= "<<leftSize<<std::endl;
+    return ERROR_NONE;
+}
+
+int OmafSegment::AddCompleteChunks()
+{
+    uint8_t  boxHeader[16];
+    uint64_t chunkSize = 0;
+    while (mSegSize - mCachedSize - chunkSize >= 8)
     {
-        free(mData);
-        mData = NULL;
+        // only peek the data downloaded, or the download thread waits for itself
+        if (mSeg->Peek(boxHeader, 8, chunkSize) != OD_STATUS_SUCCESS)
+            return ERROR_INVALID;
+
+        uint64_t boxSize = ((uint64_t)boxHeader[0] << 24) | ((uint64_t)boxHeader[1] << 16) |
+                           ((uint64_t)boxHeader[2] << 8) | (uint64_t)boxHeader[3];
+        if (boxSize == 1)
+        {
+            if (mSegSize - mCachedSize - chunkSize < 16)
+                break;
+
+            if (mSeg->Peek(boxHeader, 16, chunkSize) != OD_STATUS_SUCCESS)
+                return ERROR_INVALID;
+
+            boxSize = 0;
+            for (uint32_t i = 8; i < 16; i++)
+            {
+                boxSize = (boxSize << 8) | boxHeader[i];
+            }
+        }
+
+        // box lasting to the end of segment is read when download completes
+        if (boxSize < 8 || boxSize > (mSegSize - mCachedSize - chunkSize))
+            break;
+
+        chunkSize += boxSize;
+        if (memcmp(boxHeader + 4, "mdat", 4))
+            continue;
+
+        OmafSegment *chunk = new OmafSegment();
+        if (!chunk)
+            return ERROR_NULL_PTR;
+
+        chunk->mCacheFile = DOWNLOADMANAGER::GetInstance()->GetCacheFolder() + "/" + DOWNLOADMANAGER::GetInstance()->AssignCacheFileName();
+        std::ofstream chunkFile(chunk->mCacheFile, ios::out|ios::binary);
+        if (!chunkFile.is_open())
+        {
+            LOG(ERROR)<<"Failed to open cache file "<<chunk->mCacheFile<<std::endl;
+            delete chunk;
+            return ERROR_INVALID;
+        }
+
+        ODStatus st = mSeg->Read(chunkFile, chunkSize);
+        chunkFile.close();
+        mCachedSize += chunkSize;
+        if (st != OD_STATUS_SUCCESS)
+        {
+            LOG(ERROR)<<"Failed to cache chunk "<<mChunkCnt<<" to "<<chunk->mCacheFile<<std::endl;
+            delete chunk;
+            return ERROR_INVALID;
+        }
+        chunkSize = 0;
+
+        chunk->mStatus    = SegDownloaded;
+        chunk->mInitSegID = mInitSegID;
+        chunk->mSegCnt    = mSegCnt;
+        chunk->mReEnabled = mReEnabled && !mChunkCnt;
+        chunk->mChunkIdx  = mChunkCnt++;
+
+        READERMANAGER::GetInstance()->AddSegment(chunk, mInitSegID, chunk->mSegID);
     }
 
-    LOG(INFO)<<"close saved cache "<<mCacheFile<<", size= "<<mSegSize<<std::endl;
     return ERROR_NONE;
 }
 
@@ -196,14 +297,54 @@ void OmafSegment::DownloadDataNotify(uint64_t bytesDownloaded)
 {
     // every time OnDownloadRateChanged called, the input bytesDownloaded
     // is the total bytes number includes previous downloaded bytes
+    if (bytesDownloaded > mSegSize)
+        DOWNLOADMANAGER::GetInstance()->AddDownloadedBytes(bytesDownloaded - mSegSize);
     mSegSize = bytesDownloaded;
+
+    if (mChunked && AddCompleteChunks())
+    {
+        LOG(WARNING)<<"Failed to read downloaded chunks of segment, wait for the whole segment"<<std::endl;
+        mChunked = false;
+    }
 }
 
 void OmafSegment::DownloadStatusNotify(DownloaderStatus state)
 {
+    // stopping may be notified together with finishing from engine
+    // thread, so the transfer is counted once
+    if (state == DOWNLOADING)
+    {
+        if (!mTransferActive.exchange(true))
+            DOWNLOADMANAGER::GetInstance()->TransferStarted();
+    }
+    else if (state != NOT_START)
+    {
+        if (mTransferActive.exchange(false))
+            DOWNLOADMANAGER::GetInstance()->TransferFinished();
+
+        // the segment is owned by reader manager once it is added
+        DOWNLOADMANAGER::GetInstance()->RemoveDownloadingSegment(this);
+    }
+
     switch(state){
         case DOWNLOADED:
             mStatus = SegDownloaded;
+            if (mChunked && AddCompleteChunks())
+                mChunked = false;
+
+            // every chunk ends with its mdat, so the data left after the
+            // last one has no samples to read
+            if (mChunkCnt)
+            {
+                if (mSegSize != mCachedSize)
+                    LOG(WARNING)<<"Drop "<<(mSegSize - mCachedSize)<<" bytes after the last chunk of segment"<<std::endl;
+
+                READERMANAGER::GetInstance()->ReleaseSegment(this);
+                break;
+            }
+
+            // no chunk found before download completes, read it whole
+            if (mChunked) mChunkIdx = mChunkCnt++;
             if( mStoreFile ) SaveToFile();
 
             if(this->mInitSegment){
@@ -42,9 +42,12 @@
 #include "OmafDashParser/SegmentElement.h"
 
 #include <fstream>
+#include <atomic>
 
 VCD_OMAF_BEGIN
 
+#define INIT_SEGMENT_DOWNLOAD_PRIORITY 100 //<! init segments are needed before any media segment can be parsed
+
 typedef enum{
     SegUnknown = 0,
     SegReady,
@@ -120,15 +123,38 @@ public:
     uint32_t GetInitSegID()              { return mInitSegID;  };
     void     SetSegStored()              { mStoreFile = true;  };
 
+    //!
+    //! \brief  Set download priority of media segment, it is used when
+    //!         download is started by Open, and reorders the download
+    //!         if it is still waiting to be started. init segments are
+    //!         always downloaded first
+    //!
+    void    SetDownloadPriority(int32_t priority);
+
     bool    IsReEnabled(){return mReEnabled;};
     int     GetSegCount(){return mSegCnt;};
 
+    //!
+    //! \brief  chunk information for segments still being produced,
+    //!         which are handed to reader manager chunk by chunk
+    //!
+    bool    IsChunk()         { return mChunkIdx >= 0; };
+    int     GetChunkIndex()   { return mChunkIdx;      };
+
 private:
     //!
     //!  \brief save the memory data to file.
     //!
     int SaveToFile();
 
+    //!
+    //!  \brief hand every chunk which has been completely downloaded
+    //!         to reader manager as a segment of its own, so that it
+    //!         can be parsed before the whole segment arrives. a chunk
+    //!         ends with its mdat box.
+    //!
+    int AddCompleteChunks();
+
     //!
     //!  \brief start downloading process.
     //!
@@ -148,12 +174,17 @@ private:
     pthread_mutex_t                   mMutex;             //<! for synchronization
     pthread_cond_t                    mCond;              //<! for synchronization
     uint64_t                          mSegSize;           //<! the total size of data downloaded for this segment
+    uint64_t                          mCachedSize;        //<! the size of data handed to reader manager as chunks
+    bool                              mChunked;           //<! flag to indicate whether the segment is read chunk by chunk while downloading
+    int                               mChunkCnt;          //<! the number of chunks handed to reader manager
+    int                               mChunkIdx;          //<! index of the chunk in its segment, -1 for a whole segment
     bool                              mInitSegment;       //<! flag to indicate whether this segment is initialize MP4
     uint32_t                          mSegID;             //<! the Segment ID used for segment reading
     uint32_t                          mInitSegID;         //<! the init Segement ID relative to this segment
-    uint8_t                           *mData;             //<! memory for saving segment data
     bool                              mReEnabled;         //<! flag to indicate whether the segment is re-enabled
     int                               mSegCnt;            //<! the count for this segment
+    int32_t                           mPriority;          //<! download priority of media segment
+    std::atomic<bool>                 mTransferActive;    //<! whether the download is counted as ongoing in bandwidth statistics
 };
 
 VCD_OMAF_END
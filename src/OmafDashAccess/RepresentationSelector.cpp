@@ -0,0 +1,248 @@
+/*
+ * Copyright (c) 2019, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+
+ *
+ */
+
+/*
+ * File:   RepresentationSelector.cpp
+ * Author: media
+ */
+
+#include "RepresentationSelector.h"
+#include <algorithm>
+
+VCD_OMAF_BEGIN
+
+RepresentationSelector::RepresentationSelector()
+{
+    mViewportLevel   = 0;
+    mBackgroundLevel = 0;
+    mStarted         = false;
+}
+
+RepresentationSelector::~RepresentationSelector()
+{
+}
+
+static bool CompareBandwidth(RepresentationElement* rep1, RepresentationElement* rep2)
+{
+    return rep1->GetBandwidth() < rep2->GetBandwidth();
+}
+
+std::vector<RepresentationElement*> RepresentationSelector::GetSwitchableRepresentations(OmafAdaptationSet* pAS)
+{
+    std::vector<RepresentationElement*> switchable;
+    RepresentationElement *current = pAS->mRepresentation;
+    if (!current)
+        return switchable;
+
+    // the reader only has the initialization segment of current
+    // representation, so only representations sharing it are used
+    SegmentElement *currentSeg = current->GetSegment();
+    std::string initialization = currentSeg ? currentSeg->GetInitialization() : "";
+    bool sharedInit = initialization.size() &&
+                      initialization.find("$" SEGMENT_REPRESENTATIONID "$") == std::string::npos &&
+                      initialization.find("$" SEGMENT_BANDWIDTH "$") == std::string::npos;
+
+    if (sharedInit && pAS->mAdaptationSet)
+    {
+        std::vector<RepresentationElement*> reps = pAS->mAdaptationSet->GetRepresentations();
+        for (auto rep : reps)
+        {
+            SegmentElement *seg = rep->GetSegment();
+            if (seg && seg->GetInitialization() == initialization)
+                switchable.push_back(rep);
+        }
+    }
+
+    if (switchable.empty())
+        switchable.push_back(current);
+
+    std::stable_sort(switchable.begin(), switchable.end(), CompareBandwidth);
+    return switchable;
+}
+
+bool RepresentationSelector::IsViewportAdaptationSet(OmafAdaptationSet* pAS)
+{
+    // quality ranking 1 is the highest resolution, whose tiles are
+    // selected by extractors to cover the viewport
+    std::string qualityRanking = pAS->mRepresentation->GetQualityRanking();
+    if (qualityRanking.empty())
+        return true;
+
+    return atoi(qualityRanking.c_str()) <= 1;
+}
+
+uint64_t RepresentationSelector::GetLevelBitrate(std::vector<std::vector<RepresentationElement*>>& group, uint32_t level)
+{
+    uint64_t bitrate = 0;
+    for (auto& reps : group)
+    {
+        uint32_t index = level < reps.size() ? level : reps.size() - 1;
+        bitrate += reps[index]->GetBandwidth();
+    }
+    return bitrate;
+}
+
+uint32_t RepresentationSelector::GetLevelForBudget(std::vector<std::vector<RepresentationElement*>>& group, uint64_t budget)
+{
+    uint32_t maxLevel = 0;
+    for (auto& reps : group)
+    {
+        if (reps.size() - 1 > maxLevel)
+            maxLevel = reps.size() - 1;
+    }
+
+    // the lowest level is used even if it exceeds the budget
+    uint32_t level = 0;
+    while (level < maxLevel && GetLevelBitrate(group, level + 1) <= budget)
+        level++;
+
+    return level;
+}
+
+uint32_t RepresentationSelector::SmoothLevel(uint32_t current, uint32_t target, bool bufferLow)
+{
+    if (target <= current)
+        return target;
+
+    // don't go up until buffer is recovered
+    if (bufferLow)
+        return current;
+
+    return current + 1;
+}
+
+void RepresentationSelector::ApplyLevel(
+    std::vector<OmafAdaptationSet*>& adaptationSets,
+    std::vector<std::vector<RepresentationElement*>>& group,
+    uint32_t level)
+{
+    for (uint32_t i = 0; i < adaptationSets.size(); i++)
+    {
+        std::vector<RepresentationElement*>& reps = group[i];
+        uint32_t index = level < reps.size() ? level : reps.size() - 1;
+        if (adaptationSets[i]->mRepresentation != reps[index])
+        {
+            LOG(INFO) << "Switch AdaptationSet " << adaptationSets[i]->GetID()
+                      << " from representation " << adaptationSets[i]->mRepresentation->GetId()
+                      << " to " << reps[index]->GetId() << " of bandwidth " << reps[index]->GetBandwidth() << endl;
+            adaptationSets[i]->mRepresentation = reps[index];
+        }
+    }
+}
+
+int RepresentationSelector::SelectRepresentations(
+    std::map<int, OmafAdaptationSet*>& adaptationSets,
+    std::list<OmafExtractor*>& extractors,
+    uint64_t bandwidth,
+    uint64_t bufferedTime,
+    uint64_t segmentDuration)
+{
+    std::vector<OmafAdaptationSet*> viewportAS, backgroundAS;
+    std::vector<std::vector<RepresentationElement*>> viewportReps, backgroundReps;
+    bool switchable = false;
+
+    for (auto& it : adaptationSets)
+    {
+        OmafAdaptationSet *pAS = it.second;
+        if (!pAS || !pAS->IsEnabled() || !pAS->mRepresentation)
+            continue;
+
+        std::vector<RepresentationElement*> reps = GetSwitchableRepresentations(pAS);
+        if (reps.size() > 1)
+            switchable = true;
+
+        if (IsViewportAdaptationSet(pAS))
+        {
+            viewportAS.push_back(pAS);
+            viewportReps.push_back(reps);
+        }
+        else
+        {
+            backgroundAS.push_back(pAS);
+            backgroundReps.push_back(reps);
+        }
+    }
+
+    if (!switchable)
+        return ERROR_NONE;
+
+    if (!mStarted)
+    {
+        // start from the representations selected at initialization
+        for (uint32_t i = 0; i < viewportAS.size(); i++)
+        {
+            uint32_t index = std::find(viewportReps[i].begin(), viewportReps[i].end(), viewportAS[i]->mRepresentation) - viewportReps[i].begin();
+            mViewportLevel = index > mViewportLevel ? index : mViewportLevel;
+        }
+        for (uint32_t i = 0; i < backgroundAS.size(); i++)
+        {
+            uint32_t index = std::find(backgroundReps[i].begin(), backgroundReps[i].end(), backgroundAS[i]->mRepresentation) - backgroundReps[i].begin();
+            mBackgroundLevel = index > mBackgroundLevel ? index : mBackgroundLevel;
+        }
+        mStarted = true;
+    }
+
+    if (!bandwidth)
+        return ERROR_NONE;
+
+    bool bufferLow  = bufferedTime < ABR_BUFFER_LOW_SEGMENTS * segmentDuration;
+    bool bufferHigh = bufferedTime >= ABR_BUFFER_HIGH_SEGMENTS * segmentDuration;
+
+    double factor = bufferLow ? ABR_LOW_BUFFER_FACTOR : (bufferHigh ? 1.0 : ABR_SAFETY_FACTOR);
+    uint64_t budget = (uint64_t)(bandwidth * factor);
+
+    // extractor tracks are always needed
+    uint64_t extractorBitrate = 0;
+    for (auto extractor : extractors)
+    {
+        if (extractor && extractor->mRepresentation)
+            extractorBitrate += extractor->mRepresentation->GetBandwidth();
+    }
+    budget = budget > extractorBitrate ? budget - extractorBitrate : 0;
+
+    // background tiles get their reserved part first, and what they
+    // don't use is left to viewport tiles
+    uint64_t backgroundBudget = viewportAS.empty() ? budget : (uint64_t)(budget * ABR_BACKGROUND_RATIO);
+    uint32_t target = GetLevelForBudget(backgroundReps, backgroundBudget);
+    mBackgroundLevel = SmoothLevel(mBackgroundLevel, target, bufferLow);
+    uint64_t backgroundBitrate = backgroundAS.empty() ? 0 : GetLevelBitrate(backgroundReps, mBackgroundLevel);
+
+    uint64_t viewportBudget = budget > backgroundBitrate ? budget - backgroundBitrate : 0;
+    target = GetLevelForBudget(viewportReps, viewportBudget);
+    mViewportLevel = SmoothLevel(mViewportLevel, target, bufferLow);
+
+    LOG(INFO) << "Bandwidth " << bandwidth << " bps, buffered " << bufferedTime << " ms, viewport level "
+              << mViewportLevel << ", background level " << mBackgroundLevel << endl;
+
+    ApplyLevel(backgroundAS, backgroundReps, mBackgroundLevel);
+    ApplyLevel(viewportAS, viewportReps, mViewportLevel);
+
+    return ERROR_NONE;
+}
+
+VCD_OMAF_END
@@ -0,0 +1,141 @@
+/*
+ * Copyright (c) 2019, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+
+ *
+ */
+//!
+//! \file:   RepresentationSelector.h
+//! \brief:  select representations of adaptation sets according to the
+//!          estimated bandwidth and the buffered media
+//! \detail: adaptation sets of the highest quality ranking, which are
+//!          used for the viewport, and the other ones covering the
+//!          background get separate bitrate budgets
+//!
+
+#ifndef REPRESENTATIONSELECTOR_H
+#define REPRESENTATIONSELECTOR_H
+
+#include "general.h"
+#include "OmafAdaptationSet.h"
+#include "OmafExtractor.h"
+
+VCD_OMAF_BEGIN
+
+#define ABR_BUFFER_LOW_SEGMENTS      1      //<! buffered segments under which bitrate is cut down quickly
+#define ABR_BUFFER_HIGH_SEGMENTS     3      //<! buffered segments above which all bandwidth can be used
+#define ABR_LOW_BUFFER_FACTOR        0.5    //<! part of bandwidth used when buffer is low
+#define ABR_SAFETY_FACTOR            0.8    //<! part of bandwidth used normally
+#define ABR_BACKGROUND_RATIO         0.25   //<! part of the budget reserved for background tiles
+
+//!
+//! \class:   RepresentationSelector
+//! \brief:   throughput and buffer based representation selection
+//!
+class RepresentationSelector {
+public:
+    //!
+    //! \brief  construct
+    //!
+    RepresentationSelector();
+
+    //!
+    //! \brief  de-construct
+    //!
+    virtual ~RepresentationSelector();
+
+public:
+    //!
+    //! \brief  select representations for the next segments of enabled
+    //!         adaptation sets, keep the current ones if no bandwidth
+    //!         is measured yet
+    //!
+    //! \param  [in] adaptationSets
+    //!         tile adaptation sets of the stream
+    //! \param  [in] extractors
+    //!         enabled extractors of the stream
+    //! \param  [in] bandwidth
+    //!         estimated bandwidth in bps, 0 if not measured yet
+    //! \param  [in] bufferedTime
+    //!         media buffered for playback in ms
+    //! \param  [in] segmentDuration
+    //!         segment duration in ms
+    //!
+    //! \return int
+    //!         ERROR_NONE if success, else fail reason
+    //!
+    int SelectRepresentations(
+        std::map<int, OmafAdaptationSet*>& adaptationSets,
+        std::list<OmafExtractor*>& extractors,
+        uint64_t bandwidth,
+        uint64_t bufferedTime,
+        uint64_t segmentDuration);
+
+private:
+    //!
+    //! \brief  get representations which can be switched to without a
+    //!         new initialization segment, sorted by bandwidth
+    //!
+    std::vector<RepresentationElement*> GetSwitchableRepresentations(OmafAdaptationSet* pAS);
+
+    //!
+    //! \brief  whether the adaptation set is of the highest quality
+    //!         ranking, i.e. used for the viewport
+    //!
+    bool IsViewportAdaptationSet(OmafAdaptationSet* pAS);
+
+    //!
+    //! \brief  get the highest quality level whose total bitrate of the
+    //!         group isn't more than budget, quality level N means the
+    //!         Nth lowest representation of each adaptation set
+    //!
+    uint32_t GetLevelForBudget(std::vector<std::vector<RepresentationElement*>>& group, uint64_t budget);
+
+    //!
+    //! \brief  get total bitrate of the group at the quality level
+    //!
+    uint64_t GetLevelBitrate(std::vector<std::vector<RepresentationElement*>>& group, uint32_t level);
+
+    //!
+    //! \brief  switch adaptation sets of the group to the quality level
+    //!
+    void ApplyLevel(std::vector<OmafAdaptationSet*>& adaptationSets,
+                    std::vector<std::vector<RepresentationElement*>>& group,
+                    uint32_t level);
+
+    //!
+    //! \brief  limit the level going up to one step each time, while
+    //!         going down is done at once
+    //!
+    uint32_t SmoothLevel(uint32_t current, uint32_t target, bool bufferLow);
+
+private:
+    uint32_t              mViewportLevel;      //<! current quality level of viewport tiles
+    uint32_t              mBackgroundLevel;    //<! current quality level of background tiles
+    bool                  mStarted;            //<! whether levels are initialized from the first selection
+};
+
+VCD_OMAF_END;
+
+#endif /* REPRESENTATIONSELECTOR_H */
@@ -0,0 +1,190 @@
+/*
+ * Copyright (c) 2019, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+
+ *
+ */
+
+/*
+ * File:   TileDownloadScheduler.cpp
+ * Author: media
+ */
+
+#include "TileDownloadScheduler.h"
+#include <math.h>
+
+VCD_OMAF_BEGIN
+
+TileDownloadScheduler::TileDownloadScheduler()
+{
+    mCentresReady     = false;
+    mHasCurrentPose   = false;
+    mHasPredictedPose = false;
+    memset(&mCurrentPose, 0, sizeof(HeadPose));
+    memset(&mPredictedPose, 0, sizeof(HeadPose));
+    pthread_mutex_init(&mMutex, NULL);
+}
+
+TileDownloadScheduler::~TileDownloadScheduler()
+{
+    pthread_mutex_destroy(&mMutex);
+}
+
+void TileDownloadScheduler::SetCurrentPose(HeadPose* pose)
+{
+    if (!pose)
+        return;
+
+    pthread_mutex_lock(&mMutex);
+    mCurrentPose    = *pose;
+    mHasCurrentPose = true;
+    pthread_mutex_unlock(&mMutex);
+}
+
+void TileDownloadScheduler::SetPredictedPose(HeadPose* pose)
+{
+    pthread_mutex_lock(&mMutex);
+    if (pose)
+        mPredictedPose = *pose;
+    mHasPredictedPose = (pose != NULL);
+    pthread_mutex_unlock(&mMutex);
+}
+
+double TileDownloadScheduler::GetAngularDistance(double azimuth1, double elevation1, double azimuth2, double elevation2)
+{
+    double a1 = azimuth1 * M_PI / 180;
+    double e1 = elevation1 * M_PI / 180;
+    double a2 = azimuth2 * M_PI / 180;
+    double e2 = elevation2 * M_PI / 180;
+
+    double cosDistance = sin(e1) * sin(e2) + cos(e1) * cos(e2) * cos(a1 - a2);
+    if (cosDistance > 1)
+        cosDistance = 1;
+    if (cosDistance < -1)
+        cosDistance = -1;
+
+    return acos(cosDistance) * 180 / M_PI;
+}
+
+void TileDownloadScheduler::SetupTileCentres(std::map<int, OmafAdaptationSet*>& adaptationSets, ProjectionFormat projFormat)
+{
+    // size of projected picture for each quality ranking, from the
+    // tiles which cover the whole picture
+    std::map<uint32_t, std::pair<int32_t, int32_t>> pictureSizes;
+    for (auto& it : adaptationSets)
+    {
+        OmafAdaptationSet *pAS = it.second;
+        OmafSrd *srd = pAS->GetSRD();
+        if (!srd)
+            continue;
+
+        std::pair<int32_t, int32_t>& size = pictureSizes[pAS->GetRepresentationQualityRanking()];
+        if (srd->get_X() + srd->get_W() > size.first)
+            size.first = srd->get_X() + srd->get_W();
+        if (srd->get_Y() + srd->get_H() > size.second)
+            size.second = srd->get_Y() + srd->get_H();
+    }
+
+    for (auto& it : adaptationSets)
+    {
+        OmafAdaptationSet *pAS = it.second;
+        ContentCoverage *cc = pAS->GetContentCoverage();
+        if (cc && cc->coverage_infos.size())
+        {
+            TileCentre centre;
+            centre.azimuth   = cc->coverage_infos[0].centre_azimuth / 65536.0;
+            centre.elevation = cc->coverage_infos[0].centre_elevation / 65536.0;
+            mTileCentres[pAS->GetID()] = centre;
+            continue;
+        }
+
+        ProjectionFormat format = pAS->GetProjectionFormat() != PF_UNKNOWN ? pAS->GetProjectionFormat() : projFormat;
+        OmafSrd *srd = pAS->GetSRD();
+        if (format != PF_ERP || !srd)
+            continue;
+
+        std::pair<int32_t, int32_t>& size = pictureSizes[pAS->GetRepresentationQualityRanking()];
+        if (size.first <= 0 || size.second <= 0)
+            continue;
+
+        // same mapping as content coverage of viewport in 360SCVP
+        TileCentre centre;
+        centre.azimuth   = (size.first / 2.0 - (srd->get_X() + srd->get_W() / 2.0)) * 360 / size.first;
+        centre.elevation = (size.second / 2.0 - (srd->get_Y() + srd->get_H() / 2.0)) * 180 / size.second;
+        mTileCentres[pAS->GetID()] = centre;
+    }
+
+    mCentresReady = true;
+}
+
+int TileDownloadScheduler::GetPriorities(
+    std::map<int, OmafAdaptationSet*>& adaptationSets,
+    ProjectionFormat projFormat,
+    std::map<int, int32_t>& priorities)
+{
+    if (!mCentresReady)
+        SetupTileCentres(adaptationSets, projFormat);
+
+    std::vector<HeadPose> poses;
+    pthread_mutex_lock(&mMutex);
+    if (mHasCurrentPose)
+        poses.push_back(mCurrentPose);
+    if (mHasPredictedPose)
+        poses.push_back(mPredictedPose);
+    pthread_mutex_unlock(&mMutex);
+
+    for (auto& it : adaptationSets)
+    {
+        OmafAdaptationSet *pAS = it.second;
+
+        // distance to the nearest viewport, tiles are needed for both
+        // current viewport and the predicted one
+        double distance = UNKNOWN_DISTANCE;
+        auto centre = mTileCentres.find(pAS->GetID());
+        if (poses.size() && centre != mTileCentres.end())
+        {
+            distance = 180;
+            for (auto& pose : poses)
+            {
+                // azimuth goes opposite to yaw, the same as content
+                // coverage of viewport in 360SCVP, while pitch is elevation
+                double d = GetAngularDistance(centre->second.azimuth, centre->second.elevation, -pose.yaw, pose.pitch);
+                distance = d < distance ? d : distance;
+            }
+        }
+
+        // quality ranking 1 is the highest resolution used for viewport
+        int32_t priority = 0;
+        if (pAS->GetRepresentationQualityRanking() <= 1)
+            priority = VIEWPORT_TILE_PRIORITY - (int32_t)(distance / 2);
+        else
+            priority = BACKGROUND_TILE_PRIORITY - (int32_t)(distance / 4);
+
+        priorities[pAS->GetID()] = priority;
+    }
+
+    return ERROR_NONE;
+}
+
+VCD_OMAF_END
@@ -0,0 +1,130 @@
+/*
+ * Copyright (c) 2019, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+
+ *
+ */
+//!
+//! \file:   TileDownloadScheduler.h
+//! \brief:  rank tile segments by the angular distance between tiles
+//!          and the current or predicted viewport
+//! \detail: the rank is used as download priority, so that tiles in
+//!          viewport are started first and tiles far from it wait
+//!
+
+#ifndef TILEDOWNLOADSCHEDULER_H
+#define TILEDOWNLOADSCHEDULER_H
+
+#include "general.h"
+#include "OmafAdaptationSet.h"
+
+VCD_OMAF_BEGIN
+
+#define EXTRACTOR_SEGMENT_PRIORITY   95     //<! extractor segments are needed to read any tile
+#define VIEWPORT_TILE_PRIORITY       90     //<! priority of high quality tile right in the viewport centre
+#define BACKGROUND_TILE_PRIORITY     45     //<! priority of low quality tile right in the viewport centre
+#define UNKNOWN_DISTANCE             90.0   //<! degree, distance used for tiles without position information
+
+//!
+//! \class:   TileDownloadScheduler
+//! \brief:   compute download priorities of tile adaptation sets
+//!
+class TileDownloadScheduler {
+public:
+    //!
+    //! \brief  construct
+    //!
+    TileDownloadScheduler();
+
+    //!
+    //! \brief  de-construct
+    //!
+    virtual ~TileDownloadScheduler();
+
+public:
+    //!
+    //! \brief  set the current viewport pose
+    //!
+    void SetCurrentPose(HeadPose* pose);
+
+    //!
+    //! \brief  set the predicted viewport pose, NULL to clear it
+    //!
+    void SetPredictedPose(HeadPose* pose);
+
+    //!
+    //! \brief  get download priorities of the adaptation sets, high
+    //!         quality tiles close to viewport get the largest ones,
+    //!         then low quality tiles which cover everywhere, and high
+    //!         quality tiles far from viewport get the smallest ones
+    //!
+    //! \param  [in] adaptationSets
+    //!         tile adaptation sets of the stream
+    //! \param  [in] projFormat
+    //!         projection format of the stream
+    //! \param  [out] priorities
+    //!         <adaptation set ID, priority>
+    //!
+    //! \return int
+    //!         ERROR_NONE if success, else fail reason
+    //!
+    int GetPriorities(std::map<int, OmafAdaptationSet*>& adaptationSets,
+                      ProjectionFormat projFormat,
+                      std::map<int, int32_t>& priorities);
+
+private:
+    //!
+    //! \brief  compute centres of tiles in degree from content coverage,
+    //!         or from SRD for ERP, tiles are static so it is done once
+    //!
+    void SetupTileCentres(std::map<int, OmafAdaptationSet*>& adaptationSets, ProjectionFormat projFormat);
+
+    //!
+    //! \brief  get great circle distance in degree between two points
+    //!
+    double GetAngularDistance(double azimuth1, double elevation1, double azimuth2, double elevation2);
+
+private:
+    //!
+    //! \struct: TileCentre
+    //! \brief:  centre of one tile on sphere
+    //!
+    struct TileCentre
+    {
+        double azimuth;
+        double elevation;
+    };
+
+    std::map<int, TileCentre>        mTileCentres;        //<! <adaptation set ID, tile centre>
+    bool                             mCentresReady;       //<! whether tile centres have been computed
+    HeadPose                         mCurrentPose;        //<! current viewport pose
+    HeadPose                         mPredictedPose;      //<! predicted viewport pose
+    bool                             mHasCurrentPose;     //<! whether current pose is set
+    bool                             mHasPredictedPose;   //<! whether predicted pose is set
+    pthread_mutex_t                  mMutex;              //<! for synchronization of poses
+};
+
+VCD_OMAF_END;
+
+#endif /* TILEDOWNLOADSCHEDULER_H */
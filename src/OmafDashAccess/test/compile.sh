@@ -6,13 +6,21 @@ g++ -I../../google_test -std=c++11 -I../util/ -g  -c testMediaSource.cpp -D_GLIB
 g++ -I../../google_test -std=c++11 -I../util/ -g  -c testMPDParser.cpp -D_GLIBCXX_USE_CXX11_ABI=0
 g++ -I../../google_test -std=c++11 -I../util/ -g  -c testOmafReader.cpp -D_GLIBCXX_USE_CXX11_ABI=0
 g++ -I../../google_test -std=c++11 -I../util/ -g  -c testOmafReaderManager.cpp -D_GLIBCXX_USE_CXX11_ABI=0
+g++ -I../../google_test -std=c++11 -I../util/ -g  -c testCurlDownloader.cpp -D_GLIBCXX_USE_CXX11_ABI=0
+g++ -I../../google_test -std=c++11 -I../util/ -g  -c testDownloadManager.cpp -D_GLIBCXX_USE_CXX11_ABI=0
+g++ -I../../google_test -std=c++11 -I../util/ -g  -c testRepresentationSelector.cpp -D_GLIBCXX_USE_CXX11_ABI=0
+g++ -I../../google_test -std=c++11 -I../util/ -g  -c testTileDownloadScheduler.cpp -D_GLIBCXX_USE_CXX11_ABI=0
 
 LD_FLAGS="-I/usr/local/include/ -lcurl -lstdc++ -lOmafDashAccess -lpthread -lglog -l360SCVP -lm -L/usr/local/lib"
-g++ -L/usr/local/lib testMediaSource.o testMPDParser.o testOmafReader.o testOmafReaderManager.o libgtest.a -o testLib ${LD_FLAGS}
+g++ -L/usr/local/lib testMediaSource.o testMPDParser.o testOmafReader.o testOmafReaderManager.o testCurlDownloader.o testDownloadManager.o testRepresentationSelector.o testTileDownloadScheduler.o libgtest.a -o testLib ${LD_FLAGS}
 g++ -L/usr/local/lib testMediaSource.o libgtest.a -o testMediaSource ${LD_FLAGS}
 g++ -L/usr/local/lib testMPDParser.o libgtest.a -o testMPDParser ${LD_FLAGS}
 g++ -L/usr/local/lib testOmafReader.o libgtest.a -o testOmafReader ${LD_FLAGS}
 g++ -L/usr/local/lib testOmafReaderManager.o libgtest.a -o testOmafReaderManager ${LD_FLAGS}
+g++ -L/usr/local/lib testCurlDownloader.o libgtest.a -o testCurlDownloader ${LD_FLAGS}
+g++ -L/usr/local/lib testDownloadManager.o libgtest.a -o testDownloadManager ${LD_FLAGS}
+g++ -L/usr/local/lib testRepresentationSelector.o libgtest.a -o testRepresentationSelector ${LD_FLAGS}
+g++ -L/usr/local/lib testTileDownloadScheduler.o libgtest.a -o testTileDownloadScheduler ${LD_FLAGS}
 
 ./run.sh
 if [ $? -ne 0 ]; then exit 1; fi
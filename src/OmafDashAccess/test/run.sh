@@ -24,6 +24,19 @@ if [ $? -ne 0 ]; then exit 1; fi
 if [ $? -ne 0 ]; then exit 1; fi
 ./testOmafReaderManager
 if [ $? -ne 0 ]; then exit 1; fi
+./testDownloadManager
+if [ $? -ne 0 ]; then exit 1; fi
+./testRepresentationSelector
+if [ $? -ne 0 ]; then exit 1; fi
+./testTileDownloadScheduler
+if [ $? -ne 0 ]; then exit 1; fi
+python3 -m http.server 8000 > /dev/null 2>&1 &
+HTTP_SERVER_PID=$!
+sleep 1
+./testCurlDownloader
+TEST_RET=$?
+kill ${HTTP_SERVER_PID}
+if [ ${TEST_RET} -ne 0 ]; then exit 1; fi
 
 # All caes passed
 ################################
@@ -0,0 +1,259 @@
+/*
+ * Copyright (c) 2019, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+//!
+//! \file:   testCurlDownloader.cpp
+//! \brief:  curl downloader and download engine unit test, files are
+//!          served by "python3 -m http.server 8000" started in test folder
+//!
+
+#include "gtest/gtest.h"
+#include "../OmafDashDownload/OmafCurlDownloader.h"
+
+VCD_USE_VROMAF;
+VCD_USE_VRVIDEO;
+
+namespace {
+
+#define TEST_FILES_NUM  24
+#define TEST_FILE_SIZE  (256 * 1024)
+
+class TestObserver : public OmafDownloaderObserver
+{
+public:
+    TestObserver()
+    {
+        m_downloadedNum = 0;
+        m_stoppedNum    = 0;
+    };
+
+    virtual ~TestObserver(){};
+
+    virtual void DownloadDataNotify(uint64_t downloadedDataLength){};
+
+    virtual void DownloadStatusNotify(DownloaderStatus status)
+    {
+        if (status == DOWNLOADED)
+            __sync_fetch_and_add(&m_downloadedNum, 1);
+        else if (status == STOPPED)
+            __sync_fetch_and_add(&m_stoppedNum, 1);
+    };
+
+    uint32_t m_downloadedNum;
+    uint32_t m_stoppedNum;
+};
+
+class CurlDownloaderTest : public testing::Test
+{
+public:
+    virtual void SetUp()
+    {
+        m_baseUrl = "http://127.0.0.1:8000/curl_test_files/";
+
+        mkdir("./curl_test_files", 0755);
+        for (uint32_t i = 0; i < TEST_FILES_NUM; i++)
+        {
+            std::ofstream file("./curl_test_files/seg" + to_string(i) + ".bin", ios::out|ios::binary);
+            for (uint32_t j = 0; j < TEST_FILE_SIZE; j++)
+            {
+                char value = (char)((i + j) & 0xFF);
+                file.write(&value, 1);
+            }
+            file.close();
+        }
+    }
+
+    virtual void TearDown()
+    {
+        for (uint32_t i = 0; i < TEST_FILES_NUM; i++)
+        {
+            remove(("./curl_test_files/seg" + to_string(i) + ".bin").c_str());
+        }
+        rmdir("./curl_test_files");
+    }
+
+    bool WaitDownloaded(TestObserver *observer, uint32_t num)
+    {
+        return WaitNotified(&observer->m_downloadedNum, num);
+    }
+
+    bool WaitStopped(TestObserver *observer, uint32_t num)
+    {
+        return WaitNotified(&observer->m_stoppedNum, num);
+    }
+
+    bool WaitNotified(uint32_t *notifiedNum, uint32_t num)
+    {
+        // wait for at most 10 seconds
+        for (uint32_t i = 0; i < 1000; i++)
+        {
+            if (*(volatile uint32_t*)notifiedNum >= num)
+                return true;
+            usleep(10000);
+        }
+        return false;
+    }
+
+    std::string m_baseUrl;
+};
+
+TEST_F(CurlDownloaderTest, DownloadInParallel)
+{
+    TestObserver observer;
+    OmafCurlDownloader *downloaders[TEST_FILES_NUM];
+    for (uint32_t i = 0; i < TEST_FILES_NUM; i++)
+    {
+        downloaders[i] = new OmafCurlDownloader(m_baseUrl + "seg" + to_string(i) + ".bin");
+        EXPECT_TRUE(downloaders[i] != NULL);
+
+        downloaders[i]->ObserverAttach(&observer);
+        downloaders[i]->SetPriority(i % 3);
+        EXPECT_TRUE(downloaders[i]->Start() == OD_STATUS_SUCCESS);
+    }
+
+    EXPECT_TRUE(WaitDownloaded(&observer, TEST_FILES_NUM));
+
+    uint8_t *data = new uint8_t[TEST_FILE_SIZE];
+    for (uint32_t i = 0; i < TEST_FILES_NUM; i++)
+    {
+        EXPECT_TRUE(downloaders[i]->Read(data, TEST_FILE_SIZE) == OD_STATUS_SUCCESS);
+        bool isSame = true;
+        for (uint32_t j = 0; j < TEST_FILE_SIZE; j++)
+        {
+            if (data[j] != (uint8_t)((i + j) & 0xFF))
+            {
+                isSame = false;
+                break;
+            }
+        }
+        EXPECT_TRUE(isSame);
+
+        downloaders[i]->Stop();
+        delete downloaders[i];
+    }
+    delete [] data;
+}
+
+TEST_F(CurlDownloaderTest, StopBeforeDownloaded)
+{
+    TestObserver observer;
+    OmafCurlDownloader *downloaders[TEST_FILES_NUM];
+    for (uint32_t i = 0; i < TEST_FILES_NUM; i++)
+    {
+        downloaders[i] = new OmafCurlDownloader(m_baseUrl + "seg" + to_string(i) + ".bin");
+        EXPECT_TRUE(downloaders[i] != NULL);
+
+        downloaders[i]->ObserverAttach(&observer);
+        downloaders[i]->Start();
+    }
+
+    // every downloader ends up stopped whether it is finished or not
+    for (uint32_t i = 0; i < TEST_FILES_NUM; i++)
+    {
+        EXPECT_TRUE(downloaders[i]->Stop() == OD_STATUS_SUCCESS);
+        delete downloaders[i];
+    }
+    EXPECT_TRUE(observer.m_stoppedNum == TEST_FILES_NUM);
+
+    // the engine keeps working after requests are cancelled
+    TestObserver newObserver;
+    OmafCurlDownloader *downloader = new OmafCurlDownloader(m_baseUrl + "seg0.bin");
+    downloader->ObserverAttach(&newObserver);
+    EXPECT_TRUE(downloader->Start() == OD_STATUS_SUCCESS);
+    EXPECT_TRUE(WaitDownloaded(&newObserver, 1));
+    downloader->Stop();
+    delete downloader;
+}
+
+TEST_F(CurlDownloaderTest, StreamRandomAccess)
+{
+    Stream stream;
+    EXPECT_TRUE(stream.Reserve(100) == OD_STATUS_SUCCESS);
+
+    // more data than reserved makes the buffer grow
+    char subStream[64];
+    for (uint32_t i = 0; i < 4; i++)
+    {
+        for (uint32_t j = 0; j < 64; j++)
+            subStream[j] = (char)(i * 64 + j);
+        EXPECT_TRUE(stream.AddSubStream(subStream, 64) == OD_STATUS_SUCCESS);
+    }
+    stream.ReachedEOS();
+    EXPECT_TRUE(stream.GetTotalStreamLength() == 256);
+
+    char data[256];
+    EXPECT_TRUE(stream.PeekStream(data, 8, 100) == OD_STATUS_SUCCESS);
+    EXPECT_TRUE(data[0] == (char)100 && data[7] == (char)107);
+
+    // partial get only consumes the got data
+    EXPECT_TRUE(stream.GetStream(data, 10) == OD_STATUS_SUCCESS);
+    EXPECT_TRUE(data[9] == (char)9);
+    EXPECT_TRUE(stream.GetTotalStreamLength() == 246);
+    EXPECT_TRUE(stream.PeekStream(data, 4) == OD_STATUS_SUCCESS);
+    EXPECT_TRUE(data[0] == (char)10);
+
+    std::ostringstream output;
+    EXPECT_TRUE(stream.GetStream(output, 246) == OD_STATUS_SUCCESS);
+    std::string outputData = output.str();
+    EXPECT_TRUE(outputData.size() == 246);
+    EXPECT_TRUE(outputData[0] == (char)10 && outputData[245] == (char)255);
+
+    EXPECT_TRUE(stream.GetTotalStreamLength() == 0);
+    EXPECT_TRUE(stream.PeekStream(data, 4) != OD_STATUS_SUCCESS);
+}
+
+TEST_F(CurlDownloaderTest, DownloadNotExistFile)
+{
+    TestObserver observer;
+    OmafCurlDownloader *downloader = new OmafCurlDownloader("http://127.0.0.1:1/no_server.bin");
+    downloader->ObserverAttach(&observer);
+    EXPECT_TRUE(downloader->Start() == OD_STATUS_SUCCESS);
+
+    // failed request is finished as stopped, so nobody waits for it
+    // forever and nothing is taken as downloaded data
+    EXPECT_TRUE(WaitStopped(&observer, 1));
+    EXPECT_TRUE(observer.m_downloadedNum == 0);
+    downloader->Stop();
+    delete downloader;
+}
+
+TEST_F(CurlDownloaderTest, DownloadHttpError)
+{
+    TestObserver observer;
+    OmafCurlDownloader *downloader = new OmafCurlDownloader(m_baseUrl + "not_exist.bin");
+    downloader->ObserverAttach(&observer);
+    EXPECT_TRUE(downloader->Start() == OD_STATUS_SUCCESS);
+
+    // error page of 404 response isn't delivered as segment data
+    EXPECT_TRUE(WaitStopped(&observer, 1));
+    EXPECT_TRUE(observer.m_downloadedNum == 0);
+
+    uint8_t data[4];
+    EXPECT_TRUE(downloader->Peek(data, 4) != OD_STATUS_SUCCESS);
+    downloader->Stop();
+    delete downloader;
+}
+}
@@ -0,0 +1,156 @@
+/*
+ * Copyright (c) 2019, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+//!
+//! \file:   testDownloadManager.cpp
+//! \brief:  download manager bandwidth statistics unit test
+//!
+
+#include "gtest/gtest.h"
+#include "../DownloadManager.h"
+
+VCD_USE_VROMAF;
+VCD_USE_VRVIDEO;
+
+namespace {
+
+#define TEST_CHUNK_SIZE   (64 * 1024)
+#define TEST_CHUNK_NUM    16
+
+class DownloadManagerTest : public testing::Test
+{
+public:
+    virtual void SetUp()
+    {
+        m_manager = new DownloadManager();
+    }
+
+    virtual void TearDown()
+    {
+        delete m_manager;
+        m_manager = NULL;
+    }
+
+    //!
+    //! \brief  feed bytes of one transfer in chunks with interval in ms
+    //!
+    void Transfer(uint32_t chunkNum, uint32_t chunkSize, uint32_t interval)
+    {
+        m_manager->TransferStarted();
+        for (uint32_t i = 0; i < chunkNum; i++)
+        {
+            usleep(interval * 1000);
+            m_manager->AddDownloadedBytes(chunkSize);
+        }
+        m_manager->TransferFinished();
+    }
+
+    DownloadManager *m_manager;
+};
+
+TEST_F(DownloadManagerTest, NoSample)
+{
+    EXPECT_EQ(m_manager->GetImmediateBitrate(), 0);
+    EXPECT_EQ(m_manager->GetAverageBitrate(), 0);
+    EXPECT_EQ(m_manager->GetBandwidthEstimate(), 0ULL);
+
+    // too small to be a sample
+    Transfer(1, 1024, 1);
+    EXPECT_EQ(m_manager->GetBandwidthEstimate(), 0ULL);
+    EXPECT_EQ(m_manager->GetDownloadBytes(), 1024ULL);
+}
+
+TEST_F(DownloadManagerTest, EstimateBandwidth)
+{
+    // 64KB every 10ms, not more than 52Mbps
+    Transfer(TEST_CHUNK_NUM, TEST_CHUNK_SIZE, 10);
+
+    uint64_t upperBound = (uint64_t)TEST_CHUNK_SIZE * 8 * 100;
+    uint64_t estimate = m_manager->GetBandwidthEstimate();
+    EXPECT_GT(estimate, 0ULL);
+    EXPECT_LE(estimate, upperBound);
+    EXPECT_GT(m_manager->GetImmediateBitrate(), 0);
+    EXPECT_EQ(m_manager->GetAverageBitrate(), m_manager->GetImmediateBitrate());
+
+    // link slows down, the estimation goes down at once
+    Transfer(TEST_CHUNK_NUM, TEST_CHUNK_SIZE / 8, 10);
+    EXPECT_LT(m_manager->GetBandwidthEstimate(), estimate / 2);
+    EXPECT_LT(m_manager->GetAverageBitrate(), (int)estimate);
+}
+
+TEST_F(DownloadManagerTest, ParallelTransfers)
+{
+    // link is busy until the last transfer finishes, bytes of all
+    // transfers are in one sample
+    m_manager->TransferStarted();
+    m_manager->TransferStarted();
+    for (uint32_t i = 0; i < TEST_CHUNK_NUM; i++)
+    {
+        usleep(10000);
+        m_manager->AddDownloadedBytes(TEST_CHUNK_SIZE);
+        m_manager->AddDownloadedBytes(TEST_CHUNK_SIZE);
+    }
+    m_manager->TransferFinished();
+    EXPECT_EQ(m_manager->GetBandwidthEstimate(), 0ULL);
+    m_manager->TransferFinished();
+
+    uint64_t estimate = m_manager->GetBandwidthEstimate();
+    EXPECT_GT(estimate, (uint64_t)TEST_CHUNK_SIZE * 8 * 100 / 2);
+    EXPECT_LE(estimate, (uint64_t)TEST_CHUNK_SIZE * 8 * 100 * 2);
+
+    // unmatched finish is ignored
+    m_manager->TransferFinished();
+    EXPECT_EQ(m_manager->GetBandwidthEstimate(), estimate);
+}
+
+TEST_F(DownloadManagerTest, DownloadingSegments)
+{
+    // segments are only used as keys
+    OmafSegment *seg1 = (OmafSegment*)0x1000;
+    OmafSegment *seg2 = (OmafSegment*)0x2000;
+    OmafSegment *seg3 = (OmafSegment*)0x3000;
+    m_manager->AddDownloadingSegment(1, seg1);
+    m_manager->AddDownloadingSegment(1, seg2);
+    m_manager->AddDownloadingSegment(2, seg3);
+
+    std::vector<OmafSegment*> visited;
+    auto visit = [&visited](OmafSegment* segment) { visited.push_back(segment); };
+    m_manager->VisitDownloadingSegments(1, visit);
+    EXPECT_EQ(visited.size(), 2UL);
+
+    m_manager->RemoveDownloadingSegment(seg1);
+    m_manager->RemoveDownloadingSegment(seg1);
+    visited.clear();
+    m_manager->VisitDownloadingSegments(1, visit);
+    ASSERT_EQ(visited.size(), 1UL);
+    EXPECT_EQ(visited.front(), seg2);
+
+    visited.clear();
+    m_manager->VisitDownloadingSegments(3, visit);
+    EXPECT_TRUE(visited.empty());
+}
+
+}
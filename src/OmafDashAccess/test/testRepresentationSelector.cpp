@@ -0,0 +1,243 @@
+/*
+ * Copyright (c) 2019, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+//!
+//! \file:   testRepresentationSelector.cpp
+//! \brief:  representation selection unit test with fixed bandwidth
+//!          estimations and buffer levels
+//!
+
+#include "gtest/gtest.h"
+#include "../RepresentationSelector.h"
+
+VCD_USE_VROMAF;
+VCD_USE_VRVIDEO;
+
+namespace {
+
+#define TEST_SEGMENT_DURATION  1000     // ms
+#define TEST_BUFFER_LOW        500      // less than ABR_BUFFER_LOW_SEGMENTS segments
+#define TEST_BUFFER_NORMAL     2000
+#define TEST_BUFFER_HIGH       3000     // ABR_BUFFER_HIGH_SEGMENTS segments
+#define TEST_INIT_SEGMENT      "init.mp4"
+
+//!
+//! \brief  adaptation set whose representations are built directly
+//!         instead of parsed from mpd
+//!
+class TestAdaptationSet : public OmafAdaptationSet
+{
+public:
+    TestAdaptationSet(int id, std::string qualityRanking)
+    {
+        mID = id;
+        mAdaptationSet = new AdaptationSetElement();
+        mQualityRanking = qualityRanking;
+    }
+
+    virtual ~TestAdaptationSet()
+    {
+        SAFE_DELETE(mAdaptationSet);
+    }
+
+    //!
+    //! \brief  add a representation, the first one added is current
+    //!
+    RepresentationElement* AddRepresentation(int32_t bandwidth, std::string initialization = TEST_INIT_SEGMENT)
+    {
+        RepresentationElement *rep = new RepresentationElement();
+        rep->SetId(to_string(mAdaptationSet->GetRepresentations().size()));
+        rep->SetBandwidth(bandwidth);
+        rep->SetQualityRanking(mQualityRanking);
+
+        SegmentElement *seg = new SegmentElement();
+        seg->SetInitialization(initialization);
+        rep->SetSegment(seg);
+
+        mAdaptationSet->AddRepresentation(rep);
+        if (!mRepresentation)
+            mRepresentation = rep;
+        return rep;
+    }
+
+    void SetCurrent(RepresentationElement* rep) { mRepresentation = rep; };
+
+    int32_t GetCurrentBandwidth() { return mRepresentation->GetBandwidth(); };
+
+private:
+    std::string mQualityRanking;
+};
+
+class RepresentationSelectorTest : public testing::Test
+{
+public:
+    virtual void SetUp()
+    {
+        m_selector = new RepresentationSelector();
+    }
+
+    virtual void TearDown()
+    {
+        delete m_selector;
+        m_selector = NULL;
+
+        for (auto& it : m_adaptationSets)
+            delete it.second;
+        m_adaptationSets.clear();
+    }
+
+    //!
+    //! \brief  add an adaptation set with representations sharing one
+    //!         initialization segment, the highest one is current
+    //!
+    TestAdaptationSet* AddAdaptationSet(std::string qualityRanking, std::vector<int32_t> bandwidths)
+    {
+        TestAdaptationSet *pAS = new TestAdaptationSet(m_adaptationSets.size(), qualityRanking);
+        RepresentationElement *rep = NULL;
+        for (auto bandwidth : bandwidths)
+            rep = pAS->AddRepresentation(bandwidth);
+        pAS->SetCurrent(rep);
+
+        m_adaptationSets[pAS->GetID()] = pAS;
+        return pAS;
+    }
+
+    int Select(uint64_t bandwidth, uint64_t bufferedTime)
+    {
+        return m_selector->SelectRepresentations(m_adaptationSets, m_extractors, bandwidth,
+                                                 bufferedTime, TEST_SEGMENT_DURATION);
+    }
+
+    RepresentationSelector            *m_selector;
+    std::map<int, OmafAdaptationSet*>  m_adaptationSets;
+    std::list<OmafExtractor*>          m_extractors;
+};
+
+TEST_F(RepresentationSelectorTest, NoBandwidthEstimate)
+{
+    TestAdaptationSet *pAS = AddAdaptationSet("1", {1000000, 2000000, 4000000});
+
+    // current representation is kept until bandwidth is measured
+    EXPECT_EQ(Select(0, TEST_BUFFER_LOW), ERROR_NONE);
+    EXPECT_EQ(pAS->GetCurrentBandwidth(), 4000000);
+}
+
+TEST_F(RepresentationSelectorTest, BufferFactors)
+{
+    // 9Mbps leaves 9M, 7.2M and 4.5M for high, normal and low buffer
+    uint64_t bufferedTime[3] = {TEST_BUFFER_HIGH, TEST_BUFFER_NORMAL, TEST_BUFFER_LOW};
+    int32_t  expected[3]     = {8000000, 5000000, 4000000};
+    for (uint32_t i = 0; i < 3; i++)
+    {
+        TearDown();
+        SetUp();
+        TestAdaptationSet *pAS = AddAdaptationSet("1", {2000000, 4000000, 5000000, 8000000});
+
+        EXPECT_EQ(Select(9000000, bufferedTime[i]), ERROR_NONE);
+        EXPECT_EQ(pAS->GetCurrentBandwidth(), expected[i]);
+    }
+}
+
+TEST_F(RepresentationSelectorTest, UpOneLevelDownAtOnce)
+{
+    TestAdaptationSet *pAS = AddAdaptationSet("1", {1000000, 2000000, 4000000, 8000000});
+
+    // drop to the lowest level at once
+    EXPECT_EQ(Select(1500000, TEST_BUFFER_HIGH), ERROR_NONE);
+    EXPECT_EQ(pAS->GetCurrentBandwidth(), 1000000);
+
+    // no going up while buffer is low, however high the bandwidth is
+    EXPECT_EQ(Select(100000000, TEST_BUFFER_LOW), ERROR_NONE);
+    EXPECT_EQ(pAS->GetCurrentBandwidth(), 1000000);
+
+    // then one level each time
+    int32_t expected[4] = {2000000, 4000000, 8000000, 8000000};
+    for (uint32_t i = 0; i < 4; i++)
+    {
+        EXPECT_EQ(Select(100000000, TEST_BUFFER_HIGH), ERROR_NONE);
+        EXPECT_EQ(pAS->GetCurrentBandwidth(), expected[i]);
+    }
+
+    // skip levels when going down
+    EXPECT_EQ(Select(3000000, TEST_BUFFER_HIGH), ERROR_NONE);
+    EXPECT_EQ(pAS->GetCurrentBandwidth(), 2000000);
+}
+
+TEST_F(RepresentationSelectorTest, ViewportBackgroundBudget)
+{
+    TestAdaptationSet *pViewport1  = AddAdaptationSet("1", {1000000, 2000000, 4000000, 8000000});
+    TestAdaptationSet *pViewport2  = AddAdaptationSet("1", {1000000, 2000000, 4000000, 8000000});
+    TestAdaptationSet *pBackground = AddAdaptationSet("2", {250000, 500000, 1000000});
+
+    // background gets 2.125M of 8.5M and uses 1M, then viewport tiles
+    // get the left 7.5M, in which 2 x 2M fits but 2 x 4M doesn't
+    EXPECT_EQ(Select(8500000, TEST_BUFFER_HIGH), ERROR_NONE);
+    EXPECT_EQ(pBackground->GetCurrentBandwidth(), 1000000);
+    EXPECT_EQ(pViewport1->GetCurrentBandwidth(), 2000000);
+    EXPECT_EQ(pViewport2->GetCurrentBandwidth(), 2000000);
+
+    // background 0.5M of 0.75M, viewport tiles 2 x 1M of 2.5M
+    EXPECT_EQ(Select(3000000, TEST_BUFFER_HIGH), ERROR_NONE);
+    EXPECT_EQ(pBackground->GetCurrentBandwidth(), 500000);
+    EXPECT_EQ(pViewport1->GetCurrentBandwidth(), 1000000);
+    EXPECT_EQ(pViewport2->GetCurrentBandwidth(), 1000000);
+
+    // disabled adaptation sets are neither switched nor counted
+    pViewport2->Enable(false);
+    EXPECT_EQ(Select(100000000, TEST_BUFFER_HIGH), ERROR_NONE);
+    EXPECT_EQ(pBackground->GetCurrentBandwidth(), 1000000);
+    EXPECT_EQ(pViewport1->GetCurrentBandwidth(), 2000000);
+    EXPECT_EQ(pViewport2->GetCurrentBandwidth(), 1000000);
+}
+
+TEST_F(RepresentationSelectorTest, SharedInitSegmentOnly)
+{
+    TestAdaptationSet *pAS = new TestAdaptationSet(0, "1");
+    m_adaptationSets[0] = pAS;
+    pAS->AddRepresentation(1000000);
+    pAS->AddRepresentation(2000000, "init_other.mp4");
+    pAS->AddRepresentation(4000000);
+
+    // the representation with another initialization segment is skipped
+    EXPECT_EQ(Select(100000000, TEST_BUFFER_HIGH), ERROR_NONE);
+    EXPECT_EQ(pAS->GetCurrentBandwidth(), 4000000);
+
+    EXPECT_EQ(Select(3000000, TEST_BUFFER_HIGH), ERROR_NONE);
+    EXPECT_EQ(pAS->GetCurrentBandwidth(), 1000000);
+}
+
+TEST_F(RepresentationSelectorTest, PerRepresentationInitSegment)
+{
+    TestAdaptationSet *pAS = new TestAdaptationSet(0, "1");
+    m_adaptationSets[0] = pAS;
+    pAS->AddRepresentation(1000000, "init_$RepresentationID$.mp4");
+    pAS->AddRepresentation(2000000, "init_$RepresentationID$.mp4");
+
+    // the reader only has the initialization segment of current one
+    EXPECT_EQ(Select(100000000, TEST_BUFFER_HIGH), ERROR_NONE);
+    EXPECT_EQ(pAS->GetCurrentBandwidth(), 1000000);
+}
+}
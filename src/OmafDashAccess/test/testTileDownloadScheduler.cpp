@@ -0,0 +1,198 @@
+/*
+ * Copyright (c) 2019, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+//!
+//! \file:   testTileDownloadScheduler.cpp
+//! \brief:  tile download priority unit test with fixed tile positions
+//!          and viewport poses
+//!
+
+#include "gtest/gtest.h"
+#include "../TileDownloadScheduler.h"
+
+VCD_USE_VROMAF;
+VCD_USE_VRVIDEO;
+
+namespace {
+
+//!
+//! \brief  tile adaptation set positioned by content coverage or SRD
+//!         instead of parsed from mpd
+//!
+class TestTileAdaptationSet : public OmafAdaptationSet
+{
+public:
+    TestTileAdaptationSet(int id, std::string qualityRanking)
+    {
+        mID = id;
+        mRepresentation = new RepresentationElement();
+        mRepresentation->SetQualityRanking(qualityRanking);
+    }
+
+    virtual ~TestTileAdaptationSet()
+    {
+        SAFE_DELETE(mRepresentation);
+        SAFE_DELETE(mCC);
+        SAFE_DELETE(mSRD);
+    }
+
+    void SetCentre(double azimuth, double elevation)
+    {
+        CoverageInfo info;
+        memset(&info, 0, sizeof(CoverageInfo));
+        info.centre_azimuth   = (int32_t)(azimuth * 65536);
+        info.centre_elevation = (int32_t)(elevation * 65536);
+
+        mCC = new ContentCoverage;
+        mCC->coverage_infos.push_back(info);
+    }
+
+    void SetSRD(int32_t x, int32_t y, int32_t w, int32_t h)
+    {
+        char value[64];
+        snprintf(value, sizeof(value), "0,%d,%d,%d,%d", x, y, w, h);
+        mSRD = new OmafSrd();
+        mSRD->SetInfo(value);
+    }
+};
+
+class TileDownloadSchedulerTest : public testing::Test
+{
+public:
+    virtual void SetUp()
+    {
+        m_scheduler = new TileDownloadScheduler();
+    }
+
+    virtual void TearDown()
+    {
+        delete m_scheduler;
+        m_scheduler = NULL;
+
+        for (auto& it : m_adaptationSets)
+            delete it.second;
+        m_adaptationSets.clear();
+    }
+
+    TestTileAdaptationSet* AddTile(std::string qualityRanking)
+    {
+        TestTileAdaptationSet *pAS = new TestTileAdaptationSet(m_adaptationSets.size(), qualityRanking);
+        m_adaptationSets[pAS->GetID()] = pAS;
+        return pAS;
+    }
+
+    void SetPose(float yaw, float pitch)
+    {
+        HeadPose pose;
+        memset(&pose, 0, sizeof(HeadPose));
+        pose.yaw   = yaw;
+        pose.pitch = pitch;
+        m_scheduler->SetCurrentPose(&pose);
+    }
+
+    //!
+    //! \brief  get ID of the adaptation set with the highest priority
+    //!
+    int GetTopTile(std::map<int, int32_t>& priorities)
+    {
+        int top = -1;
+        for (auto& it : priorities)
+        {
+            if (top < 0 || it.second > priorities[top])
+                top = it.first;
+        }
+        return top;
+    }
+
+    TileDownloadScheduler             *m_scheduler;
+    std::map<int, OmafAdaptationSet*>  m_adaptationSets;
+};
+
+TEST_F(TileDownloadSchedulerTest, YawToAzimuth)
+{
+    double azimuths[4] = {0, 90, -90, 180};
+    for (uint32_t i = 0; i < 4; i++)
+        AddTile("1")->SetCentre(azimuths[i], 0);
+
+    // yaw 90 is looking at azimuth -90, not at the mirrored tile
+    std::map<int, int32_t> priorities;
+    SetPose(90, 0);
+    EXPECT_EQ(m_scheduler->GetPriorities(m_adaptationSets, PF_ERP, priorities), ERROR_NONE);
+    EXPECT_EQ(GetTopTile(priorities), 2);
+    EXPECT_EQ(priorities[2], VIEWPORT_TILE_PRIORITY);
+    EXPECT_LT(priorities[1], priorities[0]);
+
+    priorities.clear();
+    SetPose(-90, 0);
+    EXPECT_EQ(m_scheduler->GetPriorities(m_adaptationSets, PF_ERP, priorities), ERROR_NONE);
+    EXPECT_EQ(GetTopTile(priorities), 1);
+
+    priorities.clear();
+    SetPose(0, 0);
+    EXPECT_EQ(m_scheduler->GetPriorities(m_adaptationSets, PF_ERP, priorities), ERROR_NONE);
+    EXPECT_EQ(GetTopTile(priorities), 0);
+}
+
+TEST_F(TileDownloadSchedulerTest, ErpTileFromSRD)
+{
+    // 4x2 tiles of 3840x1920 picture, tile centres are at azimuth
+    // 135, 45, -45, -135 and elevation 45, -45
+    for (int32_t row = 0; row < 2; row++)
+    {
+        for (int32_t col = 0; col < 4; col++)
+            AddTile("1")->SetSRD(col * 960, row * 960, 960, 960);
+    }
+
+    // right of the picture centre and upwards
+    std::map<int, int32_t> priorities;
+    SetPose(45, 45);
+    EXPECT_EQ(m_scheduler->GetPriorities(m_adaptationSets, PF_ERP, priorities), ERROR_NONE);
+    EXPECT_EQ(GetTopTile(priorities), 2);
+
+    priorities.clear();
+    SetPose(-135, -45);
+    EXPECT_EQ(m_scheduler->GetPriorities(m_adaptationSets, PF_ERP, priorities), ERROR_NONE);
+    EXPECT_EQ(GetTopTile(priorities), 4);
+}
+
+TEST_F(TileDownloadSchedulerTest, QualityRanking)
+{
+    TestTileAdaptationSet *pNear       = AddTile("1");
+    TestTileAdaptationSet *pFar        = AddTile("1");
+    TestTileAdaptationSet *pBackground = AddTile("2");
+    pNear->SetCentre(-90, 0);
+    pFar->SetCentre(90, 0);
+    pBackground->SetCentre(0, 0);
+
+    // background tile aside ranks between high quality tiles in view
+    // and out of view
+    std::map<int, int32_t> priorities;
+    SetPose(90, 0);
+    EXPECT_EQ(m_scheduler->GetPriorities(m_adaptationSets, PF_ERP, priorities), ERROR_NONE);
+    EXPECT_GT(priorities[pNear->GetID()], priorities[pBackground->GetID()]);
+    EXPECT_GT(priorities[pBackground->GetID()], priorities[pFar->GetID()]);
+}
+}
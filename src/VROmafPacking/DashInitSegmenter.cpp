@@ -260,7 +260,27 @@ int32_t DashInitSegmenter::GenerateInitSegment(
     {
         if (m_config.writeToBitstream)
         {
-            if (!endOfStream)
+            if (!endOfStream && trackSegCtx->dashInitCfg.segWriter)
+            {
+                SegmentWriter *segWriter = trackSegCtx->dashInitCfg.segWriter;
+                SegmentBuffer *segBuffer = segWriter->GetBuffer();
+                if (!segBuffer)
+                    return OMAF_ERROR_NULL_PTR;
+
+                SegmentStreamBuf streamBuf(segBuffer);
+                std::ostream frameStream(&streamBuf);
+                StreamSegmenter::Segmenter::writeInitSegment(frameStream, MakeInitSegment(m_config.fragmented));
+
+                int32_t ret = streamBuf.Finish();
+                if (ret)
+                {
+                    SegmentWriter::DestroyBuffer(segBuffer);
+                    return ret;
+                }
+
+                return segWriter->WriteSegment(segBuffer, trackSegCtx->dashInitCfg.initSegName);
+            }
+            else if (!endOfStream)
             {
                 std::ostringstream frameStream;
                 StreamSegmenter::Segmenter::writeInitSegment(frameStream, MakeInitSegment(m_config.fragmented));
@@ -36,6 +36,7 @@
 
 #include "DashSegmenter.h"
 #include "streamsegmenter/segmenterapi.hpp"
+#include "../utils/OmafStructure.h"
 
 VCD_NS_BEGIN
 
@@ -101,6 +102,8 @@ DashSegmenter::DashSegmenter(GeneralSegConfig *dashConfig, bool createWriter)
 
 DashSegmenter::~DashSegmenter()
 {
+    SegmentWriter::DestroyBuffer(m_segBuffer);
+    m_segBuffer = NULL;
 }
 
 bool DashSegmenter::DetectNonRefFrame(uint8_t *frameData)
@@ -195,6 +198,15 @@ int32_t DashSegmenter::SegmentOneTrack(Nalu *dataNalu, CodedMeta codedMeta, char
         trackInfo.lastPresIndex = frameMeta.presIndex;
         trackInfo.isFirstFrame = false;
 
+        // chunks are cut every framesPerChunk frames whatever the
+        // frame type, so record whether each one starts with IDR
+        if (m_config.framesPerChunk)
+        {
+            if (!(m_fedFramesNum % m_config.framesPerChunk))
+                m_chunksStartWithIDR.push_back(frameMeta.isIDR());
+            m_fedFramesNum++;
+        }
+
         Feed(trackId, codedMeta, dataNalu, frameCts);
 
     }
@@ -209,19 +221,34 @@ int32_t DashSegmenter::SegmentOneTrack(Nalu *dataNalu, CodedMeta codedMeta, char
     {
         for (auto& segment : segments)
         {
-            m_segNum++;
-            snprintf(m_segName, 1024, "%s.%ld.mp4", outBaseName, m_segNum);
-
-            WriteSegment(segment);
+            int32_t ret = ERROR_NONE;
+            if (m_config.chunksPerSegment)
+            {
+                ret = WriteChunk(segment, outBaseName);
+            }
+            else
+            {
+                m_segNum++;
+                snprintf(m_segName, 1024, "%s.%ld.mp4", outBaseName, m_segNum);
+                ret = WriteSegment(segment);
+            }
+            if (ret)
+                return ret;
         }
     }
 
+    // the last segment may be shorter than the configured chunks number
+    if (codedMeta.isEOS && m_config.chunksPerSegment && (m_chunkNum % m_config.chunksPerSegment))
+    {
+        m_chunkNum = 0;
+        return m_config.segWriter->WriteChunk(NULL, m_segName, true);
+    }
+
     return ERROR_NONE;
 }
 
 int32_t DashSegmenter::WriteSegment(StreamSegmenter::Segmenter::Segments& aSegment)
 {
-    std::ostringstream frameStream;
     std::unique_ptr<std::ostringstream> sidxStream;
 
     if (m_config.useSeparatedSidx)
@@ -241,20 +268,129 @@ int32_t DashSegmenter::WriteSegment(StreamSegmenter::Segmenter::Segments& aSegme
         //mSidxWriter = mSegmentWriter.newSidxWriter();
     }
 
+    SegmentWriter *segWriter = m_config.segWriter;
+    SegmentBuffer *segBuffer = NULL;
+    if (segWriter)
+    {
+        segBuffer = segWriter->GetBuffer();
+    }
+    else
+    {
+        if (!m_segBuffer)
+        {
+            m_segBuffer = new SegmentBuffer;
+        }
+        segBuffer = m_segBuffer;
+    }
+    if (!segBuffer)
+        return OMAF_ERROR_NULL_PTR;
+
+    SegmentStreamBuf streamBuf(segBuffer);
+    std::ostream frameStream(&streamBuf);
+
     m_segmentWriter->writeSubsegments(frameStream, aSegment);
 
-    std::string frameString(frameStream.str());
+    int32_t ret = streamBuf.Finish();
+    if (ret)
+    {
+        if (segWriter)
+        {
+            SegmentWriter::DestroyBuffer(segBuffer);
+        }
+        return ret;
+    }
+
+    if (segWriter)
+        return segWriter->WriteSegment(segBuffer, m_segName);
 
-    m_file = fopen(m_segName, "wb+");
-    if (!m_file)
+    return SegmentWriter::WriteFile(segBuffer, m_segName, false);
+}
+
+int32_t DashSegmenter::WriteChunk(StreamSegmenter::Segmenter::Segments& aChunk, char *outBaseName)
+{
+    SegmentWriter *segWriter = m_config.segWriter;
+    if (!segWriter)
         return OMAF_ERROR_NULL_PTR;
 
-    fwrite(frameString.c_str(), 1, frameString.size(), m_file);
+    bool startWithIDR = false;
+    if (m_chunksStartWithIDR.size())
+    {
+        startWithIDR = m_chunksStartWithIDR.front();
+        m_chunksStartWithIDR.pop_front();
+    }
+
+    uint32_t chunkIdx = m_chunkNum % m_config.chunksPerSegment;
+    if (!chunkIdx)
+    {
+        // clients joining at this segment can't decode it otherwise
+        if (!startWithIDR)
+        {
+            LOG(ERROR) << "Segment " << (m_segNum + 1) << " of " << outBaseName << " doesn't start with IDR frame !" << std::endl;
+            return OMAF_ERROR_INVALID_FRAME_BITSTREAM;
+        }
+
+        m_segNum++;
+        snprintf(m_segName, 1024, "%s.%ld.mp4", outBaseName, m_segNum);
+    }
+    bool isLast = ((chunkIdx + 1) == m_config.chunksPerSegment);
 
-    fclose(m_file);
-    m_file = NULL;
+    // only the first chunk starts with segment type box
+    if (!m_config.useSeparatedSidx)
+    {
+        m_segmentWriter->setWriteSegmentHeader(!chunkIdx);
+    }
 
-    return ERROR_NONE;
+    SegmentBuffer *segBuffer = segWriter->GetBuffer();
+    if (!segBuffer)
+        return OMAF_ERROR_NULL_PTR;
+
+    SegmentStreamBuf streamBuf(segBuffer);
+    std::ostream chunkStream(&streamBuf);
+
+    m_segmentWriter->writeSubsegments(chunkStream, aChunk);
+
+    int32_t ret = streamBuf.Finish();
+    if (ret)
+    {
+        SegmentWriter::DestroyBuffer(segBuffer);
+        return ret;
+    }
+
+    m_chunkNum++;
+    return segWriter->WriteChunk(segBuffer, m_segName, isLast);
+}
+
+//!
+//! \brief  Calculate the size of the extractor NAL unit which
+//!         PackExtractors will write for one extractor
+//!
+static uint32_t CalculateExtractorNaluSize(Extractor *extractor)
+{
+    // NAL length field and two bytes NAL header
+    uint32_t naluSize = HEVC_STARTCODES_LEN + HEVC_NALUHEADER_LEN;
+
+    std::list<InlineConstructor*>::iterator itInline;
+    for (itInline = extractor->inlineConstructor.begin();
+        itInline != extractor->inlineConstructor.end(); itInline++)
+    {
+        // constructor type, data length and inline data
+        naluSize += 2 + (*itInline)->length;
+    }
+
+    // constructor type, track reference index, sample offset,
+    // data offset and data length
+    naluSize += (uint32_t)(extractor->sampleConstructor.size()) * 11;
+
+    return naluSize;
+}
+
+static inline uint8_t* WriteUint32BE(uint8_t *dst, uint32_t value)
+{
+    dst[0] = (uint8_t)(value >> 24);
+    dst[1] = (uint8_t)(value >> 16);
+    dst[2] = (uint8_t)(value >> 8);
+    dst[3] = (uint8_t)(value);
+    return dst + 4;
 }
 
 int32_t DashSegmenter::PackExtractors(
@@ -262,108 +398,72 @@ int32_t DashSegmenter::PackExtractors(
     std::list<TrackId> refTrackIdxs,
     Nalu *extractorsNalu)
 {
-    if (!extractorsMap)
+    if (!extractorsMap || !extractorsNalu)
         return OMAF_ERROR_NULL_PTR;
 
-    std::vector<uint8_t> extractorNALUs;
+    if ((extractorsNalu->data == NULL) != (extractorsNalu->dataSize == 0))
+        return OMAF_ERROR_INVALID_DATA;
 
-    std::map<uint8_t, Extractor*>::iterator it;
-    std::list<TrackId>::iterator itRefTrack = refTrackIdxs.begin();
-    if (itRefTrack == refTrackIdxs.end())
+    if (refTrackIdxs.size() < extractorsMap->size())
         return OMAF_ERROR_INVALID_REF_TRACK;
-    for (it = extractorsMap->begin(); it != extractorsMap->end(); it++, itRefTrack++)
+
+    std::map<uint8_t, Extractor*>::iterator it;
+    uint64_t extractorByteSize = 0;
+    for (it = extractorsMap->begin(); it != extractorsMap->end(); it++)
     {
         Extractor *extractor = it->second;
         if (!extractor)
             return OMAF_ERROR_NULL_PTR;
 
+        extractorByteSize += CalculateExtractorNaluSize(extractor);
+    }
+
+    uint64_t origDataSize = extractorsNalu->dataSize;
+    uint8_t *data = (uint8_t*)realloc((void*)(extractorsNalu->data), origDataSize + extractorByteSize);
+    if (!data)
+        return OMAF_ERROR_NULL_PTR;
+
+    extractorsNalu->data = data;
+    extractorsNalu->dataSize = origDataSize + extractorByteSize;
+
+    uint8_t *dst = data + origDataSize;
+    std::list<TrackId>::iterator itRefTrack = refTrackIdxs.begin();
+    for (it = extractorsMap->begin(); it != extractorsMap->end(); it++, itRefTrack++)
+    {
+        Extractor *extractor = it->second;
+        uint32_t naluSize = CalculateExtractorNaluSize(extractor);
 
-        StreamSegmenter::Segmenter::HevcExtractorTrackFrameData hevcExFrame;
-        hevcExFrame.nuhTemporalIdPlus1 = DEFAULT_HEVC_TEMPORALIDPLUS1;//extractor.nuhTemporalIdPlus1;
-        std::list<SampleConstructor*>::iterator createSam;
-        std::list<InlineConstructor*>::iterator createLine;
+        dst = WriteUint32BE(dst, naluSize - HEVC_STARTCODES_LEN);
+        *dst++ = (uint8_t)(HEVC_EXTRACTOR_NALU_TYPE << 1);
+        *dst++ = DEFAULT_HEVC_TEMPORALIDPLUS1;
 
-        StreamSegmenter::Segmenter::HevcExtractor hevcExOutput;
-        for (createSam = extractor->sampleConstructor.begin(),
-            createLine = extractor->inlineConstructor.begin();
-            createSam != extractor->sampleConstructor.end() ||
-            createLine != extractor->inlineConstructor.end();)
+        // constructors are written in pairs, inline constructor first
+        std::list<SampleConstructor*>::iterator createSam = extractor->sampleConstructor.begin();
+        std::list<InlineConstructor*>::iterator createLine = extractor->inlineConstructor.begin();
+        while (createSam != extractor->sampleConstructor.end() ||
+            createLine != extractor->inlineConstructor.end())
         {
             if (createLine != extractor->inlineConstructor.end())
             {
-                hevcExOutput.inlineConstructor = StreamSegmenter::Segmenter::HevcExtractorInlineConstructor{};
-                std::vector<uint8_t> necessaryInput(
-                    static_cast<const uint8_t*>((*createLine)->inlineData),
-                    static_cast<const uint8_t*>((*createLine)->inlineData + (*createLine)->length));
-                hevcExOutput.inlineConstructor->inlineData = std::move(necessaryInput);
+                *dst++ = EXTRACTOR_INLINE_CONSTRUCTOR_TYPE;
+                *dst++ = (*createLine)->length;
+                memcpy(dst, (*createLine)->inlineData, (*createLine)->length);
+                dst += (*createLine)->length;
                 createLine++;
             }
-            else if (createSam != extractor->sampleConstructor.end())
+            if (createSam != extractor->sampleConstructor.end())
             {
-                hevcExOutput.sampleConstructor = StreamSegmenter::Segmenter::HevcExtractorSampleConstructor{};
-                hevcExOutput.sampleConstructor->sampleOffset = 0;
-                hevcExOutput.sampleConstructor->dataOffset = (*createSam)->dataOffset;
-                hevcExOutput.sampleConstructor->dataLength = (*createSam)->dataLength;
-                hevcExOutput.sampleConstructor->trackId = (*itRefTrack).get();//(*createSam)->trackRefIndex;  // Note: this refers to the index in the track references. It works if trackIds are 1-based and contiguous, as the spec expects the index is 1-based.
+                *dst++ = EXTRACTOR_SAMPLE_CONSTRUCTOR_TYPE;
+                *dst++ = (uint8_t)((*itRefTrack).get()); // the index in the track references, trackIds are 1-based and contiguous
+                *dst++ = 0;
+                dst = WriteUint32BE(dst, (*createSam)->dataOffset);
+                dst = WriteUint32BE(dst, (*createSam)->dataLength);
                 createSam++;
-                // now we have a full extractor: either just a sample constructor, or inline+sample constructor pair
-                hevcExFrame.samples.push_back(hevcExOutput);
-                const StreamSegmenter::FrameData& nal = hevcExFrame.toFrameData();
-                extractorNALUs.insert(extractorNALUs.end(), make_move_iterator(nal.begin()), make_move_iterator(nal.end()));
             }
         }
     }
 
-    if (extractorsNalu->data == NULL)
-    {
-        if (extractorsNalu->dataSize != 0)
-            return OMAF_ERROR_INVALID_DATA;
-
-        int32_t extractorByteSize = extractorNALUs.size();
-
-        extractorsNalu->dataSize = extractorByteSize;
-        extractorsNalu->data = (uint8_t*)malloc(extractorByteSize * sizeof(uint8_t));
-
-        if (!(extractorsNalu->data))
-            return OMAF_ERROR_NULL_PTR;
-
-         std::vector<uint8_t>::iterator it1;
-         int32_t idx = 0;
-         for (it1 = extractorNALUs.begin(); it1 != extractorNALUs.end(); )
-         {
-             extractorsNalu->data[idx] = *it1;
-             idx++;
-             it1++;
-         }
-     }
-     else
-     {
-         if (extractorsNalu->dataSize == 0)
-         {
-             return OMAF_ERROR_INVALID_DATA;
-         }
-
-         int32_t extractorByteSize = extractorNALUs.size();
-         int32_t origDataSize = extractorsNalu->dataSize;
-         extractorsNalu->dataSize += extractorByteSize;
-
-         extractorsNalu->data = (uint8_t*)realloc((void*)(extractorsNalu->data), extractorsNalu->dataSize * sizeof(uint8_t));
-         if (!(extractorsNalu->data))
-             return OMAF_ERROR_NULL_PTR;
-
-         std::vector<uint8_t>::iterator it1;
-         int32_t idx = origDataSize;
-         for (it1 = extractorNALUs.begin(); it1 != extractorNALUs.end(); )
-         {
-             extractorsNalu->data[idx] = *it1;
-             idx++;
-             it1++;
-         }
-     }
-
-     extractorNALUs.clear();
-
-     return ERROR_NONE;
+    return ERROR_NONE;
 }
 
 VCD_NS_END
@@ -49,6 +49,7 @@
 #include "OmafPackingCommon.h"
 #include "MediaStream.h"
 #include "ExtractorTrack.h"
+#include "SegmentWriter.h"
 
 VCD_NS_BEGIN
 
@@ -57,6 +58,10 @@ VCD_NS_BEGIN
 
 #define DEFAULT_HEVC_TEMPORALIDPLUS1 1
 
+#define HEVC_EXTRACTOR_NALU_TYPE           49
+#define EXTRACTOR_SAMPLE_CONSTRUCTOR_TYPE  0
+#define EXTRACTOR_INLINE_CONSTRUCTOR_TYPE  2
+
 #define DEFAULT_EXTRACTORTRACK_TRACKIDBASE 1000
 
 #define DEFAULT_QUALITY_RANK 1
@@ -181,6 +186,8 @@ struct InitSegConfig
 
     std::list<StreamId> streamIds;
 
+    SegmentWriter *segWriter = NULL; // initial segment is written synchronously if NULL
+
     char initSegName[1024];
 };
 
@@ -205,6 +212,12 @@ struct GeneralSegConfig
 
     std::list<uint32_t> streamsIdx;
 
+    SegmentWriter *segWriter = NULL; // segments are written synchronously if NULL
+
+    uint32_t chunksPerSegment = 0; // if not 0, sgtDuration is the chunk duration and each segment is published chunk by chunk through segWriter
+
+    uint32_t framesPerChunk = 0; // frames number of one chunk in chunked mode
+
     //std::shared_ptr<Log> log;
 
     char tileSegBaseName[1024];
@@ -700,7 +713,27 @@ protected:
     int32_t WriteSegment(StreamSegmenter::Segmenter::Segments& aSegments);
 
     //!
-    //! \brief  Pack all extractors data into bitstream
+    //! \brief  Append one chunk to the segment being produced,
+    //!         a new segment is started for the first chunk
+    //!         and completed with the last chunk, the first
+    //!         chunk must start with IDR frame
+    //!
+    //! \param  [in] aChunk
+    //!         the segments produced by the low level segmenter
+    //!         for one chunk duration
+    //! \param  [in] outBaseName
+    //!         segment base name
+    //!
+    //! \return int32_t
+    //!         ERROR_NONE if success, else failed reason
+    //!
+    int32_t WriteChunk(StreamSegmenter::Segmenter::Segments& aChunk, char *outBaseName);
+
+    //!
+    //! \brief  Pack all extractors data into bitstream, the
+    //!         extractor NAL units are written directly into
+    //!         extractorsNalu after its existing data, whose
+    //!         size is grown once to the final packed size
     //!
     //! \param  [in] extractorsMap
     //!         the pointer to the all extractors map belong to the
@@ -726,7 +759,10 @@ private:
     StreamSegmenter::SidxWriter                                       *m_sidxWriter = NULL;    //!< the low level sidx writer
 
     uint64_t                                                          m_segNum = 0;            //!< current segments number
-    FILE                                                              *m_file = NULL;          //!< file pointer to write segments
+    uint64_t                                                          m_chunkNum = 0;          //!< current chunks number in chunked mode
+    uint64_t                                                          m_fedFramesNum = 0;      //!< frames number fed to low level segmenter in chunked mode
+    std::list<bool>                                                   m_chunksStartWithIDR;    //!< whether each chunk not written yet starts with IDR frame
+    SegmentBuffer                                                     *m_segBuffer = NULL;     //!< reused segment buffer when no segment writer is set
     char                                                              m_segName[1024];           //!< segment file name string
 };
 
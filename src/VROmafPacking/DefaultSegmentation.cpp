@@ -43,6 +43,11 @@ VCD_NS_BEGIN
 
 DefaultSegmentation::~DefaultSegmentation()
 {
+    StopSegmentationThreads();
+    DELETE_MEMORY(m_httpServer);
+    DELETE_MEMORY(m_segWriter);
+    DELETE_MEMORY(m_segStore);
+
     std::map<MediaStream*, TrackSegmentCtx*>::iterator itTrackCtx;
     for (itTrackCtx = m_streamSegCtx.begin();
         itTrackCtx != m_streamSegCtx.end();
@@ -82,6 +87,8 @@ DefaultSegmentation::~DefaultSegmentation()
     }
 
     m_extractorSegCtx.clear();
+    pthread_cond_destroy(&m_framesReadyCond);
+    pthread_cond_destroy(&m_framesProcessedCond);
     int32_t ret = pthread_mutex_destroy(&m_mutex);
     if (ret)
     {
@@ -173,6 +180,26 @@ int32_t FillQualityRank(CodedMeta *codedMeta, std::list<PicResolution> *picResLi
     return ERROR_NONE;
 }
 
+void DefaultSegmentation::SetSegmentDuration(GeneralSegConfig *dashCfg)
+{
+    if (m_chunksPerSeg)
+    {
+        // the low level segmenter produces one chunk each time,
+        // and chunks are not required to start with IDR frame,
+        // only the first chunk of each segment is checked then
+        dashCfg->sgtDuration = StreamSegmenter::RatU64(m_segInfo->framesPerChunk * m_frameRate.den, m_frameRate.num);
+        dashCfg->needCheckIDR = false;
+        dashCfg->framesPerChunk = m_segInfo->framesPerChunk;
+    }
+    else
+    {
+        dashCfg->sgtDuration = StreamSegmenter::RatU64(m_videoSegInfo->segDur, 1); //?
+        dashCfg->needCheckIDR = true;
+    }
+    dashCfg->subsgtDuration = dashCfg->sgtDuration / FrameDuration{ 1, 1}; //?
+    dashCfg->chunksPerSegment = m_chunksPerSeg;
+}
+
 int32_t DefaultSegmentation::ConstructTileTrackSegCtx()
 {
     std::set<uint64_t> bitRateRanking;
@@ -199,6 +226,28 @@ int32_t DefaultSegmentation::ConstructTileTrackSegCtx()
             TileInfo *tilesInfo = vs->GetAllTilesInfo();
             Rational frameRate = vs->GetFrameRate();
             m_frameRate = frameRate;
+            if (m_segStore && m_segInfo->framesPerChunk)
+            {
+                // each segment must be made up of whole chunks
+                uint64_t segFramesNum = m_segInfo->segDuration * frameRate.num;
+                uint64_t chunkFramesNum = m_segInfo->framesPerChunk * frameRate.den;
+                if (!segFramesNum || (segFramesNum % chunkFramesNum))
+                {
+                    LOG(ERROR) << "Segment duration is not multiple of chunk duration of " << m_segInfo->framesPerChunk << " frames !" << std::endl;
+                    return OMAF_ERROR_BAD_PARAM;
+                }
+                m_chunksPerSeg = (uint32_t)(segFramesNum / chunkFramesNum);
+
+                // chunks are cut without checking frame type, so
+                // segments start with IDR frame only if they are
+                // made up of whole GOPs
+                uint64_t gopFramesNum = (uint64_t)(m_segInfo->gopSize) * frameRate.den;
+                if (!gopFramesNum || (segFramesNum % gopFramesNum))
+                {
+                    LOG(ERROR) << "Segment duration is not multiple of GOP size of " << m_segInfo->gopSize << " frames !" << std::endl;
+                    return OMAF_ERROR_BAD_PARAM;
+                }
+            }
             uint64_t bitRate = vs->GetBitRate();
             uint8_t qualityLevel = bitRateRanking.size();
             std::set<uint64_t>::iterator itBitRate;
@@ -264,11 +313,10 @@ int32_t DefaultSegmentation::ConstructTileTrackSegCtx()
                 trackSegCtxs[i].dashInitCfg.mode = OperatingMode::OMAF;
                 trackSegCtxs[i].dashInitCfg.streamIds.push_back(trackConfig.meta.trackId.get());
                 snprintf(trackSegCtxs[i].dashInitCfg.initSegName, 1024, "%s%s_track%ld.init.mp4", m_segInfo->dirName, m_segInfo->outName, m_trackIdStarter + i);
+                trackSegCtxs[i].dashInitCfg.segWriter = m_segWriter;
 
                 //set GeneralSegConfig
-                trackSegCtxs[i].dashCfg.sgtDuration = StreamSegmenter::RatU64(m_videoSegInfo->segDur, 1); //?
-                trackSegCtxs[i].dashCfg.subsgtDuration = trackSegCtxs[i].dashCfg.sgtDuration / FrameDuration{ 1, 1}; //?
-                trackSegCtxs[i].dashCfg.needCheckIDR = true;
+                SetSegmentDuration(&(trackSegCtxs[i].dashCfg));
 
                 StreamSegmenter::TrackMeta trackMeta{};
                 trackMeta.trackId = trackSegCtxs[i].trackIdx;
@@ -278,6 +326,7 @@ int32_t DefaultSegmentation::ConstructTileTrackSegCtx()
 
                 trackSegCtxs[i].dashCfg.useSeparatedSidx = false;
                 trackSegCtxs[i].dashCfg.streamsIdx.push_back(it->first);
+                trackSegCtxs[i].dashCfg.segWriter = m_segWriter;
                 snprintf(trackSegCtxs[i].dashCfg.tileSegBaseName, 1024, "%s%s_track%ld", m_segInfo->dirName, m_segInfo->outName, m_trackIdStarter + i);
 
                 //setup DashInitSegmenter
@@ -495,11 +544,10 @@ int32_t DefaultSegmentation::ConstructExtractorTrackSegCtx()
             trackSegCtx->dashInitCfg.streamIds.push_back((*itId).get());
         }
         snprintf(trackSegCtx->dashInitCfg.initSegName, 1024, "%s%s_track%d.init.mp4", m_segInfo->dirName, m_segInfo->outName, trackSegCtx->trackIdx.get());
+        trackSegCtx->dashInitCfg.segWriter = m_segWriter;
 
         //set up GeneralSegConfig
-        trackSegCtx->dashCfg.sgtDuration = StreamSegmenter::RatU64(m_videoSegInfo->segDur, 1); //?
-        trackSegCtx->dashCfg.subsgtDuration = trackSegCtx->dashCfg.sgtDuration / FrameDuration{ 1, 1}; //?
-        trackSegCtx->dashCfg.needCheckIDR = true;
+        SetSegmentDuration(&(trackSegCtx->dashCfg));
 
         StreamSegmenter::TrackMeta trackMeta{};
         trackMeta.trackId = trackSegCtx->trackIdx;
@@ -509,6 +557,7 @@ int32_t DefaultSegmentation::ConstructExtractorTrackSegCtx()
 
         trackSegCtx->dashCfg.useSeparatedSidx = false;
         trackSegCtx->dashCfg.streamsIdx.push_back(trackSegCtx->trackIdx.get());
+        trackSegCtx->dashCfg.segWriter = m_segWriter;
         snprintf(trackSegCtx->dashCfg.tileSegBaseName, 1024, "%s%s_track%d", m_segInfo->dirName, m_segInfo->outName, trackSegCtx->trackIdx.get());
 
         //set up DashInitSegmenter
@@ -595,45 +644,33 @@ int32_t DefaultSegmentation::VideoEndSegmentation()
     return ERROR_NONE;
 }
 
-int32_t DefaultSegmentation::WriteSegmentForEachVideo(MediaStream *stream, bool isKeyFrame, bool isEOS)
+int32_t DefaultSegmentation::WriteSegmentForOneTileTrack(
+    TrackSegmentCtx *trackSegCtx,
+    bool isKeyFrame,
+    bool isEOS)
 {
-    if (!stream)
+    if (!trackSegCtx)
         return OMAF_ERROR_NULL_PTR;
 
-    VideoStream *vs = (VideoStream*)stream;
-
-    std::map<MediaStream*, TrackSegmentCtx*>::iterator itStreamTrack;
-    itStreamTrack = m_streamSegCtx.find(stream);
-    if (itStreamTrack == m_streamSegCtx.end())
-        return OMAF_ERROR_STREAM_NOT_FOUND;
-
-    TrackSegmentCtx *trackSegCtxs = itStreamTrack->second;
-
-    uint32_t tilesNum = vs->GetTileInRow() * vs->GetTileInCol();
-    for (uint32_t tileIdx = 0; tileIdx < tilesNum; tileIdx++)
-    {
-        DashSegmenter *dashSegmenter = trackSegCtxs[tileIdx].dashSegmenter;
-        if (!dashSegmenter)
-            return OMAF_ERROR_NULL_PTR;
-
-        if (isKeyFrame)
-            trackSegCtxs[tileIdx].codedMeta.type = FrameType::IDR;
-        else
-            trackSegCtxs[tileIdx].codedMeta.type = FrameType::NONIDR;
+    DashSegmenter *dashSegmenter = trackSegCtx->dashSegmenter;
+    if (!dashSegmenter)
+        return OMAF_ERROR_NULL_PTR;
 
-        trackSegCtxs[tileIdx].codedMeta.isEOS = isEOS;
+    if (isKeyFrame)
+        trackSegCtx->codedMeta.type = FrameType::IDR;
+    else
+        trackSegCtx->codedMeta.type = FrameType::NONIDR;
 
-        int32_t ret = dashSegmenter->SegmentData(&(trackSegCtxs[tileIdx]));
-        if (ret)
-            return ret;
+    trackSegCtx->codedMeta.isEOS = isEOS;
 
-        trackSegCtxs[tileIdx].codedMeta.presIndex++;
-        trackSegCtxs[tileIdx].codedMeta.codingIndex++;
-        trackSegCtxs[tileIdx].codedMeta.presTime.num += 1000 / (m_frameRate.num / m_frameRate.den);
-        trackSegCtxs[tileIdx].codedMeta.presTime.den = 1000;
+    int32_t ret = dashSegmenter->SegmentData(trackSegCtx);
+    if (ret)
+        return ret;
 
-        m_segNum = dashSegmenter->GetSegmentsNum();
-    }
+    trackSegCtx->codedMeta.presIndex++;
+    trackSegCtx->codedMeta.codingIndex++;
+    trackSegCtx->codedMeta.presTime.num += 1000 / (m_frameRate.num / m_frameRate.den);
+    trackSegCtx->codedMeta.presTime.den = 1000;
 
     return ERROR_NONE;
 }
@@ -678,203 +715,246 @@ int32_t DefaultSegmentation::WriteSegmentForEachExtractorTrack(
     return ERROR_NONE;
 }
 
-int32_t DefaultSegmentation::StartExtractorTrackSegmentation(
-    ExtractorTrack *extractorTrack)
+int32_t DefaultSegmentation::StartSegmentationThreads()
 {
-    pthread_t threadId;
-    int32_t ret = pthread_create(&threadId, NULL, ExtractorTrackSegThread, this);
+    SegJob job;
+    memset(&job, 0, sizeof(SegJob));
 
-    if (ret)
+    std::map<MediaStream*, TrackSegmentCtx*>::iterator itStreamTrack;
+    for (itStreamTrack = m_streamSegCtx.begin(); itStreamTrack != m_streamSegCtx.end(); itStreamTrack++)
     {
-        LOG(ERROR) << "Failed to create extractor track segmentation thread !" << std::endl;
-        return OMAF_ERROR_CREATE_THREAD;
+        MediaStream *stream = itStreamTrack->first;
+        if (stream->GetMediaType() != VIDEOTYPE)
+            continue;
+
+        VideoStream *vs = (VideoStream*)stream;
+        job.type = PARSE_TILES_NALU;
+        job.stream = vs;
+        job.trackSegCtx = NULL;
+        m_parseJobs.push_back(job);
+
+        uint32_t tilesNum = vs->GetTileInRow() * vs->GetTileInCol();
+        for (uint32_t tileIdx = 0; tileIdx < tilesNum; tileIdx++)
+        {
+            job.type = SEGMENT_TILE_TRACK;
+            job.trackSegCtx = &(itStreamTrack->second[tileIdx]);
+            m_segJobs.push_back(job);
+        }
     }
 
-    m_extractorThreadIds.insert(std::make_pair(threadId, extractorTrack));
-    return ERROR_NONE;
-}
+    std::map<uint8_t, ExtractorTrack*> *extractorTracks = m_extractorTrackMan->GetAllExtractorTracks();
+    std::map<uint8_t, ExtractorTrack*>::iterator itExtractorTrack;
+    for (itExtractorTrack = extractorTracks->begin();
+        itExtractorTrack != extractorTracks->end();
+        itExtractorTrack++)
+    {
+        job.type = SEGMENT_EXTRACTOR_TRACK;
+        job.stream = NULL;
+        job.trackSegCtx = NULL;
+        job.extractorTrack = itExtractorTrack->second;
+        m_segJobs.push_back(job);
+    }
 
-int32_t DefaultSegmentation::StartLastExtractorTrackSegmentation(
-    ExtractorTrack *extractorTrack)
-{
-    pthread_t threadId;
-    int32_t ret = pthread_create(&threadId, NULL, LastExtractorTrackSegThread, this);
+    long coresNum = sysconf(_SC_NPROCESSORS_ONLN);
+    if (coresNum < 1)
+        coresNum = 1;
 
-    if (ret)
+    m_segThreadsNum = m_segJobs.size();
+    if ((long)m_segThreadsNum > coresNum)
+        m_segThreadsNum = (uint16_t)coresNum;
+
+    for (uint16_t threadIdx = 0; threadIdx < m_segThreadsNum; threadIdx++)
     {
-        LOG(ERROR) << "Failed to create extractor track segmentation thread !" << std::endl;
-        return OMAF_ERROR_CREATE_THREAD;
+        pthread_t threadId;
+        int32_t ret = pthread_create(&threadId, NULL, SegmentationThread, this);
+        if (ret)
+        {
+            LOG(ERROR) << "Failed to create segmentation thread !" << std::endl;
+            return OMAF_ERROR_CREATE_THREAD;
+        }
+
+        m_segThreadIds.push_back(threadId);
     }
 
-    m_extractorThreadIds.insert(std::make_pair(threadId, extractorTrack));
     return ERROR_NONE;
 }
 
-void *DefaultSegmentation::ExtractorTrackSegThread(void *pThis)
+void DefaultSegmentation::StopSegmentationThreads()
 {
-    DefaultSegmentation *defaultSegmentation = (DefaultSegmentation*)pThis;
-
-    defaultSegmentation->ExtractorTrackSegmentation();
-
-    return NULL;
+    pthread_mutex_lock(&m_mutex);
+    m_isSegThreadsStopped = true;
+    pthread_cond_broadcast(&m_framesReadyCond);
+    pthread_mutex_unlock(&m_mutex);
+
+    std::vector<pthread_t>::iterator itThread;
+    for (itThread = m_segThreadIds.begin();
+        itThread != m_segThreadIds.end();
+        itThread++)
+    {
+        pthread_join(*itThread, NULL);
+    }
+    m_segThreadIds.clear();
 }
 
-void *DefaultSegmentation::LastExtractorTrackSegThread(void *pThis)
+void *DefaultSegmentation::SegmentationThread(void *pThis)
 {
     DefaultSegmentation *defaultSegmentation = (DefaultSegmentation*)pThis;
 
-    defaultSegmentation->LastExtractorTrackSegmentation();
+    defaultSegmentation->RunSegmentationJobs();
 
     return NULL;
 }
 
-int32_t DefaultSegmentation::ExtractorTrackSegmentation()
+void DefaultSegmentation::SetFramesReady(std::vector<SegJob> *jobs)
+{
+    pthread_mutex_lock(&m_mutex);
+    m_currJobs = jobs;
+    m_readyFramesNum++;
+    m_finishedThreadsNum = 0;
+    m_nextSegJob = 0;
+    pthread_cond_broadcast(&m_framesReadyCond);
+    pthread_mutex_unlock(&m_mutex);
+}
+
+bool DefaultSegmentation::WaitFramesReady(uint64_t *framesNum)
 {
-    while(1)
+    pthread_mutex_lock(&m_mutex);
+    while ((m_readyFramesNum == *framesNum) && !m_isSegThreadsStopped)
     {
+        pthread_cond_wait(&m_framesReadyCond, &m_mutex);
+    }
+    *framesNum = m_readyFramesNum;
+    bool isStopped = m_isSegThreadsStopped;
+    pthread_mutex_unlock(&m_mutex);
 
-        std::map<uint8_t, ExtractorTrack*> *extractorTracks = m_extractorTrackMan->GetAllExtractorTracks();
-        std::map<uint8_t, ExtractorTrack*>::iterator itExtractorTrack;
+    return !isStopped;
+}
 
-        pthread_t threadId = pthread_self();
-        ExtractorTrack *extractorTrack = m_extractorThreadIds[threadId];
-        if (!extractorTrack)
-            return OMAF_ERROR_NULL_PTR;
+void DefaultSegmentation::SetFramesProcessed(int32_t result)
+{
+    pthread_mutex_lock(&m_mutex);
+    m_finishedThreadsNum++;
+    if (result)
+        m_segJobsRet = result;
+    pthread_cond_signal(&m_framesProcessedCond);
+    pthread_mutex_unlock(&m_mutex);
+}
 
-        for (itExtractorTrack = extractorTracks->begin();
-            itExtractorTrack != extractorTracks->end(); itExtractorTrack++)
-        {
-            if (itExtractorTrack->second == extractorTrack)
-                break;
-        }
-        if (itExtractorTrack == extractorTracks->end())
-        {
-            LOG(ERROR) << "Can't find specified Extractor Track! " << std::endl;
-            return OMAF_ERROR_INVALID_DATA;
-        }
-        while (!(extractorTrack->GetFramesReadyStatus()))
-        {
-            usleep(50);
-        }
+int32_t DefaultSegmentation::WaitFramesProcessed()
+{
+    pthread_mutex_lock(&m_mutex);
+    // wait for all threads even if one fails, since the others still
+    // use current frames and streams
+    while (m_finishedThreadsNum < m_segThreadIds.size())
+    {
+        pthread_cond_wait(&m_framesProcessedCond, &m_mutex);
+    }
+    int32_t ret = m_segJobsRet;
+    pthread_mutex_unlock(&m_mutex);
 
-        uint8_t etId = 0;
-        for ( ; etId < m_aveETPerSegThread; etId++)
-        {
+    return ret;
+}
 
-            if (itExtractorTrack == extractorTracks->end())
-            {
-                LOG(ERROR) << "Can't find specified Extractor Track! " << std::endl;
-                return OMAF_ERROR_INVALID_DATA;
-            }
+int32_t DefaultSegmentation::SegmentOneExtractorTrack(ExtractorTrack *extractorTrack)
+{
+    if (!extractorTrack)
+        return OMAF_ERROR_NULL_PTR;
 
-            ExtractorTrack *extractorTrack1 = itExtractorTrack->second;
+    std::map<ExtractorTrack*, TrackSegmentCtx*>::iterator itET;
+    itET = m_extractorSegCtx.find(extractorTrack);
+    if (itET == m_extractorSegCtx.end())
+    {
+        LOG(ERROR) << "Can't find segmentation context for specified extractor track !" << std::endl;
+        return OMAF_ERROR_INVALID_DATA;
+    }
+    TrackSegmentCtx *trackSegCtx = itET->second;
 
-            extractorTrack1->ConstructExtractors();
-            WriteSegmentForEachExtractorTrack(extractorTrack1, m_nowKeyFrame, m_isEOS);
+    // tile tracks are segmented at the same time, so whether
+    // one new segment is started is got from the track itself
+    uint64_t prevSegNum = trackSegCtx->dashSegmenter->GetSegmentsNum();
 
-            std::map<ExtractorTrack*, TrackSegmentCtx*>::iterator itET;
-            itET = m_extractorSegCtx.find(extractorTrack1);
-            if (itET == m_extractorSegCtx.end())
-            {
-                LOG(ERROR) << "Can't find segmentation context for specified extractor track !" << std::endl;
-                return OMAF_ERROR_INVALID_DATA;
-            }
-            TrackSegmentCtx *trackSegCtx = itET->second;
+    // extractors aren't written at EOS, and there are no tiles of
+    // current frames to construct them from
+    int32_t ret = ERROR_NONE;
+    if (!m_isEOS)
+        ret = extractorTrack->ConstructExtractors();
+    if (!ret)
+        ret = WriteSegmentForEachExtractorTrack(extractorTrack, m_nowKeyFrame, m_isEOS);
 
-            if (m_segNum == (m_prevSegNum + 1))
-            {
-                extractorTrack1->DestroyCurrSegNalus();
-            }
+    if (trackSegCtx->dashSegmenter->GetSegmentsNum() != prevSegNum)
+    {
+        extractorTrack->DestroyCurrSegNalus();
+    }
 
-            if (trackSegCtx->extractorTrackNalu.data)
-            {
-                extractorTrack1->AddExtractorsNaluToSeg(trackSegCtx->extractorTrackNalu.data);
-                trackSegCtx->extractorTrackNalu.data = NULL;
-            }
-            trackSegCtx->extractorTrackNalu.dataSize = 0;
+    if (trackSegCtx->extractorTrackNalu.data)
+    {
+        extractorTrack->AddExtractorsNaluToSeg(trackSegCtx->extractorTrackNalu.data);
+        trackSegCtx->extractorTrackNalu.data = NULL;
+    }
+    trackSegCtx->extractorTrackNalu.dataSize = 0;
 
-            extractorTrack1->IncreaseProcessedFrmNum();
-            itExtractorTrack++;
-        }
-        if (m_isEOS)
-            //return ERROR_NONE;
-            break;
+    if (ret)
+    {
+        LOG(ERROR) << "Failed to segment extractor track !" << std::endl;
+        return ret;
     }
 
+    extractorTrack->IncreaseProcessedFrmNum();
+
     return ERROR_NONE;
 }
 
-int32_t DefaultSegmentation::LastExtractorTrackSegmentation()
+int32_t DefaultSegmentation::RunOneSegJob(SegJob *job)
 {
-    while(1)
+    switch (job->type)
     {
-        std::map<uint8_t, ExtractorTrack*> *extractorTracks = m_extractorTrackMan->GetAllExtractorTracks();
-        std::map<uint8_t, ExtractorTrack*>::iterator itExtractorTrack;
-
-        pthread_t threadId = pthread_self();
-        ExtractorTrack *extractorTrack = m_extractorThreadIds[threadId];
-        if (!extractorTrack)
-            return OMAF_ERROR_NULL_PTR;
-
-        for (itExtractorTrack = extractorTracks->begin();
-            itExtractorTrack != extractorTracks->end(); itExtractorTrack++)
+        case PARSE_TILES_NALU:
         {
-            if (itExtractorTrack->second == extractorTrack)
-                break;
-        }
-        if (itExtractorTrack == extractorTracks->end())
-        {
-            LOG(ERROR) << "Can't find specified Extractor Track! " << std::endl;
-            return OMAF_ERROR_INVALID_DATA;
-        }
+            // streams which reach EOS have no current frame
+            if (!job->stream->GetCurrFrameInfo())
+                return ERROR_NONE;
 
-        while (!(extractorTrack->GetFramesReadyStatus()))
-        {
-            usleep(50);
+            return job->stream->UpdateTilesNalu();
         }
-
-        uint8_t etId = 0;
-        for ( ; etId < m_lastETPerSegThread; etId++)
+        case SEGMENT_TILE_TRACK:
         {
+            MediaStream *stream = (MediaStream*)(job->stream);
+            std::map<MediaStream*, bool>::iterator itKeyFrame = m_framesIsKey.find(stream);
+            std::map<MediaStream*, bool>::iterator itEOS = m_streamsIsEOS.find(stream);
+            if (itKeyFrame == m_framesIsKey.end() || itEOS == m_streamsIsEOS.end())
+                return OMAF_ERROR_STREAM_NOT_FOUND;
 
-            if (itExtractorTrack == extractorTracks->end())
-            {
-                LOG(ERROR) << "Can't find specified Extractor Track! " << std::endl;
-                return OMAF_ERROR_INVALID_DATA;
-            }
-
-            ExtractorTrack *extractorTrack1 = itExtractorTrack->second;
-
-            extractorTrack1->ConstructExtractors();
-            WriteSegmentForEachExtractorTrack(extractorTrack1, m_nowKeyFrame, m_isEOS);
-
-            std::map<ExtractorTrack*, TrackSegmentCtx*>::iterator itET;
-            itET = m_extractorSegCtx.find(extractorTrack1);
-            if (itET == m_extractorSegCtx.end())
-            {
-                LOG(ERROR) << "Can't find segmentation context for specified extractor track !" << std::endl;
-                return OMAF_ERROR_INVALID_DATA;
-            }
-            TrackSegmentCtx *trackSegCtx = itET->second;
+            return WriteSegmentForOneTileTrack(job->trackSegCtx, itKeyFrame->second, itEOS->second);
+        }
+        case SEGMENT_EXTRACTOR_TRACK:
+            return SegmentOneExtractorTrack(job->extractorTrack);
+        default:
+            return OMAF_ERROR_UNDEFINED_OPERATION;
+    }
+}
 
-            if (m_segNum == (m_prevSegNum + 1))
-            {
-                extractorTrack1->DestroyCurrSegNalus();
-            }
+int32_t DefaultSegmentation::RunSegmentationJobs()
+{
+    uint64_t framesNum = 0;
+    while (WaitFramesReady(&framesNum))
+    {
+        std::vector<SegJob> *jobs = m_currJobs;
+        uint32_t jobsNum = jobs->size();
+        int32_t ret = ERROR_NONE;
 
-            if (trackSegCtx->extractorTrackNalu.data)
-            {
-                extractorTrack1->AddExtractorsNaluToSeg(trackSegCtx->extractorTrackNalu.data);
-                trackSegCtx->extractorTrackNalu.data = NULL;
-            }
-            trackSegCtx->extractorTrackNalu.dataSize = 0;
+        uint32_t jobIdx = __sync_fetch_and_add(&m_nextSegJob, 1);
+        while (jobIdx < jobsNum)
+        {
+            ret = RunOneSegJob(&((*jobs)[jobIdx]));
+            if (ret)
+                break;
 
-            extractorTrack1->IncreaseProcessedFrmNum();
-            itExtractorTrack++;
+            jobIdx = __sync_fetch_and_add(&m_nextSegJob, 1);
         }
-        if (m_isEOS)
-            //return ERROR_NONE;
-            break;
+
+        // keep waiting for frames after failure, until the threads
+        // are stopped, so that the processed number still counts it
+        SetFramesProcessed(ret);
     }
 
     return ERROR_NONE;
@@ -883,7 +963,35 @@ int32_t DefaultSegmentation::LastExtractorTrackSegmentation()
 int32_t DefaultSegmentation::VideoSegmentation()
 {
     uint64_t currentT = 0;
-    int32_t ret = ConstructTileTrackSegCtx();
+    int32_t ret = ERROR_NONE;
+    if (m_segInfo->isLive && m_segInfo->httpPort)
+    {
+        uint32_t windowSize = 0;
+        if (m_segInfo->windowSize && m_segInfo->extraWindowSize)
+            windowSize = m_segInfo->windowSize + m_segInfo->extraWindowSize;
+
+        m_segStore = new SegmentStore(windowSize);
+        if (!m_segStore)
+            return OMAF_ERROR_NULL_PTR;
+
+        m_httpServer = new HttpServer(m_segStore);
+        if (!m_httpServer)
+            return OMAF_ERROR_NULL_PTR;
+
+        ret = m_httpServer->Start(m_segInfo->httpPort);
+        if (ret)
+            return ret;
+    }
+
+    m_segWriter = new SegmentWriter(false, m_segStore);
+    if (!m_segWriter)
+        return OMAF_ERROR_NULL_PTR;
+
+    ret = m_segWriter->Initialize();
+    if (ret)
+        return ret;
+
+    ret = ConstructTileTrackSegCtx();
     if (ret)
         return ret;
 
@@ -896,7 +1004,8 @@ int32_t DefaultSegmentation::VideoSegmentation()
                     &m_extractorSegCtx,
                     m_segInfo,
                     m_projType,
-                    m_frameRate);
+                    m_frameRate,
+                    m_segStore);
     if (!m_mpdGen)
         return OMAF_ERROR_NULL_PTR;
 
@@ -948,23 +1057,11 @@ int32_t DefaultSegmentation::VideoSegmentation()
 
     m_prevSegNum = m_segNum;
 
-    uint16_t extractorTrackNum = m_extractorSegCtx.size();
-    if (extractorTrackNum % m_segInfo->extractorTracksPerSegThread == 0)
-    {
-        m_aveETPerSegThread = m_segInfo->extractorTracksPerSegThread;
-        m_lastETPerSegThread = m_segInfo->extractorTracksPerSegThread;
-        m_threadNumForET = extractorTrackNum / m_segInfo->extractorTracksPerSegThread;
-    }
-    else
-    {
-        m_aveETPerSegThread = m_segInfo->extractorTracksPerSegThread;
-        m_lastETPerSegThread = extractorTrackNum % m_segInfo->extractorTracksPerSegThread;
-        m_threadNumForET = extractorTrackNum / m_segInfo->extractorTracksPerSegThread + 1;
-    }
+    ret = StartSegmentationThreads();
+    if (ret)
+        return ret;
 
-    LOG(INFO) << "Lanuch  " << m_threadNumForET << " threads for Extractor Track segmentation!" << std::endl;
-    LOG(INFO) << "Average Extractor Track number per thread is  " << m_aveETPerSegThread << std::endl;
-    LOG(INFO) << "The last thread involves  " << m_lastETPerSegThread << " Extractor Tracks !" << std::endl;
+    LOG(INFO) << "Lanuch  " << m_segThreadsNum << " threads for " << m_segJobs.size() << " Tile and Extractor Tracks segmentation!" << std::endl;
 
     while (1)
     {
@@ -986,33 +1083,27 @@ int32_t DefaultSegmentation::VideoSegmentation()
                 vs->SetCurrFrameInfo();
                 FrameBSInfo *currFrame = vs->GetCurrFrameInfo();
 
-                while (!currFrame)
-                {
-                    usleep(50);
-                    vs->SetCurrFrameInfo();
-                    currFrame = vs->GetCurrFrameInfo();
-                    if (!currFrame && (vs->GetEOS()))
-                        break;
-                }
-
                 if (currFrame)
                 {
                     m_framesIsKey[vs] = currFrame->isKeyFrame;
                     m_streamsIsEOS[vs] = false;
-
-                    vs->UpdateTilesNalu();
-                    WriteSegmentForEachVideo(vs, currFrame->isKeyFrame, false);
                 }
                 else
                 {
                     m_framesIsKey[vs] = false;
                     m_streamsIsEOS[vs] = true;
-
-                    WriteSegmentForEachVideo(vs, false, true);
                 }
             }
         }
 
+        // parse tiles of all video streams in parallel, extractors
+        // of current frames can only be generated after that
+        SetFramesReady(&m_parseJobs);
+
+        ret = WaitFramesProcessed();
+        if (ret)
+            return ret;
+
         std::map<MediaStream*, bool>::iterator itKeyFrame = m_framesIsKey.begin();
         if (itKeyFrame == m_framesIsKey.end())
             return OMAF_ERROR_INVALID_DATA;
@@ -1040,76 +1131,15 @@ int32_t DefaultSegmentation::VideoSegmentation()
         }
         m_isEOS = nowEOS;
 
-        std::map<uint8_t, ExtractorTrack*> *extractorTracks = m_extractorTrackMan->GetAllExtractorTracks();
-        std::map<uint8_t, ExtractorTrack*>::iterator itExtractorTrack = extractorTracks->begin();
-        for ( ; itExtractorTrack != extractorTracks->end(); /*itExtractorTrack++*/)
-        {
-            ExtractorTrack *extractorTrack = itExtractorTrack->second;
-            extractorTrack->SetFramesReady(true);
-            if (m_extractorThreadIds.size() < m_threadNumForET)
-            {
-                if (m_aveETPerSegThread == m_lastETPerSegThread)
-                {
-                    int32_t retET = StartExtractorTrackSegmentation(extractorTrack);
-                    if (retET)
-                        return retET;
+        // tile tracks and extractor tracks are segmented together
+        SetFramesReady(&m_segJobs);
 
-                    for (uint16_t num = 0; num < m_aveETPerSegThread; num++)
-                    {
-                        itExtractorTrack++;
-                    }
-                }
-                else
-                {
-                    if ((uint16_t)(m_extractorThreadIds.size()) < (m_threadNumForET - 1))
-                    {
-                        int32_t retET = StartExtractorTrackSegmentation(extractorTrack);
-                        if (retET)
-                            return retET;
-
-                        for (uint16_t num = 0; num < m_aveETPerSegThread; num++)
-                        {
-                            itExtractorTrack++;
-                        }
-                    }
-                    else
-                    {
-                        int32_t retET = StartLastExtractorTrackSegmentation(extractorTrack);
-                        if (retET)
-                            return retET;
-
-                        for ( ; itExtractorTrack != extractorTracks->end(); )
-                        {
-                            itExtractorTrack++;
-                        }
-                    }
-                }
-            }
-            else
-            {
-                itExtractorTrack++;
-            }
-        }
-        if (m_extractorThreadIds.size() != m_threadNumForET)
-        {
-            LOG(ERROR) << "Launched threads number  " << (m_extractorThreadIds.size()) << " doesn't match calculated threads number  " << m_threadNumForET << std::endl;
-        }
+        ret = WaitFramesProcessed();
+        if (ret)
+            return ret;
 
-        usleep(2000);
-
-        for (itExtractorTrack = extractorTracks->begin();
-            itExtractorTrack != extractorTracks->end();
-            itExtractorTrack++)
-        {
-            ExtractorTrack *extractorTrack = itExtractorTrack->second;
-            while (extractorTrack->GetProcessedFrmNum() == m_framesNum)
-            {
-                usleep(1);
-
-                if (extractorTrack->GetProcessedFrmNum() == (m_framesNum + 1))
-                    break;
-            }
-        }
+        TrackSegmentCtx *firstTileTrack = m_segJobs.front().trackSegCtx;
+        m_segNum = firstTileTrack->dashSegmenter->GetSegmentsNum();
 
         for (itStream = m_streamMap->begin(); itStream != m_streamMap->end(); itStream++)
         {
@@ -1138,7 +1168,10 @@ int32_t DefaultSegmentation::VideoSegmentation()
             currentT = before;
         }
 
-        if (m_segInfo->isLive)
+        // in-memory segment store slides the window by itself, files
+        // on disk are removed by the writer thread after their pending
+        // writes, which would otherwise create them again
+        if (m_segInfo->isLive && !m_segStore)
         {
             if (m_segInfo->windowSize && m_segInfo->extraWindowSize)
             {
@@ -1153,7 +1186,9 @@ int32_t DefaultSegmentation::VideoSegmentation()
                         TrackId trackIndex = itOneTrack->first;
                         char rmFile[1024];
                         snprintf(rmFile, 1024, "%s%s_track%d.%d.mp4", m_segInfo->dirName, m_segInfo->outName, trackIndex.get(), removeCnt);
-                        remove(rmFile);
+                        ret = m_segWriter->RemoveSegment(rmFile);
+                        if (ret)
+                            return ret;
                     }
                     std::map<ExtractorTrack*, TrackSegmentCtx*>::iterator itOneExtractorTrack;
                     for (itOneExtractorTrack = m_extractorSegCtx.begin();
@@ -1164,7 +1199,9 @@ int32_t DefaultSegmentation::VideoSegmentation()
                         TrackId trackIndex = trackSegCtx->trackIdx;
                         char rmFile[1024];
                         snprintf(rmFile, 1024, "%s%s_track%d.%d.mp4", m_segInfo->dirName, m_segInfo->outName, trackIndex.get(), removeCnt);
-                        remove(rmFile);
+                        ret = m_segWriter->RemoveSegment(rmFile);
+                        if (ret)
+                            return ret;
                     }
                 }
             }
@@ -1172,6 +1209,10 @@ int32_t DefaultSegmentation::VideoSegmentation()
 
         if (m_isEOS)
         {
+            ret = m_segWriter->Flush();
+            if (ret)
+                return ret;
+
             if (m_segInfo->isLive)
             {
                 int32_t ret = m_mpdGen->UpdateMpd(m_segNum, m_framesNum);
@@ -1189,6 +1230,8 @@ int32_t DefaultSegmentation::VideoSegmentation()
         m_framesNum++;
     }
 
+    StopSegmentationThreads();
+
     return ERROR_NONE;
 }
 
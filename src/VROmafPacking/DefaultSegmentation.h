@@ -37,9 +37,36 @@
 
 #include "Segmentation.h"
 #include "DashSegmenter.h"
+#include "SegmentStore.h"
+#include "HttpServer.h"
+
+#include <vector>
 
 VCD_NS_BEGIN
 
+//!
+//! \enum:   SegJobType
+//! \brief:  type of job run by segmentation threads
+//!
+enum SegJobType
+{
+    PARSE_TILES_NALU = 0,
+    SEGMENT_TILE_TRACK,
+    SEGMENT_EXTRACTOR_TRACK,
+};
+
+//!
+//! \struct: SegJob
+//! \brief:  one job for current frames taken by segmentation threads
+//!
+struct SegJob
+{
+    SegJobType      type;
+    VideoStream     *stream;         //!< video stream to be parsed, or video stream the tile track belongs to
+    TrackSegmentCtx *trackSegCtx;    //!< segmentation context of the tile track
+    ExtractorTrack  *extractorTrack; //!< extractor track to be segmented
+};
+
 //!
 //! \class DefaultSegmentation
 //! \brief Define the operation and needed data for default segmentation
@@ -61,10 +88,19 @@ public:
         m_nowKeyFrame = false;
         m_prevSegNum = 0;
         pthread_mutex_init(&m_mutex, NULL);
-        m_isFramesReady = false;
-        m_aveETPerSegThread = 0;
-        m_lastETPerSegThread = 0;
-        m_threadNumForET = 0;
+        pthread_cond_init(&m_framesReadyCond, NULL);
+        pthread_cond_init(&m_framesProcessedCond, NULL);
+        m_readyFramesNum = 0;
+        m_finishedThreadsNum = 0;
+        m_segJobsRet = ERROR_NONE;
+        m_nextSegJob = 0;
+        m_currJobs = NULL;
+        m_isSegThreadsStopped = false;
+        m_segThreadsNum = 0;
+        m_segWriter = NULL;
+        m_segStore = NULL;
+        m_httpServer = NULL;
+        m_chunksPerSeg = 0;
     };
 
     //!
@@ -89,10 +125,19 @@ public:
         m_nowKeyFrame = false;
         m_prevSegNum = 0;
         pthread_mutex_init(&m_mutex, NULL);
-        m_isFramesReady = false;
-        m_aveETPerSegThread = 0;
-        m_lastETPerSegThread = 0;
-        m_threadNumForET = 0;
+        pthread_cond_init(&m_framesReadyCond, NULL);
+        pthread_cond_init(&m_framesProcessedCond, NULL);
+        m_readyFramesNum = 0;
+        m_finishedThreadsNum = 0;
+        m_segJobsRet = ERROR_NONE;
+        m_nextSegJob = 0;
+        m_currJobs = NULL;
+        m_isSegThreadsStopped = false;
+        m_segThreadsNum = 0;
+        m_segWriter = NULL;
+        m_segStore = NULL;
+        m_httpServer = NULL;
+        m_chunksPerSeg = 0;
     };
 
     //!
@@ -149,15 +194,36 @@ private:
     int32_t ConstructExtractorTrackSegCtx();
 
     //!
-    //! \brief  Write segments for specified video stream
+    //! \brief  Set the duration of data produced by the low
+    //!         level segmenter for one track, which is the
+    //!         chunk duration when segments are published
+    //!         in chunks
     //!
-    //! \param  [in] stream
-    //!         pointer to specified video stream
+    //! \param  [in] dashCfg
+    //!         pointer to the configuration of data segment
+    //!         of the track
+    //!
+    //! \return void
+    //!
+    void SetSegmentDuration(GeneralSegConfig *dashCfg);
+
+    //!
+    //! \brief  Write segment for current frame of specified tile track
+    //!
+    //! \param  [in] trackSegCtx
+    //!         pointer to segmentation context of the tile track
+    //! \param  [in] isKeyFrame
+    //!         whether current frame is key frame
+    //! \param  [in] isEOS
+    //!         whether EOS has been gotten for the video stream
     //!
     //! \return int32_t
     //!         ERROR_NONE if success, else failed reason
     //!
-    int32_t WriteSegmentForEachVideo(MediaStream *stream, bool isKeyFrame, bool isEOS);
+    int32_t WriteSegmentForOneTileTrack(
+        TrackSegmentCtx *trackSegCtx,
+        bool isKeyFrame,
+        bool isEOS);
 
     //!
     //! \brief  Write segment for specified extractor track
@@ -185,30 +251,25 @@ private:
     int32_t EndEachVideo(MediaStream *stream);
 
     //!
-    //! \brief  Start segmentation thread for specified extractor track
-    //!
-    //! \param  [in] extractorTrack
-    //!         pointer to the specified extractor track
+    //! \brief  Create tiles parsing jobs and tile / extractor
+    //!         tracks segmentation jobs, then start segmentation
+    //!         threads pool, threads number is the minimum of
+    //!         online CPU cores number and segmentation jobs number
     //!
     //! \return int32_t
     //!         ERROR_NONE if success, else failed reason
     //!
-    int32_t StartExtractorTrackSegmentation(ExtractorTrack *extractorTrack);
+    int32_t StartSegmentationThreads();
 
     //!
-    //! \brief  Start last segmentation thread for rest extractor tracks
-    //!
-    //! \param  [in] extractorTrack
-    //!         pointer to the first extractor track in rest extractor
-    //!         tracks which are not created segmentation thread
+    //! \brief  Stop and join all segmentation threads
     //!
-    //! \return int32_t
-    //!         ERROR_NONE if success, else failed reason
+    //! \return void
     //!
-    int32_t StartLastExtractorTrackSegmentation(ExtractorTrack *extractorTrack);
+    void StopSegmentationThreads();
 
     //!
-    //! \brief  extractor track segmentation thread function
+    //! \brief  segmentation thread function
     //!
     //! \param  [in] pThis
     //!         this DefaultSegmentation
@@ -216,51 +277,86 @@ private:
     //! \return void*
     //!         return NULL
     //!
-    static void* ExtractorTrackSegThread(void *pThis);
+    static void* SegmentationThread(void *pThis);
 
     //!
-    //! \brief  extractor track segmentation thread function for last extractor
-    //!         tracks
-    //!
-    //! \param  [in] pThis
-    //!         this DefaultSegmentation
+    //! \brief  Run jobs for current frames, each thread takes
+    //!         jobs one by one from current jobs list until all
+    //!         jobs are taken
     //!
-    //! \return void*
-    //!         return NULL
+    //! \return int32_t
+    //!         ERROR_NONE if success, else failed reason
     //!
-    static void* LastExtractorTrackSegThread(void *pThis);
+    int32_t RunSegmentationJobs();
 
     //!
-    //! \brief  Generate extractor track segments
+    //! \brief  Run one tiles parsing or track segmentation job
+    //!
+    //! \param  [in] job
+    //!         pointer to the job to be run
     //!
     //! \return int32_t
     //!         ERROR_NONE if success, else failed reason
     //!
-    int32_t ExtractorTrackSegmentation();
+    int32_t RunOneSegJob(SegJob *job);
 
     //!
-    //! \brief  Generate extractor track segments for last
-    //!         extractor tracks
+    //! \brief  Generate extractors and write segment for
+    //!         current frames of specified extractor track
+    //!
+    //! \param  [in] extractorTrack
+    //!         pointer to specified extractor track
     //!
     //! \return int32_t
     //!         ERROR_NONE if success, else failed reason
     //!
-    int32_t LastExtractorTrackSegmentation();
+    int32_t SegmentOneExtractorTrack(ExtractorTrack *extractorTrack);
 
     //!
-    //! \brief  Set frames ready status for extractor track
+    //! \brief  Wake up segmentation threads to run specified
+    //!         jobs for current frames of all video streams
     //!
-    //! \param  [in] isFramesReady
-    //!         whether frames ready for extractor track
+    //! \param  [in] jobs
+    //!         pointer to jobs list to be run
     //!
     //! \return void
     //!
-    void SetFramesReadyStatus(bool isFramesReady)
-    {
-        pthread_mutex_lock(&m_mutex);
-        m_isFramesReady = isFramesReady;
-        pthread_mutex_unlock(&m_mutex);
-    };
+    void SetFramesReady(std::vector<SegJob> *jobs);
+
+    //!
+    //! \brief  Wait until new jobs are ready for segmentation
+    //!         threads
+    //!
+    //! \param  [in/out] framesNum
+    //!         frames number already processed by calling thread,
+    //!         updated to current ready frames number
+    //!
+    //! \return bool
+    //!         true if new frames are ready, false if
+    //!         segmentation threads are stopped
+    //!
+    bool WaitFramesReady(uint64_t *framesNum);
+
+    //!
+    //! \brief  Notify main segmentation thread that current
+    //!         frames have been processed by calling thread
+    //!
+    //! \param  [in] result
+    //!         segmentation result of calling thread
+    //!
+    //! \return void
+    //!
+    void SetFramesProcessed(int32_t result);
+
+    //!
+    //! \brief  Wait until current frames have been processed
+    //!         by all segmentation threads, even if some of
+    //!         them fail
+    //!
+    //! \return int32_t
+    //!         ERROR_NONE if success, else failed reason
+    //!
+    int32_t WaitFramesProcessed();
 
 private:
     std::map<MediaStream*, TrackSegmentCtx*>       m_streamSegCtx;       //!< map of media stream and its track segmentation context
@@ -274,15 +370,26 @@ private:
     std::map<TrackId, TrackSegmentCtx*>            m_trackSegCtx;        //!< map of tile track and its track segmentation context
     uint64_t                                       m_segNum;             //!< current written segments number
     uint64_t                                       m_framesNum;          //!< current written frames number
-    std::map<pthread_t, ExtractorTrack*>           m_extractorThreadIds; //!< map of thread ID for extractor track segmentation and corresponding extractor track
+    std::vector<pthread_t>                         m_segThreadIds;       //!< thread ID of segmentation threads
+    std::vector<SegJob>                            m_parseJobs;          //!< tiles parsing jobs, one for each video stream
+    std::vector<SegJob>                            m_segJobs;            //!< tile tracks and extractor tracks segmentation jobs
+    std::vector<SegJob>                            *m_currJobs;          //!< jobs list being run for current frames
+    uint32_t                                       m_nextSegJob;         //!< index of next job to be taken by segmentation threads
+    bool                                           m_isSegThreadsStopped;//!< whether segmentation threads are stopped
     bool                                           m_isEOS;              //!< whether EOS has been gotten for all media streams
     bool                                           m_nowKeyFrame;        //!< whether current frames are key frames for each corresponding media stream
     uint64_t                                       m_prevSegNum;         //!< previously written segments number
     pthread_mutex_t                                m_mutex;              //!< thread mutex for main segmentation thread
-    bool                                           m_isFramesReady;      //!< whether frames are ready for extractor track
-    uint16_t                                       m_aveETPerSegThread;  //!< average extractor tracks number in segmentation thread
-    uint16_t                                       m_lastETPerSegThread; //!< extractor tracks number in last segmentation thread
-    uint16_t                                       m_threadNumForET;     //!< threads number for extractor track segmentation
+    pthread_cond_t                                 m_framesReadyCond;    //!< signalled when new jobs are ready for segmentation threads
+    pthread_cond_t                                 m_framesProcessedCond;//!< signalled when one segmentation thread finishes current jobs
+    uint64_t                                       m_readyFramesNum;     //!< jobs rounds number which have been ready for segmentation threads
+    uint16_t                                       m_finishedThreadsNum; //!< segmentation threads number which have finished current jobs
+    int32_t                                        m_segJobsRet;         //!< failed reason of segmentation threads
+    uint16_t                                       m_segThreadsNum;      //!< threads number for segmentation
+    SegmentWriter                                  *m_segWriter;         //!< asynchronous writer shared by all tracks segmentation
+    SegmentStore                                   *m_segStore;          //!< in-memory store of live segments, NULL if segments are written to disk
+    HttpServer                                     *m_httpServer;        //!< http server serving the in-memory segment store
+    uint32_t                                       m_chunksPerSeg;       //!< chunks number of each segment, 0 if segments are published as a whole
 };
 
 VCD_NS_END;
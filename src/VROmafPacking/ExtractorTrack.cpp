@@ -322,14 +322,14 @@ int32_t ExtractorTrack::GenerateExtractors()
 
             memset(inlineCtor, 0, sizeof(InlineConstructor));
 
-            inlineCtor->inlineData = new uint8_t[256];
+            inlineCtor->inlineData = new uint8_t[SLICE_HEADER_BUF_SIZE];
             if (!inlineCtor->inlineData)
             {
                 DELETE_MEMORY(extractor);
                 DELETE_MEMORY(inlineCtor);
                 return OMAF_ERROR_NULL_PTR;
             }
-            memset(inlineCtor->inlineData, 0, 256);
+            memset(inlineCtor->inlineData, 0, SLICE_HEADER_BUF_SIZE);
 
             if (m_360scvpHandles.size() < m_streams->size())
             {
@@ -356,36 +356,20 @@ int32_t ExtractorTrack::GenerateExtractors()
             m_360scvpParam->destWidth = m_dstWidth;
             m_360scvpParam->destHeight = m_dstHeight;
 
-            uint8_t *tempData = new uint8_t[tileInfo->tileNalu->dataSize];
-            if (!tempData)
-            {
-                DELETE_MEMORY(extractor);
-                DELETE_ARRAY(inlineCtor->inlineData);
-                DELETE_MEMORY(inlineCtor);
-                return OMAF_ERROR_NULL_PTR;
-            }
-            memcpy(tempData, tileInfo->tileNalu->data, tileInfo->tileNalu->dataSize);
-
-            tempData[0] = 0;
-            tempData[1] = 0;
-            tempData[2] = 0;
-            tempData[3] = 1;
-
-            m_360scvpParam->pInputBitstream = tempData;
-            m_360scvpParam->inputBitstreamLen = tileInfo->tileNalu->dataSize;
-            m_360scvpParam->pOutputBitstream = inlineCtor->inlineData;
-
-            int32_t ret = I360SCVP_GenerateSliceHdr(m_360scvpParam, ctuIdx, m_360scvpHandle);
+            uint32_t hdrSize = 0;
+            int32_t ret = video->GetTileSliceHeader(
+                            origTileIdx, ctuIdx, m_dstWidth, m_dstHeight,
+                            m_360scvpHandle, m_360scvpParam,
+                            inlineCtor->inlineData, &hdrSize);
             if (ret)
             {
                 DELETE_MEMORY(extractor);
                 DELETE_ARRAY(inlineCtor->inlineData);
                 DELETE_MEMORY(inlineCtor);
-                DELETE_ARRAY(tempData);
-                return OMAF_ERROR_SCVP_OPERATION_FAILED;
+                return ret;
             }
 
-            inlineCtor->length = DASH_SAMPLELENFIELD_SIZE + m_360scvpParam->outputBitstreamLen - HEVC_STARTCODES_LEN;
+            inlineCtor->length = DASH_SAMPLELENFIELD_SIZE + hdrSize - HEVC_STARTCODES_LEN;
 
             memset(inlineCtor->inlineData, 0xff, DASH_SAMPLELENFIELD_SIZE);
 
@@ -397,7 +381,6 @@ int32_t ExtractorTrack::GenerateExtractors()
                 DELETE_MEMORY(extractor);
                 DELETE_ARRAY(inlineCtor->inlineData);
                 DELETE_MEMORY(inlineCtor);
-                DELETE_ARRAY(tempData);
                 return OMAF_ERROR_NULL_PTR;
             }
 
@@ -414,7 +397,6 @@ int32_t ExtractorTrack::GenerateExtractors()
             m_extractors.insert(std::make_pair(tileIdx, extractor));
 
             tileIdx++;
-            DELETE_ARRAY(tempData);
         }
     }
     m_isFramesReady = false;
@@ -525,46 +507,25 @@ int32_t ExtractorTrack::UpdateExtractors()
 
             if (!(inlineCtor->inlineData))
                 return OMAF_ERROR_NULL_PTR;
-            memset(inlineCtor->inlineData, 0, 256);
+            memset(inlineCtor->inlineData, 0, SLICE_HEADER_BUF_SIZE);
 
             void *m_360scvpHandle = m_360scvpHandles[(MediaStream*)video];
-            memcpy(m_360scvpParam, video->Get360SCVPParam(), sizeof(param_360SCVP));
-
-            m_360scvpParam->destWidth = m_dstWidth;
-            m_360scvpParam->destHeight = m_dstHeight;
-
-            uint8_t *tempData = new uint8_t[tileInfo->tileNalu->dataSize];
-            if (!tempData)
-                return OMAF_ERROR_NULL_PTR;
-
-            memcpy(tempData, tileInfo->tileNalu->data, tileInfo->tileNalu->dataSize);
-
-            tempData[0] = 0;
-            tempData[1] = 0;
-            tempData[2] = 0;
-            tempData[3] = 1;
 
-            m_360scvpParam->pInputBitstream = tempData;
-            m_360scvpParam->inputBitstreamLen = tileInfo->tileNalu->dataSize;
-            m_360scvpParam->pOutputBitstream  = inlineCtor->inlineData;
-
-            int32_t ret = I360SCVP_GenerateSliceHdr(m_360scvpParam, ctuIdx, m_360scvpHandle);
+            uint32_t hdrSize = 0;
+            int32_t ret = video->GetTileSliceHeader(
+                            origTileIdx, ctuIdx, m_dstWidth, m_dstHeight,
+                            m_360scvpHandle, m_360scvpParam,
+                            inlineCtor->inlineData, &hdrSize);
             if (ret)
-            {
-                DELETE_ARRAY(tempData);
-                return OMAF_ERROR_SCVP_OPERATION_FAILED;
-            }
+                return ret;
 
-            inlineCtor->length = DASH_SAMPLELENFIELD_SIZE + m_360scvpParam->outputBitstreamLen - HEVC_STARTCODES_LEN;
+            inlineCtor->length = DASH_SAMPLELENFIELD_SIZE + hdrSize - HEVC_STARTCODES_LEN;
 
             memset(inlineCtor->inlineData, 0xff, DASH_SAMPLELENFIELD_SIZE);
 
             SampleConstructor *sampleCtor = extractor->sampleConstructor.front();
             if (!sampleCtor)
-            {
-                DELETE_ARRAY(tempData);
                 return OMAF_ERROR_NULL_PTR;
-            }
 
             sampleCtor->dataOffset    = DASH_SAMPLELENFIELD_SIZE + HEVC_NALUHEADER_LEN + tileInfo->tileNalu->sliceHeaderLen;
             sampleCtor->dataLength = tileInfo->tileNalu->dataSize -
@@ -573,7 +534,6 @@ int32_t ExtractorTrack::UpdateExtractors()
 
 
             tileIdx++;
-            DELETE_ARRAY(tempData);
         }
     }
     m_isFramesReady = false;
@@ -0,0 +1,135 @@
+/*
+ * Copyright (c) 2019, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+//!
+//! \file:   FrameInfoPool.cpp
+//! \brief:  Frame information pool class implementation
+//!
+
+#include "FrameInfoPool.h"
+
+VCD_NS_BEGIN
+
+FrameInfoPool::FrameInfoPool()
+{
+    m_freeFrames = NULL;
+    pthread_mutex_init(&m_mutex, NULL);
+}
+
+FrameInfoPool::~FrameInfoPool()
+{
+    while (m_freeFrames)
+    {
+        PooledFrameInfo *pooledFrame = m_freeFrames;
+        m_freeFrames = pooledFrame->next;
+
+        DELETE_ARRAY(pooledFrame->buffer);
+        delete pooledFrame;
+        pooledFrame = NULL;
+    }
+
+    pthread_mutex_destroy(&m_mutex);
+}
+
+FrameBSInfo* FrameInfoPool::GetFrameInfo(
+    FrameBSInfo *frameInfo,
+    FrameDataReleaseFunc releaseFunc,
+    void *opaque)
+{
+    if (!frameInfo || !(frameInfo->data) || (frameInfo->dataSize <= 0))
+        return NULL;
+
+    pthread_mutex_lock(&m_mutex);
+    PooledFrameInfo *pooledFrame = m_freeFrames;
+    if (pooledFrame)
+        m_freeFrames = pooledFrame->next;
+    pthread_mutex_unlock(&m_mutex);
+
+    if (!pooledFrame)
+    {
+        pooledFrame = new PooledFrameInfo;
+        if (!pooledFrame)
+            return NULL;
+
+        memset(pooledFrame, 0, sizeof(PooledFrameInfo));
+    }
+    pooledFrame->next = NULL;
+
+    if (releaseFunc)
+    {
+        pooledFrame->frameInfo.data = frameInfo->data;
+    }
+    else
+    {
+        if (pooledFrame->bufferSize < frameInfo->dataSize)
+        {
+            DELETE_ARRAY(pooledFrame->buffer);
+            pooledFrame->bufferSize = 0;
+
+            pooledFrame->buffer = new uint8_t[frameInfo->dataSize];
+            if (!(pooledFrame->buffer))
+            {
+                delete pooledFrame;
+                pooledFrame = NULL;
+                return NULL;
+            }
+            pooledFrame->bufferSize = frameInfo->dataSize;
+        }
+        memcpy(pooledFrame->buffer, frameInfo->data, frameInfo->dataSize);
+        pooledFrame->frameInfo.data = pooledFrame->buffer;
+    }
+
+    pooledFrame->frameInfo.dataSize = frameInfo->dataSize;
+    pooledFrame->frameInfo.pts = frameInfo->pts;
+    pooledFrame->frameInfo.isKeyFrame = frameInfo->isKeyFrame;
+    pooledFrame->releaseFunc = releaseFunc;
+    pooledFrame->releaseOpaque = opaque;
+
+    return &(pooledFrame->frameInfo);
+}
+
+void FrameInfoPool::PutFrameInfo(FrameBSInfo *frameInfo)
+{
+    if (!frameInfo)
+        return;
+
+    PooledFrameInfo *pooledFrame = (PooledFrameInfo*)frameInfo;
+    if (pooledFrame->releaseFunc)
+    {
+        pooledFrame->releaseFunc(pooledFrame->frameInfo.data, pooledFrame->releaseOpaque);
+        pooledFrame->releaseFunc = NULL;
+        pooledFrame->releaseOpaque = NULL;
+    }
+    pooledFrame->frameInfo.data = NULL;
+    pooledFrame->frameInfo.dataSize = 0;
+
+    pthread_mutex_lock(&m_mutex);
+    pooledFrame->next = m_freeFrames;
+    m_freeFrames = pooledFrame;
+    pthread_mutex_unlock(&m_mutex);
+}
+
+VCD_NS_END
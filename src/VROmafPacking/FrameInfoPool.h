@@ -0,0 +1,118 @@
+/*
+ * Copyright (c) 2019, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+//!
+//! \file:   FrameInfoPool.h
+//! \brief:  Frame information pool class definition
+//! \detail: Recycle frame information objects and their bitstream
+//!          buffers, or take over the ownership of caller's bitstream
+//!          data, so that frames are not copied or reallocated for
+//!          each input frame.
+//!
+
+#ifndef _FRAMEINFOPOOL_H_
+#define _FRAMEINFOPOOL_H_
+
+#include "OmafPackingCommon.h"
+#include "VROmafPacking_data.h"
+
+#include <pthread.h>
+
+VCD_NS_BEGIN
+
+//!
+//! \struct: PooledFrameInfo
+//! \brief:  frame information together with the information
+//!          needed to give its bitstream data back
+//!
+struct PooledFrameInfo
+{
+    FrameBSInfo          frameInfo;     //!< frame information handed out by the pool, must be the first member
+    FrameDataReleaseFunc releaseFunc;   //!< release function of caller's data, NULL if data is pool buffer
+    void                 *releaseOpaque;//!< user data passed to the release function
+    uint8_t              *buffer;       //!< pool buffer for copied bitstream data
+    int32_t              bufferSize;    //!< allocated size of the pool buffer
+    PooledFrameInfo      *next;         //!< next free frame information in the pool
+};
+
+//!
+//! \class FrameInfoPool
+//! \brief Define the frame information pool shared by the
+//!        frame producer and the segmentation thread
+//!
+
+class FrameInfoPool
+{
+public:
+    //!
+    //! \brief  Constructor
+    //!
+    FrameInfoPool();
+
+    //!
+    //! \brief  Destructor
+    //!
+    ~FrameInfoPool();
+
+    //!
+    //! \brief  Get one frame information from the pool and
+    //!         fill it with the input frame
+    //!
+    //! \param  [in] frameInfo
+    //!         pointer to the input frame information
+    //! \param  [in] releaseFunc
+    //!         if not NULL, the bitstream data is referenced
+    //!         instead of copied and releaseFunc is called
+    //!         when the frame is put back to the pool
+    //! \param  [in] opaque
+    //!         user data passed to releaseFunc
+    //!
+    //! \return FrameBSInfo*
+    //!         the pointer to the frame information, NULL if failed
+    //!
+    FrameBSInfo* GetFrameInfo(
+        FrameBSInfo *frameInfo,
+        FrameDataReleaseFunc releaseFunc,
+        void *opaque);
+
+    //!
+    //! \brief  Put the frame information got from the pool back
+    //!         and release its bitstream data
+    //!
+    //! \param  [in] frameInfo
+    //!         pointer to the frame information
+    //!
+    //! \return void
+    //!
+    void PutFrameInfo(FrameBSInfo *frameInfo);
+
+private:
+    PooledFrameInfo *m_freeFrames; //!< list of free frame information
+    pthread_mutex_t m_mutex;       //!< thread mutex for the free list
+};
+
+VCD_NS_END;
+#endif /* _FRAMEINFOPOOL_H_ */
@@ -35,6 +35,8 @@
 #include "../utils/OmafStructure.h"
 #include "HevcNaluParser.h"
 
+#define HEVC_EXTRA_NALU_NUM 8 //<! room for the parameter sets and SEI in front of the slices of one frame
+
 VCD_NS_BEGIN
 
 HevcNaluParser::~HevcNaluParser()
@@ -279,51 +281,50 @@ int32_t HevcNaluParser::ParseSliceNalu(
     if (!frameData || !frameDataSize || !tilesNum || !tilesInfo)
         return OMAF_ERROR_BAD_PARAM;
 
-    m_360scvpParam->pInputBitstream = frameData;
-    m_360scvpParam->inputBitstreamLen = frameDataSize;
-    uint32_t restBSBytes = m_360scvpParam->inputBitstreamLen;
+    // find all the NAL units of the frame in one pass
+    if (m_nalIndex.size() < (size_t)tilesNum + HEVC_EXTRA_NALU_NUM)
+        m_nalIndex.resize(tilesNum + HEVC_EXTRA_NALU_NUM);
+    int32_t nalsNum = I360SCVP_ScanNALs(frameData, frameDataSize, m_nalIndex.data(), m_nalIndex.size());
+    if (nalsNum > (int32_t)m_nalIndex.size())
+    {
+        m_nalIndex.resize(nalsNum);
+        nalsNum = I360SCVP_ScanNALs(frameData, frameDataSize, m_nalIndex.data(), m_nalIndex.size());
+    }
+    if (nalsNum <= 0)
+        return OMAF_ERROR_INVALID_FRAME_BITSTREAM;
 
-    while (restBSBytes > 0)
+    int32_t naluIdx = 0;
+    while (naluIdx < nalsNum)
     {
-        Nalu *tempNalu = new Nalu;
-        tempNalu->data = m_360scvpParam->pInputBitstream;
-        tempNalu->dataSize = restBSBytes;
-        I360SCVP_ParseNAL(tempNalu, m_360scvpHandle);
-        if (tempNalu->naluType == 32 || tempNalu->naluType == 33
-        || tempNalu->naluType == 34 || tempNalu->naluType == 39
-        || tempNalu->naluType == 40) // skip VPS/SPS/PPS/SEI
-        {
-            m_360scvpParam->pInputBitstream = m_360scvpParam->pInputBitstream + tempNalu->dataSize;
-            restBSBytes -= tempNalu->dataSize;
-            delete tempNalu;
-            tempNalu = NULL;
-        }
-        else
-        {
-            delete tempNalu;
-            tempNalu = NULL;
+        param_nalIndex *nalIndex = &(m_nalIndex[naluIdx]);
+        if (nalIndex->startCodeOffset + nalIndex->startCodeSize >= (uint32_t)frameDataSize)
             break;
-        }
+        uint8_t naluType = (frameData[nalIndex->startCodeOffset + nalIndex->startCodeSize] & 0x7e) >> 1;
+        if (naluType != 32 && naluType != 33 && naluType != 34 && naluType != 39 && naluType != 40)
+            break;
+
+        // VPS/SPS/PPS/SEI ahead of slices are parsed into the parser state
+        Nalu tempNalu;
+        memset(&tempNalu, 0, sizeof(Nalu));
+        tempNalu.data = frameData + nalIndex->startCodeOffset;
+        tempNalu.dataSize = nalIndex->naluSize;
+        I360SCVP_ParseNAL(&tempNalu, m_360scvpHandle);
+        naluIdx++;
     }
 
-    uint32_t restBitstreamLen = restBSBytes;
+    // one slice NAL unit is needed for each tile, a frame with fewer
+    // slices than tiles is rejected instead of being read beyond its end
+    if (nalsNum - naluIdx < tilesNum)
+        return OMAF_ERROR_INVALID_FRAME_BITSTREAM;
+
     for (uint16_t tileIdx = 0; tileIdx < tilesNum; tileIdx++)
     {
         TileInfo *tileInfo = &(tilesInfo[tileIdx]);
         Nalu *nalu         = tileInfo->tileNalu;
+        param_nalIndex *nalIndex = &(m_nalIndex[naluIdx + tileIdx]);
 
-        if (tileIdx == 0)
-        {
-            nalu->data       = m_360scvpParam->pInputBitstream;
-            nalu->dataSize   = restBitstreamLen;
-        }
-        else
-        {
-            TileInfo *tileInfoPrev = &(tilesInfo[tileIdx - 1]);
-            Nalu *naluPrev         = tileInfoPrev->tileNalu;
-            nalu->data             = naluPrev->data + naluPrev->dataSize;
-            nalu->dataSize         = restBitstreamLen;
-        }
+        nalu->data     = frameData + nalIndex->startCodeOffset;
+        nalu->dataSize = nalIndex->naluSize;
 
         uint8_t *startPos = nalu->data;
 
@@ -334,8 +335,6 @@ int32_t HevcNaluParser::ParseSliceNalu(
 
         nalu->sliceHeaderLen = nalu->sliceHeaderLen - HEVC_NALUHEADER_LEN;
 
-        restBitstreamLen = restBitstreamLen - nalu->dataSize;
-
         uint64_t actualSize = nalu->dataSize - HEVC_STARTCODES_LEN;
         nalu->data[0] = (uint8_t)((0xff000000 & actualSize) >> 24);
         nalu->data[1] = (uint8_t)((0x00ff0000 & actualSize) >> 16);
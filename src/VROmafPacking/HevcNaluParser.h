@@ -37,6 +37,7 @@
 #ifndef _HEVCNALUPARSER_H_
 #define _HEVCNALUPARSER_H_
 
+#include <vector>
 #include "NaluParser.h"
 
 VCD_NS_BEGIN
@@ -154,7 +155,9 @@ public:
     //!         in video frame, including nalu information
     //!
     //! \return int32_t
-    //!         ERROR_NONE if success, else failed reason
+    //!         ERROR_NONE if success, OMAF_ERROR_INVALID_FRAME_BITSTREAM
+    //!         if the frame has fewer slice NAL units than tilesNum,
+    //!         else failed reason
     //!
     virtual int32_t ParseSliceNalu(
         uint8_t *frameData,
@@ -173,6 +176,7 @@ private:
     virtual int16_t ParseProjectionTypeSei();
 
 private:
+    std::vector<param_nalIndex> m_nalIndex;   //!< NAL units of the frame being parsed
 };
 
 VCD_NS_END;
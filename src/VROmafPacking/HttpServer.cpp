@@ -0,0 +1,427 @@
+/*
+ * Copyright (c) 2019, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+//!
+//! \file:   HttpServer.cpp
+//! \brief:  Embedded http server class implementation
+//!
+
+#include "HttpServer.h"
+
+#include <errno.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <strings.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+VCD_NS_BEGIN
+
+//!
+//! \struct: ConnectionCtx
+//! \brief:  arguments passed to connection thread
+//!
+struct ConnectionCtx
+{
+    HttpServer *server;
+    int32_t    sock;
+};
+
+static int32_t SendAll(int32_t sock, const char *data, size_t dataSize)
+{
+    while (dataSize)
+    {
+        ssize_t sentSize = send(sock, data, dataSize, MSG_NOSIGNAL);
+        if (sentSize < 0 && errno == EINTR)
+            continue;
+        if (sentSize <= 0)
+            return OMAF_ERROR_INVALID_DATA;
+
+        data += sentSize;
+        dataSize -= sentSize;
+    }
+
+    return ERROR_NONE;
+}
+
+static bool IsMpdFile(const char *path)
+{
+    const char *ext = strrchr(path, '.');
+    return (ext && !strcmp(ext, ".mpd"));
+}
+
+HttpServer::HttpServer(SegmentStore *segStore)
+{
+    m_segStore = segStore;
+    m_listenSock = -1;
+    m_acceptThreadId = 0;
+    m_isRunning = false;
+    m_isStopped = false;
+    pthread_mutex_init(&m_mutex, NULL);
+    pthread_cond_init(&m_connCond, NULL);
+}
+
+HttpServer::~HttpServer()
+{
+    Stop();
+
+    pthread_cond_destroy(&m_connCond);
+    pthread_mutex_destroy(&m_mutex);
+}
+
+int32_t HttpServer::Start(uint16_t port)
+{
+    if (!m_segStore)
+        return OMAF_ERROR_NULL_PTR;
+
+    if (m_isRunning)
+        return ERROR_NONE;
+
+    m_listenSock = socket(AF_INET, SOCK_STREAM, 0);
+    if (m_listenSock < 0)
+    {
+        LOG(ERROR) << "Failed to create http server socket !" << std::endl;
+        return OMAF_ERROR_START_HTTP_SERVER_FAILED;
+    }
+
+    int32_t reuseAddr = 1;
+    setsockopt(m_listenSock, SOL_SOCKET, SO_REUSEADDR, &reuseAddr, sizeof(reuseAddr));
+
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    addr.sin_port = htons(port);
+
+    if (bind(m_listenSock, (struct sockaddr*)&addr, sizeof(addr)) ||
+        listen(m_listenSock, SOMAXCONN))
+    {
+        LOG(ERROR) << "Failed to listen on port " << port << " for http server !" << std::endl;
+        close(m_listenSock);
+        m_listenSock = -1;
+        return OMAF_ERROR_START_HTTP_SERVER_FAILED;
+    }
+
+    m_isStopped = false;
+    int32_t ret = pthread_create(&m_acceptThreadId, NULL, AcceptThread, this);
+    if (ret)
+    {
+        LOG(ERROR) << "Failed to create http server thread !" << std::endl;
+        close(m_listenSock);
+        m_listenSock = -1;
+        return OMAF_ERROR_CREATE_THREAD;
+    }
+    m_isRunning = true;
+
+    LOG(INFO) << "Http server is serving segments on port " << port << std::endl;
+
+    return ERROR_NONE;
+}
+
+void HttpServer::Stop()
+{
+    if (!m_isRunning)
+        return;
+
+    pthread_mutex_lock(&m_mutex);
+    m_isStopped = true;
+    std::set<int32_t>::iterator it;
+    for (it = m_connSocks.begin(); it != m_connSocks.end(); it++)
+    {
+        shutdown(*it, SHUT_RDWR);
+    }
+    pthread_mutex_unlock(&m_mutex);
+
+    // wake up connections waiting for data of incomplete files
+    m_segStore->Stop();
+
+    shutdown(m_listenSock, SHUT_RDWR);
+    pthread_join(m_acceptThreadId, NULL);
+    close(m_listenSock);
+    m_listenSock = -1;
+
+    pthread_mutex_lock(&m_mutex);
+    while (!m_connSocks.empty())
+    {
+        pthread_cond_wait(&m_connCond, &m_mutex);
+    }
+    pthread_mutex_unlock(&m_mutex);
+
+    m_isRunning = false;
+}
+
+void *HttpServer::AcceptThread(void *pThis)
+{
+    HttpServer *server = (HttpServer*)pThis;
+
+    server->AcceptConnections();
+
+    return NULL;
+}
+
+void *HttpServer::ConnectionThread(void *pCtx)
+{
+    ConnectionCtx *connCtx = (ConnectionCtx*)pCtx;
+    HttpServer *server = connCtx->server;
+    int32_t sock = connCtx->sock;
+    delete connCtx;
+    connCtx = NULL;
+
+    server->ServeConnection(sock);
+
+    pthread_mutex_lock(&(server->m_mutex));
+    server->m_connSocks.erase(sock);
+    close(sock);
+    pthread_cond_signal(&(server->m_connCond));
+    pthread_mutex_unlock(&(server->m_mutex));
+
+    return NULL;
+}
+
+void HttpServer::AcceptConnections()
+{
+    while (true)
+    {
+        int32_t sock = accept(m_listenSock, NULL, NULL);
+        if (sock < 0)
+        {
+            if (errno == EINTR || errno == ECONNABORTED)
+                continue;
+            break;
+        }
+
+        int32_t noDelay = 1;
+        setsockopt(sock, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+
+        pthread_mutex_lock(&m_mutex);
+        if (m_isStopped)
+        {
+            pthread_mutex_unlock(&m_mutex);
+            close(sock);
+            break;
+        }
+
+        ConnectionCtx *connCtx = new ConnectionCtx;
+        pthread_t threadId;
+        int32_t ret = OMAF_ERROR_NULL_PTR;
+        if (connCtx)
+        {
+            connCtx->server = this;
+            connCtx->sock = sock;
+            ret = pthread_create(&threadId, NULL, ConnectionThread, connCtx);
+        }
+
+        if (ret)
+        {
+            LOG(ERROR) << "Failed to create http connection thread !" << std::endl;
+            DELETE_MEMORY(connCtx);
+            close(sock);
+        }
+        else
+        {
+            pthread_detach(threadId);
+            m_connSocks.insert(sock);
+        }
+        pthread_mutex_unlock(&m_mutex);
+    }
+}
+
+void HttpServer::ServeConnection(int32_t sock)
+{
+    char reqBuf[HTTP_REQUEST_MAX_SIZE + 1];
+    size_t reqSize = 0;
+    bool keepAlive = true;
+
+    while (keepAlive)
+    {
+        char *headerEnd = NULL;
+        while (true)
+        {
+            reqBuf[reqSize] = '\0';
+            headerEnd = strstr(reqBuf, "\r\n\r\n");
+            if (headerEnd)
+                break;
+
+            if (reqSize >= HTTP_REQUEST_MAX_SIZE)
+            {
+                const char *response = "HTTP/1.1 431 Request Header Fields Too Large\r\nContent-Length: 0\r\nConnection: close\r\n\r\n";
+                SendAll(sock, response, strlen(response));
+                return;
+            }
+
+            ssize_t recvSize = recv(sock, reqBuf + reqSize, HTTP_REQUEST_MAX_SIZE - reqSize, 0);
+            if (recvSize < 0 && errno == EINTR)
+                continue;
+            if (recvSize <= 0)
+                return;
+
+            reqSize += recvSize;
+        }
+        *headerEnd = '\0';
+        size_t requestLen = headerEnd - reqBuf + 4;
+
+        char method[16];
+        char path[1024];
+        int32_t majorVer = 0;
+        int32_t minorVer = 0;
+        if (sscanf(reqBuf, "%15s %1023s HTTP/%d.%d", method, path, &majorVer, &minorVer) != 4)
+        {
+            const char *response = "HTTP/1.1 400 Bad Request\r\nContent-Length: 0\r\nConnection: close\r\n\r\n";
+            SendAll(sock, response, strlen(response));
+            return;
+        }
+
+        bool isHttp10 = (majorVer == 1 && minorVer == 0);
+        keepAlive = !isHttp10;
+        const char *connHeader = strcasestr(reqBuf, "\r\nConnection:");
+        if (connHeader)
+        {
+            connHeader += strlen("\r\nConnection:");
+            while (*connHeader == ' ')
+                connHeader++;
+
+            if (!strncasecmp(connHeader, "close", 5))
+                keepAlive = false;
+            else if (!strncasecmp(connHeader, "keep-alive", 10))
+                keepAlive = true;
+        }
+
+        bool isHead = !strcmp(method, "HEAD");
+        if (!isHead && strcmp(method, "GET"))
+        {
+            const char *response = "HTTP/1.1 405 Method Not Allowed\r\nAllow: GET, HEAD\r\nContent-Length: 0\r\nConnection: close\r\n\r\n";
+            SendAll(sock, response, strlen(response));
+            return;
+        }
+
+        char *query = strchr(path, '?');
+        if (query)
+            *query = '\0';
+
+        int32_t ret = SendFile(sock, path, isHead, isHttp10, &keepAlive);
+        if (ret)
+            return;
+
+        // keep pipelined requests
+        reqSize -= requestLen;
+        memmove(reqBuf, reqBuf + requestLen, reqSize);
+    }
+}
+
+int32_t HttpServer::SendFile(int32_t sock, const char *path, bool isHead, bool isHttp10, bool *keepAlive)
+{
+    char header[1024];
+    const char *connValue = *keepAlive ? "keep-alive" : "close";
+
+    std::shared_ptr<StoredFile> file = m_segStore->GetFile(path);
+    if (!file)
+    {
+        snprintf(header, 1024, "HTTP/1.1 404 Not Found\r\nContent-Length: 0\r\nConnection: %s\r\n\r\n", connValue);
+        return SendAll(sock, header, strlen(header));
+    }
+
+    uint64_t fileSize = 0;
+    bool isComplete = false;
+    int32_t ret = m_segStore->GetFileStatus(file, &fileSize, &isComplete);
+    if (ret)
+        return ret;
+
+    // incomplete file is sent as its data arrives, with chunked
+    // transfer encoding, or until connection is closed for HTTP/1.0
+    bool isChunked = !isComplete && !isHttp10;
+    if (!isComplete && isHttp10)
+    {
+        *keepAlive = false;
+        connValue = "close";
+    }
+
+    int32_t headerLen = snprintf(header, 1024,
+        "HTTP/1.1 200 OK\r\n"
+        "Content-Type: %s\r\n"
+        "Access-Control-Allow-Origin: *\r\n"
+        "%s"
+        "Connection: %s\r\n",
+        IsMpdFile(path) ? "application/dash+xml" : "video/mp4",
+        IsMpdFile(path) ? "Cache-Control: no-cache\r\n" : "",
+        connValue);
+    if (isComplete)
+        headerLen += snprintf(header + headerLen, 1024 - headerLen, "Content-Length: %lu\r\n\r\n", (unsigned long)fileSize);
+    else if (isChunked)
+        headerLen += snprintf(header + headerLen, 1024 - headerLen, "Transfer-Encoding: chunked\r\n\r\n");
+    else
+        headerLen += snprintf(header + headerLen, 1024 - headerLen, "\r\n");
+
+    ret = SendAll(sock, header, headerLen);
+    if (ret || isHead)
+        return ret;
+
+    // reserve space before data for chunk size line, and after
+    // data for chunk end, so each chunk is sent at once
+    const uint32_t chunkHeaderSpace = 32;
+    uint8_t *sendBuf = new uint8_t[chunkHeaderSpace + HTTP_SEND_BUFFER_SIZE + 2];
+    if (!sendBuf)
+        return OMAF_ERROR_NULL_PTR;
+
+    uint8_t *dataBuf = sendBuf + chunkHeaderSpace;
+    uint64_t offset = 0;
+    while (!isComplete || offset < fileSize)
+    {
+        uint64_t readSize = 0;
+        ret = m_segStore->ReadFile(file, offset, dataBuf, HTTP_SEND_BUFFER_SIZE, &readSize);
+        if (ret || !readSize)
+            break;
+        offset += readSize;
+
+        if (isChunked)
+        {
+            char chunkHeader[chunkHeaderSpace];
+            int32_t chunkHeaderLen = snprintf(chunkHeader, chunkHeaderSpace, "%lx\r\n", (unsigned long)readSize);
+            memcpy(dataBuf - chunkHeaderLen, chunkHeader, chunkHeaderLen);
+            memcpy(dataBuf + readSize, "\r\n", 2);
+            ret = SendAll(sock, (char*)(dataBuf - chunkHeaderLen), chunkHeaderLen + readSize + 2);
+        }
+        else
+        {
+            ret = SendAll(sock, (char*)dataBuf, readSize);
+        }
+        if (ret)
+            break;
+    }
+    DELETE_ARRAY(sendBuf);
+
+    if (ret)
+        return ret;
+
+    if (isChunked)
+    {
+        const char *lastChunk = "0\r\n\r\n";
+        ret = SendAll(sock, lastChunk, strlen(lastChunk));
+    }
+
+    return ret;
+}
+
+VCD_NS_END
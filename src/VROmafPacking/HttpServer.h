@@ -0,0 +1,151 @@
+/*
+ * Copyright (c) 2019, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+//!
+//! \file:   HttpServer.h
+//! \brief:  Embedded http server class definition
+//! \detail: A small HTTP/1.1 origin server which serves files kept
+//!          in the in-memory segment store. Files which are still
+//!          being written are sent with chunked transfer encoding
+//!          as their data arrives.
+//!
+
+#ifndef _HTTPSERVER_H_
+#define _HTTPSERVER_H_
+
+#include "OmafPackingCommon.h"
+#include "SegmentStore.h"
+
+#include <pthread.h>
+#include <set>
+
+VCD_NS_BEGIN
+
+#define HTTP_REQUEST_MAX_SIZE  8192   //!< max size of request line and headers
+#define HTTP_SEND_BUFFER_SIZE  65536  //!< size of each piece of file data sent
+
+//!
+//! \class HttpServer
+//! \brief Define the http server serving the segment store
+//!
+
+class HttpServer
+{
+public:
+    //!
+    //! \brief  Constructor
+    //!
+    //! \param  [in] segStore
+    //!         pointer to the segment store to be served
+    //!
+    HttpServer(SegmentStore *segStore);
+
+    //!
+    //! \brief  Destructor
+    //!
+    ~HttpServer();
+
+    //!
+    //! \brief  Listen on the port and start accepting
+    //!         connections
+    //!
+    //! \param  [in] port
+    //!         the TCP port to listen on
+    //!
+    //! \return int32_t
+    //!         ERROR_NONE if success, else failed reason
+    //!
+    int32_t Start(uint16_t port);
+
+    //!
+    //! \brief  Stop accepting connections and close all
+    //!         connections
+    //!
+    //! \return void
+    //!
+    void Stop();
+
+private:
+    //!
+    //! \brief  Thread function for accepting connections
+    //!
+    static void* AcceptThread(void *pThis);
+
+    //!
+    //! \brief  Thread function for serving one connection
+    //!
+    static void* ConnectionThread(void *pCtx);
+
+    //!
+    //! \brief  Accept connections until the server is stopped
+    //!
+    //! \return void
+    //!
+    void AcceptConnections();
+
+    //!
+    //! \brief  Serve requests of the connection until it is
+    //!         closed by client or the server is stopped
+    //!
+    //! \param  [in] sock
+    //!         socket of the connection
+    //!
+    //! \return void
+    //!
+    void ServeConnection(int32_t sock);
+
+    //!
+    //! \brief  Send the response for one GET or HEAD request
+    //!
+    //! \param  [in] sock
+    //!         socket of the connection
+    //! \param  [in] path
+    //!         requested path
+    //! \param  [in] isHead
+    //!         whether the request is HEAD request
+    //! \param  [in] isHttp10
+    //!         whether the client uses HTTP/1.0 which doesn't
+    //!         support chunked transfer encoding
+    //! \param  [out] keepAlive
+    //!         whether the connection can be kept for next request
+    //!
+    //! \return int32_t
+    //!         ERROR_NONE if success, else failed reason
+    //!
+    int32_t SendFile(int32_t sock, const char *path, bool isHead, bool isHttp10, bool *keepAlive);
+
+    SegmentStore    *m_segStore;      //!< pointer to the segment store to be served
+    int32_t         m_listenSock;     //!< listening socket
+    pthread_t       m_acceptThreadId; //!< thread ID of connections accepting thread
+    bool            m_isRunning;      //!< whether the server is running
+    bool            m_isStopped;      //!< whether the server is asked to stop
+    pthread_mutex_t m_mutex;          //!< thread mutex for connections
+    pthread_cond_t  m_connCond;       //!< signalled when one connection is closed
+    std::set<int32_t> m_connSocks;    //!< sockets of connections being served
+};
+
+VCD_NS_END;
+#endif /* _HTTPSERVER_H_ */
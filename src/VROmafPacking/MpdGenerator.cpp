@@ -53,6 +53,7 @@ MpdGenerator::MpdGenerator()
     m_xmlDoc = NULL;
     m_frameRate.num = 0;
     m_frameRate.den = 0;
+    m_segStore = NULL;
 }
 
 MpdGenerator::MpdGenerator(
@@ -60,7 +61,8 @@ MpdGenerator::MpdGenerator(
     std::map<ExtractorTrack*, TrackSegmentCtx*> *extractorSegCtxs,
     SegmentationInfo *segInfo,
     VCD::OMAF::ProjectionFormat projType,
-    Rational frameRate)
+    Rational frameRate,
+    SegmentStore *segStore)
 {
     m_streamSegCtx = streamsSegCtxs;
     m_extractorSegCtx = extractorSegCtxs;
@@ -73,6 +75,7 @@ MpdGenerator::MpdGenerator(
     m_frameRate = frameRate;
     m_timeScale = 0;
     m_xmlDoc = NULL;
+    m_segStore = segStore;
 }
 
 MpdGenerator::~MpdGenerator()
@@ -200,11 +203,27 @@ int32_t MpdGenerator::WriteTileTrackAS(XMLElement *periodEle, TrackSegmentCtx *p
     sgtTpeEle->SetAttribute(DURATION, m_segInfo->segDuration * m_timeScale);
     sgtTpeEle->SetAttribute(STARTNUMBER, 0);
     sgtTpeEle->SetAttribute(TIMESCALE, m_timeScale);
+    WriteChunkAvailability(sgtTpeEle);
     representationEle->InsertEndChild(sgtTpeEle);
 
     return ERROR_NONE;
 }
 
+void MpdGenerator::WriteChunkAvailability(XMLElement *sgtTpeEle)
+{
+    if (!m_segStore || !m_segInfo->isLive || !m_segInfo->framesPerChunk)
+        return;
+
+    // the first chunk of one segment is available once its
+    // frames are produced, instead of the whole segment duration
+    double chunkDur = (double)(m_segInfo->framesPerChunk * m_frameRate.den) / m_frameRate.num;
+    char string[1024];
+    memset(string, 0, 1024);
+    snprintf(string, 1024, "%.3f", (double)m_segInfo->segDuration - chunkDur);
+    sgtTpeEle->SetAttribute(AVAILABILITYTIMEOFFSET, string);
+    sgtTpeEle->SetAttribute(AVAILABILITYTIMECOMPLETE, "false");
+}
+
 int32_t MpdGenerator::WriteExtractorTrackAS(XMLElement *periodEle, TrackSegmentCtx *pTrackSegCtx)
 {
     TrackSegmentCtx trackSegCtx = *pTrackSegCtx;
@@ -306,12 +325,13 @@ int32_t MpdGenerator::WriteExtractorTrackAS(XMLElement *periodEle, TrackSegmentC
     sgtTpeEle->SetAttribute(DURATION, m_segInfo->segDuration * m_timeScale);
     sgtTpeEle->SetAttribute(STARTNUMBER, 0);
     sgtTpeEle->SetAttribute(TIMESCALE, m_timeScale);
+    WriteChunkAvailability(sgtTpeEle);
     representationEle->InsertEndChild(sgtTpeEle);
 
     return ERROR_NONE;
 }
 
-int32_t MpdGenerator::WriteMpd(uint64_t totalFramesNum)
+int32_t MpdGenerator::BuildMpdTemplate()
 {
     const char *declaration = "xml version=\"1.0\" encoding=\"UTF-8\"";
     XMLDeclaration *xmlDec = m_xmlDoc->NewDeclaration();
@@ -348,69 +368,17 @@ int32_t MpdGenerator::WriteMpd(uint64_t totalFramesNum)
 
     if (m_segInfo->isLive)
     {
-
-        uint32_t sec;
-        time_t gTime;
-        struct tm *t;
-        struct timeval now;
-        struct timeb timeBuffer;
-        ftime(&timeBuffer);
-        now.tv_sec = (long)(timeBuffer.time);
-        now.tv_usec = timeBuffer.millitm * 1000;
-        sec = (uint32_t)(now.tv_sec) + NTP_SEC_1900_TO_1970;
-
-        gTime = sec - NTP_SEC_1900_TO_1970;
-        t = gmtime(&gTime);
-        if (!t)
-            return OMAF_ERROR_INVALID_TIME;
-
-        char forCmp[1024];
-        memset(forCmp, 0, 1024);
-        int32_t cmpRet = memcmp(m_availableStartTime, forCmp, 1024);
-        if (0 == cmpRet)
-        {
-            snprintf(m_availableStartTime, 1024, "%d-%d-%dT%d:%d:%dZ", 1900 + t->tm_year,
-                t->tm_mon + 1, t->tm_mday, t->tm_hour, t->tm_min, t->tm_sec);
-        }
-
-        if (!m_publishTime)
-        {
-            m_publishTime = new char[1024];
-            if (!m_publishTime)
-                return OMAF_ERROR_NULL_PTR;
-        }
-        memset(m_publishTime, 0, 1024);
-        snprintf(m_publishTime, 1024, "%d-%02d-%02dT%02d:%02d:%02dZ", 1900+t->tm_year, t->tm_mon+1, t->tm_mday, t->tm_hour, t->tm_min, t->tm_sec);
-
-        mpdEle->SetAttribute(AVAILABILITYSTARTTIME, m_availableStartTime);
+        mpdEle->SetAttribute(AVAILABILITYSTARTTIME, MPD_AVAILABILITYSTARTTIME_FIELD);
         mpdEle->SetAttribute(TIMESHIFTBUFFERDEPTH, "PT5M");
 
         memset(string, 0, 1024);
         snprintf(string, 1024, "PT%dS", m_miniUpdatePeriod);
         mpdEle->SetAttribute(MINIMUMUPDATEPERIOD, string);
-        mpdEle->SetAttribute(PUBLISHTIME, m_publishTime);
+        mpdEle->SetAttribute(PUBLISHTIME, MPD_PUBLISHTIME_FIELD);
     }
     else
     {
-        uint32_t totalDur = (uint32_t)(totalFramesNum * 1000 / (double)(m_frameRate.num / m_frameRate.den) + 0.5);
-        uint32_t hour = totalDur / 3600000;
-        totalDur = totalDur % 3600000;
-        uint32_t minute = totalDur / 60000;
-        totalDur = totalDur % 60000;
-        uint32_t second = totalDur / 1000;
-        uint32_t msecond = totalDur % 1000;
-
-        if (!m_presentationDur)
-        {
-            m_presentationDur = new char[1024];
-            if (!m_presentationDur)
-                return OMAF_ERROR_NULL_PTR;
-        }
-        memset(m_presentationDur, 0, 1024);
-        snprintf(m_presentationDur, 1024, "PT%02dH%02dM%02d.%03dS",
-            hour, minute, second, msecond);
-
-        mpdEle->SetAttribute(MEDIAPRESENTATIONDURATION, m_presentationDur);
+        mpdEle->SetAttribute(MEDIAPRESENTATIONDURATION, MPD_PRESENTATIONDURATION_FIELD);
     }
 
     m_xmlDoc->InsertEndChild(mpdEle);
@@ -437,7 +405,7 @@ int32_t MpdGenerator::WriteMpd(uint64_t totalFramesNum)
     }
     else
     {
-        periodEle->SetAttribute(DURATION, m_presentationDur);
+        periodEle->SetAttribute(DURATION, MPD_PRESENTATIONDURATION_FIELD);
     }
 
     mpdEle->InsertEndChild(periodEle);
@@ -526,26 +494,196 @@ int32_t MpdGenerator::WriteMpd(uint64_t totalFramesNum)
         WriteExtractorTrackAS(periodEle, trackSegCtx);
     }
 
-    m_xmlDoc->SaveFile(m_mpdFileName);
+    XMLPrinter printer;
+    m_xmlDoc->Print(&printer);
+    m_mpdTemplate.assign(printer.CStr(), printer.CStrSize() - 1);
+
+    // the whole document is not needed any more once serialized
+    m_xmlDoc->Clear();
+
+    const char *fieldNames[MPD_DYNAMIC_FIELDS_NUM] = {
+        MPD_AVAILABILITYSTARTTIME_FIELD,
+        MPD_PUBLISHTIME_FIELD,
+        MPD_PRESENTATIONDURATION_FIELD };
+
+    // record where dynamic fields are and strip their names,
+    // fields are found in the order they appear in the template
+    m_dynamicFields.clear();
+    size_t pos = 0;
+    while ((pos = m_mpdTemplate.find('$', pos)) != std::string::npos)
+    {
+        uint8_t fieldIdx = 0;
+        for ( ; fieldIdx < MPD_DYNAMIC_FIELDS_NUM; fieldIdx++)
+        {
+            if (0 == m_mpdTemplate.compare(pos, strlen(fieldNames[fieldIdx]), fieldNames[fieldIdx]))
+                break;
+        }
+        if (fieldIdx == MPD_DYNAMIC_FIELDS_NUM)
+        {
+            pos++;
+            continue;
+        }
+
+        m_mpdTemplate.erase(pos, strlen(fieldNames[fieldIdx]));
+        m_dynamicFields.push_back(std::make_pair(pos, (MpdDynamicField)fieldIdx));
+    }
+
+    return ERROR_NONE;
+}
+
+int32_t MpdGenerator::UpdateDynamicFields(uint64_t totalFramesNum)
+{
+    if (m_segInfo->isLive)
+    {
+        uint32_t sec;
+        time_t gTime;
+        struct tm *t;
+        struct timeval now;
+        struct timeb timeBuffer;
+        ftime(&timeBuffer);
+        now.tv_sec = (long)(timeBuffer.time);
+        now.tv_usec = timeBuffer.millitm * 1000;
+        sec = (uint32_t)(now.tv_sec) + NTP_SEC_1900_TO_1970;
+
+        gTime = sec - NTP_SEC_1900_TO_1970;
+        t = gmtime(&gTime);
+        if (!t)
+            return OMAF_ERROR_INVALID_TIME;
+
+        char forCmp[1024];
+        memset(forCmp, 0, 1024);
+        int32_t cmpRet = memcmp(m_availableStartTime, forCmp, 1024);
+        if (0 == cmpRet)
+        {
+            snprintf(m_availableStartTime, 1024, "%d-%d-%dT%d:%d:%dZ", 1900 + t->tm_year,
+                t->tm_mon + 1, t->tm_mday, t->tm_hour, t->tm_min, t->tm_sec);
+        }
+
+        if (!m_publishTime)
+        {
+            m_publishTime = new char[1024];
+            if (!m_publishTime)
+                return OMAF_ERROR_NULL_PTR;
+        }
+        memset(m_publishTime, 0, 1024);
+        snprintf(m_publishTime, 1024, "%d-%02d-%02dT%02d:%02d:%02dZ", 1900+t->tm_year, t->tm_mon+1, t->tm_mday, t->tm_hour, t->tm_min, t->tm_sec);
+    }
+    else
+    {
+        uint32_t totalDur = (uint32_t)(totalFramesNum * 1000 / (double)(m_frameRate.num / m_frameRate.den) + 0.5);
+        uint32_t hour = totalDur / 3600000;
+        totalDur = totalDur % 3600000;
+        uint32_t minute = totalDur / 60000;
+        totalDur = totalDur % 60000;
+        uint32_t second = totalDur / 1000;
+        uint32_t msecond = totalDur % 1000;
+
+        if (!m_presentationDur)
+        {
+            m_presentationDur = new char[1024];
+            if (!m_presentationDur)
+                return OMAF_ERROR_NULL_PTR;
+        }
+        memset(m_presentationDur, 0, 1024);
+        snprintf(m_presentationDur, 1024, "PT%02dH%02dM%02d.%03dS",
+            hour, minute, second, msecond);
+    }
+
+    return ERROR_NONE;
+}
+
+int32_t MpdGenerator::PublishMpd(const std::string &mpd)
+{
+    if (m_segStore)
+    {
+        // the store swaps in the new file, readers keep the old one
+        return m_segStore->AppendFile(m_mpdFileName, (const uint8_t*)(mpd.data()), mpd.size(), true);
+    }
+
+    char tmpFileName[1024];
+    snprintf(tmpFileName, 1024, "%s%s", m_mpdFileName, SEGMENT_TEMP_FILE_SUFFIX);
+
+    FILE *fp = fopen(tmpFileName, "wb");
+    if (!fp)
+    {
+        LOG(ERROR) << "Failed to open mpd file " << tmpFileName << " ! " << std::endl;
+        return OMAF_ERROR_CREATE_XMLFILE_FAILED;
+    }
+
+    size_t writtenSize = fwrite(mpd.data(), 1, mpd.size(), fp);
+    int32_t closeRet = fclose(fp);
+    if (writtenSize != mpd.size() || closeRet)
+    {
+        LOG(ERROR) << "Failed to write mpd file " << tmpFileName << " ! " << std::endl;
+        remove(tmpFileName);
+        return OMAF_ERROR_CREATE_XMLFILE_FAILED;
+    }
+
+    // clients always see either the previous or the new mpd
+    if (rename(tmpFileName, m_mpdFileName))
+    {
+        LOG(ERROR) << "Failed to rename mpd file " << tmpFileName << " ! " << std::endl;
+        remove(tmpFileName);
+        return OMAF_ERROR_CREATE_XMLFILE_FAILED;
+    }
 
     return ERROR_NONE;
 }
 
+int32_t MpdGenerator::WriteMpd(uint64_t totalFramesNum)
+{
+    int32_t ret = ERROR_NONE;
+    if (m_mpdTemplate.empty())
+    {
+        ret = BuildMpdTemplate();
+        if (ret)
+            return ret;
+    }
+
+    ret = UpdateDynamicFields(totalFramesNum);
+    if (ret)
+        return ret;
+
+    const char *fieldValues[MPD_DYNAMIC_FIELDS_NUM] = {
+        m_availableStartTime,
+        m_publishTime,
+        m_presentationDur };
+
+    std::string mpd;
+    mpd.reserve(m_mpdTemplate.size() + 128);
+    size_t copiedPos = 0;
+    std::vector<std::pair<size_t, MpdDynamicField>>::iterator it;
+    for (it = m_dynamicFields.begin(); it != m_dynamicFields.end(); it++)
+    {
+        const char *value = fieldValues[it->second];
+        if (!value)
+            return OMAF_ERROR_NULL_PTR;
+
+        mpd.append(m_mpdTemplate, copiedPos, it->first - copiedPos);
+        mpd.append(value);
+        copiedPos = it->first;
+    }
+    mpd.append(m_mpdTemplate, copiedPos, std::string::npos);
+
+    // nothing changed since last time, e.g. within the same second
+    if (mpd == m_publishedMpd)
+        return ERROR_NONE;
+
+    ret = PublishMpd(mpd);
+    if (ret)
+        return ret;
+
+    m_publishedMpd.swap(mpd);
+    return ERROR_NONE;
+}
+
 int32_t MpdGenerator::UpdateMpd(uint64_t segNumber, uint64_t framesNumber)
 {
+    // only dynamic fields are patched into the cached template
     if (m_segInfo->windowSize)
     {
         if (segNumber % m_segInfo->windowSize == 1)
         {
-            if (0 == access(m_mpdFileName, R_OK | W_OK))
-            {
-                remove(m_mpdFileName);
-                DELETE_MEMORY(m_xmlDoc);
-
-                m_xmlDoc = new XMLDocument;
-                if (!m_xmlDoc)
-                    return OMAF_ERROR_CREATE_XMLFILE_FAILED;
-            }
             int32_t ret = WriteMpd(framesNumber);
             return ret;
         }
@@ -554,15 +692,6 @@ int32_t MpdGenerator::UpdateMpd(uint64_t segNumber, uint64_t framesNumber)
     {
         if (framesNumber % (m_segInfo->segDuration * (uint16_t)((double)(m_frameRate.num / m_frameRate.den) + 0.5)) == 0)
         {
-            if (0 == access(m_mpdFileName, R_OK | W_OK))
-            {
-                remove(m_mpdFileName);
-                DELETE_MEMORY(m_xmlDoc);
-
-                m_xmlDoc = new XMLDocument;
-                if (!m_xmlDoc)
-                    return OMAF_ERROR_CREATE_XMLFILE_FAILED;
-            }
             int32_t ret = WriteMpd(framesNumber);
             return ret;
         }
@@ -41,6 +41,7 @@
 #include "MediaStream.h"
 #include "ExtractorTrackManager.h"
 #include "DashSegmenter.h"
+#include "SegmentStore.h"
 #include "../utils/OmafStructure.h"
 #include "../utils/tinyxml2.h"
 
@@ -48,6 +49,23 @@ VCD_NS_BEGIN
 
 using namespace tinyxml2;
 
+#define MPD_AVAILABILITYSTARTTIME_FIELD "$AvailabilityStartTime$"
+#define MPD_PUBLISHTIME_FIELD           "$PublishTime$"
+#define MPD_PRESENTATIONDURATION_FIELD  "$PresentationDuration$"
+
+//!
+//! \enum:   MpdDynamicField
+//! \brief:  fields of mpd file which are patched into the
+//!          cached mpd template each time mpd is written
+//!
+enum MpdDynamicField
+{
+    MPD_AVAILABILITYSTARTTIME = 0,
+    MPD_PUBLISHTIME,
+    MPD_PRESENTATIONDURATION,
+    MPD_DYNAMIC_FIELDS_NUM
+};
+
 //!
 //! \class MpdGenerator
 //! \brief Define the operation and needed data for mpd generator
@@ -76,13 +94,17 @@ public:
     //!         projection type
     //! \param  [in] frameRate
     //!         video stream frame rate
+    //! \param  [in] segStore
+    //!         if not NULL, mpd file is put into the in-memory
+    //!         segment store instead of being written to disk
     //!
     MpdGenerator(
         std::map<MediaStream*, TrackSegmentCtx*> *streamsSegCtxs,
         std::map<ExtractorTrack*, TrackSegmentCtx*> *extractorSegCtxs,
         SegmentationInfo *segInfo,
         VCD::OMAF::ProjectionFormat projType,
-        Rational frameRate);
+        Rational frameRate,
+        SegmentStore *segStore = NULL);
 
 
     //!
@@ -102,7 +124,9 @@ public:
     int32_t Initialize();
 
     //!
-    //! \brief  Write the mpd file according to segmentation information
+    //! \brief  Write the mpd file according to segmentation information,
+    //!         the mpd template is built for the first time and then
+    //!         only its dynamic fields are updated
     //!
     //! \param  [in] totalFramesNum
     //!         total number of frames written into segments
@@ -155,6 +179,52 @@ private:
     //!
     int32_t WriteExtractorTrackAS(XMLElement *periodEle, TrackSegmentCtx *pTrackSegCtx);
 
+    //!
+    //! \brief  Advertise in SegmentTemplate that segments are
+    //!         available chunk by chunk before they are complete,
+    //!         when live segments are published in chunks
+    //!
+    //! \param  [in] sgtTpeEle
+    //!         pointer to SegmentTemplate element of the track
+    //!
+    //! \return void
+    //!
+    void WriteChunkAvailability(XMLElement *sgtTpeEle);
+
+    //!
+    //! \brief  Build the whole mpd document once and serialize
+    //!         it into the mpd template, dynamic fields are left
+    //!         out and their positions are recorded
+    //!
+    //! \return int32_t
+    //!         ERROR_NONE if success, else failed reason
+    //!
+    int32_t BuildMpdTemplate();
+
+    //!
+    //! \brief  Update values of dynamic fields of mpd file
+    //!
+    //! \param  [in] totalFramesNum
+    //!         total number of frames written into segments
+    //!
+    //! \return int32_t
+    //!         ERROR_NONE if success, else failed reason
+    //!
+    int32_t UpdateDynamicFields(uint64_t totalFramesNum);
+
+    //!
+    //! \brief  Publish the mpd, it is written into a temporary
+    //!         file and renamed to mpd file, so that clients never
+    //!         get a missing or partially written mpd
+    //!
+    //! \param  [in] mpd
+    //!         the serialized mpd
+    //!
+    //! \return int32_t
+    //!         ERROR_NONE if success, else failed reason
+    //!
+    int32_t PublishMpd(const std::string &mpd);
+
 private:
     std::map<MediaStream*, TrackSegmentCtx*>    *m_streamSegCtx;    //!< map of media stream and its track segmentation context
     std::map<ExtractorTrack*, TrackSegmentCtx*> *m_extractorSegCtx; //!< map of extractor track and its track segmentation context
@@ -173,6 +243,10 @@ private:
     Rational                                    m_frameRate;           //!< video stream frame rate
     uint16_t                                    m_timeScale;           //!< timescale of video stream
     XMLDocument                                 *m_xmlDoc;             //!< XML doc element for writting mpd file created using tinyxml2
+    SegmentStore                                *m_segStore;           //!< in-memory segment store, NULL if mpd file is written to disk
+    std::string                                 m_mpdTemplate;         //!< serialized mpd without dynamic fields
+    std::vector<std::pair<size_t, MpdDynamicField>> m_dynamicFields;   //!< positions in mpd template and the dynamic fields inserted there
+    std::string                                 m_publishedMpd;        //!< the mpd published last time
 };
 
 VCD_NS_END;
@@ -154,16 +154,22 @@ int32_t OmafPackage::InitOmafPackage(InitialInfo *initInfo)
     return ERROR_NONE;
 }
 
-int32_t OmafPackage::SetFrameInfo(uint8_t streamIdx, FrameBSInfo *frameInfo)
+int32_t OmafPackage::SetFrameInfo(
+    uint8_t streamIdx,
+    FrameBSInfo *frameInfo,
+    FrameDataReleaseFunc releaseFunc,
+    void *opaque)
 {
     MediaStream *stream = m_streams[streamIdx];
-    if (!stream)
-        return OMAF_ERROR_NULL_PTR;
+    if (!stream || (stream->GetMediaType() != VIDEOTYPE))
+    {
+        if (releaseFunc && frameInfo)
+            releaseFunc(frameInfo->data, opaque);
 
-    if (stream->GetMediaType() != VIDEOTYPE)
-        return OMAF_ERROR_MEDIA_TYPE;
+        return stream ? OMAF_ERROR_MEDIA_TYPE : OMAF_ERROR_NULL_PTR;
+    }
 
-    int32_t ret = ((VideoStream*)stream)->AddFrameInfo(frameInfo);
+    int32_t ret = ((VideoStream*)stream)->AddFrameInfo(frameInfo, releaseFunc, opaque);
     if (ret)
         return OMAF_ERROR_ADD_FRAMEINFO;
 
@@ -186,7 +192,16 @@ void OmafPackage::SegmentAllStreams()
 
 int32_t OmafPackage::OmafPacketStream(uint8_t streamIdx, FrameBSInfo *frameInfo)
 {
-    int32_t ret = SetFrameInfo(streamIdx, frameInfo);
+    return OmafPacketStream(streamIdx, frameInfo, NULL, NULL);
+}
+
+int32_t OmafPackage::OmafPacketStream(
+    uint8_t streamIdx,
+    FrameBSInfo *frameInfo,
+    FrameDataReleaseFunc releaseFunc,
+    void *opaque)
+{
+    int32_t ret = SetFrameInfo(streamIdx, frameInfo, releaseFunc, opaque);
     if (ret)
         return ret;
     //printf("m_initInfo->segmentationInfo->needBufedFrames %d \n", m_initInfo->segmentationInfo->needBufedFrames);
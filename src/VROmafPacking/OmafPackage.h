@@ -87,6 +87,30 @@ public:
     //!
     int32_t OmafPacketStream(uint8_t streamIdx, FrameBSInfo *frameInfo);
 
+    //!
+    //! \brief  Packet the specified media stream without copying
+    //!         the frame bitstream data
+    //!
+    //! \param  [in] streamIdx
+    //!         the index of specified stream in whole streams
+    //! \param  [in] frameInfo
+    //!         frame information for a new frame of specified stream
+    //! \param  [in] releaseFunc
+    //!         function to release the frame bitstream data after
+    //!         the frame is written into segments, NULL to copy
+    //!         the data
+    //! \param  [in] opaque
+    //!         user data passed to releaseFunc
+    //!
+    //! \return int32_t
+    //!         ERROR_NONE if success, else failed reason
+    //!
+    int32_t OmafPacketStream(
+        uint8_t streamIdx,
+        FrameBSInfo *frameInfo,
+        FrameDataReleaseFunc releaseFunc,
+        void *opaque);
+
     //!
     //! \brief  End the packeting of all streams
     //!
@@ -145,11 +169,20 @@ private:
     //!         the index of the stream to be handled
     //! \param  [in] frameInfo
     //!         frame information of new frame of the stream
+    //! \param  [in] releaseFunc
+    //!         function to release the frame bitstream data,
+    //!         NULL to copy the data
+    //! \param  [in] opaque
+    //!         user data passed to releaseFunc
     //!
     //! \return int32_t
     //!         ERROR_NONE if success, else failed reason
     //!
-    int32_t SetFrameInfo(uint8_t streamIdx, FrameBSInfo *frameInfo);
+    int32_t SetFrameInfo(
+        uint8_t streamIdx,
+        FrameBSInfo *frameInfo,
+        FrameDataReleaseFunc releaseFunc,
+        void *opaque);
 
     //!
     //! \brief  Segment all media streams
@@ -0,0 +1,252 @@
+/*
+ * Copyright (c) 2019, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+//!
+//! \file:   SegmentStore.cpp
+//! \brief:  In-memory segment store class implementation
+//!
+
+#include "SegmentStore.h"
+
+VCD_NS_BEGIN
+
+static std::string GetBaseName(const char *fileName)
+{
+    const char *baseName = strrchr(fileName, '/');
+    return std::string(baseName ? (baseName + 1) : fileName);
+}
+
+//!
+//! \brief  Get the track name of numbered segment, which is
+//!         named as "<track name>.<segment number>.<extension>"
+//!
+//! \return bool
+//!         true if the file is a numbered segment, else false
+//!
+static bool GetTrackName(const std::string &fileName, std::string &trackName)
+{
+    size_t extPos = fileName.rfind('.');
+    if (extPos == std::string::npos || !extPos)
+        return false;
+
+    size_t numPos = fileName.rfind('.', extPos - 1);
+    if (numPos == std::string::npos || (numPos + 1) == extPos)
+        return false;
+
+    for (size_t i = numPos + 1; i < extPos; i++)
+    {
+        if (fileName[i] < '0' || fileName[i] > '9')
+            return false;
+    }
+
+    trackName = fileName.substr(0, numPos);
+    return true;
+}
+
+SegmentStore::SegmentStore(uint32_t windowSize)
+{
+    m_windowSize = windowSize;
+    m_isStopped = false;
+    pthread_mutex_init(&m_mutex, NULL);
+    pthread_cond_init(&m_dataCond, NULL);
+}
+
+SegmentStore::~SegmentStore()
+{
+    m_files.clear();
+    m_trackSegments.clear();
+    pthread_cond_destroy(&m_dataCond);
+    pthread_mutex_destroy(&m_mutex);
+}
+
+StoredFile* SegmentStore::GetFileForWriting(const char *fileName)
+{
+    std::string baseName = GetBaseName(fileName);
+
+    std::map<std::string, std::shared_ptr<StoredFile>>::iterator it = m_files.find(baseName);
+    if (it != m_files.end() && !(it->second->isComplete))
+        return it->second.get();
+
+    std::shared_ptr<StoredFile> file(new StoredFile);
+    file->isComplete = false;
+
+    bool isReplaced = (it != m_files.end());
+    m_files[baseName] = file;
+
+    std::string trackName;
+    if (!isReplaced && m_windowSize && GetTrackName(baseName, trackName))
+    {
+        std::list<std::string> &segNames = m_trackSegments[trackName];
+        segNames.push_back(baseName);
+        while (segNames.size() > m_windowSize)
+        {
+            m_files.erase(segNames.front());
+            segNames.pop_front();
+        }
+    }
+
+    return file.get();
+}
+
+int32_t SegmentStore::AppendFile(const char *fileName, const uint8_t *data, uint64_t dataSize, bool isLast)
+{
+    if (!fileName || (!data && dataSize))
+        return OMAF_ERROR_NULL_PTR;
+
+    pthread_mutex_lock(&m_mutex);
+    StoredFile *file = GetFileForWriting(fileName);
+    if (dataSize)
+    {
+        file->data.insert(file->data.end(), data, data + dataSize);
+    }
+    file->isComplete = isLast;
+    pthread_cond_broadcast(&m_dataCond);
+    pthread_mutex_unlock(&m_mutex);
+
+    return ERROR_NONE;
+}
+
+//!
+//! \brief  Append the data serialized in the segment buffer
+//!         to the file data
+//!
+//! \return uint64_t
+//!         size of data which is missing in the chunks
+//!
+static uint64_t AppendSegmentData(StoredFile *file, SegmentBuffer *segBuffer)
+{
+    file->data.reserve(file->data.size() + segBuffer->dataSize);
+
+    uint64_t leftSize = segBuffer->dataSize;
+    std::vector<uint8_t*>::iterator it;
+    for (it = segBuffer->chunks.begin(); it != segBuffer->chunks.end() && leftSize; it++)
+    {
+        uint64_t copySize = (leftSize < SEGMENT_BUFFER_CHUNK_SIZE) ? leftSize : SEGMENT_BUFFER_CHUNK_SIZE;
+        file->data.insert(file->data.end(), *it, *it + copySize);
+        leftSize -= copySize;
+    }
+
+    return leftSize;
+}
+
+int32_t SegmentStore::PutSegment(const char *fileName, SegmentBuffer *segBuffer)
+{
+    if (!fileName || !segBuffer)
+        return OMAF_ERROR_NULL_PTR;
+
+    pthread_mutex_lock(&m_mutex);
+    StoredFile *file = GetFileForWriting(fileName);
+    file->data.clear();
+    uint64_t leftSize = AppendSegmentData(file, segBuffer);
+    file->isComplete = true;
+    pthread_cond_broadcast(&m_dataCond);
+    pthread_mutex_unlock(&m_mutex);
+
+    return leftSize ? OMAF_ERROR_DATA_SIZE : ERROR_NONE;
+}
+
+int32_t SegmentStore::AppendSegment(const char *fileName, SegmentBuffer *segBuffer, bool isLast)
+{
+    if (!fileName || !segBuffer)
+        return OMAF_ERROR_NULL_PTR;
+
+    pthread_mutex_lock(&m_mutex);
+    StoredFile *file = GetFileForWriting(fileName);
+    uint64_t leftSize = AppendSegmentData(file, segBuffer);
+    file->isComplete = isLast;
+    pthread_cond_broadcast(&m_dataCond);
+    pthread_mutex_unlock(&m_mutex);
+
+    return leftSize ? OMAF_ERROR_DATA_SIZE : ERROR_NONE;
+}
+
+std::shared_ptr<StoredFile> SegmentStore::GetFile(const char *fileName)
+{
+    std::shared_ptr<StoredFile> file;
+    if (!fileName)
+        return file;
+
+    pthread_mutex_lock(&m_mutex);
+    std::map<std::string, std::shared_ptr<StoredFile>>::iterator it = m_files.find(GetBaseName(fileName));
+    if (it != m_files.end())
+        file = it->second;
+    pthread_mutex_unlock(&m_mutex);
+
+    return file;
+}
+
+int32_t SegmentStore::GetFileStatus(std::shared_ptr<StoredFile> file, uint64_t *fileSize, bool *isComplete)
+{
+    if (!file || !fileSize || !isComplete)
+        return OMAF_ERROR_NULL_PTR;
+
+    pthread_mutex_lock(&m_mutex);
+    *fileSize = file->data.size();
+    *isComplete = file->isComplete;
+    pthread_mutex_unlock(&m_mutex);
+
+    return ERROR_NONE;
+}
+
+int32_t SegmentStore::ReadFile(
+    std::shared_ptr<StoredFile> file,
+    uint64_t offset,
+    uint8_t *buf,
+    uint64_t bufSize,
+    uint64_t *readSize)
+{
+    if (!file || !buf || !readSize)
+        return OMAF_ERROR_NULL_PTR;
+
+    *readSize = 0;
+
+    pthread_mutex_lock(&m_mutex);
+    while (offset >= file->data.size() && !(file->isComplete) && !m_isStopped)
+    {
+        pthread_cond_wait(&m_dataCond, &m_mutex);
+    }
+
+    if (offset < file->data.size())
+    {
+        uint64_t leftSize = file->data.size() - offset;
+        *readSize = (leftSize < bufSize) ? leftSize : bufSize;
+        memcpy(buf, file->data.data() + offset, *readSize);
+    }
+    bool isBroken = !(*readSize) && !(file->isComplete);
+    pthread_mutex_unlock(&m_mutex);
+
+    return isBroken ? OMAF_ERROR_END_OF_STREAM : ERROR_NONE;
+}
+
+void SegmentStore::Stop()
+{
+    pthread_mutex_lock(&m_mutex);
+    m_isStopped = true;
+    pthread_cond_broadcast(&m_dataCond);
+    pthread_mutex_unlock(&m_mutex);
+}
+
+VCD_NS_END
@@ -0,0 +1,210 @@
+/*
+ * Copyright (c) 2019, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+//!
+//! \file:   SegmentStore.h
+//! \brief:  In-memory segment store class definition
+//! \detail: Keep live segments, initial segments and mpd file in
+//!          memory instead of disk. Numbered segments of each track
+//!          are kept in a sliding window, other files are kept until
+//!          they are replaced. Files can be read while they are
+//!          still being written.
+//!
+
+#ifndef _SEGMENTSTORE_H_
+#define _SEGMENTSTORE_H_
+
+#include "OmafPackingCommon.h"
+#include "SegmentWriter.h"
+
+#include <list>
+#include <map>
+#include <memory>
+#include <string>
+
+VCD_NS_BEGIN
+
+//!
+//! \struct: StoredFile
+//! \brief:  one file kept in the segment store
+//!
+struct StoredFile
+{
+    std::vector<uint8_t> data;        //!< file data written so far
+    bool                 isComplete;  //!< whether all data of the file has been written
+};
+
+//!
+//! \class SegmentStore
+//! \brief Define the in-memory segment store shared by the
+//!        segment writer and the http server
+//!
+
+class SegmentStore
+{
+public:
+    //!
+    //! \brief  Constructor
+    //!
+    //! \param  [in] windowSize
+    //!         number of numbered segments kept for each
+    //!         track, 0 means all segments are kept
+    //!
+    SegmentStore(uint32_t windowSize);
+
+    //!
+    //! \brief  Destructor
+    //!
+    ~SegmentStore();
+
+    //!
+    //! \brief  Append data to the file, a new file is created
+    //!         if the file doesn't exist or has been completed
+    //!
+    //! \param  [in] fileName
+    //!         file name, directory part is ignored
+    //! \param  [in] data
+    //!         pointer to the data
+    //! \param  [in] dataSize
+    //!         size of the data
+    //! \param  [in] isLast
+    //!         whether the data is the last part of the file
+    //!
+    //! \return int32_t
+    //!         ERROR_NONE if success, else failed reason
+    //!
+    int32_t AppendFile(const char *fileName, const uint8_t *data, uint64_t dataSize, bool isLast);
+
+    //!
+    //! \brief  Store the whole segment serialized in the
+    //!         segment buffer as a completed file
+    //!
+    //! \param  [in] fileName
+    //!         file name, directory part is ignored
+    //! \param  [in] segBuffer
+    //!         pointer to the segment buffer
+    //!
+    //! \return int32_t
+    //!         ERROR_NONE if success, else failed reason
+    //!
+    int32_t PutSegment(const char *fileName, SegmentBuffer *segBuffer);
+
+    //!
+    //! \brief  Append the chunk serialized in the segment
+    //!         buffer to the segment being written, a new
+    //!         segment is created if it doesn't exist or has
+    //!         been completed
+    //!
+    //! \param  [in] fileName
+    //!         file name, directory part is ignored
+    //! \param  [in] segBuffer
+    //!         pointer to the segment buffer
+    //! \param  [in] isLast
+    //!         whether the chunk is the last one of the segment
+    //!
+    //! \return int32_t
+    //!         ERROR_NONE if success, else failed reason
+    //!
+    int32_t AppendSegment(const char *fileName, SegmentBuffer *segBuffer, bool isLast);
+
+    //!
+    //! \brief  Get the file with the name
+    //!
+    //! \param  [in] fileName
+    //!         file name, directory part is ignored
+    //!
+    //! \return std::shared_ptr<StoredFile>
+    //!         the file which stays valid even if it is
+    //!         removed from the store, empty if not found
+    //!
+    std::shared_ptr<StoredFile> GetFile(const char *fileName);
+
+    //!
+    //! \brief  Get the current size and status of the file
+    //!
+    //! \param  [in] file
+    //!         the file got by GetFile
+    //! \param  [out] fileSize
+    //!         size of data written so far
+    //! \param  [out] isComplete
+    //!         whether all data of the file has been written
+    //!
+    //! \return int32_t
+    //!         ERROR_NONE if success, else failed reason
+    //!
+    int32_t GetFileStatus(std::shared_ptr<StoredFile> file, uint64_t *fileSize, bool *isComplete);
+
+    //!
+    //! \brief  Read data of the file from the offset, wait
+    //!         for more data if the file is still being written
+    //!
+    //! \param  [in] file
+    //!         the file got by GetFile
+    //! \param  [in] offset
+    //!         offset in the file to read from
+    //! \param  [out] buf
+    //!         buffer for read data
+    //! \param  [in] bufSize
+    //!         size of the buffer
+    //! \param  [out] readSize
+    //!         size of read data, 0 if all data has been read
+    //!
+    //! \return int32_t
+    //!         ERROR_NONE if success, else failed reason
+    //!
+    int32_t ReadFile(
+        std::shared_ptr<StoredFile> file,
+        uint64_t offset,
+        uint8_t *buf,
+        uint64_t bufSize,
+        uint64_t *readSize);
+
+    //!
+    //! \brief  Wake up all readers waiting for data, and
+    //!         make further reading of incomplete files fail
+    //!
+    //! \return void
+    //!
+    void Stop();
+
+private:
+    //!
+    //! \brief  Get the file to append data to, create it
+    //!         and slide the window of its track if needed,
+    //!         must be called with the mutex locked
+    //!
+    StoredFile* GetFileForWriting(const char *fileName);
+
+    uint32_t                                             m_windowSize;     //!< number of segments kept for each track
+    bool                                                 m_isStopped;      //!< whether the store is stopped
+    pthread_mutex_t                                      m_mutex;          //!< thread mutex for the files
+    pthread_cond_t                                       m_dataCond;       //!< signalled when data is appended to any file
+    std::map<std::string, std::shared_ptr<StoredFile>>   m_files;          //!< map of file name and the file
+    std::map<std::string, std::list<std::string>>        m_trackSegments;  //!< map of track name and its kept segments names
+};
+
+VCD_NS_END;
+#endif /* _SEGMENTSTORE_H_ */
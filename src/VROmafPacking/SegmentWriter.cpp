@@ -0,0 +1,513 @@
+/*
+ * Copyright (c) 2019, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+//!
+//! \file:   SegmentWriter.cpp
+//! \brief:  Segment writer class implementation
+//!
+
+#include "SegmentWriter.h"
+#include "SegmentStore.h"
+
+#include <algorithm>
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+VCD_NS_BEGIN
+
+SegmentStreamBuf::SegmentStreamBuf(SegmentBuffer *segBuffer)
+{
+    m_segBuffer = segBuffer;
+    m_currChunk = 0;
+    m_isFailed = false;
+
+    m_segBuffer->dataSize = 0;
+    if (m_segBuffer->chunks.empty())
+    {
+        uint8_t *chunk = new uint8_t[SEGMENT_BUFFER_CHUNK_SIZE];
+        if (!chunk)
+        {
+            m_isFailed = true;
+            return;
+        }
+        m_segBuffer->chunks.push_back(chunk);
+    }
+
+    char *chunkData = (char*)(m_segBuffer->chunks[0]);
+    setp(chunkData, chunkData + SEGMENT_BUFFER_CHUNK_SIZE);
+}
+
+SegmentStreamBuf::~SegmentStreamBuf()
+{
+    m_segBuffer = NULL;
+}
+
+bool SegmentStreamBuf::NextChunk()
+{
+    if (m_isFailed)
+        return false;
+
+    m_currChunk++;
+    if (m_currChunk >= m_segBuffer->chunks.size())
+    {
+        uint8_t *chunk = new uint8_t[SEGMENT_BUFFER_CHUNK_SIZE];
+        if (!chunk)
+        {
+            m_isFailed = true;
+            return false;
+        }
+        m_segBuffer->chunks.push_back(chunk);
+    }
+
+    char *chunkData = (char*)(m_segBuffer->chunks[m_currChunk]);
+    setp(chunkData, chunkData + SEGMENT_BUFFER_CHUNK_SIZE);
+    return true;
+}
+
+SegmentStreamBuf::int_type SegmentStreamBuf::overflow(int_type ch)
+{
+    if (traits_type::eq_int_type(ch, traits_type::eof()))
+        return traits_type::not_eof(ch);
+
+    if (!NextChunk())
+        return traits_type::eof();
+
+    *pptr() = traits_type::to_char_type(ch);
+    pbump(1);
+    return ch;
+}
+
+std::streamsize SegmentStreamBuf::xsputn(const char *s, std::streamsize n)
+{
+    std::streamsize written = 0;
+    while (written < n)
+    {
+        std::streamsize avail = epptr() - pptr();
+        if (!avail)
+        {
+            if (!NextChunk())
+                break;
+            continue;
+        }
+
+        std::streamsize copySize = std::min(avail, n - written);
+        memcpy(pptr(), s + written, copySize);
+        pbump((int)copySize);
+        written += copySize;
+    }
+
+    return written;
+}
+
+int32_t SegmentStreamBuf::Finish()
+{
+    if (m_isFailed)
+        return OMAF_ERROR_NULL_PTR;
+
+    m_segBuffer->dataSize = (uint64_t)m_currChunk * SEGMENT_BUFFER_CHUNK_SIZE + (pptr() - pbase());
+    return ERROR_NONE;
+}
+
+SegmentWriter::SegmentWriter(bool needSync, SegmentStore *segStore)
+{
+    m_needSync = needSync;
+    m_segStore = segStore;
+    m_threadId = 0;
+    m_isRunning = false;
+    m_isStopped = false;
+    m_pendingHead = NULL;
+    m_pendingTail = NULL;
+    m_pendingNum = 0;
+    m_freeBuffers = NULL;
+    m_writeRet = ERROR_NONE;
+    pthread_mutex_init(&m_mutex, NULL);
+    pthread_cond_init(&m_queuedCond, NULL);
+    pthread_cond_init(&m_writtenCond, NULL);
+}
+
+SegmentWriter::~SegmentWriter()
+{
+    Stop();
+
+    while (m_freeBuffers)
+    {
+        SegmentBuffer *segBuffer = m_freeBuffers;
+        m_freeBuffers = segBuffer->next;
+        DestroyBuffer(segBuffer);
+    }
+
+    pthread_cond_destroy(&m_queuedCond);
+    pthread_cond_destroy(&m_writtenCond);
+    pthread_mutex_destroy(&m_mutex);
+}
+
+int32_t SegmentWriter::Initialize()
+{
+    if (m_isRunning)
+        return ERROR_NONE;
+
+    int32_t ret = pthread_create(&m_threadId, NULL, WriterThread, this);
+    if (ret)
+    {
+        LOG(ERROR) << "Failed to create segment writer thread !" << std::endl;
+        return OMAF_ERROR_CREATE_THREAD;
+    }
+    m_isRunning = true;
+
+    return ERROR_NONE;
+}
+
+void SegmentWriter::Stop()
+{
+    if (!m_isRunning)
+        return;
+
+    pthread_mutex_lock(&m_mutex);
+    m_isStopped = true;
+    pthread_cond_signal(&m_queuedCond);
+    pthread_mutex_unlock(&m_mutex);
+
+    pthread_join(m_threadId, NULL);
+    m_isRunning = false;
+}
+
+void SegmentWriter::DestroyBuffer(SegmentBuffer *segBuffer)
+{
+    if (!segBuffer)
+        return;
+
+    std::vector<uint8_t*>::iterator it;
+    for (it = segBuffer->chunks.begin(); it != segBuffer->chunks.end(); it++)
+    {
+        delete[] (*it);
+    }
+    segBuffer->chunks.clear();
+
+    delete segBuffer;
+    segBuffer = NULL;
+}
+
+SegmentBuffer* SegmentWriter::GetBuffer()
+{
+    pthread_mutex_lock(&m_mutex);
+    SegmentBuffer *segBuffer = m_freeBuffers;
+    if (segBuffer)
+        m_freeBuffers = segBuffer->next;
+    pthread_mutex_unlock(&m_mutex);
+
+    if (!segBuffer)
+    {
+        segBuffer = new SegmentBuffer;
+        if (!segBuffer)
+            return NULL;
+    }
+    segBuffer->dataSize = 0;
+    segBuffer->fileName[0] = '\0';
+    segBuffer->isRemoval = false;
+    segBuffer->next = NULL;
+
+    return segBuffer;
+}
+
+int32_t SegmentWriter::WriteSegment(SegmentBuffer *segBuffer, const char *fileName)
+{
+    if (!segBuffer || !fileName)
+        return OMAF_ERROR_NULL_PTR;
+
+    snprintf(segBuffer->fileName, 1024, "%s", fileName);
+    segBuffer->next = NULL;
+
+    // putting segment into memory is cheap enough to be done
+    // by the calling thread
+    if (m_segStore || !m_isRunning)
+    {
+        int32_t ret = ERROR_NONE;
+        if (m_segStore)
+            ret = m_segStore->PutSegment(segBuffer->fileName, segBuffer);
+        else
+            ret = WriteFile(segBuffer, segBuffer->fileName, m_needSync);
+
+        pthread_mutex_lock(&m_mutex);
+        segBuffer->next = m_freeBuffers;
+        m_freeBuffers = segBuffer;
+        pthread_mutex_unlock(&m_mutex);
+
+        return ret;
+    }
+
+    return QueueBuffer(segBuffer);
+}
+
+int32_t SegmentWriter::RemoveSegment(const char *fileName)
+{
+    if (!fileName)
+        return OMAF_ERROR_NULL_PTR;
+
+    // nothing is pending when segments are written by the
+    // calling thread
+    if (m_segStore || !m_isRunning)
+    {
+        remove(fileName);
+        return ERROR_NONE;
+    }
+
+    SegmentBuffer *segBuffer = GetBuffer();
+    if (!segBuffer)
+        return OMAF_ERROR_NULL_PTR;
+
+    snprintf(segBuffer->fileName, 1024, "%s", fileName);
+    segBuffer->isRemoval = true;
+
+    return QueueBuffer(segBuffer);
+}
+
+int32_t SegmentWriter::QueueBuffer(SegmentBuffer *segBuffer)
+{
+    pthread_mutex_lock(&m_mutex);
+    while (m_pendingNum >= SEGMENT_WRITER_MAX_PENDING_NUM)
+    {
+        pthread_cond_wait(&m_writtenCond, &m_mutex);
+    }
+
+    // report failure of segments written before, since live
+    // streams never reach Flush at EOS
+    if (m_writeRet)
+    {
+        int32_t ret = m_writeRet;
+        segBuffer->next = m_freeBuffers;
+        m_freeBuffers = segBuffer;
+        pthread_mutex_unlock(&m_mutex);
+        return ret;
+    }
+
+    if (m_pendingTail)
+        m_pendingTail->next = segBuffer;
+    else
+        m_pendingHead = segBuffer;
+    m_pendingTail = segBuffer;
+    m_pendingNum++;
+
+    pthread_cond_signal(&m_queuedCond);
+    pthread_mutex_unlock(&m_mutex);
+
+    return ERROR_NONE;
+}
+
+int32_t SegmentWriter::WriteChunk(SegmentBuffer *segBuffer, const char *fileName, bool isLast)
+{
+    if (!fileName)
+        return OMAF_ERROR_NULL_PTR;
+
+    // chunks are only published progressively from memory,
+    // files on disk are renamed into place as a whole
+    if (!m_segStore)
+    {
+        DestroyBuffer(segBuffer);
+        return OMAF_ERROR_UNDEFINED_OPERATION;
+    }
+
+    pthread_mutex_lock(&m_mutex);
+    int32_t writeRet = m_writeRet;
+    pthread_mutex_unlock(&m_mutex);
+    if (writeRet)
+    {
+        DestroyBuffer(segBuffer);
+        return writeRet;
+    }
+
+    if (!segBuffer)
+    {
+        if (!isLast)
+            return OMAF_ERROR_NULL_PTR;
+
+        return m_segStore->AppendFile(fileName, NULL, 0, true);
+    }
+
+    int32_t ret = m_segStore->AppendSegment(fileName, segBuffer, isLast);
+
+    pthread_mutex_lock(&m_mutex);
+    segBuffer->next = m_freeBuffers;
+    m_freeBuffers = segBuffer;
+    pthread_mutex_unlock(&m_mutex);
+
+    return ret;
+}
+
+int32_t SegmentWriter::Flush()
+{
+    pthread_mutex_lock(&m_mutex);
+    while (m_pendingNum)
+    {
+        pthread_cond_wait(&m_writtenCond, &m_mutex);
+    }
+    int32_t ret = m_writeRet;
+    pthread_mutex_unlock(&m_mutex);
+
+    return ret;
+}
+
+void *SegmentWriter::WriterThread(void *pThis)
+{
+    SegmentWriter *segWriter = (SegmentWriter*)pThis;
+
+    segWriter->WriteQueuedSegments();
+
+    return NULL;
+}
+
+void SegmentWriter::WriteQueuedSegments()
+{
+    pthread_mutex_lock(&m_mutex);
+    while (true)
+    {
+        while (!m_pendingHead && !m_isStopped)
+        {
+            pthread_cond_wait(&m_queuedCond, &m_mutex);
+        }
+
+        if (!m_pendingHead)
+            break;
+
+        // take all pending segments at once, and write them
+        // without holding the lock
+        SegmentBuffer *segBuffers = m_pendingHead;
+        m_pendingHead = NULL;
+        m_pendingTail = NULL;
+        pthread_mutex_unlock(&m_mutex);
+
+        int32_t writeRet = ERROR_NONE;
+        uint32_t writtenNum = 0;
+        SegmentBuffer *lastBuffer = NULL;
+        for (SegmentBuffer *segBuffer = segBuffers; segBuffer; segBuffer = segBuffer->next)
+        {
+            // segments may not exist for all tracks when being
+            // removed, so that failure is not reported
+            int32_t ret = ERROR_NONE;
+            if (segBuffer->isRemoval)
+                remove(segBuffer->fileName);
+            else
+                ret = WriteFile(segBuffer, segBuffer->fileName, m_needSync);
+            if (ret && !writeRet)
+                writeRet = ret;
+
+            writtenNum++;
+            lastBuffer = segBuffer;
+        }
+
+        pthread_mutex_lock(&m_mutex);
+        lastBuffer->next = m_freeBuffers;
+        m_freeBuffers = segBuffers;
+        m_pendingNum -= writtenNum;
+        if (writeRet && !m_writeRet)
+            m_writeRet = writeRet;
+        pthread_cond_broadcast(&m_writtenCond);
+    }
+    pthread_mutex_unlock(&m_mutex);
+}
+
+int32_t SegmentWriter::WriteFile(SegmentBuffer *segBuffer, const char *fileName, bool needSync)
+{
+    if (!segBuffer || !fileName)
+        return OMAF_ERROR_NULL_PTR;
+
+    char tempName[1024 + sizeof(SEGMENT_TEMP_FILE_SUFFIX)];
+    snprintf(tempName, sizeof(tempName), "%s%s", fileName, SEGMENT_TEMP_FILE_SUFFIX);
+
+    int fd = open(tempName, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0)
+    {
+        LOG(ERROR) << "Failed to open segment file " << tempName << " !" << std::endl;
+        return OMAF_ERROR_WRITE_SEGMENT_FAILED;
+    }
+
+    uint32_t chunksNum = (uint32_t)((segBuffer->dataSize + SEGMENT_BUFFER_CHUNK_SIZE - 1) / SEGMENT_BUFFER_CHUNK_SIZE);
+    if (chunksNum > segBuffer->chunks.size())
+    {
+        close(fd);
+        unlink(tempName);
+        return OMAF_ERROR_DATA_SIZE;
+    }
+
+    std::vector<struct iovec> iovs(chunksNum);
+    uint64_t leftSize = segBuffer->dataSize;
+    for (uint32_t i = 0; i < chunksNum; i++)
+    {
+        iovs[i].iov_base = segBuffer->chunks[i];
+        iovs[i].iov_len = (size_t)std::min(leftSize, (uint64_t)SEGMENT_BUFFER_CHUNK_SIZE);
+        leftSize -= iovs[i].iov_len;
+    }
+
+    int32_t ret = ERROR_NONE;
+    uint32_t iovIdx = 0;
+    while (iovIdx < chunksNum)
+    {
+        int iovCnt = (int)std::min(chunksNum - iovIdx, (uint32_t)IOV_MAX);
+        ssize_t writtenSize = writev(fd, &(iovs[iovIdx]), iovCnt);
+        if (writtenSize < 0 && errno == EINTR)
+            continue;
+        if (writtenSize <= 0)
+        {
+            ret = OMAF_ERROR_WRITE_SEGMENT_FAILED;
+            break;
+        }
+
+        // skip fully written chunks and continue from the
+        // rest of partially written one
+        size_t leftWritten = (size_t)writtenSize;
+        while (iovIdx < chunksNum && leftWritten >= iovs[iovIdx].iov_len)
+        {
+            leftWritten -= iovs[iovIdx].iov_len;
+            iovIdx++;
+        }
+        if (iovIdx < chunksNum)
+        {
+            iovs[iovIdx].iov_base = (uint8_t*)(iovs[iovIdx].iov_base) + leftWritten;
+            iovs[iovIdx].iov_len -= leftWritten;
+        }
+    }
+
+    if (!ret && needSync && fdatasync(fd))
+        ret = OMAF_ERROR_WRITE_SEGMENT_FAILED;
+
+    if (close(fd) && !ret)
+        ret = OMAF_ERROR_WRITE_SEGMENT_FAILED;
+
+    if (!ret && rename(tempName, fileName))
+        ret = OMAF_ERROR_WRITE_SEGMENT_FAILED;
+
+    if (ret)
+    {
+        LOG(ERROR) << "Failed to write segment file " << fileName << " !" << std::endl;
+        unlink(tempName);
+    }
+
+    return ret;
+}
+
+VCD_NS_END
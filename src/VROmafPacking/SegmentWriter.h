@@ -0,0 +1,301 @@
+/*
+ * Copyright (c) 2019, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+//!
+//! \file:   SegmentWriter.h
+//! \brief:  Segment writer class definition
+//! \detail: Serialize segments into reusable chunked buffers and
+//!          write them to disk on a dedicated I/O thread. Each
+//!          segment is written into a temporary file which is then
+//!          renamed to the final name, so that web servers never
+//!          serve half-written segments.
+//!
+
+#ifndef _SEGMENTWRITER_H_
+#define _SEGMENTWRITER_H_
+
+#include "OmafPackingCommon.h"
+
+#include <pthread.h>
+#include <streambuf>
+#include <vector>
+
+VCD_NS_BEGIN
+
+#define SEGMENT_BUFFER_CHUNK_SIZE      65536 //!< size of each chunk of segment buffer
+#define SEGMENT_WRITER_MAX_PENDING_NUM 512   //!< max number of segments waiting to be written
+#define SEGMENT_TEMP_FILE_SUFFIX       ".tmp"
+
+class SegmentStore;
+
+//!
+//! \struct: SegmentBuffer
+//! \brief:  chunked buffer holding the serialized data of
+//!          one segment, chunks are kept when the buffer
+//!          is reused
+//!
+struct SegmentBuffer
+{
+    std::vector<uint8_t*> chunks;          //!< allocated chunks, each of SEGMENT_BUFFER_CHUNK_SIZE bytes
+    uint64_t              dataSize;        //!< size of serialized data
+    char                  fileName[1024];  //!< final file name of the segment
+    bool                  isRemoval;       //!< whether the segment file is removed instead of written
+    SegmentBuffer         *next;           //!< next segment buffer in free or pending list
+};
+
+//!
+//! \class SegmentStreamBuf
+//! \brief Stream buffer which appends the output of std::ostream
+//!        into a segment buffer
+//!
+
+class SegmentStreamBuf : public std::streambuf
+{
+public:
+    //!
+    //! \brief  Constructor
+    //!
+    //! \param  [in] segBuffer
+    //!         pointer to the segment buffer to be filled,
+    //!         its previous data is discarded
+    //!
+    SegmentStreamBuf(SegmentBuffer *segBuffer);
+
+    //!
+    //! \brief  Destructor
+    //!
+    virtual ~SegmentStreamBuf();
+
+    //!
+    //! \brief  Update data size of the segment buffer with
+    //!         all data written so far, must be called after
+    //!         the segment has been serialized
+    //!
+    //! \return int32_t
+    //!         ERROR_NONE if success, else failed reason
+    //!
+    int32_t Finish();
+
+protected:
+    virtual int_type overflow(int_type ch);
+
+    virtual std::streamsize xsputn(const char *s, std::streamsize n);
+
+private:
+    //!
+    //! \brief  Move to the next chunk, allocate it if needed
+    //!
+    //! \return bool
+    //!         true if success, else false
+    //!
+    bool NextChunk();
+
+    SegmentBuffer *m_segBuffer;   //!< segment buffer to be filled
+    uint32_t      m_currChunk;    //!< index of the chunk being filled
+    bool          m_isFailed;     //!< whether chunk allocation failed
+};
+
+//!
+//! \class SegmentWriter
+//! \brief Define the asynchronous segment writer shared by
+//!        all tracks segmentation
+//!
+
+class SegmentWriter
+{
+public:
+    //!
+    //! \brief  Constructor
+    //!
+    //! \param  [in] needSync
+    //!         whether segment data is flushed to storage
+    //!         by fdatasync before the segment is published
+    //! \param  [in] segStore
+    //!         if not NULL, segments are put into the in-memory
+    //!         segment store instead of being written to disk
+    //!
+    SegmentWriter(bool needSync, SegmentStore *segStore = NULL);
+
+    //!
+    //! \brief  Destructor, all pending segments are written
+    //!         before the I/O thread exits
+    //!
+    ~SegmentWriter();
+
+    //!
+    //! \brief  Start the I/O thread
+    //!
+    //! \return int32_t
+    //!         ERROR_NONE if success, else failed reason
+    //!
+    int32_t Initialize();
+
+    //!
+    //! \brief  Get one segment buffer for serializing segment
+    //!
+    //! \return SegmentBuffer*
+    //!         the pointer to the segment buffer, NULL if failed
+    //!
+    SegmentBuffer* GetBuffer();
+
+    //!
+    //! \brief  Queue the serialized segment to the I/O thread,
+    //!         the segment buffer is owned by the writer then,
+    //!         block if too many segments are pending
+    //!
+    //! \param  [in] segBuffer
+    //!         pointer to the segment buffer got by GetBuffer
+    //! \param  [in] fileName
+    //!         final file name of the segment
+    //!
+    //! \return int32_t
+    //!         ERROR_NONE if success, else failed reason, which
+    //!         can be the failure of one segment queued before
+    //!
+    int32_t WriteSegment(SegmentBuffer *segBuffer, const char *fileName);
+
+    //!
+    //! \brief  Append one chunk of the segment being produced
+    //!         to the in-memory segment store, so that it can
+    //!         be served before the whole segment is finished,
+    //!         the segment buffer is owned by the writer then
+    //!
+    //! \param  [in] segBuffer
+    //!         pointer to the segment buffer got by GetBuffer,
+    //!         can be NULL to only complete the segment
+    //! \param  [in] fileName
+    //!         final file name of the segment
+    //! \param  [in] isLast
+    //!         whether the chunk is the last one of the segment
+    //!
+    //! \return int32_t
+    //!         ERROR_NONE if success, else failed reason, which
+    //!         can be the failure of one segment queued before
+    //!
+    int32_t WriteChunk(SegmentBuffer *segBuffer, const char *fileName, bool isLast);
+
+    //!
+    //! \brief  Queue the removal of one segment file to the I/O
+    //!         thread, so that it is done after the segments
+    //!         queued before, which may include the same file
+    //!
+    //! \param  [in] fileName
+    //!         file name of the segment to be removed
+    //!
+    //! \return int32_t
+    //!         ERROR_NONE if success, else failed reason, which
+    //!         can be the failure of one segment queued before
+    //!
+    int32_t RemoveSegment(const char *fileName);
+
+    //!
+    //! \brief  Wait until all queued segments are written
+    //!
+    //! \return int32_t
+    //!         ERROR_NONE if all segments have been written
+    //!         successfully, else failed reason
+    //!
+    int32_t Flush();
+
+    //!
+    //! \brief  Write the segment buffer into a temporary file
+    //!         and rename it to the final file name
+    //!
+    //! \param  [in] segBuffer
+    //!         pointer to the segment buffer
+    //! \param  [in] fileName
+    //!         final file name of the segment
+    //! \param  [in] needSync
+    //!         whether to call fdatasync before renaming
+    //!
+    //! \return int32_t
+    //!         ERROR_NONE if success, else failed reason
+    //!
+    static int32_t WriteFile(SegmentBuffer *segBuffer, const char *fileName, bool needSync);
+
+    //!
+    //! \brief  Free the segment buffer and all its chunks
+    //!
+    //! \param  [in] segBuffer
+    //!         pointer to the segment buffer
+    //!
+    //! \return void
+    //!
+    static void DestroyBuffer(SegmentBuffer *segBuffer);
+
+private:
+    //!
+    //! \brief  I/O thread function
+    //!
+    static void* WriterThread(void *pThis);
+
+    //!
+    //! \brief  Take all pending segments and write them
+    //!         until the writer is stopped
+    //!
+    //! \return void
+    //!
+    void WriteQueuedSegments();
+
+    //!
+    //! \brief  Append the segment buffer to pending list,
+    //!         block if too many segments are pending
+    //!
+    //! \param  [in] segBuffer
+    //!         pointer to the segment buffer
+    //!
+    //! \return int32_t
+    //!         ERROR_NONE if success, else the failure of one
+    //!         segment queued before, and the segment buffer
+    //!         is put back to free list
+    //!
+    int32_t QueueBuffer(SegmentBuffer *segBuffer);
+
+    //!
+    //! \brief  Stop the I/O thread after pending segments
+    //!         are written
+    //!
+    //! \return void
+    //!
+    void Stop();
+
+    bool            m_needSync;       //!< whether to fdatasync each segment
+    SegmentStore    *m_segStore;      //!< in-memory segment store, NULL if segments are written to disk
+    pthread_t       m_threadId;       //!< thread ID of the I/O thread
+    bool            m_isRunning;      //!< whether the I/O thread is running
+    bool            m_isStopped;      //!< whether the I/O thread is asked to stop
+    pthread_mutex_t m_mutex;          //!< thread mutex for segment lists
+    pthread_cond_t  m_queuedCond;     //!< signalled when segments are queued or writer is stopped
+    pthread_cond_t  m_writtenCond;    //!< signalled when queued segments have been written
+    SegmentBuffer   *m_pendingHead;   //!< first segment waiting to be written
+    SegmentBuffer   *m_pendingTail;   //!< last segment waiting to be written
+    uint32_t        m_pendingNum;     //!< number of segments queued but not written yet
+    SegmentBuffer   *m_freeBuffers;   //!< list of free segment buffers
+    int32_t         m_writeRet;       //!< first failed reason of segments writing
+};
+
+VCD_NS_END;
+#endif /* _SEGMENTWRITER_H_ */
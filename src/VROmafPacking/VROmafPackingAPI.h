@@ -76,6 +76,36 @@ Handler VROmafPackingInit(InitialInfo *initInfo);
 //!
 int32_t VROmafPackingWriteSegment(Handler hdl, uint8_t streamIdx, FrameBSInfo *frameInfo);
 
+//!
+//! \brief  Same as VROmafPackingWriteSegment, but the frame
+//!         bitstream data is not copied. The library takes
+//!         over the ownership of frameInfo->data and calls
+//!         releaseFunc exactly once when the data is no longer
+//!         needed, also when the frame is failed to be added
+//!
+//! \param  [in] hdl
+//!         VR OMAF Packing library handle
+//! \param  [in] streamIdx
+//!         the index of the specified media stream
+//! \param  [in] frameInfo
+//!         pointer to the frame bitstream information of new frame
+//!         needed to be written into the segment for the
+//!         specified media stream
+//! \param  [in] releaseFunc
+//!         function to release the frame bitstream data
+//! \param  [in] opaque
+//!         user data passed to releaseFunc
+//!
+//! \return int32_t
+//!         ERROR_NONE if success, else failed reason
+//!
+int32_t VROmafPackingWriteSegmentNoCopy(
+    Handler hdl,
+    uint8_t streamIdx,
+    FrameBSInfo *frameInfo,
+    FrameDataReleaseFunc releaseFunc,
+    void *opaque);
+
 //!
 //! \brief  VR OMAF Packing library ends the processing
 //!         for all media streams, called when there is
@@ -65,6 +65,24 @@ int32_t VROmafPackingWriteSegment(Handler hdl, uint8_t streamIdx, FrameBSInfo *f
     return ERROR_NONE;
 }
 
+int32_t VROmafPackingWriteSegmentNoCopy(
+    Handler hdl,
+    uint8_t streamIdx,
+    FrameBSInfo *frameInfo,
+    FrameDataReleaseFunc releaseFunc,
+    void *opaque)
+{
+    if (!releaseFunc)
+        return OMAF_ERROR_NULL_PTR;
+
+    OmafPackage *omafPackage = (OmafPackage*)hdl;
+    int32_t ret = omafPackage->OmafPacketStream(streamIdx, frameInfo, releaseFunc, opaque);
+    if (ret)
+        return ret;
+
+    return ERROR_NONE;
+}
+
 int32_t VROmafPackingEndStreams(Handler hdl)
 {
     OmafPackage *omafPackage = (OmafPackage*)hdl;
@@ -149,6 +149,9 @@ typedef struct SegmentationInfo
     bool          isLive;
     int32_t       splitTile;
     bool          hasMainAS;
+    uint16_t      httpPort;         //if not 0, live segments and mpd are kept in memory and served on this port
+    uint32_t      framesPerChunk;   //if not 0 together with httpPort, live segments are published in moof/mdat chunks of this frames number
+    uint32_t      gopSize;          //frames number between IDR frames of input streams, mandatory when framesPerChunk is set
 }SegmentationInfo;
 
 //!
@@ -182,6 +185,14 @@ typedef struct FrameBSInfo
     bool     isKeyFrame;
 }FrameBSInfo;
 
+//!
+//! \brief: release function for the frame bitstream data whose
+//!         ownership has been handed over to the library, called
+//!         with the data pointer and user data once the frame
+//!         has been written into segments
+//!
+typedef void (*FrameDataReleaseFunc)(uint8_t *data, void *opaque);
+
 #ifdef __cplusplus
 }
 #endif
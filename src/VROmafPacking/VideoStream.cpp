@@ -34,6 +34,7 @@
 #include "VideoStream.h"
 #include "AvcNaluParser.h"
 #include "HevcNaluParser.h"
+#include "../utils/OmafStructure.h"
 
 VCD_NS_BEGIN
 
@@ -61,6 +62,12 @@ VideoStream::VideoStream()
     m_360scvpHandle = NULL;
     m_naluParser = NULL;
     m_isEOS = false;
+    m_maxBufferedFrames = 0;
+    pthread_mutex_init(&m_frameMutex, NULL);
+    pthread_cond_init(&m_frameAdded, NULL);
+    pthread_cond_init(&m_frameFetched, NULL);
+    m_tilesNaluFrameNum = 0;
+    pthread_mutex_init(&m_sliceHdrMutex, NULL);
 }
 
 VideoStream::~VideoStream()
@@ -99,13 +106,7 @@ VideoStream::~VideoStream()
     for (it1 = m_frameInfoList.begin(); it1 != m_frameInfoList.end();)
     {
         FrameBSInfo *frameInfo = *it1;
-        if (frameInfo)
-        {
-            DELETE_ARRAY(frameInfo->data);
-
-            delete frameInfo;
-            frameInfo = NULL;
-        }
+        m_framePool.PutFrameInfo(frameInfo);
 
         it1 = m_frameInfoList.erase(it1);
     }
@@ -115,18 +116,24 @@ VideoStream::~VideoStream()
     for (it2 = m_framesToOneSeg.begin(); it2 != m_framesToOneSeg.end();)
     {
         FrameBSInfo *frameInfo = *it2;
-        if (frameInfo)
-        {
-            DELETE_ARRAY(frameInfo->data);
-
-            delete frameInfo;
-            frameInfo = NULL;
-        }
+        m_framePool.PutFrameInfo(frameInfo);
 
         it2 = m_framesToOneSeg.erase(it2);
     }
     m_framesToOneSeg.clear();
 
+    pthread_cond_destroy(&m_frameAdded);
+    pthread_cond_destroy(&m_frameFetched);
+    pthread_mutex_destroy(&m_frameMutex);
+
+    std::map<uint64_t, SliceHeaderCache*>::iterator itHdr;
+    for (itHdr = m_sliceHdrCache.begin(); itHdr != m_sliceHdrCache.end(); itHdr++)
+    {
+        DELETE_MEMORY(itHdr->second);
+    }
+    m_sliceHdrCache.clear();
+    pthread_mutex_destroy(&m_sliceHdrMutex);
+
     DELETE_MEMORY(m_360scvpParam);
 
     if (m_360scvpHandle)
@@ -279,6 +286,12 @@ int32_t VideoStream::Initialize(
     m_frameRate = bs->frameRate;
     m_bitRate = bs->bitRate;
 
+    if (initInfo->segmentationInfo && initInfo->segmentationInfo->needBufedFrames >= 0)
+    {
+        m_maxBufferedFrames = (uint32_t)(initInfo->segmentationInfo->needBufedFrames) +
+                              EXTRA_BUFFERED_FRAMES_NUM;
+    }
+
     m_360scvpParam = new param_360SCVP;
     if (!m_360scvpParam)
         return OMAF_ERROR_NULL_PTR;
@@ -339,44 +352,89 @@ int32_t VideoStream::Initialize(
 
 int32_t VideoStream::AddFrameInfo(FrameBSInfo *frameInfo)
 {
-    if (!frameInfo || !(frameInfo->data))
-        return OMAF_ERROR_NULL_PTR;
+    return AddFrameInfo(frameInfo, NULL, NULL);
+}
 
-    if (!frameInfo->dataSize)
-        return OMAF_ERROR_DATA_SIZE;
+int32_t VideoStream::AddFrameInfo(
+    FrameBSInfo *frameInfo,
+    FrameDataReleaseFunc releaseFunc,
+    void *opaque)
+{
+    if (!frameInfo || !(frameInfo->data) || !frameInfo->dataSize)
+    {
+        if (releaseFunc && frameInfo)
+            releaseFunc(frameInfo->data, opaque);
 
-    FrameBSInfo *newFrameInfo = new FrameBSInfo;
-    if (!newFrameInfo)
-        return OMAF_ERROR_NULL_PTR;
+        if (!frameInfo || !(frameInfo->data))
+            return OMAF_ERROR_NULL_PTR;
 
-    memset(newFrameInfo, 0, sizeof(FrameBSInfo));
+        return OMAF_ERROR_DATA_SIZE;
+    }
 
-    uint8_t *localData = new uint8_t[frameInfo->dataSize];
-    if (!localData)
+    FrameBSInfo *newFrameInfo = m_framePool.GetFrameInfo(frameInfo, releaseFunc, opaque);
+    if (!newFrameInfo)
     {
-        delete newFrameInfo;
-        newFrameInfo = NULL;
+        if (releaseFunc)
+            releaseFunc(frameInfo->data, opaque);
+
         return OMAF_ERROR_NULL_PTR;
     }
-    memcpy(localData, frameInfo->data, frameInfo->dataSize);
-
-    newFrameInfo->data = localData;
-    newFrameInfo->dataSize = frameInfo->dataSize;
-    newFrameInfo->pts = frameInfo->pts;
-    newFrameInfo->isKeyFrame = frameInfo->isKeyFrame;
 
+    pthread_mutex_lock(&m_frameMutex);
+    while (m_maxBufferedFrames && !m_isEOS &&
+        (m_frameInfoList.size() >= m_maxBufferedFrames))
+    {
+        pthread_cond_wait(&m_frameFetched, &m_frameMutex);
+    }
     m_frameInfoList.push_back(newFrameInfo);
+    pthread_cond_signal(&m_frameAdded);
+    pthread_mutex_unlock(&m_frameMutex);
 
     return ERROR_NONE;
 }
 
 void VideoStream::SetCurrFrameInfo()
 {
+    pthread_mutex_lock(&m_frameMutex);
+    while (!m_frameInfoList.size() && !m_isEOS)
+    {
+        pthread_cond_wait(&m_frameAdded, &m_frameMutex);
+    }
+
     if (m_frameInfoList.size() > 0)
     {
         m_currFrameInfo = m_frameInfoList.front();
         m_frameInfoList.pop_front();
+        pthread_cond_signal(&m_frameFetched);
     }
+    pthread_mutex_unlock(&m_frameMutex);
+}
+
+void VideoStream::SetEOS(bool isEOS)
+{
+    pthread_mutex_lock(&m_frameMutex);
+    m_isEOS = isEOS;
+    pthread_cond_broadcast(&m_frameAdded);
+    pthread_cond_broadcast(&m_frameFetched);
+    pthread_mutex_unlock(&m_frameMutex);
+}
+
+bool VideoStream::GetEOS()
+{
+    pthread_mutex_lock(&m_frameMutex);
+    bool isEOS = m_isEOS;
+    pthread_mutex_unlock(&m_frameMutex);
+
+    return isEOS;
+}
+
+uint32_t VideoStream::GetBufferedFrameNum()
+{
+    pthread_mutex_lock(&m_frameMutex);
+    uint32_t framesNum = m_frameInfoList.size();
+    pthread_mutex_unlock(&m_frameMutex);
+
+    return framesNum;
 }
 
 int32_t VideoStream::UpdateTilesNalu()
@@ -389,6 +447,96 @@ int32_t VideoStream::UpdateTilesNalu()
     if (ret)
         return ret;
 
+    m_tilesNaluFrameNum++;
+
+    return ERROR_NONE;
+}
+
+int32_t VideoStream::GetTileSliceHeader(
+    uint8_t tileIdx,
+    uint16_t ctuIdx,
+    int32_t dstWidth,
+    int32_t dstHeight,
+    void *scvpHandle,
+    param_360SCVP *scvpParam,
+    uint8_t *hdrData,
+    uint32_t *hdrSize)
+{
+    if (!m_tilesInfo || !scvpHandle || !scvpParam || !hdrData || !hdrSize)
+        return OMAF_ERROR_NULL_PTR;
+
+    if (tileIdx >= m_tileInRow * m_tileInCol)
+        return OMAF_ERROR_INVALID_DATA;
+
+    uint64_t key = ((uint64_t)tileIdx << 48) | ((uint64_t)ctuIdx << 32) |
+                   ((uint64_t)(dstWidth & 0xFFFF) << 16) | (uint64_t)(dstHeight & 0xFFFF);
+
+    pthread_mutex_lock(&m_sliceHdrMutex);
+    std::map<uint64_t, SliceHeaderCache*>::iterator it = m_sliceHdrCache.find(key);
+    if ((it != m_sliceHdrCache.end()) && (it->second->frameNum == m_tilesNaluFrameNum))
+    {
+        SliceHeaderCache *hdrCache = it->second;
+        memcpy(hdrData, hdrCache->data, hdrCache->dataSize);
+        *hdrSize = hdrCache->dataSize;
+        pthread_mutex_unlock(&m_sliceHdrMutex);
+        return ERROR_NONE;
+    }
+    pthread_mutex_unlock(&m_sliceHdrMutex);
+
+    // only the slice header is parsed, so copy it out of the
+    // slice instead of the whole slice data
+    Nalu *tileNalu = m_tilesInfo[tileIdx].tileNalu;
+    if (!tileNalu || !(tileNalu->data))
+        return OMAF_ERROR_NULL_PTR;
+
+    uint8_t parseData[SLICE_HEADER_BUF_SIZE + SLICE_HEADER_EXTRA_BYTES];
+    uint32_t parseSize = tileNalu->startCodesSize + HEVC_NALUHEADER_LEN +
+                         tileNalu->sliceHeaderLen + SLICE_HEADER_EXTRA_BYTES;
+    if (parseSize > (uint32_t)(tileNalu->dataSize))
+        parseSize = tileNalu->dataSize;
+    if ((parseSize < HEVC_STARTCODES_LEN) || (parseSize > sizeof(parseData)))
+        return OMAF_ERROR_INVALID_DATA;
+
+    memcpy(parseData, tileNalu->data, parseSize);
+    parseData[0] = 0;
+    parseData[1] = 0;
+    parseData[2] = 0;
+    parseData[3] = 1;
+
+    memcpy(scvpParam, m_360scvpParam, sizeof(param_360SCVP));
+    scvpParam->destWidth = dstWidth;
+    scvpParam->destHeight = dstHeight;
+    scvpParam->pInputBitstream = parseData;
+    scvpParam->inputBitstreamLen = parseSize;
+    scvpParam->pOutputBitstream = hdrData;
+
+    int32_t ret = I360SCVP_GenerateSliceHdr(scvpParam, ctuIdx, scvpHandle);
+    if (ret)
+        return OMAF_ERROR_SCVP_OPERATION_FAILED;
+
+    if (scvpParam->outputBitstreamLen > SLICE_HEADER_BUF_SIZE)
+        return OMAF_ERROR_INVALID_DATA;
+
+    *hdrSize = scvpParam->outputBitstreamLen;
+
+    pthread_mutex_lock(&m_sliceHdrMutex);
+    SliceHeaderCache *hdrCache = m_sliceHdrCache[key];
+    if (!hdrCache)
+    {
+        hdrCache = new SliceHeaderCache;
+        if (!hdrCache)
+        {
+            m_sliceHdrCache.erase(key);
+            pthread_mutex_unlock(&m_sliceHdrMutex);
+            return ERROR_NONE;
+        }
+        m_sliceHdrCache[key] = hdrCache;
+    }
+    memcpy(hdrCache->data, hdrData, *hdrSize);
+    hdrCache->dataSize = *hdrSize;
+    hdrCache->frameNum = m_tilesNaluFrameNum;
+    pthread_mutex_unlock(&m_sliceHdrMutex);
+
     return ERROR_NONE;
 }
 
@@ -408,12 +556,7 @@ void VideoStream::DestroyCurrSegmentFrames()
     for (it = m_framesToOneSeg.begin(); it != m_framesToOneSeg.end(); )
     {
         FrameBSInfo *frameInfo = *it;
-        if (frameInfo)
-        {
-            DELETE_ARRAY(frameInfo->data);
-            delete frameInfo;
-            frameInfo = NULL;
-        }
+        m_framePool.PutFrameInfo(frameInfo);
 
         //m_framesToOneSeg.erase(it++);
         it = m_framesToOneSeg.erase(it);
@@ -426,9 +569,7 @@ void VideoStream::DestroyCurrFrameInfo()
 {
     if (m_currFrameInfo)
     {
-        DELETE_ARRAY(m_currFrameInfo->data);
-
-        delete m_currFrameInfo;
+        m_framePool.PutFrameInfo(m_currFrameInfo);
         m_currFrameInfo = NULL;
     }
 }
@@ -40,11 +40,37 @@
 #include "MediaStream.h"
 #include "NaluParser.h"
 #include "VideoSegmentInfoGenerator.h"
+#include "FrameInfoPool.h"
 
 #include <list>
+#include <map>
+#include <pthread.h>
 
 VCD_NS_BEGIN
 
+//! extra frames the frame list may hold beyond the frames
+//! which need to be buffered before segmentation starts
+#define EXTRA_BUFFERED_FRAMES_NUM 30
+
+//! size of the buffer holding one generated slice header
+#define SLICE_HEADER_BUF_SIZE 256
+
+//! bytes read beyond the original slice header when
+//! regenerating it, which covers the byte alignment bits
+#define SLICE_HEADER_EXTRA_BYTES 16
+
+//!
+//! \struct: SliceHeaderCache
+//! \brief:  slice header regenerated for one tile placed at one
+//!          new slice address, shared by all extractor tracks
+//!
+typedef struct SliceHeaderCache
+{
+    uint64_t frameNum;                    //!< frame number the slice header is generated for
+    uint32_t dataSize;                    //!< size of the slice header data, including start codes
+    uint8_t  data[SLICE_HEADER_BUF_SIZE]; //!< slice header data
+}SliceHeaderCache;
+
 //!
 //! \class VideoStream
 //! \brief Define the video stream data and data operation
@@ -177,9 +203,31 @@ public:
     //!
     int32_t AddFrameInfo(FrameBSInfo *frameInfo);
 
+    //!
+    //! \brief  Add frame information of new frame into
+    //!         frame information list
+    //!
+    //! \param  [in] frameInfo
+    //!         pointer to the frame information of the new frame
+    //! \param  [in] releaseFunc
+    //!         if not NULL, the bitstream data is not copied but
+    //!         owned by the video stream, and releaseFunc is called
+    //!         after the frame is written into segments
+    //! \param  [in] opaque
+    //!         user data passed to releaseFunc
+    //!
+    //! \return int32_t
+    //!         ERROR_NONE if success, else failed reason
+    //!
+    int32_t AddFrameInfo(
+        FrameBSInfo *frameInfo,
+        FrameDataReleaseFunc releaseFunc,
+        void *opaque);
+
     //!
     //! \brief  Fetch the front frame information in frame
-    //!         information list as current frame information
+    //!         information list as current frame information,
+    //!         blocks until one frame is added or EOS is set
     //!
     //! \return void
     //!
@@ -194,6 +242,45 @@ public:
     //!
     int32_t UpdateTilesNalu();
 
+    //!
+    //! \brief  Get slice header of specified tile in current frame
+    //!         with new slice address in the destination picture,
+    //!         the header is generated only once for each frame
+    //!         and placement, then shared by all extractor tracks
+    //!
+    //! \param  [in] tileIdx
+    //!         the index of the tile in the video stream
+    //! \param  [in] ctuIdx
+    //!         the new slice address in the destination picture
+    //! \param  [in] dstWidth
+    //!         the width of the destination picture
+    //! \param  [in] dstHeight
+    //!         the height of the destination picture
+    //! \param  [in] scvpHandle
+    //!         360SCVP library handle of the caller to generate
+    //!         the slice header
+    //! \param  [in] scvpParam
+    //!         360SCVP library parameter of the caller used as
+    //!         working space
+    //! \param  [out] hdrData
+    //!         buffer of SLICE_HEADER_BUF_SIZE bytes for the
+    //!         slice header data, including start codes
+    //! \param  [out] hdrSize
+    //!         size of the slice header data
+    //!
+    //! \return int32_t
+    //!         ERROR_NONE if success, else failed reason
+    //!
+    int32_t GetTileSliceHeader(
+        uint8_t tileIdx,
+        uint16_t ctuIdx,
+        int32_t dstWidth,
+        int32_t dstHeight,
+        void *scvpHandle,
+        param_360SCVP *scvpParam,
+        uint8_t *hdrData,
+        uint32_t *hdrSize);
+
     //!
     //! \brief  Get all tiles information
     //!
@@ -289,7 +376,7 @@ public:
     //!
     //! \return void
     //!
-    void SetEOS(bool isEOS) { m_isEOS = isEOS; };
+    void SetEOS(bool isEOS);
 
     //!
     //! \brief  Get the EOS status of the video stream
@@ -297,7 +384,7 @@ public:
     //! \return bool
     //!         the EOS status of the video stream
     //!
-    bool GetEOS() { return m_isEOS; };
+    bool GetEOS();
 
     //!
     //! \brief  Add current frame to frames list for current
@@ -319,10 +406,7 @@ public:
     //! \return uint32_t
     //!         current buffered frames number
     //!
-    uint32_t GetBufferedFrameNum()
-    {
-        return m_frameInfoList.size();
-    }
+    uint32_t GetBufferedFrameNum();
 
 private:
     //!
@@ -374,6 +458,14 @@ private:
     Rational                  m_frameRate;        //!< the frame rate of the video stream
     uint64_t                  m_bitRate;          //!< the bit rate of the video stream
     bool                      m_isEOS;            //!< the EOS status of the video stream
+    uint32_t                  m_maxBufferedFrames;//!< maximum frames number in frame information list, 0 means no limit
+    pthread_mutex_t           m_frameMutex;       //!< thread mutex for frame information list and EOS status
+    pthread_cond_t            m_frameAdded;       //!< signalled when one frame is added or EOS is set
+    pthread_cond_t            m_frameFetched;     //!< signalled when one frame is fetched from frame information list
+    FrameInfoPool             m_framePool;        //!< pool of frame information and bitstream buffers
+    uint64_t                  m_tilesNaluFrameNum;//!< number of frames whose tiles nalu information has been updated
+    std::map<uint64_t, SliceHeaderCache*> m_sliceHdrCache; //!< map of tile placement and its regenerated slice header
+    pthread_mutex_t           m_sliceHdrMutex;    //!< thread mutex for slice header cache
 };
 
 VCD_NS_END;
@@ -6,6 +6,8 @@ g++ -I../ -I../../google_test/ -std=c++11 -g -c testHevcNaluParser.cpp -D_GLIBCX
 g++ -I../ -I../../google_test/ -std=c++11 -g -c testVideoStream.cpp -D_GLIBCXX_USE_CXX11_ABI=0
 g++ -I../ -I../../google_test/ -std=c++11 -g -c testExtractorTrack.cpp -D_GLIBCXX_USE_CXX11_ABI=0
 g++ -I../ -I../../google_test/ -std=c++11 -g -c testDefaultSegmentation.cpp -D_GLIBCXX_USE_CXX11_ABI=0
+g++ -I../ -I../../google_test/ -std=c++11 -g -c testSegmentWriter.cpp -D_GLIBCXX_USE_CXX11_ABI=0
+g++ -I../ -I../../google_test/ -std=c++11 -g -c testSegmentStore.cpp -D_GLIBCXX_USE_CXX11_ABI=0
 
 LD_FLAGS="-L/usr/local/lib -lVROmafPacking -l360SCVP -lstdc++ -lpthread -lm -L/usr/local/lib"
 
@@ -13,8 +15,12 @@ g++ -L/usr/local/lib testHevcNaluParser.o libgtest.a -o testHevcNaluParser ${LD_
 g++ -L/usr/local/lib testVideoStream.o libgtest.a -o testVideoStream ${LD_FLAGS}
 g++ -L/usr/local/lib testExtractorTrack.o libgtest.a -o testExtractorTrack ${LD_FLAGS}
 g++ -L/usr/local/lib testDefaultSegmentation.o libgtest.a -o testDefaultSegmentation ${LD_FLAGS}
+g++ -L/usr/local/lib testSegmentWriter.o libgtest.a -o testSegmentWriter ${LD_FLAGS}
+g++ -L/usr/local/lib testSegmentStore.o libgtest.a -o testSegmentStore ${LD_FLAGS}
 
 ./testHevcNaluParser
 ./testVideoStream
 ./testExtractorTrack
 ./testDefaultSegmentation
+./testSegmentWriter
+./testSegmentStore
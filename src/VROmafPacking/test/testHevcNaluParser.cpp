@@ -426,4 +426,111 @@ TEST_F(HevcNaluParserTest, ParseSliceNalu)
     delete parser;
     parser = NULL;
 }
+
+TEST_F(HevcNaluParserTest, ParseSliceNaluWithHeaders)
+{
+    HevcNaluParser *parser = new HevcNaluParser(m_360scvpHandle, m_360scvpParam);
+    EXPECT_TRUE(parser != NULL);
+    if (!parser)
+        return;
+
+    int32_t ret = parser->ParseHeaderData();
+    EXPECT_TRUE(ret == 0);
+
+    // VPS/SPS/PPS/SEI are repeated ahead of the slices of the frame
+    uint32_t frameSize = m_headerSize + 370771;
+    uint8_t  *frameData = new uint8_t[frameSize];
+    EXPECT_TRUE(frameData != NULL);
+    if (!frameData)
+    {
+        DELETE_MEMORY(parser);
+        return;
+    }
+    memcpy(frameData, m_headerData, m_headerSize);
+    fread(frameData + m_headerSize, 1, frameSize - m_headerSize, m_testFile);
+
+    uint16_t tilesNum = m_tilesInRow * m_tilesInCol;
+    TileInfo *tilesInfo = new TileInfo[tilesNum];
+    EXPECT_TRUE(tilesInfo != NULL);
+    if (!tilesInfo)
+    {
+        DELETE_MEMORY(parser);
+        DELETE_ARRAY(frameData);
+        return;
+    }
+    for (uint16_t i = 0; i < tilesNum; i++)
+    {
+        tilesInfo[i].tileNalu = new Nalu;
+    }
+
+    ret = parser->ParseSliceNalu(
+                    frameData,
+                    frameSize,
+                    tilesNum,
+                    tilesInfo);
+    EXPECT_TRUE(ret == 0);
+    EXPECT_TRUE(tilesInfo[0].tileNalu->data == (frameData + m_headerSize));
+    EXPECT_TRUE(tilesInfo[0].tileNalu->dataSize == 191005);
+    EXPECT_TRUE(tilesInfo[1].tileNalu->dataSize == 179766);
+    for (uint16_t i = 0; i < tilesNum; i++)
+    {
+        EXPECT_TRUE(tilesInfo[i].tileNalu->naluType == 19); //IDR_W_RADL
+        DELETE_MEMORY(tilesInfo[i].tileNalu);
+    }
+
+    DELETE_ARRAY(tilesInfo);
+    DELETE_ARRAY(frameData);
+    DELETE_MEMORY(parser);
+}
+
+TEST_F(HevcNaluParserTest, ParseSliceNaluMissingTiles)
+{
+    HevcNaluParser *parser = new HevcNaluParser(m_360scvpHandle, m_360scvpParam);
+    EXPECT_TRUE(parser != NULL);
+    if (!parser)
+        return;
+
+    int32_t ret = parser->ParseHeaderData();
+    EXPECT_TRUE(ret == 0);
+
+    uint32_t firstFrameSize = 370771;
+    uint8_t  *firstFrameData = new uint8_t[firstFrameSize];
+    EXPECT_TRUE(firstFrameData != NULL);
+    if (!firstFrameData)
+    {
+        DELETE_MEMORY(parser);
+        return;
+    }
+    fread(firstFrameData, 1, firstFrameSize, m_testFile);
+
+    // the frame has one slice for each of 2 tiles, ask for one more
+    uint16_t tilesNum = m_tilesInRow * m_tilesInCol + 1;
+    TileInfo *tilesInfo = new TileInfo[tilesNum];
+    EXPECT_TRUE(tilesInfo != NULL);
+    if (!tilesInfo)
+    {
+        DELETE_MEMORY(parser);
+        DELETE_ARRAY(firstFrameData);
+        return;
+    }
+    for (uint16_t i = 0; i < tilesNum; i++)
+    {
+        tilesInfo[i].tileNalu = new Nalu;
+    }
+
+    ret = parser->ParseSliceNalu(
+                    firstFrameData,
+                    firstFrameSize,
+                    tilesNum,
+                    tilesInfo);
+    EXPECT_TRUE(ret == OMAF_ERROR_INVALID_FRAME_BITSTREAM);
+
+    for (uint16_t i = 0; i < tilesNum; i++)
+    {
+        DELETE_MEMORY(tilesInfo[i].tileNalu);
+    }
+    DELETE_ARRAY(tilesInfo);
+    DELETE_ARRAY(firstFrameData);
+    DELETE_MEMORY(parser);
+}
 }
@@ -0,0 +1,263 @@
+/*
+ * Copyright (c) 2019, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+//!
+//! \file:   testSegmentStore.cpp
+//! \brief:  In-memory segment store and http server unit test
+//!
+
+#include "gtest/gtest.h"
+#include "../SegmentStore.h"
+#include "../HttpServer.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <pthread.h>
+#include <string>
+#include <sys/socket.h>
+#include <unistd.h>
+
+VCD_USE_VRVIDEO;
+
+namespace {
+
+#define TEST_HTTP_PORT 19876
+
+class SegmentStoreTest : public testing::Test
+{
+public:
+    virtual void SetUp()
+    {
+        m_segStore = new SegmentStore(2);
+    }
+
+    virtual void TearDown()
+    {
+        DELETE_MEMORY(m_segStore);
+    }
+
+    std::string HttpGet(const char *path)
+    {
+        std::string response;
+        int32_t sock = socket(AF_INET, SOCK_STREAM, 0);
+        if (sock < 0)
+            return response;
+
+        struct sockaddr_in addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = inet_addr("127.0.0.1");
+        addr.sin_port = htons(TEST_HTTP_PORT);
+        if (connect(sock, (struct sockaddr*)&addr, sizeof(addr)))
+        {
+            close(sock);
+            return response;
+        }
+
+        char request[1024];
+        snprintf(request, 1024, "GET %s HTTP/1.1\r\nHost: localhost\r\nConnection: close\r\n\r\n", path);
+        send(sock, request, strlen(request), 0);
+
+        char buf[4096];
+        ssize_t recvSize = 0;
+        while ((recvSize = recv(sock, buf, 4096, 0)) > 0)
+        {
+            response.append(buf, recvSize);
+        }
+        close(sock);
+
+        return response;
+    }
+
+    SegmentStore *m_segStore;
+};
+
+static void *HttpGetThread(void *pTest)
+{
+    SegmentStoreTest *test = (SegmentStoreTest*)pTest;
+    std::string *response = new std::string(test->HttpGet("/live_track1.1.mp4"));
+    return response;
+}
+
+static void *AppendRestThread(void *pStore)
+{
+    SegmentStore *segStore = (SegmentStore*)pStore;
+    usleep(100000);
+    segStore->AppendFile("live_track1.1.mp4", (const uint8_t*)"world", 5, true);
+    return NULL;
+}
+
+TEST_F(SegmentStoreTest, SlideWindow)
+{
+    const uint8_t data[4] = { 1, 2, 3, 4 };
+    int32_t ret = m_segStore->AppendFile("/tmp/live_track1.init.mp4", data, 4, true);
+    EXPECT_TRUE(ret == ERROR_NONE);
+
+    for (uint32_t segIdx = 1; segIdx <= 3; segIdx++)
+    {
+        char segName[1024];
+        snprintf(segName, 1024, "/tmp/live_track1.%d.mp4", segIdx);
+        ret = m_segStore->AppendFile(segName, data, 4, true);
+        EXPECT_TRUE(ret == ERROR_NONE);
+    }
+
+    EXPECT_TRUE(m_segStore->GetFile("live_track1.1.mp4") == NULL);
+    EXPECT_TRUE(m_segStore->GetFile("live_track1.2.mp4") != NULL);
+    EXPECT_TRUE(m_segStore->GetFile("live_track1.3.mp4") != NULL);
+    EXPECT_TRUE(m_segStore->GetFile("live_track1.init.mp4") != NULL);
+
+    std::shared_ptr<StoredFile> file = m_segStore->GetFile("live_track1.3.mp4");
+    uint8_t readData[8];
+    uint64_t readSize = 0;
+    ret = m_segStore->ReadFile(file, 1, readData, 8, &readSize);
+    EXPECT_TRUE(ret == ERROR_NONE);
+    EXPECT_TRUE(readSize == 3);
+    EXPECT_TRUE(0 == memcmp(readData, data + 1, 3));
+}
+
+TEST_F(SegmentStoreTest, ServeCompleteFile)
+{
+    HttpServer *httpServer = new HttpServer(m_segStore);
+    int32_t ret = httpServer->Start(TEST_HTTP_PORT);
+    EXPECT_TRUE(ret == ERROR_NONE);
+
+    const char *mpd = "<MPD></MPD>";
+    ret = m_segStore->AppendFile("/tmp/live.mpd", (const uint8_t*)mpd, strlen(mpd), true);
+    EXPECT_TRUE(ret == ERROR_NONE);
+
+    std::string response = HttpGet("/live.mpd?t=1");
+    EXPECT_TRUE(response.find("HTTP/1.1 200 OK\r\n") == 0);
+    EXPECT_TRUE(response.find("Content-Type: application/dash+xml\r\n") != std::string::npos);
+    EXPECT_TRUE(response.find("Content-Length: 11\r\n") != std::string::npos);
+    EXPECT_TRUE(response.substr(response.size() - strlen(mpd)) == mpd);
+
+    response = HttpGet("/live_track1.1.mp4");
+    EXPECT_TRUE(response.find("HTTP/1.1 404 Not Found\r\n") == 0);
+
+    delete httpServer;
+    httpServer = NULL;
+}
+
+TEST_F(SegmentStoreTest, ServeFileBeingWritten)
+{
+    HttpServer *httpServer = new HttpServer(m_segStore);
+    int32_t ret = httpServer->Start(TEST_HTTP_PORT);
+    EXPECT_TRUE(ret == ERROR_NONE);
+
+    ret = m_segStore->AppendFile("live_track1.1.mp4", (const uint8_t*)"hello ", 6, false);
+    EXPECT_TRUE(ret == ERROR_NONE);
+
+    pthread_t threadId;
+    ret = pthread_create(&threadId, NULL, AppendRestThread, m_segStore);
+    EXPECT_TRUE(ret == 0);
+
+    std::string response = HttpGet("/live_track1.1.mp4");
+    pthread_join(threadId, NULL);
+
+    EXPECT_TRUE(response.find("HTTP/1.1 200 OK\r\n") == 0);
+    EXPECT_TRUE(response.find("Transfer-Encoding: chunked\r\n") != std::string::npos);
+    size_t bodyPos = response.find("\r\n\r\n") + 4;
+    EXPECT_TRUE(response.substr(bodyPos) == "6\r\nhello \r\n5\r\nworld\r\n0\r\n\r\n");
+
+    delete httpServer;
+    httpServer = NULL;
+}
+
+TEST_F(SegmentStoreTest, WriteSegmentInChunks)
+{
+    SegmentWriter *segWriter = new SegmentWriter(false, m_segStore);
+    EXPECT_TRUE(segWriter != NULL);
+    if (!segWriter)
+        return;
+
+    const char *chunksData[2] = { "styp moof mdat ", "moof mdat" };
+    for (uint32_t chunkIdx = 0; chunkIdx < 2; chunkIdx++)
+    {
+        SegmentBuffer *segBuffer = segWriter->GetBuffer();
+        EXPECT_TRUE(segBuffer != NULL);
+
+        SegmentStreamBuf *streamBuf = new SegmentStreamBuf(segBuffer);
+        std::ostream chunkStream(streamBuf);
+        chunkStream.write(chunksData[chunkIdx], strlen(chunksData[chunkIdx]));
+        int32_t ret = streamBuf->Finish();
+        EXPECT_TRUE(ret == ERROR_NONE);
+        delete streamBuf;
+        streamBuf = NULL;
+
+        ret = segWriter->WriteChunk(segBuffer, "/tmp/live_track1.1.mp4", false);
+        EXPECT_TRUE(ret == ERROR_NONE);
+
+        std::shared_ptr<StoredFile> file = m_segStore->GetFile("live_track1.1.mp4");
+        EXPECT_TRUE(file != NULL);
+        uint64_t fileSize = 0;
+        bool isComplete = true;
+        ret = m_segStore->GetFileStatus(file, &fileSize, &isComplete);
+        EXPECT_TRUE(ret == ERROR_NONE);
+        EXPECT_FALSE(isComplete);
+        EXPECT_TRUE(fileSize == (chunkIdx ? 24 : 15));
+    }
+
+    int32_t ret = segWriter->WriteChunk(NULL, "/tmp/live_track1.1.mp4", true);
+    EXPECT_TRUE(ret == ERROR_NONE);
+
+    std::shared_ptr<StoredFile> file = m_segStore->GetFile("live_track1.1.mp4");
+    uint8_t readData[32];
+    uint64_t readSize = 0;
+    ret = m_segStore->ReadFile(file, 0, readData, 32, &readSize);
+    EXPECT_TRUE(ret == ERROR_NONE);
+    EXPECT_TRUE(readSize == 24);
+    EXPECT_TRUE(0 == memcmp(readData, "styp moof mdat moof mdat", 24));
+    EXPECT_TRUE(file->isComplete);
+
+    delete segWriter;
+    segWriter = NULL;
+}
+
+TEST_F(SegmentStoreTest, StopWhileServing)
+{
+    HttpServer *httpServer = new HttpServer(m_segStore);
+    int32_t ret = httpServer->Start(TEST_HTTP_PORT);
+    EXPECT_TRUE(ret == ERROR_NONE);
+
+    ret = m_segStore->AppendFile("live_track1.1.mp4", (const uint8_t*)"hello ", 6, false);
+    EXPECT_TRUE(ret == ERROR_NONE);
+
+    pthread_t threadId;
+    ret = pthread_create(&threadId, NULL, HttpGetThread, this);
+    EXPECT_TRUE(ret == 0);
+
+    usleep(100000);
+    delete httpServer;
+    httpServer = NULL;
+
+    void *response = NULL;
+    pthread_join(threadId, &response);
+    std::string *responseStr = (std::string*)response;
+    EXPECT_TRUE(responseStr->find("6\r\nhello \r\n") != std::string::npos);
+    EXPECT_TRUE(responseStr->find("0\r\n\r\n") == std::string::npos);
+    delete responseStr;
+}
+}
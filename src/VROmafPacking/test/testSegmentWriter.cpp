@@ -0,0 +1,253 @@
+/*
+ * Copyright (c) 2019, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+//!
+//! \file:   testSegmentWriter.cpp
+//! \brief:  Segment writer class unit test
+//!
+
+#include "gtest/gtest.h"
+#include "../SegmentWriter.h"
+
+#include <ostream>
+#include <unistd.h>
+
+VCD_USE_VRVIDEO;
+
+namespace {
+class SegmentWriterTest : public testing::Test
+{
+public:
+    virtual void SetUp()
+    {
+        m_dataSize = SEGMENT_BUFFER_CHUNK_SIZE * 2 + 1234;
+        m_data = new char[m_dataSize];
+        if (!m_data)
+            return;
+
+        for (uint32_t i = 0; i < m_dataSize; i++)
+        {
+            m_data[i] = (char)(i * 7 + i / 251);
+        }
+    }
+
+    virtual void TearDown()
+    {
+        DELETE_ARRAY(m_data);
+    }
+
+    bool CheckFile(const char *fileName)
+    {
+        FILE *fp = fopen(fileName, "rb");
+        if (!fp)
+            return false;
+
+        char *readData = new char[m_dataSize + 1];
+        size_t readSize = fread(readData, 1, m_dataSize + 1, fp);
+        fclose(fp);
+
+        bool isSame = (readSize == m_dataSize) && !memcmp(readData, m_data, m_dataSize);
+        delete[] readData;
+        readData = NULL;
+
+        return isSame;
+    }
+
+    char     *m_data;
+    uint32_t m_dataSize;
+};
+
+TEST_F(SegmentWriterTest, SerializeIntoChunks)
+{
+    SegmentWriter *segWriter = new SegmentWriter(false);
+    EXPECT_TRUE(segWriter != NULL);
+    if (!segWriter)
+        return;
+
+    SegmentBuffer *segBuffer = segWriter->GetBuffer();
+    EXPECT_TRUE(segBuffer != NULL);
+
+    SegmentStreamBuf *streamBuf = new SegmentStreamBuf(segBuffer);
+    std::ostream segStream(streamBuf);
+    segStream.put(m_data[0]);
+    segStream.write(m_data + 1, m_dataSize - 1);
+    int32_t ret = streamBuf->Finish();
+    EXPECT_TRUE(ret == ERROR_NONE);
+    EXPECT_TRUE(segBuffer->dataSize == m_dataSize);
+    EXPECT_TRUE(segBuffer->chunks.size() == 3);
+    delete streamBuf;
+    streamBuf = NULL;
+
+    const char *segName = "testSegmentWriter.1.mp4";
+    ret = segWriter->WriteSegment(segBuffer, segName);
+    EXPECT_TRUE(ret == ERROR_NONE);
+    EXPECT_TRUE(CheckFile(segName));
+    EXPECT_TRUE(access("testSegmentWriter.1.mp4.tmp", F_OK) != 0);
+
+    SegmentBuffer *reusedBuffer = segWriter->GetBuffer();
+    EXPECT_TRUE(reusedBuffer == segBuffer);
+    EXPECT_TRUE(reusedBuffer->chunks.size() == 3);
+    SegmentWriter::DestroyBuffer(reusedBuffer);
+
+    remove(segName);
+    delete segWriter;
+    segWriter = NULL;
+}
+
+TEST_F(SegmentWriterTest, WriteSegmentsAsync)
+{
+    SegmentWriter *segWriter = new SegmentWriter(true);
+    EXPECT_TRUE(segWriter != NULL);
+    if (!segWriter)
+        return;
+
+    int32_t ret = segWriter->Initialize();
+    EXPECT_TRUE(ret == ERROR_NONE);
+
+    char segName[1024];
+    for (uint32_t segIdx = 0; segIdx < 20; segIdx++)
+    {
+        SegmentBuffer *segBuffer = segWriter->GetBuffer();
+        EXPECT_TRUE(segBuffer != NULL);
+
+        SegmentStreamBuf streamBuf(segBuffer);
+        std::ostream segStream(&streamBuf);
+        segStream.write(m_data, m_dataSize);
+        ret = streamBuf.Finish();
+        EXPECT_TRUE(ret == ERROR_NONE);
+
+        snprintf(segName, 1024, "testSegmentWriter.async.%d.mp4", segIdx);
+        ret = segWriter->WriteSegment(segBuffer, segName);
+        EXPECT_TRUE(ret == ERROR_NONE);
+    }
+
+    ret = segWriter->Flush();
+    EXPECT_TRUE(ret == ERROR_NONE);
+
+    for (uint32_t segIdx = 0; segIdx < 20; segIdx++)
+    {
+        snprintf(segName, 1024, "testSegmentWriter.async.%d.mp4", segIdx);
+        EXPECT_TRUE(CheckFile(segName));
+        remove(segName);
+    }
+
+    delete segWriter;
+    segWriter = NULL;
+}
+
+TEST_F(SegmentWriterTest, RemoveSegmentsInOrder)
+{
+    SegmentWriter *segWriter = new SegmentWriter(false);
+    EXPECT_TRUE(segWriter != NULL);
+    if (!segWriter)
+        return;
+
+    int32_t ret = segWriter->Initialize();
+    EXPECT_TRUE(ret == ERROR_NONE);
+
+    // each segment is removed right after being queued, so that
+    // the removal is always queued before it is written
+    char segName[1024];
+    for (uint32_t segIdx = 0; segIdx < 20; segIdx++)
+    {
+        SegmentBuffer *segBuffer = segWriter->GetBuffer();
+        EXPECT_TRUE(segBuffer != NULL);
+
+        SegmentStreamBuf streamBuf(segBuffer);
+        std::ostream segStream(&streamBuf);
+        segStream.write(m_data, m_dataSize);
+        ret = streamBuf.Finish();
+        EXPECT_TRUE(ret == ERROR_NONE);
+
+        snprintf(segName, 1024, "testSegmentWriter.remove.%d.mp4", segIdx);
+        ret = segWriter->WriteSegment(segBuffer, segName);
+        EXPECT_TRUE(ret == ERROR_NONE);
+
+        if (segIdx % 2)
+            continue;
+
+        ret = segWriter->RemoveSegment(segName);
+        EXPECT_TRUE(ret == ERROR_NONE);
+    }
+
+    // removing not existed segment isn't a failure
+    ret = segWriter->RemoveSegment("testSegmentWriter.remove.100.mp4");
+    EXPECT_TRUE(ret == ERROR_NONE);
+
+    ret = segWriter->Flush();
+    EXPECT_TRUE(ret == ERROR_NONE);
+
+    for (uint32_t segIdx = 0; segIdx < 20; segIdx++)
+    {
+        snprintf(segName, 1024, "testSegmentWriter.remove.%d.mp4", segIdx);
+        if (segIdx % 2)
+        {
+            EXPECT_TRUE(CheckFile(segName));
+            remove(segName);
+        }
+        else
+        {
+            EXPECT_TRUE(access(segName, F_OK) != 0);
+        }
+    }
+
+    delete segWriter;
+    segWriter = NULL;
+}
+
+TEST_F(SegmentWriterTest, WriteSegmentFailed)
+{
+    SegmentWriter *segWriter = new SegmentWriter(false);
+    EXPECT_TRUE(segWriter != NULL);
+    if (!segWriter)
+        return;
+
+    int32_t ret = segWriter->Initialize();
+    EXPECT_TRUE(ret == ERROR_NONE);
+
+    SegmentBuffer *segBuffer = segWriter->GetBuffer();
+    SegmentStreamBuf streamBuf(segBuffer);
+    std::ostream segStream(&streamBuf);
+    segStream.write(m_data, m_dataSize);
+    streamBuf.Finish();
+
+    ret = segWriter->WriteSegment(segBuffer, "notExistedDir/testSegmentWriter.1.mp4");
+    EXPECT_TRUE(ret == ERROR_NONE);
+
+    ret = segWriter->Flush();
+    EXPECT_TRUE(ret == OMAF_ERROR_WRITE_SEGMENT_FAILED);
+
+    // the failure is reported by next write too, since live
+    // streams never call Flush
+    segBuffer = segWriter->GetBuffer();
+    ret = segWriter->WriteSegment(segBuffer, "testSegmentWriter.2.mp4");
+    EXPECT_TRUE(ret == OMAF_ERROR_WRITE_SEGMENT_FAILED);
+    EXPECT_TRUE(access("testSegmentWriter.2.mp4", F_OK) != 0);
+
+    delete segWriter;
+    segWriter = NULL;
+}
+}
@@ -976,4 +976,45 @@ TEST_F(VideoStreamTest, AllProcess)
     fclose(fp);
     fp = NULL;
 }
+
+static void CountReleasedFrame(uint8_t *data, void *opaque)
+{
+    (void)data;
+    (*(uint32_t*)opaque)++;
+}
+
+TEST_F(VideoStreamTest, AddFrameInfoNoCopy)
+{
+    uint64_t frameSize[5] = { 79306, 39, 85, 39, 593 };
+
+    uint32_t releasedNum = 0;
+    uint64_t offset = 0;
+    for (uint8_t idx = 0; idx < 5; idx++)
+    {
+        FrameBSInfo frameInfo;
+        memset(&frameInfo, 0, sizeof(FrameBSInfo));
+        frameInfo.data = m_totalDataLow + offset;
+        frameInfo.dataSize = frameSize[idx];
+        frameInfo.pts = idx;
+        frameInfo.isKeyFrame = (idx == 0);
+        offset += frameSize[idx];
+
+        int32_t ret = m_vsLow->AddFrameInfo(&frameInfo, CountReleasedFrame, &releasedNum);
+        EXPECT_TRUE(ret == ERROR_NONE);
+
+        m_vsLow->SetCurrFrameInfo();
+        FrameBSInfo *currFrame = m_vsLow->GetCurrFrameInfo();
+        EXPECT_TRUE(currFrame != NULL);
+        if (!currFrame)
+            return;
+
+        EXPECT_TRUE(currFrame->data == frameInfo.data);
+        EXPECT_TRUE(currFrame->dataSize == frameInfo.dataSize);
+        EXPECT_TRUE(currFrame->pts == idx);
+        EXPECT_TRUE(releasedNum == idx);
+
+        m_vsLow->DestroyCurrFrameInfo();
+        EXPECT_TRUE(releasedNum == (uint32_t)(idx + 1));
+    }
+}
 }
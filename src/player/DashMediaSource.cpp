@@ -313,6 +313,7 @@ RenderStatus DashMediaSource::Initialize(struct RenderConfig renderConfig)
     pCtxDashStreaming->media_url = renderConfig.url;
     pCtxDashStreaming->cache_path = renderConfig.cachePath;
     pCtxDashStreaming->source_type = MultiResSource;
+    pCtxDashStreaming->viewport_lut_step = 0;
     m_handler = OmafAccess_Init(pCtxDashStreaming);
     if (NULL == m_handler)
     {
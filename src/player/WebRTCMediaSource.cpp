@@ -63,93 +63,46 @@ static inline int64_t currentTimeMs()
     return ((time.tv_sec * 1000) + (time.tv_usec / 1000));
 }
 
-static int isValidStartCode(uint8_t *data, int length)
-{
-    if (length < 3)
-        return -1;
-
-    if (data[0] == 0 && data[1] == 0 && data[2] == 1)
-        return 3;
-
-    if (length >= 4 && data[0] == 0 && data[1] == 0 && data[2] == 0 && data[3] == 1)
-        return 4;
-
-    return 0;
-}
-
-static int findFirstNALU(uint8_t *data, int length, int *offset, int *size)
-{
-    int i = 0;
-    int ret = -1;
-    int start_code_len = 0;
-    int nalu_offset = 0;
-    int nalu_type = -1;
-    int nalu_size = 0;
-
-    while (true) {
-        ret = isValidStartCode(data + i, length - i);
-        if (ret < 0)
-            return -1;
-        else if (ret > 0) {
-            start_code_len = ret;
-            nalu_offset = i;
-            break;
-        }
-
-        ++i;
-    }
-
-    i += start_code_len;
-    while (true) {
-        ret = isValidStartCode(data + i, length - i);
-        if (ret < 0) {
-            nalu_size = length - nalu_offset;
-            break;
-        } else if (ret > 0) {
-            nalu_size = i - nalu_offset ;
-            break;
-        }
-
-        ++i;
-    }
-
-    *offset = nalu_offset;
-    *size = nalu_size;
-    return (data[nalu_offset + start_code_len] & 0x7e) >> 1;
-}
+#define NALU_INDEX_SIZE 64
 
 static int filterNALs(std::shared_ptr<SimpleBuffer> bitstream_buf, const std::vector<int> &remove_types, std::shared_ptr<SimpleBuffer> sei_buf)
 {
-    int remove_nals_size = 0;
-
     uint8_t *buffer_start = bitstream_buf->data();
     int buffer_length = bitstream_buf->size();
-    int nalu_offset = 0;
-    int nalu_size = 0;
-    int nalu_type;
 
-    while (buffer_length > 0) {
-        nalu_type = findFirstNALU(buffer_start, buffer_length, &nalu_offset, &nalu_size);
-        if (nalu_type < 0)
-            break;
-
-        if (std::find(remove_types.begin(), remove_types.end(), nalu_type) != remove_types.end()) {
-            //copy
-            sei_buf->insert(buffer_start + nalu_offset, nalu_size);
+    // find all the NAL units in one pass, rescan only if the frame has more than the default index holds
+    param_nalIndex nalu_index[NALU_INDEX_SIZE];
+    std::vector<param_nalIndex> nalu_index_ext;
+    param_nalIndex *nalus = nalu_index;
+    int nalus_num = I360SCVP_ScanNALs(buffer_start, buffer_length, nalu_index, NALU_INDEX_SIZE);
+    if (nalus_num <= 0)
+        return buffer_length;
+    if (nalus_num > NALU_INDEX_SIZE) {
+        nalu_index_ext.resize(nalus_num);
+        nalus = nalu_index_ext.data();
+        I360SCVP_ScanNALs(buffer_start, buffer_length, nalus, nalus_num);
+    }
 
-            //next
-            memmove(buffer_start, buffer_start + nalu_offset + nalu_size, buffer_length - nalu_offset - nalu_size);
-            buffer_length -= nalu_offset + nalu_size;
+    // removed NAL units are dropped together with the bytes before them, the kept ones are moved down
+    int kept_length = 0;
+    int gap_start = 0;
+    for (int i = 0; i < nalus_num; i++) {
+        int nalu_offset = nalus[i].startCodeOffset;
+        int nalu_end = nalu_offset + nalus[i].naluSize;
+        int header_offset = nalu_offset + nalus[i].startCodeSize;
+        int nalu_type = (header_offset < buffer_length) ? ((buffer_start[header_offset] & 0x7e) >> 1) : -1;
 
-            remove_nals_size += nalu_offset + nalu_size;
-            continue;
+        if (std::find(remove_types.begin(), remove_types.end(), nalu_type) != remove_types.end()) {
+            sei_buf->insert(buffer_start + nalu_offset, nalus[i].naluSize);
+        } else {
+            if (kept_length != gap_start)
+                memmove(buffer_start + kept_length, buffer_start + gap_start, nalu_end - gap_start);
+            kept_length += nalu_end - gap_start;
         }
-
-        buffer_start += (nalu_offset + nalu_size);
-        buffer_length -= (nalu_offset + nalu_size);
+        gap_start = nalu_end;
     }
 
-    bitstream_buf->resize(bitstream_buf->size() - remove_nals_size);
+    bitstream_buf->resize(kept_length);
     return bitstream_buf->size();
 }
 
@@ -124,6 +124,8 @@ VCD_OMAF_BEGIN
 
 #define MAXSEGMENTDURATION                      "maxSegmentDuration"
 #define AVAILABILITYSTARTTIME                   "availabilityStartTime"
+#define AVAILABILITYTIMEOFFSET                  "availabilityTimeOffset"
+#define AVAILABILITYTIMECOMPLETE                "availabilityTimeComplete"
 #define MINIMUMUPDATEPERIOD                     "minimumUpdatePeriod"
 #define TIMESHIFTBUFFERDEPTH                    "timeShiftBufferDepth"
 #define PUBLISHTIME                             "publishTime"
@@ -83,6 +83,8 @@
 #define OMAF_ERROR_CREATE_FOLDER_FAILED          -46
 #define OMAF_ERROR_CREATE_XMLFILE_FAILED         -47
 #define OMAF_ERROR_INVALID_TRACKSEG_CTX          -48
+#define OMAF_ERROR_WRITE_SEGMENT_FAILED          -49
+#define OMAF_ERROR_START_HTTP_SERVER_FAILED      -50
 #define OMAF_ERROR_END_OF_STREAM                 -80
 #define OMAF_MEMORY_TOO_SMALL_BUFFER             -81
 #define OMAF_ERROR_STREAM_NOT_FOUND              -82